@@ -0,0 +1,156 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/PolylineCollection.hpp>
+#include <libslic3r/ShortestPath.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: chainingbench [num_polylines]\n"
+    "Measures the greedy chaining of num_polylines (50000 by default) infill polylines of a rectilinear\n"
+    "and of a gyroid like layer by the former linear scan and by the grid accelerated chaining,\n"
+    "and the travel length saved by the 2-opt improvement with a couple of time limits."
+};
+
+using namespace Slic3r;
+
+// Horizontal lines 0.5mm apart over a 200x200mm square, interrupted by random gaps as if clipped by an object with many holes.
+static Polylines rectilinear_layer(size_t num_polylines)
+{
+    std::mt19937 rng(0);
+    const coord_t size    = coord_t(scale_(200.));
+    const coord_t spacing = coord_t(scale_(0.5));
+    const size_t  num_lines = size_t(size / spacing);
+    const coord_t segment = coord_t(size / std::max<size_t>(1, (num_polylines + num_lines - 1) / num_lines));
+    std::uniform_int_distribution<coord_t> gap(segment / 10, segment / 3);
+    Polylines out;
+    for (size_t i = 0; out.size() < num_polylines; ++ i) {
+        coord_t y = coord_t(i % num_lines) * spacing + coord_t(i / num_lines) * spacing / 4;
+        for (coord_t x = gap(rng); x + segment / 2 < size && out.size() < num_polylines; x += segment)
+            out.emplace_back(Polyline(Point(x, y), Point(x + segment - gap(rng), y)));
+    }
+    std::shuffle(out.begin(), out.end(), rng);
+    return out;
+}
+
+// Short wavy polylines along the gyroid like curves y = a * sin(x / a), alternating their direction.
+static Polylines gyroid_layer(size_t num_polylines)
+{
+    std::mt19937 rng(1);
+    const double size    = 200.;
+    const double spacing = 1.;
+    const double period  = 4.;
+    std::uniform_real_distribution<double> length(1., 4.);
+    Polylines out;
+    for (size_t i = 0; out.size() < num_polylines; ++ i) {
+        double y0 = std::fmod(double(i) * spacing, size);
+        for (double x = 0.; x < size && out.size() < num_polylines;) {
+            double   x_end = std::min(size, x + length(rng));
+            Polyline polyline;
+            for (double t = x; t < x_end; t += 0.25)
+                polyline.points.emplace_back(Point::new_scale(t, y0 + 0.5 * period / PI * std::sin(2. * PI * t / period)));
+            if (polyline.points.size() > 1)
+                out.emplace_back(std::move(polyline));
+            x = x_end + 0.5;
+        }
+    }
+    std::shuffle(out.begin(), out.end(), rng);
+    return out;
+}
+
+// The former PolylineCollection::_chained_path_from(): Linear scan over the end points, which are erased once visited.
+static Polylines chain_linear(const Polylines &src, Point start_near)
+{
+    struct Chaining { Point first; Point last; size_t idx; };
+    std::vector<Chaining> endpoints;
+    for (size_t i = 0; i < src.size(); ++ i)
+        endpoints.push_back({ src[i].first_point(), src[i].last_point(), i });
+    Polylines out;
+    while (! endpoints.empty()) {
+        double dmin = std::numeric_limits<double>::max();
+        size_t idx  = 0;
+        for (size_t i = 0; i < endpoints.size() * 2; ++ i) {
+            const Point &pt = (i & 1) ? endpoints[i / 2].last : endpoints[i / 2].first;
+            double d = sqr(double(start_near.x() - pt.x())) + sqr(double(start_near.y() - pt.y()));
+            if (d < dmin) {
+                dmin = d;
+                idx  = i;
+            }
+        }
+        out.push_back(src[endpoints[idx / 2].idx]);
+        if (idx & 1)
+            out.back().reverse();
+        endpoints.erase(endpoints.begin() + idx / 2);
+        start_near = out.back().last_point();
+    }
+    return out;
+}
+
+static double travel_length(const Polylines &polylines, Point start_near)
+{
+    double length = 0.;
+    for (const Polyline &polyline : polylines) {
+        length    += (polyline.first_point() - start_near).cast<double>().norm();
+        start_near = polyline.last_point();
+    }
+    return unscale<double>(length);
+}
+
+static void bench_layer(const char *name, const Polylines &polylines)
+{
+    using std::cout; using std::endl;
+    cout << name << ", " << polylines.size() << " polylines:" << endl;
+
+    Benchmark bench;
+    Point     start(0, 0);
+    bench.start();
+    Polylines linear = chain_linear(polylines, start);
+    bench.stop();
+    double time_linear = bench.getElapsedSec();
+    cout << "    linear scan:          " << std::setw(8) << std::setprecision(4) << time_linear << " s, travel " << travel_length(linear, start) << " mm" << endl;
+
+    bench.start();
+    Polylines grid = PolylineCollection::chained_path_from(polylines, start);
+    bench.stop();
+    cout << "    grid:                 " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, travel " << travel_length(grid, start)
+         << " mm, " << std::setprecision(3) << time_linear / bench.getElapsedSec() << "x faster"
+         << ((linear.size() == grid.size() && std::equal(linear.begin(), linear.end(), grid.begin(), [](const Polyline &a, const Polyline &b) { return a.points == b.points; })) ?
+            ", same order" : ", DIFFERENT ORDER") << endl;
+
+    Points endpoints;
+    for (const Polyline &polyline : polylines) {
+        endpoints.emplace_back(polyline.first_point());
+        endpoints.emplace_back(polyline.last_point());
+    }
+    for (double time_limit : { 0.05, 0.2, 1., 5. }) {
+        bench.start();
+        std::vector<std::pair<size_t, bool>> chain = chain_segments(endpoints, start, false);
+        improve_chain_by_two_opt(endpoints, start, chain, time_limit);
+        bench.stop();
+        cout << "    grid + 2-opt " << std::setw(4) << time_limit << " s: " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec()
+             << " s, travel " << unscale<double>(chain_travel_length(endpoints, start, chain)) << " mm" << endl;
+    }
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t num_polylines = 50000;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_polylines = size_t(std::stoul(argv[1]));
+    }
+
+    bench_layer("Rectilinear", rectilinear_layer(num_polylines));
+    bench_layer("Gyroid", gyroid_layer(num_polylines));
+    return EXIT_SUCCESS;
+}
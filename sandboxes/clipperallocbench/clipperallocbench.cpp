@@ -0,0 +1,170 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <boost/filesystem.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: clipperallocbench [model_file]\n"
+    "Counts the heap allocations of a print (slicing and G-code export) and of the most frequent ClipperUtils calls\n"
+    "over its layers, comparing the reused Clipper engines with a fresh Clipper engine and a copy of the input per call.\n"
+    "A reference print of a couple of synthetic objects is used if no model file is given."
+};
+
+// Count all heap allocations of the process.
+static std::atomic<size_t> g_num_allocations(0);
+static std::atomic<size_t> g_bytes_allocated(0);
+
+void* operator new(std::size_t size)
+{
+    ++ g_num_allocations;
+    g_bytes_allocated += size;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void  operator delete(void *ptr) noexcept { std::free(ptr); }
+void  operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+using namespace Slic3r;
+
+struct AllocationCounter
+{
+    void   start() { m_num_allocations = g_num_allocations; m_bytes_allocated = g_bytes_allocated; m_bench.start(); }
+    void   stop()  { m_bench.stop(); m_num_allocations = g_num_allocations - m_num_allocations; m_bytes_allocated = g_bytes_allocated - m_bytes_allocated; }
+    size_t num_allocations() const { return m_num_allocations; }
+    double mb_allocated()    const { return double(m_bytes_allocated) / (1024. * 1024.); }
+    double seconds()               { return m_bench.getElapsedSec(); }
+
+private:
+    size_t    m_num_allocations = 0;
+    size_t    m_bytes_allocated = 0;
+    Benchmark m_bench;
+};
+
+static Model reference_model()
+{
+    Model model;
+    auto add_object = [&model](const char *name, TriangleMesh &&mesh, size_t num_instances) {
+        ModelObject *object = model.add_object();
+        object->name = name;
+        object->add_volume(std::move(mesh));
+        for (size_t i = 0; i < num_instances; ++ i)
+            object->add_instance();
+    };
+    add_object("sphere",   make_sphere(25., 2. * PI / 360.), 1);
+    add_object("cylinder", make_cylinder(12., 40.), 2);
+    add_object("cube",     make_cube(30., 30., 20.), 2);
+    return model;
+}
+
+// The former implementation of the ClipperUtils calls: A new Clipper engine per call and the input copied to ClipperLib::Paths.
+static Polygons fresh_diff(const Polygons &subject, const Polygons &clip)
+{
+    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
+    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
+    ClipperLib::Clipper clipper;
+    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    ClipperLib::Paths output;
+    clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return ClipperPaths_to_Slic3rPolygons(output);
+}
+
+static Polygons fresh_offset(const Polygons &polygons, const float delta)
+{
+    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
+    for (ClipperLib::Path &path : input)
+        for (ClipperLib::IntPoint &pt : path) {
+            pt.X <<= CLIPPER_OFFSET_POWER_OF_2;
+            pt.Y <<= CLIPPER_OFFSET_POWER_OF_2;
+        }
+    ClipperLib::ClipperOffset co;
+    co.MiterLimit = 3.;
+    const float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
+    co.ShortestEdgeLength = double(std::abs(delta_scaled * 0.005f));
+    co.AddPaths(input, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+    ClipperLib::Paths output;
+    co.Execute(output, delta_scaled);
+    for (ClipperLib::Path &path : output)
+        for (ClipperLib::IntPoint &pt : path) {
+            pt.X = (pt.X + CLIPPER_OFFSET_SCALE_ROUNDING_DELTA) >> CLIPPER_OFFSET_POWER_OF_2;
+            pt.Y = (pt.Y + CLIPPER_OFFSET_SCALE_ROUNDING_DELTA) >> CLIPPER_OFFSET_POWER_OF_2;
+        }
+    return ClipperPaths_to_Slic3rPolygons(output);
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+    config->set_deserialize("layer_height", "0.2");
+    config->set_deserialize("fill_density", "20%");
+
+    Model model = (argc > 1) ? Model::read_from_file(argv[1]) : reference_model();
+    model.add_default_instances();
+    model.arrange_objects(PrintConfig::min_object_distance(config.get()));
+    model.center_instances_around_point(Vec2d(125., 105.));
+
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    std::vector<Polygons> layers;
+    {
+        AllocationCounter counter;
+        Print print;
+        print.apply(model, *config);
+        counter.start();
+        print.process();
+        GCode gcode;
+        gcode.do_export(&print, path.c_str());
+        counter.stop();
+        boost::filesystem::remove(path);
+        cout << "Print: " << counter.num_allocations() << " allocations, " << std::setprecision(4) << counter.mb_allocated() << " MB, "
+             << counter.seconds() << " s" << endl;
+        for (const PrintObject *object : print.objects())
+            for (const Layer *layer : object->layers())
+                layers.emplace_back(to_polygons(layer->slices.expolygons));
+    }
+
+    // Per layer operations as performed by the perimeter generator and by the infill preparation.
+    auto bench = [&layers](const char *name, const std::function<size_t(const Polygons&, const Polygons&)> &fn) {
+        AllocationCounter counter;
+        size_t num_calls = 0;
+        size_t check     = 0;
+        counter.start();
+        for (size_t i = 1; i < layers.size(); ++ i, ++ num_calls)
+            check += fn(layers[i], layers[i - 1]);
+        counter.stop();
+        cout << "    " << std::left << std::setw(24) << name << std::right << std::setw(10) << std::setprecision(4)
+             << double(counter.num_allocations()) / double(std::max<size_t>(num_calls, 1)) << " allocations per call, "
+             << counter.seconds() << " s, " << check << " points" << endl;
+    };
+    auto num_points = [](const Polygons &polygons) { size_t n = 0; for (const Polygon &p : polygons) n += p.points.size(); return n; };
+    cout << layers.size() << " layers:" << endl;
+    bench("diff, fresh engine",     [&num_points](const Polygons &a, const Polygons &b) { return num_points(fresh_diff(a, b)); });
+    bench("diff, reused engine",    [&num_points](const Polygons &a, const Polygons &b) { return num_points(diff(a, b)); });
+    bench("offset, fresh engine",   [&num_points](const Polygons &a, const Polygons &)  { return num_points(fresh_offset(a, -0.45f)); });
+    bench("offset, reused engine",  [&num_points](const Polygons &a, const Polygons &)  { return num_points(offset(a, -0.45f)); });
+    return EXIT_SUCCESS;
+}
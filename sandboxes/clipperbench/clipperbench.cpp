@@ -0,0 +1,138 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: clipperbench [grid_size]\n"
+    "Slices a grid of grid_size x grid_size spheres (20 x 20 by default) and runs the boolean operations\n"
+    "of the support trimming, of the extra perimeters detection, of clip_fill_surfaces() and a union\n"
+    "over the sliced layers, by the plain Clipper operations and by their bounding box aware variants."
+};
+
+using namespace Slic3r;
+
+// Layers of a grid of spheres 3mm in radius, 8mm apart.
+static std::vector<ExPolygons> slice_spheres(size_t grid_size, const std::vector<float> &z)
+{
+    TriangleMesh mesh;
+    TriangleMesh sphere = make_sphere(3., 2. * PI / 72.);
+    for (size_t i = 0; i < grid_size; ++ i)
+        for (size_t j = 0; j < grid_size; ++ j) {
+            TriangleMesh copy = sphere;
+            copy.translate(float(8. * i), float(8. * j), 3.f);
+            mesh.merge(copy);
+        }
+    mesh.require_shared_vertices();
+    TriangleMeshSlicer slicer(&mesh);
+    std::vector<ExPolygons> layers;
+    slicer.slice(z, 0.f, &layers, [](){});
+    return layers;
+}
+
+static double area(const Polygons &polygons)
+{
+    double a = 0.;
+    for (const Polygon &polygon : polygons)
+        a += polygon.area();
+    return unscale<double>(unscale<double>(a));
+}
+
+static double area(const ExPolygons &expolygons)
+{
+    double a = 0.;
+    for (const ExPolygon &expolygon : expolygons)
+        a += expolygon.area();
+    return unscale<double>(unscale<double>(a));
+}
+
+// Run the plain operation, its bounding box aware variant and the parallel bounding box aware variant,
+// report the times and the resulting areas (or lengths), which shall match.
+static void bench(const char *name, const std::function<double(int)> &fn)
+{
+    using std::cout; using std::endl;
+    static const char *variants[] = { "plain", "bbox", "bbox parallel" };
+    cout << name << ":" << endl;
+    Benchmark b;
+    for (int variant = 0; variant < 3; ++ variant) {
+        b.start();
+        double result = fn(variant);
+        b.stop();
+        cout << "    " << std::left << std::setw(16) << variants[variant] << std::right << std::setw(10) << std::setprecision(4) << b.getElapsedSec()
+             << " s, result " << std::setprecision(8) << result << endl;
+    }
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t grid_size = 20;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        grid_size = size_t(std::stoul(argv[1]));
+    }
+
+    std::vector<ExPolygons> layers = slice_spheres(grid_size, { 1.f, 1.2f, 3.f, 5.f });
+    const Polygons lower = to_polygons(layers[0]);
+    const Polygons upper = to_polygons(layers[1]);
+    cout << grid_size * grid_size << " islands per layer" << endl;
+
+    {
+        // PrintObjectSupportMaterial::trim_support_layers_by_object(): Support islands trimmed by the object layers offsetted by the XY gap.
+        Polygons support   = offset(lower, float(scale_(2.)));
+        Polygons trimming  = offset(layers[2], float(scale_(0.5)));
+        polygons_append(trimming, offset(layers[1], float(scale_(0.5))));
+        bench("diff: support trimming", [&](int variant) {
+            return area(variant == 0 ? diff(support, trimming) : diff_bbox(support, trimming, false, variant == 2));
+        });
+    }
+    {
+        // PrintObject::make_perimeters(): The upper layer polylines intersected with the critical area of each lower layer island.
+        Polylines upper_polylines = to_polylines(layers[3]);
+        bench("intersection_pl: extra perimeters", [&](int variant) {
+            double length = 0.;
+            for (const ExPolygon &island : layers[2]) {
+                Polygons critical_area = diff(offset(island, float(scale_(-0.4))), offset(island, float(scale_(-1.))));
+                length += total_length(variant == 0 ? intersection_pl(upper_polylines, critical_area) :
+                                                      intersection_pl_bbox(upper_polylines, critical_area, false, variant == 2));
+            }
+            return unscale<double>(length);
+        });
+    }
+    {
+        // PrintObject::clip_fill_surfaces(): The internal surfaces split by the areas to be supported.
+        Polygons internal       = offset(layers[2], float(scale_(-0.8)));
+        Polygons upper_internal = offset(upper, float(scale_(-0.5)));
+        bench("intersection_ex + diff_ex: clip_fill_surfaces", [&](int variant) {
+            return variant == 0 ?
+                area(intersection_ex(internal, upper_internal, true)) + area(diff_ex(internal, upper_internal, true)) :
+                area(intersection_ex_bbox(internal, upper_internal, true, variant == 2)) + area(diff_ex_bbox(internal, upper_internal, true, variant == 2));
+        });
+    }
+    {
+        // Union of overlapping islands, where the bounding box split does not help.
+        Polygons islands = offset(lower, float(scale_(2.5)));
+        polygons_append(islands, upper);
+        bench("union_ex: overlapping islands", [&](int variant) {
+            return area(variant == 0 ? union_ex(islands) : union_ex_bbox(islands, false, variant == 2));
+        });
+    }
+    {
+        Polygons islands = lower;
+        polygons_append(islands, upper);
+        bench("union_ex: disjoint islands", [&](int variant) {
+            return area(variant == 0 ? union_ex(islands) : union_ex_bbox(islands, false, variant == 2));
+        });
+    }
+    return EXIT_SUCCESS;
+}
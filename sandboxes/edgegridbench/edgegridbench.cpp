@@ -0,0 +1,129 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <tbb/task_scheduler_init.h>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/EdgeGrid.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: edgegridbench [model_file]\n"
+    "Measures the construction of the edge grids over the layer outlines of a print by a single thread and by all threads,\n"
+    "and the overhang queries of the seam placement (the signed distances of the perimeter points to the outlines of the layer below)\n"
+    "point by point and by the batch query. The batch results are verified to be identical.\n"
+    "A reference print of a couple of synthetic objects is used if no model file is given."
+};
+
+using namespace Slic3r;
+
+static Model reference_model()
+{
+    Model model;
+    auto add_object = [&model](const char *name, TriangleMesh &&mesh, size_t num_instances) {
+        ModelObject *object = model.add_object();
+        object->name = name;
+        object->add_volume(std::move(mesh));
+        for (size_t i = 0; i < num_instances; ++ i)
+            object->add_instance();
+    };
+    add_object("sphere",   make_sphere(25., 2. * PI / 360.), 1);
+    add_object("cylinder", make_cylinder(12., 40.), 2);
+    add_object("cube",     make_cube(30., 30., 20.), 2);
+    return model;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+    config->set_deserialize("layer_height", "0.2");
+
+    Model model = (argc > 1) ? Model::read_from_file(argv[1]) : reference_model();
+    model.add_default_instances();
+    model.arrange_objects(PrintConfig::min_object_distance(config.get()));
+    model.center_instances_around_point(Vec2d(125., 105.));
+
+    // Outlines of the layers and the points of their outer perimeters, as queried by GCode::extrude_loop().
+    std::vector<ExPolygons> outlines;
+    std::vector<Points>     perimeter_points;
+    {
+        Print print;
+        print.apply(model, *config);
+        print.process();
+        for (const PrintObject *object : print.objects())
+            for (const Layer *layer : object->layers()) {
+                outlines.emplace_back(layer->slices.expolygons);
+                Points pts;
+                for (const Polygon &polygon : to_polygons(offset_ex(layer->slices.expolygons, float(scale_(-0.2)))))
+                    append(pts, polygon.points);
+                perimeter_points.emplace_back(std::move(pts));
+            }
+    }
+    size_t num_points = 0;
+    for (const Points &pts : perimeter_points)
+        num_points += pts.size();
+    cout << outlines.size() << " layers, " << num_points << " perimeter points" << endl;
+
+    const coord_t resolution = coord_t(scale_(1.));
+    const coord_t search_r   = coord_t(scale_(0.8 * 0.4) + 0.5);
+    std::vector<std::unique_ptr<EdgeGrid::Grid>> grids(outlines.size());
+    Benchmark bench;
+    auto create_grids = [&]() {
+        for (size_t i = 0; i < outlines.size(); ++ i) {
+            grids[i].reset(new EdgeGrid::Grid());
+            grids[i]->create(outlines[i], resolution);
+            grids[i]->calculate_sdf();
+        }
+    };
+    {
+        tbb::task_scheduler_init init(1);
+        bench.start();
+        create_grids();
+        bench.stop();
+    }
+    double time_serial = bench.getElapsedSec();
+    cout << "    create, 1 thread:     " << std::setw(8) << std::setprecision(4) << time_serial << " s" << endl;
+    bench.start();
+    create_grids();
+    bench.stop();
+    cout << "    create, " << std::setw(3) << tbb::task_scheduler_init::default_num_threads() << " threads:  " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, "
+         << std::setprecision(3) << time_serial / bench.getElapsedSec() << "x faster" << endl;
+
+    // Query each layer's perimeter points against the grid of the layer below, a couple of times to get measurable times.
+    const size_t num_repeats = 10;
+    std::vector<std::vector<coordf_t>> scalar(outlines.size()), batch(outlines.size());
+    bench.start();
+    for (size_t repeat = 0; repeat < num_repeats; ++ repeat)
+        for (size_t i = 1; i < outlines.size(); ++ i) {
+            const Points &pts = perimeter_points[i];
+            scalar[i].assign(pts.size(), 0.);
+            for (size_t j = 0; j < pts.size(); ++ j)
+                grids[i - 1]->signed_distance(pts[j], search_r, scalar[i][j]);
+        }
+    bench.stop();
+    double time_scalar = bench.getElapsedSec();
+    cout << "    " << num_repeats << "x queries, scalar:  " << std::setw(8) << std::setprecision(4) << time_scalar << " s" << endl;
+    bench.start();
+    for (size_t repeat = 0; repeat < num_repeats; ++ repeat)
+        for (size_t i = 1; i < outlines.size(); ++ i)
+            grids[i - 1]->signed_distances(perimeter_points[i], search_r, batch[i]);
+    bench.stop();
+    cout << "    " << num_repeats << "x queries, batch:   " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, "
+         << std::setprecision(3) << time_scalar / bench.getElapsedSec() << "x faster" << ((scalar == batch) ? ", same distances" : ", DIFFERENT DISTANCES") << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: gcodebench [model_file [repetitions]]\n"
+    "Measures the G-code export throughput (MB/s) of the serial and of the pipelined export.\n"
+    "A reference print of a couple of synthetic objects is used if no model file is given."
+};
+
+using namespace Slic3r;
+
+static Model reference_model()
+{
+    Model model;
+    auto add_object = [&model](const char *name, TriangleMesh &&mesh, size_t num_instances) {
+        ModelObject *object = model.add_object();
+        object->name = name;
+        object->add_volume(std::move(mesh));
+        for (size_t i = 0; i < num_instances; ++ i)
+            object->add_instance();
+    };
+    add_object("sphere",   make_sphere(25., 2. * PI / 360.), 1);
+    add_object("cylinder", make_cylinder(12., 40.), 2);
+    add_object("cube",     make_cube(30., 30., 20.), 2);
+    return model;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+    config->set_deserialize("layer_height", "0.1");
+    config->set_deserialize("fill_density", "25%");
+    config->set_deserialize("gcode_comments", "1");
+
+    Model model = (argc > 1) ? Model::read_from_file(argv[1]) : reference_model();
+    model.add_default_instances();
+    model.arrange_objects(PrintConfig::min_object_distance(config.get()));
+    model.center_instances_around_point(Vec2d(125., 105.));
+    int repetitions = (argc > 2) ? std::stoi(argv[2]) : 3;
+
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    Benchmark bench;
+    for (bool pipelined : { false, true }) {
+        double time_total = 0.;
+        size_t size_total = 0;
+        for (int i = 0; i < repetitions; ++ i) {
+            // A G-code may only be exported once from a Print, slice it again.
+            Print print;
+            print.apply(model, *config);
+            print.process();
+            GCode gcode;
+            gcode.set_pipelined_export(pipelined);
+            bench.start();
+            gcode.do_export(&print, path.c_str());
+            bench.stop();
+            time_total += bench.getElapsedSec();
+            size_total += size_t(boost::filesystem::file_size(path));
+            boost::filesystem::remove(path);
+        }
+        cout << (pipelined ? "Pipelined" : "Serial   ") << " export: " << std::setprecision(4)
+             << time_total / repetitions << " seconds, " << double(size_total) / double(repetitions * 1024 * 1024) << " MB, "
+             << double(size_total) / (1024. * 1024. * time_total) << " MB/s" << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
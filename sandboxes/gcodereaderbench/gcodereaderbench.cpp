@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <random>
+
+#include <boost/filesystem.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCodeReader.hpp>
+#include <libslic3r/GCodeTimeEstimator.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: gcodereaderbench [size_MB]\n"
+    "Generates a synthetic G-code file of size_MB megabytes (500 MB by default)\n"
+    "and measures the parsing throughput of GCodeReader and of GCodeTimeEstimator."
+};
+
+using namespace Slic3r;
+
+// Write a G-code resembling the output of the G-code generator.
+static void generate_gcode(const std::string &path, size_t size)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coordinates(20., 230.);
+    FILE  *f     = fopen(path.c_str(), "wb");
+    size_t total = 0;
+    double e     = 0.;
+    char   line[128];
+    for (size_t layer_id = 0; total < size; ++ layer_id) {
+        total += fprintf(f, ";LAYER_CHANGE\n;Z:%.3f\nG1 Z%.3f F10800.000\n", 0.2 * (layer_id + 1), 0.2 * (layer_id + 1));
+        for (size_t i = 0; i < 10000 && total < size; ++ i) {
+            int len;
+            switch (i % 20) {
+            case 0:  len = sprintf(line, "G1 X%.3f Y%.3f F7800.000\n", coordinates(rng), coordinates(rng)); break;
+            case 1:  len = sprintf(line, "G1 E%.5f F2100.00000\n", e += 0.8); break;
+            case 2:  len = sprintf(line, "G1 F1800\n"); break;
+            case 19: len = sprintf(line, "G1 E%.5f F2100.00000\n", e -= 0.8); break;
+            default: len = sprintf(line, "G1 X%.3f Y%.3f E%.5f\n", coordinates(rng), coordinates(rng), e += 0.04); break;
+            }
+            fwrite(line, 1, len, f);
+            total += len;
+        }
+    }
+    fclose(f);
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t size_MB = 500;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        size_MB = size_t(std::stoul(argv[1]));
+    }
+
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    generate_gcode(path, size_MB * 1024 * 1024);
+    double file_MB = double(boost::filesystem::file_size(path)) / (1024. * 1024.);
+    cout << "Generated " << std::setprecision(4) << file_MB << " MB of G-code" << endl;
+
+    Benchmark bench;
+    auto report = [&bench, file_MB](const char *name, size_t num_lines) {
+        cout << name << std::setprecision(4) << bench.getElapsedSec() << " seconds, "
+             << file_MB / bench.getElapsedSec() << " MB/s";
+        if (num_lines > 0)
+            cout << ", " << num_lines << " lines";
+        cout << endl;
+    };
+
+    {
+        // The former GCodeReader::parse_file(): std::getline() and a new GCodeLine for each line.
+        GCodeReader reader;
+        size_t      num_lines = 0;
+        bench.start();
+        std::ifstream f(path);
+        std::string line;
+        while (std::getline(f, line))
+            reader.parse_line(line, [&num_lines](GCodeReader&, const GCodeReader::GCodeLine&) { ++ num_lines; });
+        bench.stop();
+        report("std::getline + parse_line:             ", num_lines);
+    }
+    {
+        GCodeReader reader;
+        size_t      num_lines = 0;
+        bench.start();
+        reader.parse_file(path, [&num_lines](GCodeReader&, const GCodeReader::GCodeLine&) { ++ num_lines; });
+        bench.stop();
+        report("GCodeReader::parse_file:               ", num_lines);
+    }
+    {
+        GCodeTimeEstimator estimator(GCodeTimeEstimator::Normal);
+        bench.start();
+        estimator.calculate_time_from_file(path);
+        bench.stop();
+        report("GCodeTimeEstimator::calculate_time_from_file: ", 0);
+        cout << "Estimated print time: " << estimator.get_time_dhms() << endl;
+    }
+
+    boost::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
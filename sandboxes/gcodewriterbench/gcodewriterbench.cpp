@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCodeWriter.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: gcodewriterbench [number_of_moves]\n"
+    "Measures the throughput of GCodeWriter::extrude_to_xy() / travel_to_xy() compared to the former std::ostringstream formatting."
+};
+
+using namespace Slic3r;
+
+// The former GCodeWriter::extrude_to_xy() formatting.
+static std::string extrude_to_xy_ostringstream(const Vec2d &point, double e)
+{
+    std::ostringstream gcode;
+    gcode << "G1 X" << std::fixed << std::setprecision(3) << point(0)
+          <<   " Y" << std::fixed << std::setprecision(3) << point(1)
+          <<   " E" << std::fixed << std::setprecision(5) << e;
+    gcode << "\n";
+    return gcode.str();
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t num_moves = 10000000;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_moves = size_t(std::stoul(argv[1]));
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coordinates(0., 250.);
+    std::vector<Vec2d> points;
+    points.reserve(num_moves);
+    for (size_t i = 0; i < num_moves; ++ i)
+        points.emplace_back(coordinates(rng), coordinates(rng));
+
+    Benchmark bench;
+    auto report = [&bench, num_moves](const char *name, size_t num_bytes) {
+        cout << name << std::setprecision(4) << bench.getElapsedSec() << " seconds, "
+             << double(num_moves) / (1000000. * bench.getElapsedSec()) << " M lines/s, "
+             << double(num_bytes) / (1024. * 1024. * bench.getElapsedSec()) << " MB/s" << endl;
+    };
+
+    {
+        size_t num_bytes = 0;
+        double e = 0.;
+        bench.start();
+        for (const Vec2d &pt : points)
+            num_bytes += extrude_to_xy_ostringstream(pt, e += 0.01).size();
+        bench.stop();
+        report("std::ostringstream extrude_to_xy: ", num_bytes);
+    }
+
+    GCodeWriter writer;
+    writer.set_extruders({ 0 });
+    writer.set_extruder(0);
+    {
+        size_t num_bytes = 0;
+        bench.start();
+        for (const Vec2d &pt : points)
+            num_bytes += writer.extrude_to_xy(pt, 0.01).size();
+        bench.stop();
+        report("GCodeWriter::extrude_to_xy:       ", num_bytes);
+    }
+    {
+        size_t num_bytes = 0;
+        bench.start();
+        for (const Vec2d &pt : points)
+            num_bytes += writer.travel_to_xy(pt).size();
+        bench.stop();
+        report("GCodeWriter::travel_to_xy:        ", num_bytes);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/IndexedMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: meshbench [stlfilename.stl]\n"
+    "Compares the memory footprint and the processing time of TriangleMesh (stl_file) and IndexedMesh.\n"
+    "A synthetic sphere of 5M facets is used if no STL file is given."
+};
+
+// Memory occupied by the stl_file buffers, including the topology tables generated for the slicer.
+static size_t stl_memsize(const Slic3r::TriangleMesh &mesh)
+{
+    const stl_file &stl = mesh.stl;
+    size_t size = stl.stats.number_of_facets * sizeof(stl_facet);
+    if (stl.neighbors_start != nullptr)
+        size += stl.stats.number_of_facets * sizeof(stl_neighbors);
+    if (stl.v_indices != nullptr)
+        size += stl.stats.number_of_facets * sizeof(v_indices_struct);
+    if (stl.v_shared != nullptr)
+        size += stl.stats.shared_vertices * sizeof(stl_vertex);
+    return size;
+}
+
+template<typename Fn> static double measure(Fn fn)
+{
+    Benchmark bench;
+    bench.start();
+    fn();
+    bench.stop();
+    return bench.getElapsedSec();
+}
+
+int main(const int argc, const char *argv[]) {
+    using namespace Slic3r;
+    using std::cout; using std::endl;
+
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        mesh.ReadSTLFile(argv[1]);
+    } else
+        mesh = make_sphere(50., 2. * PI / std::sqrt(5000000.));
+    mesh.require_shared_vertices();
+
+    IndexedMesh imesh(mesh);
+
+    cout << "Facets: " << mesh.facets_count() << ", vertices: " << imesh.vertices_count() << endl;
+    cout << std::setprecision(6);
+    cout << "Memory stl_file:    " << double(stl_memsize(mesh)) / (1024. * 1024.) << " MB" << endl;
+    cout << "Memory IndexedMesh: " << double(imesh.memsize()) / (1024. * 1024.) << " MB" << endl;
+
+    Transform3d trafo = Transform3d::Identity();
+    trafo.rotate(Eigen::AngleAxisd(0.3, Vec3d(1., 1., 0.).normalized()));
+    trafo.translate(Vec3d(10., 20., 30.));
+
+    BoundingBoxf3 bb1, bb2;
+    cout << "transformed_bounding_box stl_file:    " << measure([&](){ bb1 = mesh.transformed_bounding_box(trafo); }) << " s" << endl;
+    cout << "transformed_bounding_box IndexedMesh: " << measure([&](){ bb2 = imesh.transformed_bounding_box(trafo); }) << " s" << endl;
+
+    TriangleMesh hull1, hull2;
+    cout << "convex_hull_3d stl_file:    " << measure([&](){ hull1 = mesh.convex_hull_3d(); }) << " s" << endl;
+    cout << "convex_hull_3d IndexedMesh: " << measure([&](){ hull2 = imesh.convex_hull_3d(); }) << " s" << endl;
+
+    ExPolygons proj1, proj2;
+    cout << "horizontal_projection stl_file:    " << measure([&](){ proj1 = mesh.horizontal_projection(); }) << " s" << endl;
+    cout << "horizontal_projection IndexedMesh: " << measure([&](){ proj2 = imesh.horizontal_projection(); }) << " s" << endl;
+
+    std::vector<float> z;
+    BoundingBoxf3 bb = mesh.bounding_box();
+    for (float slice_z = float(bb.min(2)) + 0.025f; slice_z < float(bb.max(2)); slice_z += 0.05f)
+        z.emplace_back(slice_z);
+    std::vector<Polygons> layers1, layers2;
+    cout << "slicing stl_file:    " << measure([&](){ 
+        TriangleMeshSlicer slicer;
+        slicer.init(&mesh, [](){});
+        slicer.slice(z, &layers1, [](){});
+    }) << " s" << endl;
+    cout << "slicing IndexedMesh: " << measure([&](){ 
+        TriangleMeshSlicer slicer;
+        slicer.init(&imesh, [](){});
+        slicer.slice(z, &layers2, [](){});
+    }) << " s" << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: motionplannerbench [model_file]\n"
+    "Measures the G-code export of a plate of multiple objects with and without avoid_crossing_perimeters,\n"
+    "the difference being the time spent planning the travel moves.\n"
+    "A reference plate of a couple of synthetic objects is used if no model file is given."
+};
+
+using namespace Slic3r;
+
+static Model reference_model()
+{
+    Model model;
+    auto add_object = [&model](const char *name, TriangleMesh &&mesh, size_t num_instances) {
+        ModelObject *object = model.add_object();
+        object->name = name;
+        object->add_volume(std::move(mesh));
+        for (size_t i = 0; i < num_instances; ++ i)
+            object->add_instance();
+    };
+    add_object("sphere",   make_sphere(15., 2. * PI / 180.), 2);
+    add_object("cylinder", make_cylinder(8., 30.), 3);
+    add_object("cube",     make_cube(20., 20., 15.), 2);
+    return model;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    Model model = (argc > 1) ? Model::read_from_file(argv[1]) : reference_model();
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    double time_without = 0.;
+    for (bool avoid_crossing_perimeters : { false, true }) {
+        std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+        config->set_deserialize("layer_height", "0.2");
+        config->set_deserialize("fill_density", "15%");
+        config->set_deserialize("avoid_crossing_perimeters", avoid_crossing_perimeters ? "1" : "0");
+        Model plate = model;
+        plate.add_default_instances();
+        plate.arrange_objects(PrintConfig::min_object_distance(config.get()));
+        plate.center_instances_around_point(Vec2d(125., 105.));
+        Print print;
+        print.apply(plate, *config);
+        print.process();
+        Benchmark bench;
+        bench.start();
+        GCode gcode;
+        // Export on a single thread to measure the travel planning only.
+        gcode.set_pipelined_export(false);
+        gcode.do_export(&print, path.c_str());
+        bench.stop();
+        boost::filesystem::remove(path);
+        cout << "G-code export, avoid_crossing_perimeters " << (avoid_crossing_perimeters ? "on:  " : "off: ")
+             << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s";
+        if (avoid_crossing_perimeters)
+            cout << ", travel planning " << bench.getElapsedSec() - time_without << " s";
+        else
+            time_without = bench.getElapsedSec();
+        cout << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <tbb/task_scheduler_init.h>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Rasterizer/Rasterizer.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: pngexportbench [num_layers]\n"
+    "Rasterizes num_layers (100 by default) layers of a tall object and compresses them to PNG, one layer at a time,\n"
+    "for the 1440 x 2560 display of the SL1 printer and for 4K and 8K displays of the same size.\n"
+    "Compares the rasterizer backends, the PNG scanline filters and the compression levels, and the PNG compression\n"
+    "in bands of rows on a single thread and on all the threads. Reports the export time per layer and the PNG size."
+};
+
+using namespace Slic3r;
+
+// A tall cylinder with a sphere at its side and a grid of thin pillars, centered on a display of 68.04 x 120.96 mm.
+static std::vector<ExPolygons> slice_object(size_t num_layers)
+{
+    double       height   = 100.;
+    TriangleMesh mesh     = make_cylinder(15., height);
+    TriangleMesh sphere   = make_sphere(12., 2. * PI / 180.);
+    mesh.translate(34.f, 40.f, 0.f);
+    sphere.translate(34.f, 85.f, 12.f);
+    mesh.merge(sphere);
+    for (int i = 0; i < 10; ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            TriangleMesh pillar = make_cylinder(0.4, height, 2. * PI / 16.);
+            pillar.translate(float(10 + 16 * j), float(10 + 11 * i), 0.f);
+            mesh.merge(pillar);
+        }
+    mesh.require_shared_vertices();
+    std::vector<float> z;
+    for (size_t i = 0; i < num_layers; ++ i)
+        z.emplace_back(float(height * (double(i) + 0.5) / double(num_layers)));
+    TriangleMeshSlicer slicer(&mesh);
+    std::vector<ExPolygons> layers;
+    slicer.slice(z, 0.f, &layers, [](){});
+    return layers;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t num_layers = 100;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_layers = size_t(std::stoul(argv[1]));
+    }
+
+    std::vector<ExPolygons> layers = slice_object(num_layers);
+
+    struct Display {
+        const char        *name;
+        Raster::Resolution res;
+    };
+    const Display displays[] = {
+        { "SL1 1440 x 2560", Raster::Resolution(1440, 2560) },
+        { "4K 2160 x 3840",  Raster::Resolution(2160, 3840) },
+        { "8K 4320 x 7680",  Raster::Resolution(4320, 7680) }
+    };
+    struct Config {
+        const char        *name;
+        Raster::Backend    backend;
+        Raster::PNGOptions png;
+    };
+    const Config configs[] = {
+        { "AGG, level 6, filter none", Raster::Backend::AGG, Raster::PNGOptions(6, PNGFilter::NONE) },
+        { "AGG, level 1, filter none", Raster::Backend::AGG, Raster::PNGOptions(1, PNGFilter::NONE) },
+        { "AGG, level 1, filter sub ", Raster::Backend::AGG, Raster::PNGOptions(1, PNGFilter::SUB) },
+        { "AGG, level 1, filter up  ", Raster::Backend::AGG, Raster::PNGOptions(1, PNGFilter::UP) },
+        { "AGG, level 6, filter up  ", Raster::Backend::AGG, Raster::PNGOptions(6, PNGFilter::UP) },
+        { "RLE,          filter none", Raster::Backend::RLE, Raster::PNGOptions(6, PNGFilter::NONE) },
+        { "RLE,          filter sub ", Raster::Backend::RLE, Raster::PNGOptions(6, PNGFilter::SUB) },
+        { "RLE,          filter up  ", Raster::Backend::RLE, Raster::PNGOptions(6, PNGFilter::UP) }
+    };
+
+    cout << layers.size() << " layers, " << tbb::task_scheduler_init::default_num_threads() << " threads" << endl;
+    for (const Display &display : displays) {
+        const Raster::PixelDim pxdim(68.04 / display.res.width_px, 120.96 / display.res.height_px);
+        cout << display.name << ":" << endl;
+        for (const Config &config : configs) {
+            double time[2];
+            size_t png_size = 0;
+            for (int threads = 0; threads < 2; ++ threads) {
+                tbb::task_scheduler_init scheduler(threads == 0 ? 1 : tbb::task_scheduler_init::automatic);
+                Benchmark bench;
+                bench.start();
+                png_size = 0;
+                for (const ExPolygons &layer : layers) {
+                    Raster raster(display.res, pxdim, Raster::Origin::TOP_LEFT, 1., config.backend);
+                    for (const ExPolygon &expoly : layer)
+                        raster.draw(expoly);
+                    png_size += raster.save(Raster::Compression::PNG, config.png).size();
+                }
+                bench.stop();
+                time[threads] = bench.getElapsedSec();
+            }
+            cout << "    " << config.name << ": " << std::fixed << std::setprecision(2)
+                 << std::setw(7) << 1000. * time[0] / double(layers.size()) << " ms per layer on 1 thread, "
+                 << std::setw(7) << 1000. * time[1] / double(layers.size()) << " ms on all threads, PNG "
+                 << std::setw(6) << double(png_size) / double(layers.size()) / 1024. << " kB" << endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
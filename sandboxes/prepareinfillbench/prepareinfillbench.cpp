@@ -0,0 +1,104 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/Layer.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+#include <tbb/task_scheduler_init.h>
+
+const std::string USAGE_STR = {
+    "Usage: prepareinfillbench [height_mm [layer_height]]\n"
+    "Measures the time of PrintObject::prepare_infill() on a tall stepped tower with 1, 4, 16 and 64 threads.\n"
+    "The tower is made of blocks of alternating size, so that each step produces top or bottom solid shells."
+};
+
+using namespace Slic3r;
+
+// A tower of blocks 2.5mm high, alternating between 30mm and 20mm wide.
+static TriangleMesh stepped_tower(double height)
+{
+    const double block_height = 2.5;
+    TriangleMesh mesh;
+    for (int i = 0; i * block_height < height; ++ i) {
+        double size = (i % 2) ? 20. : 30.;
+        TriangleMesh block = make_cube(size, size, block_height);
+        block.translate(float(- 0.5 * size), float(- 0.5 * size), float(i * block_height));
+        mesh.merge(block);
+    }
+    return mesh;
+}
+
+// Area of the fill surfaces of each surface type, to verify that the result does not depend on the number of threads.
+static std::vector<double> fill_surfaces_areas(const Print &print)
+{
+    std::vector<double> areas(size_t(stInternalVoid) + 1, 0.);
+    for (const PrintObject *object : print.objects())
+        for (const Layer *layer : object->layers())
+            for (const LayerRegion *layerm : layer->regions())
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    areas[size_t(surface.surface_type)] += surface.area();
+    return areas;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    double height = 150.;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        height = std::stod(argv[1]);
+    }
+
+    std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+    config->set_deserialize("layer_height", (argc > 2) ? argv[2] : "0.1");
+    config->set_deserialize("fill_density", "20%");
+    config->set_deserialize("top_solid_layers", "6");
+    config->set_deserialize("bottom_solid_layers", "5");
+    // Let discover_horizontal_shells() generate the shells instead of discover_vertical_shells().
+    config->set_deserialize("ensure_vertical_shell_thickness", "0");
+    config->set_deserialize("infill_every_layers", "2");
+
+    Model model;
+    ModelObject *object = model.add_object();
+    object->name = "tower";
+    object->add_volume(stepped_tower(height));
+    object->add_instance();
+    model.center_instances_around_point(Vec2d(125., 105.));
+
+    Benchmark bench;
+    std::vector<double> reference;
+    for (int num_threads : { 1, 4, 16, 64 }) {
+        tbb::task_scheduler_init scheduler(num_threads);
+        Print print;
+        print.apply(model, *config);
+        // Print::process() reports the start of prepare_infill() and of infill() of the only object.
+        print.set_status_callback([&bench](const PrintBase::SlicingStatus &status) {
+            if (status.percent == 30)
+                bench.start();
+            else if (status.percent == 70)
+                bench.stop();
+        });
+        print.process();
+
+        std::vector<double> areas = fill_surfaces_areas(print);
+        if (reference.empty())
+            reference = areas;
+        cout << "Threads: " << std::setw(2) << num_threads << ", layers: " << print.objects().front()->layers().size()
+             << ", prepare_infill time: " << std::setprecision(6) << bench.getElapsedSec() << " seconds"
+             << ((areas == reference) ? "" : ", fill surfaces differ from the single threaded run!") << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Rasterizer/Rasterizer.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: rasterizerbench [num_layers]\n"
+    "Rasterizes num_layers (500 by default) layers of a tall object for the 1440 x 2560 display of the SL1 printer\n"
+    "and compresses them to PNG with the AGG and with the run-length encoded rasterizer backends, single threaded.\n"
+    "Reports the throughput in layers per second, the size of the PNG files and whether the pixels are identical."
+};
+
+using namespace Slic3r;
+
+// A tall cylinder with a sphere at its side and a grid of thin pillars, centered on a display of 68.04 x 120.96 mm.
+static std::vector<ExPolygons> slice_object(size_t num_layers)
+{
+    double       height   = 100.;
+    TriangleMesh mesh     = make_cylinder(15., height);
+    TriangleMesh sphere   = make_sphere(12., 2. * PI / 180.);
+    mesh.translate(34.f, 40.f, 0.f);
+    sphere.translate(34.f, 85.f, 12.f);
+    mesh.merge(sphere);
+    for (int i = 0; i < 10; ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            TriangleMesh pillar = make_cylinder(0.4, height, 2. * PI / 16.);
+            pillar.translate(float(10 + 16 * j), float(10 + 11 * i), 0.f);
+            mesh.merge(pillar);
+        }
+    mesh.require_shared_vertices();
+    std::vector<float> z;
+    for (size_t i = 0; i < num_layers; ++ i)
+        z.emplace_back(float(height * (double(i) + 0.5) / double(num_layers)));
+    TriangleMeshSlicer slicer(&mesh);
+    std::vector<ExPolygons> layers;
+    slicer.slice(z, 0.f, &layers, [](){});
+    return layers;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t num_layers = 500;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_layers = size_t(std::stoul(argv[1]));
+    }
+
+    std::vector<ExPolygons> layers = slice_object(num_layers);
+    const Raster::Resolution res(1440, 2560);
+    const Raster::PixelDim   pxdim(0.047, 0.047);
+
+    cout << layers.size() << " layers:" << endl;
+    Benchmark bench;
+    double    time_agg = 0.;
+    for (Raster::Backend backend : { Raster::Backend::AGG, Raster::Backend::RLE }) {
+        size_t png_size = 0;
+        double time_draw = 0.;
+        Benchmark bench_draw;
+        bench.start();
+        for (const ExPolygons &layer : layers) {
+            Raster raster(res, pxdim, Raster::Origin::TOP_LEFT, 1., backend);
+            bench_draw.start();
+            for (const ExPolygon &expoly : layer)
+                raster.draw(expoly);
+            bench_draw.stop();
+            time_draw += bench_draw.getElapsedSec();
+            png_size += raster.save(Raster::Compression::PNG).size();
+        }
+        bench.stop();
+        double time = bench.getElapsedSec();
+        cout << (backend == Raster::Backend::AGG ? "    AGG: " : "    RLE: ") << std::setw(8) << std::setprecision(4)
+             << double(layers.size()) / time << " layers/s (rasterization " << double(layers.size()) / time_draw
+             << " layers/s), PNG " << double(png_size) / double(layers.size()) / 1024. << " kB per layer";
+        if (backend == Raster::Backend::AGG)
+            time_agg = time;
+        else
+            cout << ", " << time_agg / time << "x faster";
+        cout << endl;
+    }
+
+    // Compare the pixels of every 10th layer.
+    bool same = true;
+    for (size_t i = 0; i < layers.size(); i += 10) {
+        Raster agg(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::AGG);
+        Raster rle(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::RLE);
+        for (const ExPolygon &expoly : layers[i]) {
+            agg.draw(expoly);
+            rle.draw(expoly);
+        }
+        RawBytes raw_agg = agg.save(Raster::Compression::RAW);
+        RawBytes raw_rle = rle.save(Raster::Compression::RAW);
+        same &= raw_agg.size() == raw_rle.size() && std::equal(raw_agg.data(), raw_agg.data() + raw_agg.size(), raw_rle.data());
+    }
+    cout << "    pixels " << (same ? "identical" : "DIFFERENT") << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <tbb/parallel_for.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/PrintExport.hpp>
+#include <libslic3r/SLAPrint.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: slaexportbench [num_layers]\n"
+    "Rasterizes num_layers (2000 by default) layers of a tall object for the 1440 x 2560 display of the SL1 printer\n"
+    "and exports them into a zip archive, first streamed (rasterized while writing the archive),\n"
+    "then buffered (all layers rasterized and compressed in memory first, as done by the slapsRasterize step).\n"
+    "Reports the export times and the peak resident set size (RSS) of the process during the export. The peak RSS\n"
+    "is read from /proc/self/status and reset through /proc/self/clear_refs, therefore it is only reported on Linux."
+};
+
+using namespace Slic3r;
+
+using SLAPrinter = FilePrinter<FilePrinterFormat::SLA_PNGZIP>;
+
+// Value of a field of /proc/self/status in kB, for example VmRSS (the resident set size) or VmHWM (its peak).
+// Returns zero if not available.
+static size_t proc_status_kb(const std::string &field)
+{
+    boost::nowide::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);)
+        if (line.compare(0, field.size() + 1, field + ":") == 0)
+            return size_t(std::stoull(line.substr(field.size() + 1)));
+    return 0;
+}
+
+// Reset the peak RSS to the current RSS (supported since Linux 4.0), return the current RSS in kB.
+static size_t reset_peak_rss()
+{
+#ifdef __GLIBC__
+    // Return the free heap memory to the system, otherwise the export would reuse the resident memory freed
+    // by the slicing without raising the peak RSS.
+    malloc_trim(0);
+#endif
+    boost::nowide::ofstream("/proc/self/clear_refs") << "5";
+    return proc_status_kb("VmRSS");
+}
+
+static double kb_to_mb(size_t kb) { return double(kb) / 1024.; }
+static double to_mb(size_t bytes) { return double(bytes) / (1024. * 1024.); }
+
+// A tall cylinder with a sphere at its side, centered on a display of 68.04 x 120.96 mm.
+static std::vector<ExPolygons> slice_object(size_t num_layers)
+{
+    double       height   = 100.;
+    TriangleMesh mesh     = make_cylinder(15., height);
+    TriangleMesh sphere   = make_sphere(12., 2. * PI / 180.);
+    mesh.translate(34.f, 40.f, 0.f);
+    sphere.translate(34.f, 85.f, 12.f);
+    mesh.merge(sphere);
+    mesh.require_shared_vertices();
+    std::vector<float> z;
+    for (size_t i = 0; i < num_layers; ++ i)
+        z.emplace_back(float(height * (double(i) + 0.5) / double(num_layers)));
+    TriangleMeshSlicer slicer(&mesh);
+    std::vector<ExPolygons> layers;
+    slicer.slice(z, 0.f, &layers, [](){});
+    return layers;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t num_layers = 2000;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_layers = size_t(std::stoul(argv[1]));
+    }
+
+    std::vector<ExPolygons> layers = slice_object(num_layers);
+    auto new_printer = []() {
+        return std::unique_ptr<SLAPrinter>(new SLAPrinter(68.04, 120.96, 1440, 2560, 0.05, 8., 35., SLAPrinter::RO_PORTRAIT, 1.));
+    };
+    auto draw_layer = [&layers](Raster &raster, unsigned layer_id) {
+        for (const ExPolygon &expoly : layers[layer_id])
+            raster.draw(expoly);
+    };
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".sl1";
+
+    cout << layers.size() << " layers:" << endl;
+    Benchmark bench;
+    size_t    rss = reset_peak_rss();
+    {
+        std::unique_ptr<SLAPrinter> printer = new_printer();
+        bench.start();
+        printer->save_streamed<Zipper>(path, "bench", unsigned(layers.size()), draw_layer, [](){}, [](unsigned){});
+        bench.stop();
+    }
+    cout << "    streamed: " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, peak RSS "
+         << kb_to_mb(proc_status_kb("VmHWM") - rss) << " MB above the initial RSS, archive " << to_mb(boost::filesystem::file_size(path)) << " MB" << endl;
+    boost::filesystem::remove(path);
+
+    rss = reset_peak_rss();
+    {
+        std::unique_ptr<SLAPrinter> printer = new_printer();
+        bench.start();
+        printer->layers(unsigned(layers.size()));
+        tbb::parallel_for<unsigned>(0, unsigned(layers.size()), [&printer, &layers](unsigned layer_id) {
+            printer->begin_layer(layer_id);
+            for (const ExPolygon &expoly : layers[layer_id])
+                printer->draw_polygon(expoly, layer_id);
+            printer->finish_layer(layer_id);
+        });
+        printer->save<Zipper>(path, "bench");
+        bench.stop();
+    }
+    cout << "    buffered: " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, peak RSS "
+         << kb_to_mb(proc_status_kb("VmHWM") - rss) << " MB above the initial RSS, archive " << to_mb(boost::filesystem::file_size(path)) << " MB" << endl;
+    boost::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
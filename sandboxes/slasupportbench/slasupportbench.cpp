@@ -0,0 +1,172 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/SLAAutoSupports.hpp>
+#include <libslic3r/SLA/SLASupportTree.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+#include <tbb/task_scheduler_init.h>
+
+// IGL defines PI in its namespace.
+#undef PI
+#include <igl/AABB.h>
+#define PI 3.141592653589793238
+
+const std::string USAGE_STR = {
+    "Usage: slasupportbench [model_file]\n"
+    "Generates the SLA support points and the support tree of a dense figurine and measures the ray casting\n"
+    "of the support generation: bundles of 8 rays around each support point, as cast by the support tree builder,\n"
+    "traced by the igl AABB tree one by one (the former implementation), by EigenMesh3D::query_ray_hit() one by one\n"
+    "and by EigenMesh3D::query_ray_hits() in packets. The hits are verified to be the same.\n"
+    "Finally the support tree is generated for the support points, once on a single thread and once on all the\n"
+    "available threads, to measure the wall time of the whole support generation.\n"
+    "A procedural figurine of about a million triangles is used if no model file is given."
+};
+
+using namespace Slic3r;
+
+// A figurine standing on two legs, with outstretched arms and a hat with a wide brim, finely tessellated.
+static TriangleMesh reference_figurine()
+{
+    TriangleMesh mesh;
+    auto add = [&mesh](TriangleMesh &&part, double x, double y, double z) {
+        part.translate(float(x), float(y), float(z));
+        mesh.merge(part);
+    };
+    for (double x : { -4., 4. })
+        add(make_cylinder(3.5, 22., 2. * PI / 720.), x, 0., 0.);
+    TriangleMesh torso = make_sphere(1., 2. * PI / 600.);
+    torso.scale(Vec3d(8., 6., 14.));
+    add(std::move(torso), 0., 0., 32.);
+    for (double side : { -1., 1. }) {
+        TriangleMesh arm = make_cylinder(2.5, 20., 2. * PI / 720.);
+        arm.rotate_y(float(side * 1.2));
+        add(std::move(arm), side * 6., 0., 40.);
+    }
+    add(make_sphere(7., 2. * PI / 500.), 0., 0., 52.);
+    add(make_cylinder(12., 1., 2. * PI / 720.), 0., 0., 57.);
+    add(make_cylinder(6., 6., 2. * PI / 720.), 0., 0., 58.);
+    return mesh;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    TriangleMesh mesh;
+    if (argc > 1) {
+        Model model = Model::read_from_file(argv[1]);
+        mesh = model.mesh();
+    } else
+        mesh = reference_figurine();
+    BoundingBoxf3 bb = mesh.bounding_box();
+    mesh.translate(0.f, 0.f, float(- bb.min(2)));
+    mesh.require_shared_vertices();
+    cout << mesh.facets_count() << " triangles, " << std::setprecision(4) << mesh.bounding_box().max(2) << " mm tall" << endl;
+
+    Benchmark bench;
+    bench.start();
+    sla::EigenMesh3D emesh(mesh);
+    bench.stop();
+    cout << "    EigenMesh3D with the ray casting tree: " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s" << endl;
+
+    std::vector<float> heights;
+    for (float z = 0.025f; z < float(mesh.bounding_box().max(2)); z += 0.05f)
+        heights.emplace_back(z);
+    std::vector<ExPolygons> slices;
+    TriangleMeshSlicer(&mesh).slice(heights, 0.f, &slices, [](){});
+
+    SLAAutoSupports::Config config;
+    config.density_relative = 1.f;
+    config.minimal_distance = 1.f;
+    config.head_diameter    = 0.4f;
+    bench.start();
+    SLAAutoSupports autosupports(mesh, emesh, slices, heights, config, [](){}, [](int){});
+    bench.stop();
+    std::vector<sla::SupportPoint> points = autosupports.output();
+    cout << "    " << points.size() << " support points:           " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s" << endl;
+
+    // Two bundles of 8 rays per support point: rays fanning out downwards from the point like the sides of a support
+    // head, and vertical rays around the point like the sides of a pillar.
+    std::vector<Vec3d> sources, dirs;
+    for (const sla::SupportPoint &pt : points) {
+        Vec3d p = pt.pos.cast<double>();
+        for (int i = 0; i < 8; ++ i) {
+            double phi = 2. * PI * i / 8.;
+            Vec3d  ring(std::cos(phi), std::sin(phi), 0.);
+            sources.emplace_back(p + 0.3 * ring - Vec3d(0., 0., 0.1));
+            dirs.emplace_back((ring - Vec3d(0., 0., 3.)).normalized());
+        }
+        for (int i = 0; i < 8; ++ i) {
+            double phi = 2. * PI * i / 8.;
+            sources.emplace_back(p + Vec3d(std::cos(phi), std::sin(phi), -3.));
+            dirs.emplace_back(Vec3d(0., 0., -1.));
+        }
+    }
+
+    const size_t num_repeats = 20;
+    {
+        igl::AABB<Eigen::MatrixXd, 3> aabb;
+        aabb.init(emesh.V(), emesh.F());
+        std::vector<double> t_igl(sources.size());
+        bench.start();
+        for (size_t repeat = 0; repeat < num_repeats; ++ repeat)
+            for (size_t i = 0; i < sources.size(); ++ i) {
+                igl::Hit hit;
+                hit.t = std::numeric_limits<float>::infinity();
+                aabb.intersect_ray(emesh.V(), emesh.F(), Eigen::RowVector3d(sources[i]), Eigen::RowVector3d(dirs[i]), hit);
+                t_igl[i] = double(hit.t);
+            }
+        bench.stop();
+        double time_igl = bench.getElapsedSec();
+        cout << "    " << num_repeats << "x " << sources.size() << " rays, igl AABB:  " << std::setw(8) << std::setprecision(4) << time_igl << " s" << endl;
+
+        std::vector<double> t_scalar(sources.size());
+        bench.start();
+        for (size_t repeat = 0; repeat < num_repeats; ++ repeat)
+            for (size_t i = 0; i < sources.size(); ++ i)
+                t_scalar[i] = emesh.query_ray_hit(sources[i], dirs[i]).distance();
+        bench.stop();
+        cout << "    " << num_repeats << "x " << sources.size() << " rays, one by one: " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, "
+             << std::setprecision(3) << time_igl / bench.getElapsedSec() << "x faster" << endl;
+
+        std::vector<sla::EigenMesh3D::hit_result> hits;
+        bench.start();
+        for (size_t repeat = 0; repeat < num_repeats; ++ repeat)
+            hits = emesh.query_ray_hits(sources, dirs);
+        bench.stop();
+        // The igl tree returns the distances in single precision.
+        bool same = true;
+        for (size_t i = 0; i < sources.size(); ++ i) {
+            double t = hits[i].distance();
+            same &= t == t_scalar[i] && (std::isinf(t) ? std::isinf(t_igl[i]) : std::abs(t - t_igl[i]) <= 1e-6 * t);
+        }
+        cout << "    " << num_repeats << "x " << sources.size() << " rays, packets:    " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, "
+             << std::setprecision(3) << time_igl / bench.getElapsedSec() << "x faster" << (same ? ", same hits" : ", DIFFERENT HITS") << endl;
+    }
+
+    sla::SupportConfig cfg;
+    double time_single_thread = 0.;
+    for (int num_threads : { 1, tbb::task_scheduler_init::default_num_threads() }) {
+        tbb::task_scheduler_init scheduler(num_threads);
+        bench.start();
+        sla::SLASupportTree tree(points, emesh, cfg);
+        bench.stop();
+        if (num_threads == 1)
+            time_single_thread = bench.getElapsedSec();
+        cout << "    support tree, " << std::setw(2) << num_threads << " thread(s):       " << std::setw(8) << std::setprecision(4) << bench.getElapsedSec() << " s, "
+             << std::setprecision(3) << time_single_thread / bench.getElapsedSec() << "x, " << tree.merged_mesh().facets_count() << " triangles" << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+#include <tbb/task_scheduler_init.h>
+
+const std::string USAGE_STR = {
+    "Usage: slicebench [number_of_facets [layer_height]]\n"
+    "Slices a synthetic sphere mesh with 1, 4, 16 and 64 threads."
+};
+
+int main(const int argc, const char *argv[]) {
+    using namespace Slic3r;
+    using std::cout; using std::endl;
+
+    size_t num_facets   = 5000000;
+    float  layer_height = 0.05f;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        num_facets = size_t(std::stoul(argv[1]));
+    }
+    if (argc > 2)
+        layer_height = std::stof(argv[2]);
+
+    // make_sphere() produces approximately 4 * PI^2 / fa^2 triangles.
+    const double radius = 50.;
+    TriangleMesh mesh = make_sphere(radius, 2. * PI / std::sqrt(double(num_facets)));
+    mesh.require_shared_vertices();
+
+    std::vector<float> z;
+    for (float slice_z = - float(radius) + 0.5f * layer_height; slice_z < float(radius); slice_z += layer_height)
+        z.emplace_back(slice_z);
+
+    cout << "Facets: " << mesh.facets_count() << ", layers: " << z.size() << endl;
+
+    Benchmark bench;
+    for (int num_threads : { 1, 4, 16, 64 }) {
+        tbb::task_scheduler_init scheduler(num_threads);
+
+        bench.start();
+        TriangleMeshSlicer slicer;
+        slicer.init(&mesh, [](){});
+        std::vector<Polygons> layers;
+        slicer.slice(z, &layers, [](){});
+        bench.stop();
+
+        size_t num_polygons = 0;
+        for (const Polygons &layer : layers)
+            num_polygons += layer.size();
+        cout << "Threads: " << std::setw(2) << num_threads << ", slicing time: " << std::setprecision(6)
+             << bench.getElapsedSec() << " seconds, " << num_polygons << " polygons." << endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <cstdio>
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+#include <admesh/stl.h>
+#include <libnest2d/tools/benchmark.h>
+
+const std::string USAGE_STR = {
+    "Usage: stlbench [size_MB]\n"
+    "Generates a synthetic binary and an ASCII STL file of about size_MB megabytes (1000 MB by default)\n"
+    "and measures the loading time of stl_open() compared to the former loading with fread() / fscanf()."
+};
+
+// Write a binary or an ASCII STL of random facets.
+static void generate_stl(const std::string &path, size_t size, bool ascii)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> coordinates(-100.f, 100.f);
+    FILE  *f     = fopen(path.c_str(), "wb");
+    size_t total = 0;
+    if (ascii) {
+        total += fprintf(f, "solid synthetic\n");
+        while (total < size) {
+            total += fprintf(f, "  facet normal %e %e %e\n    outer loop\n", coordinates(rng) / 100.f, coordinates(rng) / 100.f, coordinates(rng) / 100.f);
+            for (int i = 0; i < 3; ++ i)
+                total += fprintf(f, "      vertex %e %e %e\n", coordinates(rng), coordinates(rng), coordinates(rng));
+            total += fprintf(f, "    endloop\n  endfacet\n");
+        }
+        fprintf(f, "endsolid synthetic\n");
+    } else {
+        uint32_t num_facets = uint32_t((size - HEADER_SIZE) / SIZEOF_STL_FACET);
+        char header[LABEL_SIZE];
+        memset(header, ' ', LABEL_SIZE);
+        fwrite(header, 1, LABEL_SIZE, f);
+        fwrite(&num_facets, 4, 1, f);
+        char facet[SIZEOF_STL_FACET];
+        memset(facet, 0, SIZEOF_STL_FACET);
+        for (uint32_t i = 0; i < num_facets; ++ i) {
+            for (int j = 0; j < 12; ++ j) {
+                float v = coordinates(rng);
+                memcpy(facet + 4 * j, &v, 4);
+            }
+            fwrite(facet, 1, SIZEOF_STL_FACET, f);
+        }
+    }
+    fclose(f);
+}
+
+// The former stl_open(): Facets counted and read with fread() / fscanf().
+static void stl_open_stdio(stl_file *stl, const char *file)
+{
+    stl_initialize(stl);
+    stl_count_facets(stl, file);
+    stl_allocate(stl);
+    stl_read(stl, 0, true);
+    if (stl->fp != nullptr) {
+        fclose(stl->fp);
+        stl->fp = nullptr;
+    }
+}
+
+static bool same_mesh(const stl_file &a, const stl_file &b)
+{
+    if (a.error || b.error || a.stats.number_of_facets != b.stats.number_of_facets ||
+        a.stats.min != b.stats.min || a.stats.max != b.stats.max)
+        return false;
+    for (uint32_t i = 0; i < a.stats.number_of_facets; ++ i)
+        if (memcmp(&a.facet_start[i], &b.facet_start[i], 48) != 0)
+            return false;
+    return true;
+}
+
+int main(const int argc, const char *argv[])
+{
+    using std::cout; using std::endl;
+
+    size_t size_MB = 1000;
+    if (argc > 1) {
+        if (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            cout << USAGE_STR << endl;
+            return EXIT_SUCCESS;
+        }
+        size_MB = size_t(std::stoul(argv[1]));
+    }
+
+    Benchmark bench;
+    for (bool ascii : { false, true }) {
+        std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".stl";
+        generate_stl(path, size_MB * 1024 * 1024, ascii);
+        double file_MB = double(boost::filesystem::file_size(path)) / (1024. * 1024.);
+        cout << (ascii ? "ASCII" : "Binary") << " STL, " << std::setprecision(4) << file_MB << " MB" << endl;
+
+        stl_file stl_stdio, stl_mapped;
+        bench.start();
+        stl_open_stdio(&stl_stdio, path.c_str());
+        bench.stop();
+        cout << "  fread / fscanf: " << bench.getElapsedSec() << " seconds, " << file_MB / bench.getElapsedSec() << " MB/s" << endl;
+        bench.start();
+        stl_open(&stl_mapped, path.c_str());
+        bench.stop();
+        cout << "  stl_open:       " << bench.getElapsedSec() << " seconds, " << file_MB / bench.getElapsedSec() << " MB/s, "
+             << stl_mapped.stats.number_of_facets << " facets" << endl;
+        if (! same_mesh(stl_stdio, stl_mapped))
+            cout << "  The meshes differ!" << endl;
+
+        stl_close(&stl_stdio);
+        stl_close(&stl_mapped);
+        boost::filesystem::remove(path);
+    }
+
+    return EXIT_SUCCESS;
+}
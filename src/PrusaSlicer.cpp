@@ -367,12 +367,16 @@ int CLI::run(int argc, char **argv)
                 Print       fff_print;
                 SLAPrint    sla_print;
 
+                fff_print.set_slice_cache_dir(m_config.opt_string("slice_cache"));
+
                 sla_print.set_status_callback(
                             [](const PrintBase::SlicingStatus& s)
                 {
                     if(s.percent >= 0) // FIXME: is this sufficient?
                         printf("%3d%s %s\n", s.percent, "% =>", s.text.c_str());
                 });
+                // The layers are exported right after slicing, rasterize them while writing the archive.
+                sla_print.set_streaming_export(true);
 
                 PrintBase  *print = (printer_technology == ptFFF) ? static_cast<PrintBase*>(&fff_print) : static_cast<PrintBase*>(&sla_print);
                 if (! m_config.opt_bool("dont_arrange")) {
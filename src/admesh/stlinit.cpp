@@ -26,8 +26,16 @@
 #include <math.h>
 #include <assert.h>
 
+#include <algorithm>
+
 #include <boost/nowide/cstdio.hpp>
 #include <boost/detail/endian.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
 
 #include "stl.h"
 
@@ -35,9 +43,14 @@
 #error "SEEK_SET not defined"
 #endif
 
+static bool stl_open_mapped(stl_file *stl, const char *file);
+
 void
 stl_open(stl_file *stl, const char *file) {
   stl_initialize(stl);
+  // Read the file through a memory mapped view if possible, otherwise with the stdio functions.
+  if (stl_open_mapped(stl, file))
+    return;
   stl_count_facets(stl, file);
   stl_allocate(stl);
   stl_read(stl, 0, true);
@@ -367,6 +380,294 @@ void stl_facet_stats(stl_file *stl, stl_facet facet, bool &first)
   }
 }
 
+// Number of facets processed by a single task of the parallel loops.
+#define STL_PARALLEL_GRAIN_SIZE 16384
+
+// Calculates the same statistics as stl_facet_stats() called for all the facets, with a parallel reduction.
+static void stl_facets_stats_parallel(stl_file *stl)
+{
+  if (stl->error || stl->stats.number_of_facets == 0)
+    return;
+
+  const stl_facet *facets = stl->facet_start;
+  typedef std::pair<stl_vertex, stl_vertex> MinMax;
+  MinMax bbox = tbb::parallel_reduce(
+    tbb::blocked_range<size_t>(0, stl->stats.number_of_facets, STL_PARALLEL_GRAIN_SIZE),
+    MinMax(facets[0].vertex[0], facets[0].vertex[0]),
+    [facets](const tbb::blocked_range<size_t> &range, MinMax bbox) {
+      for (size_t i = range.begin(); i < range.end(); ++ i)
+        for (size_t j = 0; j < 3; ++ j) {
+          bbox.first  = bbox.first .cwiseMin(facets[i].vertex[j]);
+          bbox.second = bbox.second.cwiseMax(facets[i].vertex[j]);
+        }
+      return bbox;
+    },
+    [](const MinMax &a, const MinMax &b) { return MinMax(a.first.cwiseMin(b.first), a.second.cwiseMax(b.second)); });
+
+  stl->stats.min = bbox.first;
+  stl->stats.max = bbox.second;
+  stl_vertex diff = (facets[0].vertex[1] - facets[0].vertex[0]).cwiseAbs();
+  stl->stats.shortest_edge = std::max(diff(0), std::max(diff(1), diff(2)));
+  stl->stats.size = stl->stats.max - stl->stats.min;
+  stl->stats.bounding_diameter = stl->stats.size.norm();
+}
+
+// Decodes a binary STL, the facet records are copied in parallel.
+static void stl_read_binary_memory(stl_file *stl, const char *file, const char *data, size_t size)
+{
+  if (((size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) || (size < STL_MIN_FILE_SIZE)) {
+    fprintf(stderr, "The file %s has the wrong size.\n", file);
+    stl->error = 1;
+    return;
+  }
+  uint32_t num_facets = uint32_t((size - HEADER_SIZE) / SIZEOF_STL_FACET);
+
+  memcpy(stl->stats.header, data, LABEL_SIZE);
+  uint32_t header_num_facets;
+  memcpy(&header_num_facets, data + LABEL_SIZE, NUM_FACET_SIZE);
+#ifndef BOOST_LITTLE_ENDIAN
+  // Convert from little endian to big endian.
+  stl_internal_reverse_quads((char*)&header_num_facets, 4);
+#endif /* BOOST_LITTLE_ENDIAN */
+  if (num_facets != header_num_facets)
+    fprintf(stderr, "Warning: File size doesn't match number of facets in the header\n");
+
+  stl->stats.number_of_facets = num_facets;
+  stl->stats.original_num_facets = stl->stats.number_of_facets;
+  stl_allocate(stl);
+  if (stl->facet_start == nullptr || stl->neighbors_start == nullptr) {
+    stl->error = 1;
+    return;
+  }
+
+  const char *records = data + HEADER_SIZE;
+  stl_facet  *facets  = stl->facet_start;
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets, STL_PARALLEL_GRAIN_SIZE),
+    [records, facets](const tbb::blocked_range<size_t> &range) {
+      for (size_t i = range.begin(); i < range.end(); ++ i) {
+        memcpy((void*)(facets + i), records + i * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
+#ifndef BOOST_LITTLE_ENDIAN
+        // Convert the loaded little endian data to big endian.
+        stl_internal_reverse_quads((char*)(facets + i), 48);
+#endif /* BOOST_LITTLE_ENDIAN */
+      }
+    });
+}
+
+static inline bool stl_is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline const char* stl_skip_spaces(const char *p, const char *end)
+{
+  for (; p != end && stl_is_space(*p); ++ p) ;
+  return p;
+}
+
+static inline const char* stl_token_end(const char *p, const char *end)
+{
+  for (; p != end && ! stl_is_space(*p); ++ p) ;
+  return p;
+}
+
+// Skips white spaces and a keyword, which has to be followed by a white space or by the end of file.
+static inline bool stl_match_keyword(const char *&p, const char *end, const char *keyword)
+{
+  const char *c = stl_skip_spaces(p, end);
+  for (; *keyword != 0; ++ c, ++ keyword)
+    if (c == end || *c != *keyword)
+      return false;
+  if (c != end && ! stl_is_space(*c))
+    return false;
+  p = c;
+  return true;
+}
+
+// Parses a number with up to 15 significant digits and a small exponent exactly, returns false for anything else.
+static inline bool stl_parse_float_fast(const char *p, const char *end, float &out)
+{
+  static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = *p ++ == '-';
+  uint64_t mantissa    = 0;
+  int      num_digits  = 0;
+  int      significant = 0;
+  int      exponent    = 0;
+  for (; p != end && *p >= '0' && *p <= '9'; ++ p, ++ num_digits) {
+    mantissa = mantissa * 10 + (*p - '0');
+    if (mantissa > 0 && ++ significant > 15)
+      return false;
+  }
+  if (p != end && *p == '.')
+    for (++ p; p != end && *p >= '0' && *p <= '9'; ++ p, ++ num_digits, -- exponent) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa > 0 && ++ significant > 15)
+        return false;
+    }
+  if (num_digits == 0)
+    return false;
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++ p;
+    bool negative_exponent = false;
+    if (p != end && (*p == '-' || *p == '+'))
+      negative_exponent = *p ++ == '-';
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+    int e = 0;
+    for (; p != end && *p >= '0' && *p <= '9' && e < 1000; ++ p)
+      e = e * 10 + (*p - '0');
+    exponent += negative_exponent ? - e : e;
+  }
+  if (p != end || exponent < -22 || exponent > 22)
+    return false;
+  double value = (exponent < 0) ? double(mantissa) / pow10[- exponent] : double(mantissa) * pow10[exponent];
+  out = float(negative ? - value : value);
+  return true;
+}
+
+// Parses a white space delimited number, returns false if the token does not start with a number.
+static inline bool stl_parse_float(const char *&p, const char *end, float &out)
+{
+  const char *begin = stl_skip_spaces(p, end);
+  const char *token_end = stl_token_end(begin, end);
+  if (begin == token_end)
+    return false;
+  p = token_end;
+  if (stl_parse_float_fast(begin, token_end, out))
+    return true;
+  // Long numbers, infinities, not a numbers etc.: Let strtof() decide.
+  char buf[32];
+  size_t len = std::min<size_t>(token_end - begin, sizeof(buf) - 1);
+  memcpy(buf, begin, len);
+  buf[len] = 0;
+  char *buf_end = nullptr;
+  out = strtof(buf, &buf_end);
+  return buf_end != buf;
+}
+
+// Parses an ASCII STL in memory. Accepts the same input as stl_read(), which parses the file with fscanf().
+static void stl_read_ascii_memory(stl_file *stl, const char *data, size_t size)
+{
+  const char *p   = data;
+  const char *end = data + size;
+
+  /* Get the header */
+  int i = 0;
+  for (; i < 80 && p + i != end && p[i] != '\n'; ++ i)
+    stl->stats.header[i] = p[i];
+  // The file is not opened in text mode, drop the '\r' of a Windows line end.
+  if (i > 0 && stl->stats.header[i - 1] == '\r')
+    -- i;
+  stl->stats.header[i] = '\0';
+
+  // Facets are parsed directly into the malloc()ed array handed over to the stl_file.
+  size_t     capacity   = size / 200 + 16;
+  size_t     num_facets = 0;
+  stl_facet *facets     = (stl_facet*)malloc(capacity * sizeof(stl_facet));
+  bool       ok         = facets != nullptr;
+  while (ok) {
+    p = stl_skip_spaces(p, end);
+    if (p == end)
+      break;
+    // Skip solid / endsolid lines, broken STL file generators may put several of them.
+    if ((end - p >= 8 && strncmp(p, "endsolid", 8) == 0) || (end - p >= 5 && strncmp(p, "solid", 5) == 0)) {
+      for (; p != end && *p != '\n'; ++ p) ;
+      continue;
+    }
+    if (num_facets == capacity) {
+      capacity += capacity / 2;
+      stl_facet *new_facets = (stl_facet*)realloc((void*)facets, capacity * sizeof(stl_facet));
+      if (new_facets == nullptr) {
+        ok = false;
+        break;
+      }
+      facets = new_facets;
+    }
+    stl_facet &facet = facets[num_facets ++];
+    memset((void*)&facet, 0, sizeof(stl_facet));
+    ok = stl_match_keyword(p, end, "facet") && stl_match_keyword(p, end, "normal");
+    if (ok) {
+      // Normal may be mangled, for example denormals or "not a number" may be stored.
+      // Just reset the normal and silently ignore it.
+      bool normal_ok = true;
+      for (int j = 0; ok && j < 3; ++ j) {
+        // The normal is parsed as three white space delimited tokens, possibly not numbers.
+        p = stl_skip_spaces(p, end);
+        ok = p != end;
+        normal_ok &= stl_parse_float(p, end, facet.normal(j));
+      }
+      if (! normal_ok)
+        memset((void*)&facet.normal, 0, sizeof(facet.normal));
+    }
+    ok = ok && stl_match_keyword(p, end, "outer") && stl_match_keyword(p, end, "loop");
+    for (int j = 0; ok && j < 3; ++ j)
+      ok = stl_match_keyword(p, end, "vertex") &&
+           stl_parse_float(p, end, facet.vertex[j](0)) && stl_parse_float(p, end, facet.vertex[j](1)) && stl_parse_float(p, end, facet.vertex[j](2));
+    ok = ok && stl_match_keyword(p, end, "endloop") && stl_match_keyword(p, end, "endfacet");
+    if (! ok)
+      perror("Something is syntactically very wrong with this ASCII STL!");
+  }
+
+  if (! ok) {
+    free(facets);
+    stl->error = 1;
+    return;
+  }
+
+  if (num_facets > 0 && num_facets < capacity)
+    facets = (stl_facet*)realloc((void*)facets, num_facets * sizeof(stl_facet));
+  stl->facet_start = facets;
+  stl->stats.number_of_facets = uint32_t(num_facets);
+  stl->stats.original_num_facets = stl->stats.number_of_facets;
+  stl->stats.facets_malloced = stl->stats.number_of_facets;
+  stl->neighbors_start = (stl_neighbors*)calloc(stl->stats.number_of_facets, sizeof(stl_neighbors));
+  if (stl->neighbors_start == nullptr)
+    stl->error = 1;
+}
+
+// Loads the STL file from a memory mapped view of the file: The binary facets are decoded in parallel,
+// an ASCII STL is parsed by a tokenizer working on the mapped memory instead of fscanf().
+// Returns false if the file could not be mapped, then it shall be read with stl_count_facets() / stl_read().
+static bool stl_open_mapped(stl_file *stl, const char *file)
+{
+  namespace bip = boost::interprocess;
+  try {
+    // On Windows, the file name is interpreted in the ANSI code page. If it cannot be represented,
+    // opening the mapping fails and the file is read through boost::nowide::fopen().
+    bip::file_mapping  mapping(file, bip::read_only);
+    bip::mapped_region region(mapping, bip::read_only);
+    region.advise(bip::mapped_region::advice_willneed);
+    const char *data = (const char*)region.get_address();
+    size_t      size = region.get_size();
+
+    /* Check for binary or ASCII file */
+    if (size < HEADER_SIZE + 128) {
+      perror("The input is an empty file");
+      stl->error = 1;
+      return true;
+    }
+    stl->stats.type = ascii;
+    for (size_t i = HEADER_SIZE; i < HEADER_SIZE + 128; ++ i)
+      if ((unsigned char)data[i] > 127) {
+        stl->stats.type = binary;
+        break;
+      }
+
+    if (stl->stats.type == binary)
+      stl_read_binary_memory(stl, file, data, size);
+    else
+      stl_read_ascii_memory(stl, data, size);
+  } catch (const bip::interprocess_exception &) {
+    // Empty file or the file could not be mapped.
+    return false;
+  }
+  stl_facets_stats_parallel(stl);
+  return true;
+}
+
 void stl_close(stl_file *stl)
 {
 	assert(stl->fp == nullptr);
@@ -723,12 +723,12 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  TEdge *edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
-  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
+  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges);
   if (result)
     // Success, remember the edge array.
-    m_edges.emplace_back(std::move(edges));
+    CommitEdges();
   return result;
 }
 
@@ -756,10 +756,10 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(num_edges_total);
+  TEdge *edges = AllocateEdges(num_edges_total);
   // Fill in the edge array.
   bool result = false;
-  TEdge *p_edge = edges.data();
+  TEdge *p_edge = edges;
   for (Paths::size_type i = 0; i < ppg.size(); ++i)
     if (num_edges[i]) {
       bool res = AddPathInternal(ppg[i], num_edges[i] - 1, PolyTyp, Closed, p_edge);
@@ -770,11 +770,32 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
     }
   if (result)
     // At least some edges were generated. Remember the edge array.
-    m_edges.emplace_back(std::move(edges));
+    CommitEdges();
   return result;
 }
 
+// Edge arrays with more edges in total are released by ClipperBase::Clear() instead of being retained for the next paths.
+static const size_t ClipperBaseRetainedEdgesMax = 1 << 14;
+
+TEdge* ClipperBase::AllocateEdges(size_t num_edges)
+{
+  if (m_edgesUsed == m_edges.size())
+    m_edges.emplace_back();
+  std::vector<TEdge> &edges = m_edges[m_edgesUsed];
+  if (edges.size() < num_edges)
+    edges.resize(num_edges);
+  return edges.data();
+}
+
 bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
+{
+  assert(highI >= 0 && highI < pg.size());
+  for (int i = 0; i <= highI; ++ i)
+    edges[i].Curr = pg[i];
+  return AddPathEdges(highI, PolyTyp, Closed, edges);
+}
+
+bool ClipperBase::AddPathEdges(int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   PROFILE_FUNC();
 #ifdef use_lines
@@ -785,20 +806,20 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
     throw clipperException("AddPath: Open paths have been disabled.");
 #endif
 
-  assert(highI >= 0 && highI < pg.size());
-
   //1. Basic (first) edge initialization ...
   try
   {
-    edges[1].Curr = pg[1];
-    RangeTest(pg[0], m_UseFullRange);
-    RangeTest(pg[highI], m_UseFullRange);
-    InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
-    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
+    IntPoint pt0 = edges[0].Curr;
+    IntPoint ptHigh = edges[highI].Curr;
+    RangeTest(pt0, m_UseFullRange);
+    RangeTest(ptHigh, m_UseFullRange);
+    InitEdge(&edges[0], &edges[1], &edges[highI], pt0);
+    InitEdge(&edges[highI], &edges[0], &edges[highI-1], ptHigh);
     for (int i = highI - 1; i >= 1; --i)
     {
-      RangeTest(pg[i], m_UseFullRange);
-      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
+      IntPoint pt = edges[i].Curr;
+      RangeTest(pt, m_UseFullRange);
+      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pt);
     }
   }
   catch(...)
@@ -952,7 +973,12 @@ void ClipperBase::Clear()
 {
   PROFILE_FUNC();
   m_MinimaList.clear();
-  m_edges.clear();
+  size_t num_edges = 0;
+  for (const std::vector<TEdge> &edges : m_edges)
+    num_edges += edges.size();
+  if (num_edges > ClipperBaseRetainedEdgesMax)
+    m_edges.clear();
+  m_edgesUsed = 0;
   m_UseFullRange = false;
   m_HasOpenPaths = false;
 }
@@ -1034,6 +1060,7 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_OutPtsChunksUsed(0),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
@@ -1050,16 +1077,26 @@ Clipper::Clipper(int initOptions) :
 }
 //------------------------------------------------------------------------------
 
+Clipper::~Clipper()
+{
+  Clear();
+  for (OutPt *pts : m_OutPts)
+    delete[] pts;
+  for (OutRec *rec : m_PolyOutsFree)
+    delete rec;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::Reset()
 {
   PROFILE_FUNC();
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt>();
+  m_Scanbeam.clear();
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
   for (auto lm = m_MinimaList.rbegin(); lm != m_MinimaList.rend(); ++lm)
-    m_Scanbeam.push(lm->Y);
+    InsertScanbeam(lm->Y);
 }
 
 //------------------------------------------------------------------------------
@@ -1105,15 +1142,13 @@ bool Clipper::ExecuteInternal()
    PROFILE_BLOCK(Clipper_ExecuteInternal_Process);
     Reset();
     if (m_MinimaList.empty()) return true;
-    cInt botY = m_Scanbeam.top();
-    do { m_Scanbeam.pop(); } while (! m_Scanbeam.empty() && botY == m_Scanbeam.top());
+    cInt botY = PopScanbeam();
     do {
       InsertLocalMinimaIntoAEL(botY);
       ProcessHorizontals();
 	    m_GhostJoins.clear();
 	    if (m_Scanbeam.empty()) break;
-      cInt topY = m_Scanbeam.top();
-      do { m_Scanbeam.pop(); } while (! m_Scanbeam.empty() && topY == m_Scanbeam.top());
+      cInt topY = PopScanbeam();
       succeeded = ProcessIntersections(topY);
       if (!succeeded) break;
       ProcessEdgesAtTopOfScanbeam(topY);
@@ -1176,23 +1211,34 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
+    pt = m_OutPts[m_OutPtsChunksUsed - 1] + (m_OutPtsChunkLast ++);
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    // The last chunk is full. Reuse a retained chunk or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    pt = m_OutPts[m_OutPtsChunksUsed ++];
     m_OutPtsChunkLast = 1;
-    pt = m_OutPts.back();
   }
   return pt;
 }
 
+// Limits of the output points and output polygons retained by Clipper::DisposeAllOutRecs() for the next Execute().
+static const size_t ClipperRetainedOutPtChunksMax = 1024;
+static const size_t ClipperRetainedOutRecsMax     = 1 << 14;
+
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
+  if (m_OutPts.size() > ClipperRetainedOutPtChunksMax) {
+    for (size_t i = ClipperRetainedOutPtChunksMax; i < m_OutPts.size(); ++ i)
+      delete[] m_OutPts[i];
+    m_OutPts.resize(ClipperRetainedOutPtChunksMax);
+  }
   for (OutRec *rec : m_PolyOuts)
-    delete rec;
-  m_OutPts.clear();
+    if (m_PolyOutsFree.size() < ClipperRetainedOutRecsMax)
+      m_PolyOutsFree.push_back(rec);
+    else
+      delete rec;
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
   m_PolyOuts.clear();
@@ -1511,7 +1557,7 @@ void Clipper::InsertLocalMinimaIntoAEL(const cInt botY)
       SetWindingCount(*lb);
       if (IsContributing(*lb))
         Op1 = AddOutPt(lb, lb->Bot);
-      m_Scanbeam.push(lb->Top.Y);
+      InsertScanbeam(lb->Top.Y);
     }
     else
     {
@@ -1522,13 +1568,13 @@ void Clipper::InsertLocalMinimaIntoAEL(const cInt botY)
       rb->WindCnt2 = lb->WindCnt2;
       if (IsContributing(*lb))
         Op1 = AddLocalMinPoly(lb, rb, lb->Bot);      
-      m_Scanbeam.push(lb->Top.Y);
+      InsertScanbeam(lb->Top.Y);
     }
 
      if (rb)
      {
        if(IsHorizontal(*rb)) AddEdgeToSEL(rb);
-       else m_Scanbeam.push(rb->Top.Y);
+       else InsertScanbeam(rb->Top.Y);
      }
 
     if (!lb || !rb) continue;
@@ -1975,7 +2021,13 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result;
+  if (m_PolyOutsFree.empty())
+    result = new OutRec;
+  else {
+    result = m_PolyOutsFree.back();
+    m_PolyOutsFree.pop_back();
+  }
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -2404,7 +2456,7 @@ void Clipper::UpdateEdgeIntoAEL(TEdge *&e)
   e->PrevInAEL = AelPrev;
   e->NextInAEL = AelNext;
   if (!IsHorizontal(*e)) 
-    m_Scanbeam.push(e->Top.Y);
+    InsertScanbeam(e->Top.Y);
 }
 //------------------------------------------------------------------------------
 
@@ -3320,10 +3372,24 @@ DoublePoint GetUnitNormal(const IntPoint &pt1, const IntPoint &pt2)
 // ClipperOffset class
 //------------------------------------------------------------------------------
 
+// Limit of the nodes retained by ClipperOffset::Clear() for the next paths to be added.
+static const size_t ClipperOffsetRetainedNodesMax = 1 << 12;
+
+ClipperOffset::~ClipperOffset()
+{
+  Clear();
+  for (PolyNode *node : m_polyNodesFree)
+    delete node;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::Clear()
 {
   for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+    if (m_polyNodesFree.size() < ClipperOffsetRetainedNodesMax)
+      m_polyNodesFree.push_back(m_polyNodes.Childs[i]);
+    else
+      delete m_polyNodes.Childs[i];
   m_polyNodes.Childs.clear();
   m_lowest.X = -1;
 }
@@ -3333,7 +3399,15 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode;
+  if (m_polyNodesFree.empty())
+    newNode = new PolyNode();
+  else {
+    // Reuse a node released by Clear() including the memory allocated for its contour.
+    newNode = m_polyNodesFree.back();
+    m_polyNodesFree.pop_back();
+    newNode->Contour.clear();
+  }
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3373,7 +3447,7 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
   }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    m_polyNodesFree.push_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3433,7 +3507,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3463,7 +3539,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
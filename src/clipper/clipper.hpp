@@ -47,6 +47,7 @@
 //use_deprecated: Enables temporary support for the obsolete functions
 //#define use_deprecated  
 
+#include <algorithm>
 #include <vector>
 #include <deque>
 #include <stdexcept>
@@ -284,10 +285,17 @@ enum EdgeSide { esLeft = 1, esRight = 2};
 class ClipperBase
 {
 public:
-  ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
+  ClipperBase() : m_UseFullRange(false), m_edgesUsed(0), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
   bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
   bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  // Same as AddPaths(), but for paths of another type (for example Slic3r::Polygons), whose points are copied
+  // directly into the edges without converting the paths to Paths first. PathAdapter::size(path) returns
+  // the number of points of a path, PathAdapter::point(path, i) returns its i-th point as an IntPoint.
+  template<typename PathAdapter, typename PathsT>
+  bool AddPathsAdapted(const PathsT &ppg, PolyType PolyTyp, bool Closed);
+  // Clear the paths, but keep the edge arrays allocated for the next paths to be added,
+  // unless they grew larger than a limit.
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -296,6 +304,12 @@ public:
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
   bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Same as AddPathInternal(), but the input points have already been stored into edges[0..highI].Curr.
+  bool AddPathEdges(int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Edge array of at least num_edges edges, reusing an array retained from before the last Clear().
+  // The array is only kept by CommitEdges() if some edges were added.
+  TEdge* AllocateEdges(size_t num_edges);
+  void CommitEdges() { ++ m_edgesUsed; }
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
@@ -308,8 +322,10 @@ protected:
   // True if the input polygons have abs values higher than loRange, but lower than hiRange.
   // False if the input polygons have abs values lower or equal to loRange.
   bool              m_UseFullRange;
-  // A vector of edges per each input path.
+  // A vector of edges per each input path. Only the first m_edgesUsed vectors are in use,
+  // the others are retained by Clear() to be reused by AddPath() / AddPaths().
   std::vector<std::vector<TEdge>> m_edges;
+  size_t           m_edgesUsed;
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -321,7 +337,9 @@ class Clipper : public ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
-  ~Clipper() { Clear(); }
+  ~Clipper();
+  // Clear the paths and the output polygons. The memory of the output polygons is retained
+  // for the next Execute(), unless it grew larger than a limit.
   void Clear() { ClipperBase::Clear(); DisposeAllOutRecs(); }
   bool Execute(ClipType clipType,
       Paths &solution,
@@ -354,8 +372,12 @@ private:
   
   // Output polygons.
   std::vector<OutRec*>  m_PolyOuts;
+  // Output polygons released by DisposeAllOutRecs(), to be reused by CreateOutRec().
+  std::vector<OutRec*>  m_PolyOutsFree;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // Only the first m_OutPtsChunksUsed chunks are in use, the others are retained by DisposeAllOutRecs().
   std::vector<OutPt*>   m_OutPts;
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
@@ -365,8 +387,19 @@ private:
   std::vector<Join>     m_GhostJoins;
   std::vector<IntersectNode> m_IntersectList;
   ClipType              m_ClipType;
-  // A priority queue (a binary heap) of Y coordinates.
-  std::priority_queue<cInt> m_Scanbeam;
+  // A priority queue (a binary max heap) of Y coordinates. Stored in a vector, which keeps its memory
+  // when cleared, contrary to std::priority_queue.
+  std::vector<cInt>     m_Scanbeam;
+  void InsertScanbeam(const cInt Y) { m_Scanbeam.push_back(Y); std::push_heap(m_Scanbeam.begin(), m_Scanbeam.end()); }
+  // Pop the maximum Y and all of its duplicates.
+  cInt PopScanbeam() {
+    cInt Y = m_Scanbeam.front();
+    do {
+      std::pop_heap(m_Scanbeam.begin(), m_Scanbeam.end());
+      m_Scanbeam.pop_back();
+    } while (! m_Scanbeam.empty() && Y == m_Scanbeam.front());
+    return Y;
+  }
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
   std::vector<cInt>     m_Maxima;
   TEdge                *m_ActiveEdges;
@@ -441,7 +474,7 @@ class ClipperOffset
 public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
-  ~ClipperOffset() { Clear(); }
+  ~ClipperOffset();
   void AddPath(const Path& path, JoinType joinType, EndType endType);
   void AddPaths(const Paths& paths, JoinType joinType, EndType endType);
   void Execute(Paths& solution, double delta);
@@ -459,6 +492,10 @@ private:
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Nodes released by Clear(), to be reused by AddPath() together with the memory of their contours.
+  PolyNodes m_polyNodesFree;
+  // Clipper to clean up the offset polygons, reused by the Execute() calls.
+  Clipper m_clipper;
 
   void FixOrientations();
   void DoOffset(double delta);
@@ -480,6 +517,51 @@ class clipperException : public std::exception
 };
 //------------------------------------------------------------------------------
 
+template<typename PathAdapter, typename PathsT>
+bool ClipperBase::AddPathsAdapted(const PathsT &ppg, PolyType PolyTyp, bool Closed)
+{
+  // Number of the points of a path after removing the duplicate end points, zero if the path is degenerate.
+  auto num_edges = [Closed](const typename PathsT::value_type &pg) -> int {
+    int highI = (int)PathAdapter::size(pg) - 1;
+    if (highI < 0)
+      return 0;
+    // Remove duplicate end point from a closed input path.
+    // Remove duplicate points from the end of the input path.
+    if (Closed)
+      while (highI > 0 && PathAdapter::point(pg, highI) == PathAdapter::point(pg, 0))
+        --highI;
+    while (highI > 0 && PathAdapter::point(pg, highI) == PathAdapter::point(pg, highI - 1))
+      --highI;
+    return ((Closed && highI < 2) || (!Closed && highI < 1)) ? 0 : highI + 1;
+  };
+  size_t num_edges_total = 0;
+  for (const auto &pg : ppg)
+    num_edges_total += num_edges(pg);
+  if (num_edges_total == 0)
+    return false;
+
+  // Allocate a new edge array.
+  TEdge *p_edge = AllocateEdges(num_edges_total);
+  // Fill in the edge array.
+  bool result = false;
+  for (const auto &pg : ppg) {
+    int n = num_edges(pg);
+    if (n) {
+      for (int i = 0; i < n; ++ i)
+        p_edge[i].Curr = PathAdapter::point(pg, i);
+      if (AddPathEdges(n - 1, PolyTyp, Closed, p_edge)) {
+        p_edge += n;
+        result = true;
+      }
+    }
+  }
+  if (result)
+    // At least some edges were generated. Remember the edge array.
+    CommitEdges();
+  return result;
+}
+//------------------------------------------------------------------------------
+
 } //ClipperLib namespace
 
 #endif //clipper_hpp
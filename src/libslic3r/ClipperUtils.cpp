@@ -7,12 +7,85 @@
 #include "SVG.hpp"
 #endif /* CLIPPER_UTILS_DEBUG */
 
+#include <memory>
+
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+
 #include <Shiny/Shiny.h>
 
 #define CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR (0.005f)
 
 namespace Slic3r {
 
+// The Clipper and ClipperOffset engines are reused by the functions of this file instead of being constructed for each call,
+// so that the memory they allocate for the edges, the scan beams and the output polygons is recycled.
+// Each thread keeps its own stack of idle engines. A nested call (for example safety_offset() called by _clipper_do())
+// takes another engine from the stack.
+static tbb::enumerable_thread_specific<std::vector<std::unique_ptr<ClipperLib::Clipper>>>       g_clipper_engines;
+static tbb::enumerable_thread_specific<std::vector<std::unique_ptr<ClipperLib::ClipperOffset>>> g_clipper_offset_engines;
+
+static inline std::vector<std::unique_ptr<ClipperLib::Clipper>>&       clipper_engines(ClipperLib::Clipper*)       { return g_clipper_engines.local(); }
+static inline std::vector<std::unique_ptr<ClipperLib::ClipperOffset>>& clipper_engines(ClipperLib::ClipperOffset*) { return g_clipper_offset_engines.local(); }
+
+// Reset the engine to the state of a freshly constructed one.
+static inline void clipper_engine_reset(ClipperLib::Clipper &clipper)
+{
+    clipper.Clear();
+    clipper.ReverseSolution(false);
+    clipper.StrictlySimple(false);
+    clipper.PreserveCollinear(false);
+#ifdef use_xyz
+    clipper.ZFillFunction(nullptr);
+#endif /* use_xyz */
+}
+
+static inline void clipper_engine_reset(ClipperLib::ClipperOffset &co)
+{
+    co.Clear();
+    co.MiterLimit         = 2.;
+    co.ArcTolerance       = 0.25;
+    co.ShortestEdgeLength = 0.;
+}
+
+// Engine borrowed from the stack of the idle engines of the current thread for the lifetime of this object.
+template<typename Engine>
+class ClipperEngine
+{
+public:
+    ClipperEngine() : m_engines(clipper_engines((Engine*)nullptr)) {
+        if (m_engines.empty())
+            m_engine.reset(new Engine());
+        else {
+            m_engine = std::move(m_engines.back());
+            m_engines.pop_back();
+            clipper_engine_reset(*m_engine);
+        }
+    }
+    ~ClipperEngine() {
+        // Release the input paths, keep the memory allocated by the engine for the next user.
+        m_engine->Clear();
+        m_engines.emplace_back(std::move(m_engine));
+    }
+    Engine& operator*()  { return *m_engine; }
+    Engine* operator->() { return m_engine.get(); }
+
+private:
+    ClipperEngine(const ClipperEngine&) = delete;
+    ClipperEngine& operator=(const ClipperEngine&) = delete;
+
+    std::vector<std::unique_ptr<Engine>> &m_engines;
+    std::unique_ptr<Engine>               m_engine;
+};
+
+// Passes the points of Slic3r::Polygons and Slic3r::Polylines to ClipperBase::AddPathsAdapted(), which copies them
+// into the Clipper edges without an intermediate ClipperLib::Paths.
+struct MultiPointClipperAdapter
+{
+    static size_t               size(const MultiPoint &path) { return path.points.size(); }
+    static ClipperLib::IntPoint point(const MultiPoint &path, size_t idx) { const Point &pt = path.points[idx]; return ClipperLib::IntPoint(pt(0), pt(1)); }
+};
+
 #ifdef CLIPPER_UTILS_DEBUG
 bool clipper_export_enabled = false;
 // For debugging the Clipper library, for providing bug reports to the Clipper author.
@@ -119,6 +192,7 @@ PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -127,6 +201,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -154,13 +229,12 @@ ExPolygons
 ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperEngine<ClipperLib::Clipper> clipper;
     
     // perform union
-    clipper.AddPaths(input, ClipperLib::ptSubject, true);
+    clipper->AddPaths(input, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
-    clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);  // offset results work with both EvenOdd and NonZero
+    clipper->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);  // offset results work with both EvenOdd and NonZero
     
     // write to ExPolygons object
     return PolyTreeToExPolygons(polytree);
@@ -170,6 +244,7 @@ ClipperLib::Path
 Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
     ClipperLib::Path retval;
+    retval.reserve(input.points.size());
     for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
         retval.emplace_back((*pit)(0), (*pit)(1));
     return retval;
@@ -188,6 +263,7 @@ Slic3rMultiPoint_to_ClipperPath_reversed(const Slic3r::MultiPoint &input)
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polygons::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -196,6 +272,7 @@ ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polylines &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polylines::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -207,16 +284,16 @@ ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType
     scaleClipperPolygons(input);
     
     // perform offset
-    ClipperLib::ClipperOffset co;
+    ClipperEngine<ClipperLib::ClipperOffset> co;
     if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
+        co->ArcTolerance = miterLimit;
     else
-        co.MiterLimit = miterLimit;
+        co->MiterLimit = miterLimit;
     float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
-    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-    co.AddPaths(input, joinType, endType);
+    co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+    co->AddPaths(input, joinType, endType);
     ClipperLib::Paths retval;
-    co.Execute(retval, delta_scaled);
+    co->Execute(retval, delta_scaled);
     
     // unscale output
     unscaleClipperPolygons(retval);
@@ -243,32 +320,34 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     {
         ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(expolygon.contour);
         scaleClipperPolygon(input);
-        ClipperLib::ClipperOffset co;
+        ClipperEngine<ClipperLib::ClipperOffset> co;
         if (joinType == jtRound)
-            co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+            co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
         else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-        co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta_scaled);
+            co->MiterLimit = miterLimit;
+        co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+        co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        co->Execute(contours, delta_scaled);
     }
 
     // 2) Offset the holes one by one, collect the results.
     ClipperLib::Paths holes;
     {
         holes.reserve(expolygon.holes.size());
+        ClipperEngine<ClipperLib::ClipperOffset> co;
+        if (joinType == jtRound)
+            co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+        else
+            co->MiterLimit = miterLimit;
+        co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+        ClipperLib::Path  input;
+        ClipperLib::Paths out;
         for (Polygons::const_iterator it_hole = expolygon.holes.begin(); it_hole != expolygon.holes.end(); ++ it_hole) {
-            ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
+            input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
             scaleClipperPolygon(input);
-            ClipperLib::ClipperOffset co;
-            if (joinType == jtRound)
-                co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
-            else
-                co.MiterLimit = miterLimit;
-            co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-            ClipperLib::Paths out;
-            co.Execute(out, - delta_scaled);
+            co->Clear();
+            co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co->Execute(out, - delta_scaled);
             holes.insert(holes.end(), out.begin(), out.end());
         }
     }
@@ -278,11 +357,10 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     if (holes.empty()) {
         output = std::move(contours);
     } else {
-        ClipperLib::Clipper clipper;
-        clipper.Clear();
-        clipper.AddPaths(contours, ClipperLib::ptSubject, true);
-        clipper.AddPaths(holes, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperEngine<ClipperLib::Clipper> clipper;
+        clipper->AddPaths(contours, ClipperLib::ptSubject, true);
+        clipper->AddPaths(holes, ClipperLib::ptClip, true);
+        clipper->Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     }
     
     // 4) Unscale the output.
@@ -309,14 +387,14 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
         {
             ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(it_expoly->contour);
             scaleClipperPolygon(input);
-            ClipperLib::ClipperOffset co;
+            ClipperEngine<ClipperLib::ClipperOffset> co;
             if (joinType == jtRound)
-                co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+                co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
-                co.MiterLimit = miterLimit;
-            co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-            co.Execute(contours, delta_scaled);
+                co->MiterLimit = miterLimit;
+            co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+            co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co->Execute(contours, delta_scaled);
         }
         if (contours.empty())
             // No need to try to offset the holes.
@@ -330,18 +408,20 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
             // 2) Offset the holes one by one, collect the offsetted holes.
             ClipperLib::Paths holes;
             {
+                ClipperEngine<ClipperLib::ClipperOffset> co;
+                if (joinType == jtRound)
+                    co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+                else
+                    co->MiterLimit = miterLimit;
+                co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+                ClipperLib::Path  input;
+                ClipperLib::Paths out;
                 for (Polygons::const_iterator it_hole = it_expoly->holes.begin(); it_hole != it_expoly->holes.end(); ++ it_hole) {
-                    ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
+                    input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
                     scaleClipperPolygon(input);
-                    ClipperLib::ClipperOffset co;
-                    if (joinType == jtRound)
-                        co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
-                    else
-                        co.MiterLimit = miterLimit;
-                    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-                    co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-                    ClipperLib::Paths out;
-                    co.Execute(out, - delta_scaled);
+                    co->Clear();
+                    co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+                    co->Execute(out, - delta_scaled);
                     holes.insert(holes.end(), out.begin(), out.end());
                 }
             }
@@ -354,12 +434,11 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
             } else if (delta < 0) {
                 // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
                 // Subtract the offsetted holes from the offsetted contours.
-                ClipperLib::Clipper clipper;
-                clipper.Clear();
-                clipper.AddPaths(contours, ClipperLib::ptSubject, true);
-                clipper.AddPaths(holes, ClipperLib::ptClip, true);
+                ClipperEngine<ClipperLib::Clipper> clipper;
+                clipper->AddPaths(contours, ClipperLib::ptSubject, true);
+                clipper->AddPaths(holes, ClipperLib::ptClip, true);
                 ClipperLib::Paths output;
-                clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+                clipper->Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
                 if (! output.empty()) {
                     contours_cummulative.insert(contours_cummulative.end(), output.begin(), output.end());
                     ++ expolygons_collected;
@@ -385,10 +464,9 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
     ClipperLib::Paths output;
     if (expolygons_collected > 1 && delta > 0) {
         // There is a chance that the outwards offsetted expolygons may intersect. Perform a union.
-        ClipperLib::Clipper clipper;
-        clipper.Clear(); 
-        clipper.AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
-        clipper.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperEngine<ClipperLib::Clipper> clipper;
+        clipper->AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
+        clipper->Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     } else {
         // Negative offset. The shrunk expolygons shall not mutually intersect. Just copy the output.
         output = std::move(contours_cummulative);
@@ -410,26 +488,26 @@ _offset2(const Polygons &polygons, const float delta1, const float delta2,
     scaleClipperPolygons(input);
     
     // prepare ClipperOffset object
-    ClipperLib::ClipperOffset co;
+    ClipperEngine<ClipperLib::ClipperOffset> co;
     if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
+        co->ArcTolerance = miterLimit;
     } else {
-        co.MiterLimit = miterLimit;
+        co->MiterLimit = miterLimit;
     }
     float delta_scaled1 = delta1 * float(CLIPPER_OFFSET_SCALE);
     float delta_scaled2 = delta2 * float(CLIPPER_OFFSET_SCALE);
-    co.ShortestEdgeLength = double(std::max(std::abs(delta_scaled1), std::abs(delta_scaled2)) * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR);
+    co->ShortestEdgeLength = double(std::max(std::abs(delta_scaled1), std::abs(delta_scaled2)) * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR);
     
     // perform first offset
     ClipperLib::Paths output1;
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
-    co.Execute(output1, delta_scaled1);
+    co->AddPaths(input, joinType, ClipperLib::etClosedPolygon);
+    co->Execute(output1, delta_scaled1);
     
     // perform second offset
-    co.Clear();
-    co.AddPaths(output1, joinType, ClipperLib::etClosedPolygon);
+    co->Clear();
+    co->AddPaths(output1, joinType, ClipperLib::etClosedPolygon);
     ClipperLib::Paths retval;
-    co.Execute(retval, delta_scaled2);
+    co->Execute(retval, delta_scaled2);
     
     // unscale output
     unscaleClipperPolygons(retval);
@@ -471,35 +549,39 @@ ExPolygons offset2_ex(const ExPolygons &expolygons, const float delta1,
     return union_ex(polys);
 }
 
+// Add the subject and clip polygons to the clipper. Only the polygons to be safety offsetted are converted to ClipperLib::Paths,
+// the others are passed to the Clipper edges directly.
+static void clipper_add_paths(ClipperLib::Clipper &clipper, const ClipperLib::ClipType clipType, const Polygons &subject, 
+    const Polygons &clip, const bool safety_offset_)
+{
+    if (safety_offset_ && clipType == ClipperLib::ctUnion) {
+        ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
+        safety_offset(&input_subject);
+        clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    } else
+        clipper.AddPathsAdapted<MultiPointClipperAdapter>(subject, ClipperLib::ptSubject, true);
+    if (safety_offset_ && clipType != ClipperLib::ctUnion) {
+        ClipperLib::Paths input_clip = Slic3rMultiPoints_to_ClipperPaths(clip);
+        safety_offset(&input_clip);
+        clipper.AddPaths(input_clip, ClipperLib::ptClip, true);
+    } else
+        clipper.AddPathsAdapted<MultiPointClipperAdapter>(clip, ClipperLib::ptClip, true);
+}
+
 template <class T>
 T
 _clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject, 
     const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperEngine<ClipperLib::Clipper> clipper;
     
-    // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    // add polygons, perform safety offset
+    clipper_add_paths(*clipper, clipType, subject, clip, safety_offset_);
     
     // perform operation
     T retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -513,26 +595,18 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject,
 inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
     const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_)
-        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
-    
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    // Perform the operation with the output to input_subject.
+    ClipperEngine<ClipperLib::Clipper> clipper;
+    clipper_add_paths(*clipper, clipType, subject, clip, safety_offset_);
+    // Perform the operation with the output to a temporary Paths.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    ClipperLib::Paths output;
+    clipper->Execute(clipType, output, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
-    clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper->Clear();
+    clipper->AddPaths(output, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+    clipper->Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
 }
 
@@ -540,24 +614,21 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
     const Polygons &clip, const ClipperLib::PolyFillType fillType,
     const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) safety_offset(&input_clip);
-    
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperEngine<ClipperLib::Clipper> clipper;
     
-    // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    // add polylines and polygons, perform safety offset
+    clipper->AddPathsAdapted<MultiPointClipperAdapter>(subject, ClipperLib::ptSubject, false);
+    if (safety_offset_) {
+        ClipperLib::Paths input_clip = Slic3rMultiPoints_to_ClipperPaths(clip);
+        safety_offset(&input_clip);
+        clipper->AddPaths(input_clip, ClipperLib::ptClip, true);
+    } else
+        clipper->AddPathsAdapted<MultiPointClipperAdapter>(clip, ClipperLib::ptClip, true);
     
     // perform operation
     ClipperLib::PolyTree retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -647,6 +718,224 @@ _clipper_ln(ClipperLib::ClipType clipType, const Lines &subject, const Polygons
     return retval;
 }
 
+// Bounding box of a Clipper path.
+static inline ClipperLib::IntRect clipper_path_bbox(const ClipperLib::Path &path)
+{
+    ClipperLib::IntRect bbox { 0, 0, -1, -1 };
+    if (! path.empty()) {
+        bbox.left = bbox.right  = path.front().X;
+        bbox.top  = bbox.bottom = path.front().Y;
+        for (const ClipperLib::IntPoint &pt : path) {
+            bbox.left   = std::min(bbox.left,   pt.X);
+            bbox.right  = std::max(bbox.right,  pt.X);
+            bbox.top    = std::min(bbox.top,    pt.Y);
+            bbox.bottom = std::max(bbox.bottom, pt.Y);
+        }
+    }
+    return bbox;
+}
+
+// Input of a single Clipper job of the bounding box aware boolean operations.
+struct ClipperBBoxJob
+{
+    ClipperLib::Paths subject;
+    ClipperLib::Paths clip;
+};
+
+// Call on_overlap for the active bounding boxes overlapping bboxes[idx], remove the active bounding boxes
+// ending left of bboxes[idx], which will not overlap any of the following bounding boxes sorted by their left edges.
+template<typename OnOverlap>
+static void clipper_bbox_overlaps(const std::vector<ClipperLib::IntRect> &bboxes, size_t idx, std::vector<size_t> &active, OnOverlap on_overlap)
+{
+    const ClipperLib::IntRect &bbox = bboxes[idx];
+    for (size_t i = 0; i < active.size();) {
+        const ClipperLib::IntRect &other = bboxes[active[i]];
+        if (other.right < bbox.left) {
+            active[i] = active.back();
+            active.pop_back();
+        } else {
+            if (other.top <= bbox.bottom && bbox.top <= other.bottom)
+                on_overlap(active[i]);
+            ++ i;
+        }
+    }
+}
+
+// Split the subject and clip paths into groups to be processed by independent Clipper jobs: The subject paths with overlapping
+// bounding boxes (closed subject paths only) and the subject and clip paths with overlapping bounding boxes fall into the same group.
+// The bounding boxes touching each other are considered overlapping. Clip paths not overlapping any subject path are dropped.
+// The overlaps are found by sweeping the bounding boxes sorted by their left edges.
+static std::vector<ClipperBBoxJob> clipper_bbox_jobs(ClipperLib::Paths &&subject, bool subject_closed, ClipperLib::Paths &&clip)
+{
+    const size_t num_subject = subject.size();
+    const size_t num_paths   = num_subject + clip.size();
+    std::vector<ClipperLib::IntRect> bboxes;
+    bboxes.reserve(num_paths);
+    for (const ClipperLib::Path &path : subject)
+        bboxes.emplace_back(clipper_path_bbox(path));
+    for (const ClipperLib::Path &path : clip)
+        bboxes.emplace_back(clipper_path_bbox(path));
+
+    // Union-find over the subject and clip paths.
+    std::vector<size_t> parent(num_paths);
+    for (size_t i = 0; i < num_paths; ++ i)
+        parent[i] = i;
+    auto find = [&parent](size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    auto merge = [&parent, &find](size_t i, size_t j) {
+        i = find(i);
+        j = find(j);
+        // Keep the lower index as a root, so that the groups are ordered by their first subject path.
+        if (i < j)
+            parent[j] = i;
+        else if (j < i)
+            parent[i] = j;
+    };
+
+    std::vector<size_t> order;
+    order.reserve(num_paths);
+    for (size_t i = 0; i < num_paths; ++ i)
+        if (bboxes[i].left <= bboxes[i].right)
+            order.emplace_back(i);
+    std::sort(order.begin(), order.end(), [&bboxes](size_t i, size_t j) { return bboxes[i].left < bboxes[j].left; });
+    std::vector<size_t> active_subject;
+    std::vector<size_t> active_clip;
+    for (size_t idx : order) {
+        auto on_overlap = [idx, &merge](size_t other) { merge(idx, other); };
+        if (idx < num_subject) {
+            if (subject_closed)
+                clipper_bbox_overlaps(bboxes, idx, active_subject, on_overlap);
+            clipper_bbox_overlaps(bboxes, idx, active_clip, on_overlap);
+            active_subject.emplace_back(idx);
+        } else {
+            clipper_bbox_overlaps(bboxes, idx, active_subject, on_overlap);
+            active_clip.emplace_back(idx);
+        }
+    }
+
+    // Roots of the groups containing a subject are subjects, as they have the lowest index.
+    std::vector<size_t> job_of_root(num_subject, size_t(-1));
+    std::vector<ClipperBBoxJob> jobs;
+    for (size_t i = 0; i < num_paths; ++ i) {
+        size_t root = find(i);
+        if (root >= num_subject)
+            // Clip path not overlapping any subject.
+            continue;
+        if (job_of_root[root] == size_t(-1)) {
+            job_of_root[root] = jobs.size();
+            jobs.emplace_back();
+        }
+        ClipperBBoxJob &job = jobs[job_of_root[root]];
+        if (i < num_subject)
+            job.subject.emplace_back(std::move(subject[i]));
+        else
+            job.clip.emplace_back(std::move(clip[i - num_subject]));
+    }
+    return jobs;
+}
+
+// Execute the Clipper jobs, optionally in parallel, and concatenate their results.
+template<typename T, typename Fn>
+static std::vector<T> clipper_bbox_execute(std::vector<ClipperBBoxJob> &jobs, bool parallel, Fn fn)
+{
+    std::vector<std::vector<T>> results(jobs.size());
+    if (parallel && jobs.size() > 1)
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, jobs.size()),
+            [&jobs, &results, &fn](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    results[i] = fn(jobs[i]);
+            });
+    else
+        for (size_t i = 0; i < jobs.size(); ++ i)
+            results[i] = fn(jobs[i]);
+    std::vector<T> out;
+    size_t cnt = 0;
+    for (const std::vector<T> &result : results)
+        cnt += result.size();
+    out.reserve(cnt);
+    for (std::vector<T> &result : results)
+        std::move(result.begin(), result.end(), std::back_inserter(out));
+    return out;
+}
+
+// Convert the input of the bounding box aware boolean operations on closed paths and split it into the Clipper jobs.
+static std::vector<ClipperBBoxJob> clipper_bbox_jobs(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
+{
+    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
+    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
+    // The safety offset is applied before splitting, so that the bounding boxes account for it.
+    if (safety_offset_)
+        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
+    std::vector<ClipperBBoxJob> jobs = clipper_bbox_jobs(std::move(input_subject), true, std::move(input_clip));
+    if (clipType == ClipperLib::ctIntersection)
+        // Subject islands not overlapping any clip polygon do not contribute to the intersection.
+        jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const ClipperBBoxJob &job){ return job.clip.empty(); }), jobs.end());
+    return jobs;
+}
+
+Polygons _clipper_bbox(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_, bool parallel)
+{
+    std::vector<ClipperBBoxJob> jobs = clipper_bbox_jobs(clipType, subject, clip, safety_offset_);
+    return clipper_bbox_execute<Polygon>(jobs, parallel, [clipType](const ClipperBBoxJob &job) {
+        ClipperEngine<ClipperLib::Clipper> clipper;
+        clipper->AddPaths(job.subject, ClipperLib::ptSubject, true);
+        clipper->AddPaths(job.clip,    ClipperLib::ptClip,    true);
+        ClipperLib::Paths output;
+        clipper->Execute(clipType, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        return ClipperPaths_to_Slic3rPolygons(output);
+    });
+}
+
+ExPolygons _clipper_ex_bbox(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_, bool parallel)
+{
+    std::vector<ClipperBBoxJob> jobs = clipper_bbox_jobs(clipType, subject, clip, safety_offset_);
+    return clipper_bbox_execute<ExPolygon>(jobs, parallel, [clipType](const ClipperBBoxJob &job) {
+        // Two passes as in _clipper_do_polytree2(), see the Fix of #117.
+        ClipperEngine<ClipperLib::Clipper> clipper;
+        clipper->AddPaths(job.subject, ClipperLib::ptSubject, true);
+        clipper->AddPaths(job.clip,    ClipperLib::ptClip,    true);
+        ClipperLib::Paths output;
+        clipper->Execute(clipType, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        clipper->Clear();
+        clipper->AddPaths(output, ClipperLib::ptSubject, true);
+        ClipperLib::PolyTree polytree;
+        clipper->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        return PolyTreeToExPolygons(polytree);
+    });
+}
+
+Polylines _clipper_pl_bbox(ClipperLib::ClipType clipType, const Polylines &subject, const Polygons &clip, bool safety_offset_, bool parallel)
+{
+    ClipperLib::Paths input_clip = Slic3rMultiPoints_to_ClipperPaths(clip);
+    if (safety_offset_)
+        safety_offset(&input_clip);
+    std::vector<ClipperBBoxJob> jobs = clipper_bbox_jobs(Slic3rMultiPoints_to_ClipperPaths(subject), false, std::move(input_clip));
+    Polylines passed;
+    if (clipType == ClipperLib::ctDifference) {
+        // The polylines not overlapping any clip polygon are passed to the output unchanged.
+        for (const ClipperBBoxJob &job : jobs)
+            if (job.clip.empty())
+                for (const ClipperLib::Path &path : job.subject)
+                    passed.emplace_back(ClipperPath_to_Slic3rPolyline(path));
+    }
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const ClipperBBoxJob &job){ return job.clip.empty(); }), jobs.end());
+    Polylines out = clipper_bbox_execute<Polyline>(jobs, parallel, [clipType](const ClipperBBoxJob &job) {
+        ClipperEngine<ClipperLib::Clipper> clipper;
+        clipper->AddPaths(job.subject, ClipperLib::ptSubject, false);
+        clipper->AddPaths(job.clip,    ClipperLib::ptClip,    true);
+        ClipperLib::PolyTree polytree;
+        clipper->Execute(clipType, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperLib::Paths output;
+        ClipperLib::PolyTreeToPaths(polytree, output);
+        return ClipperPaths_to_Slic3rPolylines(output);
+    });
+    append(out, std::move(passed));
+    return out;
+}
+
 ClipperLib::PolyTree
 union_pt(const Polygons &subject, bool safety_offset_)
 {
@@ -691,18 +980,14 @@ void traverse_pt(ClipperLib::PolyNodes &nodes, Polygons* retval)
 
 Polygons simplify_polygons(const Polygons &subject, bool preserve_collinear)
 {
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::Paths output;
-    if (preserve_collinear) {
-        ClipperLib::Clipper c;
-        c.PreserveCollinear(true);
-        c.StrictlySimple(true);
-        c.AddPaths(input_subject, ClipperLib::ptSubject, true);
-        c.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
-    } else {
-        ClipperLib::SimplifyPolygons(input_subject, output, ClipperLib::pftNonZero);
+    {
+        // Equivalent to ClipperLib::SimplifyPolygons() if ! preserve_collinear.
+        ClipperEngine<ClipperLib::Clipper> c;
+        c->PreserveCollinear(preserve_collinear);
+        c->StrictlySimple(true);
+        c->AddPathsAdapted<MultiPointClipperAdapter>(subject, ClipperLib::ptSubject, true);
+        c->Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     }
     
     // convert into Slic3r polygons
@@ -714,16 +999,13 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
     if (! preserve_collinear)
         return union_ex(simplify_polygons(subject, false));
 
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::PolyTree polytree;
     
-    ClipperLib::Clipper c;
-    c.PreserveCollinear(true);
-    c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    ClipperEngine<ClipperLib::Clipper> c;
+    c->PreserveCollinear(true);
+    c->StrictlySimple(true);
+    c->AddPathsAdapted<MultiPointClipperAdapter>(subject, ClipperLib::ptSubject, true);
+    c->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
     return PolyTreeToExPolygons(polytree);
@@ -737,7 +1019,7 @@ void safety_offset(ClipperLib::Paths* paths)
     scaleClipperPolygons(*paths);
     
     // perform offset (delta = scale 1e-05)
-    ClipperLib::ClipperOffset co;
+    ClipperEngine<ClipperLib::ClipperOffset> co;
 #ifdef CLIPPER_UTILS_DEBUG
     if (clipper_export_enabled) {
         static int iRun = 0;
@@ -747,20 +1029,20 @@ void safety_offset(ClipperLib::Paths* paths)
     ClipperLib::Paths out;
     for (size_t i = 0; i < paths->size(); ++ i) {
         ClipperLib::Path &path = (*paths)[i];
-        co.Clear();
-        co.MiterLimit = 2;
+        co->Clear();
+        co->MiterLimit = 2;
         bool ccw = ClipperLib::Orientation(path);
         if (! ccw)
             std::reverse(path.begin(), path.end());
         {
             PROFILE_BLOCK(safety_offset_AddPaths);
-            co.AddPath((*paths)[i], ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+            co->AddPath((*paths)[i], ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
         }
         {
             PROFILE_BLOCK(safety_offset_Execute);
             // offset outside by 10um
             ClipperLib::Paths out_this;
-            co.Execute(out_this, ccw ? 10.f * float(CLIPPER_OFFSET_SCALE) : -10.f * float(CLIPPER_OFFSET_SCALE));
+            co->Execute(out_this, ccw ? 10.f * float(CLIPPER_OFFSET_SCALE) : -10.f * float(CLIPPER_OFFSET_SCALE));
             if (! ccw) {
                 // Reverse the resulting contours once again.
                 for (ClipperLib::Paths::iterator it = out_this.begin(); it != out_this.end(); ++ it)
@@ -781,12 +1063,11 @@ void safety_offset(ClipperLib::Paths* paths)
 Polygons top_level_islands(const Slic3r::Polygons &polygons)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperEngine<ClipperLib::Clipper> clipper;
     // perform union
-    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::ptSubject, true);
+    clipper->AddPathsAdapted<MultiPointClipperAdapter>(polygons, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
-    clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
+    clipper->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
     // Convert only the top level islands to the output.
     Polygons out;
     out.reserve(polytree.ChildCount());
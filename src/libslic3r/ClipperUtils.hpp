@@ -214,6 +214,60 @@ inline Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject, bool safety_
 }
 
 
+// Bounding box aware variants of the boolean operations above for large subject and clip sets, most of which do not overlap.
+// The subject is split into islands with disjoint bounding boxes. Each island is processed by an independent smaller Clipper job
+// with just the clip polygons overlapping it, the clip polygons not overlapping any subject are dropped.
+// The jobs are optionally executed in parallel. The resulting area is the same as of the operations above,
+// but the order of the resulting polygons differs. Don't use them where the order propagates into the G-code,
+// for example for the fill surfaces, which are extruded in their order.
+Slic3r::Polygons _clipper_bbox(ClipperLib::ClipType clipType,
+    const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false);
+Slic3r::ExPolygons _clipper_ex_bbox(ClipperLib::ClipType clipType,
+    const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false);
+// The subject polylines not overlapping any clip polygon are not passed to Clipper at all.
+Slic3r::Polylines _clipper_pl_bbox(ClipperLib::ClipType clipType,
+    const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false);
+
+inline Slic3r::Polygons diff_bbox(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_bbox(ClipperLib::ctDifference, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::ExPolygons diff_ex_bbox(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_ex_bbox(ClipperLib::ctDifference, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::Polylines diff_pl_bbox(const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_pl_bbox(ClipperLib::ctDifference, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::Polygons intersection_bbox(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_bbox(ClipperLib::ctIntersection, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::ExPolygons intersection_ex_bbox(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_ex_bbox(ClipperLib::ctIntersection, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::Polylines intersection_pl_bbox(const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_pl_bbox(ClipperLib::ctIntersection, subject, clip, safety_offset_, parallel);
+}
+
+inline Slic3r::Polygons union_bbox(const Slic3r::Polygons &subject, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_bbox(ClipperLib::ctUnion, subject, Slic3r::Polygons(), safety_offset_, parallel);
+}
+
+inline Slic3r::ExPolygons union_ex_bbox(const Slic3r::Polygons &subject, bool safety_offset_ = false, bool parallel = false)
+{
+    return _clipper_ex_bbox(ClipperLib::ctUnion, subject, Slic3r::Polygons(), safety_offset_, parallel);
+}
+
 ClipperLib::PolyTree union_pt(const Slic3r::Polygons &subject, bool safety_offset_ = false);
 Slic3r::Polygons union_pt_chained(const Slic3r::Polygons &subject, bool safety_offset_ = false);
 void traverse_pt(ClipperLib::PolyNodes &nodes, Slic3r::Polygons* retval);
@@ -1,8 +1,13 @@
 #include <algorithm>
 #include <vector>
 #include <float.h>
+#include <limits>
 #include <unordered_map>
 
+#include <thread>
+
+#include <tbb/parallel_for.h>
+
 #if 0
 // #ifdef SLIC3R_GUI
 #include <wx/image.h>
@@ -27,6 +32,7 @@ namespace Slic3r {
 EdgeGrid::Grid::Grid() : 
 	m_rows(0), m_cols(0) 
 {
+	m_cell_edges_state = CELL_EDGES_INVALID;
 }
 
 EdgeGrid::Grid::~Grid() 
@@ -34,6 +40,7 @@ EdgeGrid::Grid::~Grid()
 	m_contours.clear();
 	m_cell_data.clear();
 	m_cells.clear();
+	m_cell_edges.clear();
 }
 
 void EdgeGrid::Grid::create(const Polygons &polygons, coord_t resolution)
@@ -109,14 +116,174 @@ void EdgeGrid::Grid::create(const ExPolygonCollection &expolygons, coord_t resol
 	create(expolygons.expolygons, resolution);
 }
 
+// Rasterize a line segment with its end points p1, p2 relative to the grid origin.
+// visitor(iy, ix) is called for each grid cell crossed by the segment, starting with the cell of p1.
+template<typename CellVisitor>
+static inline void rasterize_segment(const Point &p1, const Point &p2, coord_t resolution, CellVisitor &visitor)
+{
+	// Get the cells of the end points.
+	coord_t ix    = p1(0) / resolution;
+	coord_t iy    = p1(1) / resolution;
+	coord_t ixb   = p2(0) / resolution;
+	coord_t iyb   = p2(1) / resolution;
+	// Account for the end points.
+	visitor(iy, ix);
+	if (ix == ixb && iy == iyb)
+		// Both ends fall into the same cell.
+		return;
+	// Raster the centeral part of the line.
+	coord_t dx = std::abs(p2(0) - p1(0));
+	coord_t dy = std::abs(p2(1) - p1(1));
+	if (p1(0) < p2(0)) {
+		int64_t ex = int64_t((ix + 1)*resolution - p1(0)) * int64_t(dy);
+		if (p1(1) < p2(1)) {
+			// x positive, y positive
+			int64_t ey = int64_t((iy + 1)*resolution - p1(1)) * int64_t(dx);
+			do {
+				assert(ix <= ixb && iy <= iyb);
+				if (ex < ey) {
+					ey -= ex;
+					ex = int64_t(dy) * resolution;
+					ix += 1;
+				}
+				else if (ex == ey) {
+					ex = int64_t(dy) * resolution;
+					ey = int64_t(dx) * resolution;
+					ix += 1;
+					iy += 1;
+				}
+				else {
+					assert(ex > ey);
+					ex -= ey;
+					ey = int64_t(dx) * resolution;
+					iy += 1;
+				}
+				visitor(iy, ix);
+			} while (ix != ixb || iy != iyb);
+		}
+		else {
+			// x positive, y non positive
+			int64_t ey = int64_t(p1(1) - iy*resolution) * int64_t(dx);
+			do {
+				assert(ix <= ixb && iy >= iyb);
+				if (ex <= ey) {
+					ey -= ex;
+					ex = int64_t(dy) * resolution;
+					ix += 1;
+				}
+				else {
+					ex -= ey;
+					ey = int64_t(dx) * resolution;
+					iy -= 1;
+				}
+				visitor(iy, ix);
+			} while (ix != ixb || iy != iyb);
+		}
+	}
+	else {
+		int64_t ex = int64_t(p1(0) - ix*resolution) * int64_t(dy);
+		if (p1(1) < p2(1)) {
+			// x non positive, y positive
+			int64_t ey = int64_t((iy + 1)*resolution - p1(1)) * int64_t(dx);
+			do {
+				assert(ix >= ixb && iy <= iyb);
+				if (ex < ey) {
+					ey -= ex;
+					ex = int64_t(dy) * resolution;
+					ix -= 1;
+				}
+				else {
+					assert(ex >= ey);
+					ex -= ey;
+					ey = int64_t(dx) * resolution;
+					iy += 1;
+				}
+				visitor(iy, ix);
+			} while (ix != ixb || iy != iyb);
+		}
+		else {
+			// x non positive, y non positive
+			int64_t ey = int64_t(p1(1) - iy*resolution) * int64_t(dx);
+			do {
+				assert(ix >= ixb && iy >= iyb);
+				if (ex < ey) {
+					ey -= ex;
+					ex = int64_t(dy) * resolution;
+					ix -= 1;
+				}
+				else if (ex == ey) {
+					// The lower edge of a grid cell belongs to the cell.
+					// Handle the case where the ray may cross the lower left corner of a cell in a general case,
+					// or a left or lower edge in a degenerate case (horizontal or vertical line).
+					if (dx > 0) {
+						ex = int64_t(dy) * resolution;
+						ix -= 1;
+					}
+					if (dy > 0) {
+						ey = int64_t(dx) * resolution;
+						iy -= 1;
+					}
+				}
+				else {
+					assert(ex > ey);
+					ex -= ey;
+					ey = int64_t(dx) * resolution;
+					iy -= 1;
+				}
+				visitor(iy, ix);
+			} while (ix != ixb || iy != iyb);
+		}
+	}
+}
+
+// Rasterize the edges of m_contours into the rows <row_begin, row_end) of the grid. The edges are visited in the order
+// of the contours and of their segments, therefore the edges of a cell are sorted the same way independently of how the rows are split.
+// If fill is false, count the edges per cell into m_cells[].end, otherwise fill in m_cell_data at m_cells[].end, advancing m_cells[].end.
+void EdgeGrid::Grid::rasterize_rows(size_t row_begin, size_t row_end, bool fill)
+{
+	for (size_t i = 0; i < m_contours.size(); ++ i) {
+		const Slic3r::Points &pts = *m_contours[i];
+		for (size_t j = 0; j < pts.size(); ++ j) {
+			// End points of the line segment.
+			Slic3r::Point p1(pts[j]);
+			Slic3r::Point p2 = pts[(j + 1 == pts.size()) ? 0 : j + 1];
+			p1(0) -= m_bbox.min(0);
+			p1(1) -= m_bbox.min(1);
+			p2(0) -= m_bbox.min(0);
+			p2(1) -= m_bbox.min(1);
+			assert(p1(0) / m_resolution >= 0 && p1(0) / m_resolution < m_cols);
+			assert(p1(1) / m_resolution >= 0 && p1(1) / m_resolution < m_rows);
+			assert(p2(0) / m_resolution >= 0 && p2(0) / m_resolution < m_cols);
+			assert(p2(1) / m_resolution >= 0 && p2(1) / m_resolution < m_rows);
+			// The rows are rasterized monotonously, skip the segments not crossing <row_begin, row_end).
+			size_t iy1 = size_t(p1(1) / m_resolution);
+			size_t iy2 = size_t(p2(1) / m_resolution);
+			if (std::max(iy1, iy2) < row_begin || std::min(iy1, iy2) >= row_end)
+				continue;
+			auto visitor = [this, row_begin, row_end, fill, i, j](coord_t iy, coord_t ix) {
+				if (size_t(iy) >= row_begin && size_t(iy) < row_end) {
+					Cell &cell = m_cells[iy * m_cols + ix];
+					if (fill)
+						m_cell_data[cell.end ++] = std::pair<size_t, size_t>(i, j);
+					else
+						++ cell.end;
+				}
+			};
+			rasterize_segment(p1, p2, m_resolution, visitor);
+		}
+	}
+}
+
 // m_contours has been initialized. Now fill in the edge grid.
 void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 {
 	// 1) Measure the bounding box.
+	size_t num_edges = 0;
 	for (size_t i = 0; i < m_contours.size(); ++ i) {
 		const Slic3r::Points &pts = *m_contours[i];
 		for (size_t j = 0; j < pts.size(); ++ j)
 			m_bbox.merge(pts[j]);
+		num_edges += pts.size();
 	}
 	coord_t eps = 16;
 	m_bbox.min(0) -= eps;
@@ -130,136 +297,19 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	m_rows = (m_bbox.max(1) - m_bbox.min(1) + m_resolution - 1) / m_resolution;
 	m_cells.assign(m_rows * m_cols, Cell());
 
+	// Rasterize bands of rows in parallel, each band owning its cells. Each band has to skip the edges outside of it,
+	// therefore the bands shall not be too thin. Small grids are rasterized by a single thread.
+	size_t rows_per_band = (num_edges < 4096) ? std::max<size_t>(m_rows, 1) : std::max<size_t>(m_rows * 2048 / num_edges, 16);
+	auto rasterize = [this, rows_per_band](bool fill) {
+		if (rows_per_band >= m_rows)
+			this->rasterize_rows(0, m_rows, fill);
+		else
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rows, rows_per_band),
+				[this, fill](const tbb::blocked_range<size_t> &range) { this->rasterize_rows(range.begin(), range.end(), fill); });
+	};
+
 	// 3) First round of contour rasterization, count the edges per grid cell.
-	for (size_t i = 0; i < m_contours.size(); ++ i) {
-		const Slic3r::Points &pts = *m_contours[i];
-		for (size_t j = 0; j < pts.size(); ++ j) {
-			// End points of the line segment.
-			Slic3r::Point p1(pts[j]);
-			Slic3r::Point p2 = pts[(j + 1 == pts.size()) ? 0 : j + 1];
-			p1(0) -= m_bbox.min(0);
-			p1(1) -= m_bbox.min(1);
-			p2(0) -= m_bbox.min(0);
-			p2(1) -= m_bbox.min(1);
-		   	// Get the cells of the end points.
-		    coord_t ix    = p1(0) / m_resolution;
-		    coord_t iy    = p1(1) / m_resolution;
-		    coord_t ixb   = p2(0) / m_resolution;
-		    coord_t iyb   = p2(1) / m_resolution;
-			assert(ix >= 0 && ix < m_cols);
-			assert(iy >= 0 && iy < m_rows);
-			assert(ixb >= 0 && ixb < m_cols);
-			assert(iyb >= 0 && iyb < m_rows);
-			// Account for the end points.
-			++ m_cells[iy*m_cols+ix].end;
-			if (ix == ixb && iy == iyb)
-				// Both ends fall into the same cell.
-				continue;
-		    // Raster the centeral part of the line.
-			coord_t dx = std::abs(p2(0) - p1(0));
-			coord_t dy = std::abs(p2(1) - p1(1));
-			if (p1(0) < p2(0)) {
-				int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else if (ex == ey) {
-							ex = int64_t(dy) * m_resolution;
-							ey = int64_t(dx) * m_resolution;
-							ix += 1;
-							iy += 1;
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy >= iyb);
-						if (ex <= ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else {
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-			else {
-				int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x non positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else {
-							assert(ex >= ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x non positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy >= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else if (ex == ey) {
-							// The lower edge of a grid cell belongs to the cell.
-							// Handle the case where the ray may cross the lower left corner of a cell in a general case,
-							// or a left or lower edge in a degenerate case (horizontal or vertical line).
-							if (dx > 0) {
-								ex = int64_t(dy) * m_resolution;
-								ix -= 1;
-							}
-							if (dy > 0) {
-								ey = int64_t(dx) * m_resolution;
-								iy -= 1;
-							}
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-		}
-	}
+	rasterize(false);
 
 	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
 	size_t cnt = m_cells.front().end;
@@ -275,135 +325,51 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	// 6) Finally fill in m_cell_data by rasterizing the lines once again.
 	for (size_t i = 0; i < m_cells.size(); ++i)
 		m_cells[i].end = m_cells[i].begin;
-	for (size_t i = 0; i < m_contours.size(); ++i) {
-		const Slic3r::Points &pts = *m_contours[i];
-		for (size_t j = 0; j < pts.size(); ++j) {
-			// End points of the line segment.
-			Slic3r::Point p1(pts[j]);
-			Slic3r::Point p2 = pts[(j + 1 == pts.size()) ? 0 : j + 1];
-			p1(0) -= m_bbox.min(0);
-			p1(1) -= m_bbox.min(1);
-			p2(0) -= m_bbox.min(0);
-			p2(1) -= m_bbox.min(1);
-			// Get the cells of the end points.
-			coord_t ix = p1(0) / m_resolution;
-			coord_t iy = p1(1) / m_resolution;
-			coord_t ixb = p2(0) / m_resolution;
-			coord_t iyb = p2(1) / m_resolution;
-			assert(ix >= 0 && ix < m_cols);
-			assert(iy >= 0 && iy < m_rows);
-			assert(ixb >= 0 && ixb < m_cols);
-			assert(iyb >= 0 && iyb < m_rows);
-			// Account for the end points.
-			m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-			if (ix == ixb && iy == iyb)
-				// Both ends fall into the same cell.
-				continue;
-			// Raster the centeral part of the line.
-			coord_t dx = std::abs(p2(0) - p1(0));
-			coord_t dy = std::abs(p2(1) - p1(1));
-			if (p1(0) < p2(0)) {
-				int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else if (ex == ey) {
-							ex = int64_t(dy) * m_resolution;
-							ey = int64_t(dx) * m_resolution;
-							ix += 1;
-							iy += 1;
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy >= iyb);
-						if (ex <= ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else {
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-			else {
-				int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x non positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else {
-							assert(ex >= ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x non positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy >= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else if (ex == ey) {
-							// The lower edge of a grid cell belongs to the cell.
-							// Handle the case where the ray may cross the lower left corner of a cell in a general case,
-							// or a left or lower edge in a degenerate case (horizontal or vertical line).
-							if (dx > 0) {
-								ex = int64_t(dy) * m_resolution;
-								ix -= 1;
-							}
-							if (dy > 0) {
-								ey = int64_t(dx) * m_resolution;
-								iy -= 1;
-							}
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-			}
+	rasterize(true);
+
+	// The edges for the batch queries are copied by prepare_cell_edges().
+	m_cell_edges.clear();
+	m_cell_edges_state = CELL_EDGES_INVALID;
+}
+
+void EdgeGrid::Grid::prepare_cell_edges() const
+{
+	for (;;) {
+		if (m_cell_edges_state == CELL_EDGES_VALID)
+			return;
+		if (m_cell_edges_state.compare_and_swap(CELL_EDGES_BUILDING, CELL_EDGES_INVALID) == CELL_EDGES_INVALID)
+			break;
+		// Another thread is copying the edges. The copy is serial, so that this thread does not wait for itself
+		// while the builder runs a task stealing a batch query of this grid.
+		while (m_cell_edges_state == CELL_EDGES_BUILDING)
+			std::this_thread::yield();
+	}
+	try {
+		m_cell_edges.assign(m_cell_data.size(), CellEdge());
+		for (size_t i = 0; i < m_cell_data.size(); ++ i) {
+			const Slic3r::Points &pts = *m_contours[m_cell_data[i].first];
+			size_t ipt = m_cell_data[i].second;
+			const Slic3r::Point &p0 = pts[(ipt == 0) ? (pts.size() - 1) : ipt - 1];
+			const Slic3r::Point &p1 = pts[ipt];
+			const Slic3r::Point &p2 = pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1];
+			Slic3r::Point v_seg      = p2 - p1;
+			Slic3r::Point v_seg_prev = p1 - p0;
+			CellEdge &edge = m_cell_edges[i];
+			edge.x       = p1(0);
+			edge.y       = p1(1);
+			edge.dx      = v_seg(0);
+			edge.dy      = v_seg(1);
+			edge.dx_prev = v_seg_prev(0);
+			edge.dy_prev = v_seg_prev(1);
+			edge.length  = sqrt(double(int64_t(v_seg(0)) * int64_t(v_seg(0)) + int64_t(v_seg(1)) * int64_t(v_seg(1))));
 		}
+	} catch (...) {
+		// Let the next query try again instead of waiting forever.
+		m_cell_edges.clear();
+		m_cell_edges_state = CELL_EDGES_INVALID;
+		throw;
 	}
+	m_cell_edges_state = CELL_EDGES_VALID;
 }
 
 #if 0
@@ -1229,6 +1195,135 @@ bool EdgeGrid::Grid::signed_distance(const Point &pt, coord_t search_radius, coo
 	return true;
 }
 
+// Kernel of the batch queries, see signed_distance_edges(). Returns an index to m_cell_data / m_cell_edges of the closest edge
+// or size_t(-1) if no edge is closer than search_radius.
+size_t EdgeGrid::Grid::closest_cell_edge(const Point &pt, coord_t search_radius, coordf_t &result_min_dist, bool &on_segment) const
+{
+	// Window of the grid cells to be searched, calculated the same way as in signed_distance_edges().
+	Point pmin(pt(0) - m_bbox.min(0), pt(1) - m_bbox.min(1));
+	Point pmax = pmin;
+	// Upper boundary, round to grid and test validity.
+	pmax(0) += search_radius;
+	pmax(1) += search_radius;
+	if (pmax(0) < 0 || pmax(1) < 0)
+		return size_t(-1);
+	pmax(0) = std::min<coord_t>(pmax(0) / m_resolution, coord_t(m_cols) - 1);
+	pmax(1) = std::min<coord_t>(pmax(1) / m_resolution, coord_t(m_rows) - 1);
+	// Lower boundary, round to grid and test validity.
+	pmin(0) = std::max<coord_t>(pmin(0) - search_radius, 0) / m_resolution;
+	pmin(1) = std::max<coord_t>(pmin(1) - search_radius, 0) / m_resolution;
+	// Is the interval empty?
+	if (pmin(0) > pmax(0) || pmin(1) > pmax(1))
+		return size_t(-1);
+
+	const coord_t px = pt(0);
+	const coord_t py = pt(1);
+	// Replicates the precision of signed_distance_edges(), which keeps the minimum distance as float.
+	float  d_min  = float(search_radius);
+	// Squared d_min, exact in double. A vertex may only be closer than d_min if its squared distance is smaller,
+	// therefore sqrt() is only evaluated for the vertices passing this test.
+	double d2_min = double(d_min) * double(d_min);
+	size_t i_min  = size_t(-1);
+	// The cells of a row of the window reference a continuous range of m_cell_data, which is traversed in the same order
+	// as by signed_distance_edges(), including the duplicate edges crossing multiple cells, so that the ties are resolved the same way.
+	for (coord_t r = pmin(1); r <= pmax(1); ++ r) {
+		const size_t end = m_cells[r * m_cols + pmax(0)].end;
+		for (size_t k = m_cells[r * m_cols + pmin(0)].begin; k < end; ++ k) {
+			const CellEdge &edge = m_cell_edges[k];
+			coord_t vx   = px - edge.x;
+			coord_t vy   = py - edge.y;
+			// dot(p2-p1, pt-p1)
+			int64_t t_pt = int64_t(edge.dx) * int64_t(vx) + int64_t(edge.dy) * int64_t(vy);
+			if (t_pt < 0) {
+				// Closest to p1.
+				double d2 = double(int64_t(vx) * int64_t(vx) + int64_t(vy) * int64_t(vy));
+				if (d2 < d2_min &&
+					// Inside the wedge between the previous and the next segment.
+					int64_t(edge.dx_prev) * int64_t(vx) + int64_t(edge.dy_prev) * int64_t(vy) > 0) {
+					double dabs = sqrt(d2);
+					if (dabs < d_min) {
+						d_min  = float(dabs);
+						d2_min = double(d_min) * double(d_min);
+						i_min  = k;
+					}
+				}
+			} else if (t_pt <= int64_t(edge.dx) * int64_t(edge.dx) + int64_t(edge.dy) * int64_t(edge.dy)) {
+				// Closest to the segment. Otherwise closest to p2, which is the starting point of another segment found in the same cell.
+				int64_t d_seg = int64_t(edge.dy) * int64_t(vx) - int64_t(edge.dx) * int64_t(vy);
+				double  dabs  = std::abs(double(d_seg)) / edge.length;
+				if (dabs < d_min) {
+					d_min  = float(dabs);
+					d2_min = double(d_min) * double(d_min);
+					i_min  = k;
+				}
+			}
+		}
+	}
+	if (i_min == size_t(-1) || d_min >= search_radius)
+		return size_t(-1);
+
+	// Signum of the closest edge or vertex.
+	const CellEdge &edge = m_cell_edges[i_min];
+	coord_t vx    = px - edge.x;
+	coord_t vy    = py - edge.y;
+	int64_t t_pt  = int64_t(edge.dx) * int64_t(vx) + int64_t(edge.dy) * int64_t(vy);
+	int64_t d_seg = int64_t(edge.dy) * int64_t(vx) - int64_t(edge.dx) * int64_t(vy);
+	int64_t det   = int64_t(edge.dx_prev) * int64_t(edge.dy) - int64_t(edge.dy_prev) * int64_t(edge.dx);
+	on_segment    = t_pt >= 0;
+	int sign_min  = on_segment ? ((d_seg < 0) ? -1 : ((d_seg == 0) ? 0 : 1)) : ((det > 0) ? 1 : -1);
+	result_min_dist = d_min * sign_min;
+	return i_min;
+}
+
+// Call fn(i) for all points of a batch query. Large batches are processed in parallel, each thread processing a block of points
+// sorted by the grid cells they fall into, so that the points close to each other share the edges in the cache.
+template<typename Fn>
+static void for_each_query_point(const Points &pts, const BoundingBox &bbox, coord_t resolution, size_t cols, Fn fn)
+{
+	if (pts.size() < 4096) {
+		for (size_t i = 0; i < pts.size(); ++ i)
+			fn(i);
+	} else {
+		std::vector<std::pair<size_t, size_t>> order(pts.size());
+		for (size_t i = 0; i < pts.size(); ++ i) {
+			// Points outside of the grid are sorted to the closest boundary cells.
+			coord_t ix = std::max<coord_t>(0, std::min<coord_t>(bbox.max(0) - bbox.min(0), pts[i](0) - bbox.min(0))) / resolution;
+			coord_t iy = std::max<coord_t>(0, std::min<coord_t>(bbox.max(1) - bbox.min(1), pts[i](1) - bbox.min(1))) / resolution;
+			order[i] = std::make_pair(size_t(iy) * cols + size_t(ix), i);
+		}
+		std::sort(order.begin(), order.end());
+		tbb::parallel_for(tbb::blocked_range<size_t>(0, order.size(), 1024), [&order, &fn](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				fn(order[i].second);
+		});
+	}
+}
+
+void EdgeGrid::Grid::signed_distances_edges(const Points &pts, coord_t search_radius, std::vector<EdgeDistance> &result) const
+{
+	result.assign(pts.size(), EdgeDistance());
+	this->prepare_cell_edges();
+	for_each_query_point(pts, m_bbox, m_resolution, m_cols, [this, &pts, search_radius, &result](size_t i) {
+		EdgeDistance &out = result[i];
+		size_t idx = this->closest_cell_edge(pts[i], search_radius, out.distance, out.on_segment);
+		if (idx != size_t(-1))
+			out.edge = ContourEdge(m_contours[m_cell_data[idx].first], m_cell_data[idx].second);
+	});
+}
+
+bool EdgeGrid::Grid::signed_distances(const Points &pts, coord_t search_radius, std::vector<coordf_t> &result_min_dist) const
+{
+	result_min_dist.assign(pts.size(), std::numeric_limits<coordf_t>::max());
+	this->prepare_cell_edges();
+	for_each_query_point(pts, m_bbox, m_resolution, m_cols, [this, &pts, search_radius, &result_min_dist](size_t i) {
+		bool on_segment;
+		if (this->closest_cell_edge(pts[i], search_radius, result_min_dist[i], on_segment) == size_t(-1) && ! m_signed_distance_field.empty())
+			result_min_dist[i] = signed_distance_bilinear(pts[i]);
+	});
+	return ! m_signed_distance_field.empty() ||
+		std::find(result_min_dist.begin(), result_min_dist.end(), std::numeric_limits<coordf_t>::max()) == result_min_dist.end();
+}
+
 Polygons EdgeGrid::Grid::contours_simplified(coord_t offset, bool fill_holes) const
 {
 	assert(std::abs(2 * offset) < m_resolution);
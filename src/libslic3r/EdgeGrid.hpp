@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <math.h>
 
+#include <tbb/atomic.h>
+
 #include "Point.hpp"
 #include "BoundingBox.hpp"
 #include "ExPolygon.hpp"
@@ -65,6 +67,26 @@ public:
 	std::vector<std::pair<ContourEdge, ContourEdge>> intersecting_edges() const;
 	bool 											 has_intersecting_edges() const;
 
+	// Result of the batch signed distance query.
+	struct EdgeDistance {
+		EdgeDistance() : distance(0.), edge(nullptr, 0), on_segment(false) {}
+		// Signed distance, positive outside of the contours, negative inside.
+		coordf_t 	distance;
+		// The closest edge, or the edge starting at the closest vertex. edge.first is NULL if no edge was found in the search radius.
+		ContourEdge edge;
+		// Is the closest point inside the edge rather than at its starting vertex?
+		bool 		on_segment;
+	};
+
+	// Batch version of signed_distance_edges() returning the same distances, and the closest edges.
+	// The distances are calculated over the edges copied to m_cell_edges, large batches are sorted by the grid cells
+	// and processed in parallel.
+	void signed_distances_edges(const Points &pts, coord_t search_radius, std::vector<EdgeDistance> &result) const;
+
+	// Batch version of signed_distance(). Returns false if the distance of any of the points is unknown,
+	// its result_min_dist is then set to std::numeric_limits<coordf_t>::max().
+	bool signed_distances(const Points &pts, coord_t search_radius, std::vector<coordf_t> &result_min_dist) const;
+
 protected:
 	struct Cell {
 		Cell() : begin(0), end(0) {}
@@ -73,6 +95,10 @@ protected:
 	};
 
 	void create_from_m_contours(coord_t resolution);
+	void rasterize_rows(size_t row_begin, size_t row_end, bool fill);
+	// Copy the edges into m_cell_edges on the first batch query.
+	void prepare_cell_edges() const;
+	size_t closest_cell_edge(const Point &pt, coord_t search_radius, coordf_t &result_min_dist, bool &on_segment) const;
 #if 0
 	bool line_cell_intersect(const Point &p1, const Point &p2, const Cell &cell);
 #endif
@@ -104,6 +130,24 @@ protected:
 	// Referencing a contour and a line segment of m_contours.
 	std::vector<std::pair<size_t, size_t> >		m_cell_data;
 
+	// Copy of the edges referenced by m_cell_data, indexed the same way as m_cell_data, so that the batch signed distance
+	// queries run over continuous memory: The starting point, the edge vector, the vector of the preceding edge and the edge length.
+	// Most grids are only queried point by point, therefore the copy is made by the first batch query.
+	struct CellEdge {
+		coord_t x, y;
+		coord_t dx, dy;
+		coord_t dx_prev, dy_prev;
+		double  length;
+	};
+	enum CellEdgesState {
+		CELL_EDGES_INVALID,
+		CELL_EDGES_BUILDING,
+		CELL_EDGES_VALID,
+	};
+	mutable std::vector<CellEdge>				m_cell_edges;
+	// CellEdgesState. A batch query waits for a concurrent batch query, which is copying the edges.
+	mutable tbb::atomic<int>					m_cell_edges_state;
+
 	// Full grid of cells.
 	std::vector<Cell> 							m_cells;
 
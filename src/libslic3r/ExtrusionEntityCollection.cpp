@@ -1,4 +1,5 @@
 #include "ExtrusionEntityCollection.hpp"
+#include "ShortestPath.hpp"
 #include <algorithm>
 #include <cmath>
 #include <map>
@@ -111,10 +112,8 @@ void ExtrusionEntityCollection::chained_path_from(Point start_near, ExtrusionEnt
     retval->entities.reserve(this->entities.size());
     retval->orig_indices.reserve(this->entities.size());
     
-    // if we're asked to return the original indices, build a map
-    std::map<ExtrusionEntity*,size_t> indices_map;
-    
     ExtrusionEntitiesPtr my_paths;
+    std::vector<size_t>  my_indices;
     for (ExtrusionEntitiesPtr::const_iterator it = this->entities.begin(); it != this->entities.end(); ++it) {
         if (role != erMixed) {
             // The caller wants only paths with a specific extrusion role.
@@ -125,36 +124,27 @@ void ExtrusionEntityCollection::chained_path_from(Point start_near, ExtrusionEnt
                 continue;
             }
         }
-
-        ExtrusionEntity* entity = (*it)->clone();
-        my_paths.push_back(entity);
-        if (orig_indices != NULL) indices_map[entity] = it - this->entities.begin();
+        my_paths.push_back((*it)->clone());
+        my_indices.push_back(it - this->entities.begin());
     }
     
-    Points endpoints;
-    for (ExtrusionEntitiesPtr::iterator it = my_paths.begin(); it != my_paths.end(); ++it) {
-        endpoints.push_back((*it)->first_point());
-        if (no_reverse || !(*it)->can_reverse()) {
-            endpoints.push_back((*it)->first_point());
-        } else {
-            endpoints.push_back((*it)->last_point());
-        }
+    Points            endpoints;
+    std::vector<bool> can_reverse;
+    endpoints.reserve(my_paths.size() * 2);
+    can_reverse.reserve(my_paths.size());
+    for (const ExtrusionEntity *entity : my_paths) {
+        endpoints.push_back(entity->first_point());
+        endpoints.push_back(entity->last_point());
+        // never reverse loops, since it's pointless for chained path and callers might depend on orientation
+        can_reverse.push_back(! no_reverse && entity->can_reverse());
     }
     
-    while (!my_paths.empty()) {
-        // find nearest point
-        int start_index = start_near.nearest_point_index(endpoints);
-        int path_index = start_index/2;
-        ExtrusionEntity* entity = my_paths.at(path_index);
-        // never reverse loops, since it's pointless for chained path and callers might depend on orientation
-        if (start_index % 2 && !no_reverse && entity->can_reverse()) {
+    for (const std::pair<size_t, bool> &segment : chain_segments(endpoints, start_near, can_reverse, ChainTieBreak::LastIndex)) {
+        ExtrusionEntity *entity = my_paths[segment.first];
+        if (segment.second)
             entity->reverse();
-        }
-        retval->entities.push_back(my_paths.at(path_index));
-        if (orig_indices != NULL) orig_indices->push_back(indices_map[entity]);
-        my_paths.erase(my_paths.begin() + path_index);
-        endpoints.erase(endpoints.begin() + 2*path_index, endpoints.begin() + 2*path_index + 2);
-        start_near = retval->entities.back()->last_point();
+        retval->entities.push_back(entity);
+        if (orig_indices != NULL) orig_indices->push_back(my_indices[segment.first]);
     }
 }
 
@@ -1492,7 +1492,7 @@ namespace Slic3r {
             // splits volume out of imported geometry
             unsigned int triangles_count = volume_data.last_triangle_id - volume_data.first_triangle_id + 1;
             ModelVolume* volume = object.add_volume(TriangleMesh());
-            stl_file& stl = volume->mesh.stl;
+            stl_file& stl = volume->mesh_mutable().stl;
             stl.stats.type = inmemory;
             stl.stats.number_of_facets = (uint32_t)triangles_count;
             stl.stats.original_num_facets = (int)stl.stats.number_of_facets;
@@ -1511,7 +1511,7 @@ namespace Slic3r {
             }
 
             stl_get_size(&stl);
-            volume->mesh.repair();
+            volume->mesh_mutable().repair();
             volume->center_geometry();
             volume->calculate_convex_hull();
 
@@ -1884,12 +1884,12 @@ namespace Slic3r {
 
             volumes_offsets.insert(VolumeToOffsetsMap::value_type(volume, Offsets(vertices_count))).first;
 
-            if (!volume->mesh.repaired)
-                volume->mesh.repair();
+            if (!volume->mesh().repaired)
+                volume->mesh_mutable().repair();
+            if (volume->mesh().stl.v_shared == nullptr)
+                stl_generate_shared_vertices(&volume->mesh_mutable().stl);
 
-            stl_file& stl = volume->mesh.stl;
-            if (stl.v_shared == nullptr)
-                stl_generate_shared_vertices(&stl);
+            const stl_file& stl = volume->mesh().stl;
 
             if (stl.stats.shared_vertices == 0)
             {
@@ -1923,7 +1923,7 @@ namespace Slic3r {
             VolumeToOffsetsMap::iterator volume_it = volumes_offsets.find(volume);
             assert(volume_it != volumes_offsets.end());
 
-            stl_file& stl = volume->mesh.stl;
+            const stl_file& stl = volume->mesh().stl;
 
             // updates triangle offsets
             volume_it->second.first_triangle_id = triangles_count;
@@ -21,6 +21,9 @@
 #include <boost/nowide/cstdio.hpp>
 #include <boost/nowide/cstdlib.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
+
 #include "SVG.hpp"
 
 #include <Shiny/Shiny.h>
@@ -43,6 +46,80 @@ static inline void check_add_eol(std::string &gcode)
         gcode += '\n';    
 }
     
+static size_t islands_hash(const ExPolygons &islands)
+{
+    size_t seed = islands.size();
+    auto hash_polygon = [&seed](const Polygon &polygon) {
+        for (const Point &pt : polygon.points)
+            seed ^= PointHash()(pt) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed = seed * 31 + polygon.points.size();
+    };
+    for (const ExPolygon &island : islands) {
+        hash_polygon(island.contour);
+        for (const Polygon &hole : island.holes)
+            hash_polygon(hole);
+    }
+    return seed;
+}
+
+static bool islands_equal(const ExPolygons &islands1, const ExPolygons &islands2)
+{
+    if (islands1.size() != islands2.size())
+        return false;
+    for (size_t i = 0; i < islands1.size(); ++ i) {
+        const ExPolygon &island1 = islands1[i];
+        const ExPolygon &island2 = islands2[i];
+        if (island1.contour.points != island2.contour.points || island1.holes.size() != island2.holes.size())
+            return false;
+        for (size_t j = 0; j < island1.holes.size(); ++ j)
+            if (island1.holes[j].points != island2.holes[j].points)
+                return false;
+    }
+    return true;
+}
+
+// Union of a stack of polygon sets, merged pairwise in parallel. Much faster than a single union of all the polygons
+// if the polygons overlap a lot, as the contours of the layers of an object do.
+static Polygons union_pairwise(std::vector<Polygons> &&polygons)
+{
+    while (polygons.size() > 1) {
+        std::vector<Polygons> merged((polygons.size() + 1) / 2);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, merged.size()),
+            [&polygons, &merged](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    if (2 * i + 1 < polygons.size()) {
+                        append(polygons[2 * i], std::move(polygons[2 * i + 1]));
+                        merged[i] = union_(polygons[2 * i]);
+                    } else
+                        merged[i] = std::move(polygons[2 * i]);
+            });
+        polygons = std::move(merged);
+    }
+    return polygons.empty() ? Polygons() : std::move(polygons.front());
+}
+
+void AvoidCrossingPerimeters::init_layer_mp(const ExPolygons &islands)
+{
+    // Number of the motion planners kept, enough for a couple of objects printed layer by layer.
+    const size_t max_layer_mps = 8;
+    size_t hash = islands_hash(islands);
+    for (auto it = m_layer_mps.begin(); it != m_layer_mps.end(); ++ it)
+        if (it->islands_hash == hash && islands_equal(it->islands, islands)) {
+            // Make it the most recently used one.
+            std::rotate(it, it + 1, m_layer_mps.end());
+            m_layer_mp = m_layer_mps.back().planner.get();
+            return;
+        }
+    if (m_layer_mps.size() == max_layer_mps)
+        m_layer_mps.erase(m_layer_mps.begin());
+    LayerMotionPlanner mp;
+    mp.islands_hash = hash;
+    mp.islands      = islands;
+    mp.planner      = Slic3r::make_unique<MotionPlanner>(islands);
+    m_layer_mps.emplace_back(std::move(mp));
+    m_layer_mp = m_layer_mps.back().planner.get();
+}
+
 // Plan a travel move while minimizing the number of perimeter crossings.
 // point is in unscaled coordinates, in the coordinate system of the current active object
 // (set by gcodegen.set_origin()).
@@ -52,7 +129,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     // Otherwise perform the path planning in the coordinate system of the active object.
     bool  use_external  = this->use_external_mp || this->use_external_mp_once;
     Point scaled_origin = use_external ? Point::new_scale(gcodegen.origin()(0), gcodegen.origin()(1)) : Point(0, 0);
-    Polyline result = (use_external ? m_external_mp.get() : m_layer_mp.get())->
+    Polyline result = (use_external ? m_external_mp.get() : m_layer_mp)->
         shortest_path(gcodegen.last_pos() + scaled_origin, point + scaled_origin);
     if (use_external)
         result.translate(- scaled_origin);
@@ -419,6 +496,19 @@ std::vector<std::pair<coordf_t, std::vector<GCode::LayerToPrint>>> GCode::collec
     return layers_to_print;
 }
 
+void GCodeOutputStream::write_format(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char buffer[1024];
+    int  res = ::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    // Only used for short lines.
+    assert(res < int(sizeof(buffer)));
+    if (res > 0)
+        this->write(buffer, std::min(size_t(res), sizeof(buffer) - 1));
+}
+
 void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_data)
 {
     PROFILE_CLEAR();
@@ -445,7 +535,9 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
 
     try {
         m_placeholder_parser_failed_templates.clear();
-        this->_do_export(*print, file);
+        GCodeOutputStream stream(file);
+        this->_do_export(*print, stream);
+        stream.flush();
         fflush(file);
         if (ferror(file)) {
             fclose(file);
@@ -475,15 +567,16 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
     }
 
     if (print->config().remaining_times.value) {
+        // The M73 placeholders were written during the export, fill in the remaining times in place.
         BOOST_LOG_TRIVIAL(debug) << "Processing remaining times for normal mode";
-        m_normal_time_estimator.post_process_remaining_times(path_tmp, 60.0f);
-        m_normal_time_estimator.reset();
+        m_normal_time_estimator.patch_remaining_times(path_tmp);
         if (m_silent_time_estimator_enabled) {
             BOOST_LOG_TRIVIAL(debug) << "Processing remaining times for silent mode";
-            m_silent_time_estimator.post_process_remaining_times(path_tmp, 60.0f);
-            m_silent_time_estimator.reset();
+            m_silent_time_estimator.patch_remaining_times(path_tmp);
         }
     }
+    m_normal_time_estimator.reset();
+    m_silent_time_estimator.reset();
 
     // starts analyzer calculations
     if (m_enable_analyzer) {
@@ -505,7 +598,7 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
     PROFILE_OUTPUT(debug_out_path("gcode-export-profile.txt").c_str());
 }
 
-void GCode::_do_export(Print &print, FILE *file)
+void GCode::_do_export(Print &print, GCodeOutputStream &file)
 {
     PROFILE_FUNC();
 
@@ -572,6 +665,11 @@ void GCode::_do_export(Print &print, FILE *file)
         m_normal_time_estimator.set_filament_load_times(print.config().filament_load_time.values);
         m_normal_time_estimator.set_filament_unload_times(print.config().filament_unload_time.values);
     }
+    // The time estimators keep just a window of the moves in memory and request the M73 lines while the G-code is being written.
+    float remaining_times_interval = print.config().remaining_times.value ? 60.0f : 0.0f;
+    m_normal_time_estimator.set_streaming(GCodeTimeEstimator::Default_Streaming_Window_Size, remaining_times_interval);
+    if (m_silent_time_estimator_enabled)
+        m_silent_time_estimator.set_streaming(GCodeTimeEstimator::Default_Streaming_Window_Size, remaining_times_interval);
 
     // resets analyzer
     m_analyzer.reset();
@@ -721,9 +819,9 @@ void GCode::_do_export(Print &print, FILE *file)
     // adds tags for time estimators
     if (print.config().remaining_times.value)
     {
-        _writeln(file, GCodeTimeEstimator::Normal_First_M73_Output_Placeholder_Tag);
+        file.write(m_normal_time_estimator.get_first_remaining_time_placeholder(file.position()));
         if (m_silent_time_estimator_enabled)
-            _writeln(file, GCodeTimeEstimator::Silent_First_M73_Output_Placeholder_Tag);
+            file.write(m_silent_time_estimator.get_first_remaining_time_placeholder(file.position()));
     }
 
     // Prepare the helper object for replacing placeholders in custom G-code and output filename.
@@ -830,15 +928,23 @@ void GCode::_do_export(Print &print, FILE *file)
     if (print.config().avoid_crossing_perimeters.value) {
         // Collect outer contours of all objects over all layers.
         // Discard objects only containing thin walls (offset would fail on an empty polygon).
+        // The contours of the layers of an object are merged first, then the merged contours are copied for each instance.
         Polygons islands;
-        for (const PrintObject *object : print.objects())
-            for (const Layer *layer : object->layers())
+        for (const PrintObject *object : print.objects()) {
+            std::vector<Polygons> layer_contours;
+            layer_contours.reserve(object->layers().size());
+            for (const Layer *layer : object->layers()) {
+                layer_contours.emplace_back();
                 for (const ExPolygon &expoly : layer->slices.expolygons)
-                    for (const Point &copy : object->copies()) {
-                        islands.emplace_back(expoly.contour);
-                        islands.back().translate(copy);
-                    }
-        //FIXME Mege the islands in parallel.
+                    layer_contours.back().emplace_back(expoly.contour);
+            }
+            Polygons object_islands = union_pairwise(std::move(layer_contours));
+            for (const Point &copy : object->copies())
+                for (const Polygon &island : object_islands) {
+                    islands.emplace_back(island);
+                    islands.back().translate(copy);
+                }
+        }
         m_avoid_crossing_perimeters.init_external_mp(union_ex(islands));
         print.throw_if_canceled();
     }
@@ -929,12 +1035,7 @@ void GCode::_do_export(Print &print, FILE *file)
                 m_cooling_buffer->set_current_extruder(initial_extruder_id);
                 // Pair the object layers with the support layers by z, extrude them.
                 std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-                for (const LayerToPrint &ltp : layers_to_print) {
-                    std::vector<LayerToPrint> lrs;
-                    lrs.emplace_back(std::move(ltp));
-                    this->process_layer(file, print, lrs, tool_ordering.tools_for_layer(ltp.print_z()), &copy - object.copies().data());
-                    print.throw_if_canceled();
-                }
+                this->process_layers(print, tool_ordering, layers_to_print, &copy - object.copies().data(), file);
 #ifdef HAS_PRESSURE_EQUALIZER
                 if (m_pressure_equalizer)
                     _write(file, m_pressure_equalizer->process("", true));
@@ -986,13 +1087,7 @@ void GCode::_do_export(Print &print, FILE *file)
             print.throw_if_canceled();
         }
         // Extrude the layers.
-        for (auto &layer : layers_to_print) {
-            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
-            if (m_wipe_tower && layer_tools.has_wipe_tower)
-                m_wipe_tower->next_layer();
-            this->process_layer(file, print, layer.second, layer_tools, size_t(-1));
-            print.throw_if_canceled();
-        }
+        this->process_layers(print, tool_ordering, layers_to_print, file);
 #ifdef HAS_PRESSURE_EQUALIZER
         if (m_pressure_equalizer)
             _write(file, m_pressure_equalizer->process("", true));
@@ -1039,9 +1134,14 @@ void GCode::_do_export(Print &print, FILE *file)
     // adds tags for time estimators
     if (print.config().remaining_times.value)
     {
-        _writeln(file, GCodeTimeEstimator::Normal_Last_M73_Output_Placeholder_Tag);
+        // Retire the blocks still in the look-ahead window of the time estimators to write their M73 placeholders.
+        m_normal_time_estimator.calculate_time(false);
         if (m_silent_time_estimator_enabled)
-            _writeln(file, GCodeTimeEstimator::Silent_Last_M73_Output_Placeholder_Tag);
+            m_silent_time_estimator.calculate_time(false);
+        _write_remaining_time_placeholders(file);
+        file.write(m_normal_time_estimator.get_last_remaining_time_line());
+        if (m_silent_time_estimator_enabled)
+            file.write(m_silent_time_estimator.get_last_remaining_time_line());
     }
 
     print.throw_if_canceled();
@@ -1190,29 +1290,29 @@ static bool custom_gcode_sets_temperature(const std::string &gcode, const int mc
 
 // Print the machine envelope G-code for the Marlin firmware based on the "machine_max_xxx" parameters.
 // Do not process this piece of G-code by the time estimator, it already knows the values through another sources.
-void GCode::print_machine_envelope(FILE *file, Print &print)
+void GCode::print_machine_envelope(GCodeOutputStream &file, Print &print)
 {
     if (print.config().gcode_flavor.value == gcfMarlin) {
-        fprintf(file, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
+        file.write_format("M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
             int(print.config().machine_max_acceleration_x.values.front() + 0.5),
             int(print.config().machine_max_acceleration_y.values.front() + 0.5),
             int(print.config().machine_max_acceleration_z.values.front() + 0.5),
             int(print.config().machine_max_acceleration_e.values.front() + 0.5));
-        fprintf(file, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
+        file.write_format("M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
             int(print.config().machine_max_feedrate_x.values.front() + 0.5),
             int(print.config().machine_max_feedrate_y.values.front() + 0.5),
             int(print.config().machine_max_feedrate_z.values.front() + 0.5),
             int(print.config().machine_max_feedrate_e.values.front() + 0.5));
-        fprintf(file, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
+        file.write_format("M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5),
             int(print.config().machine_max_acceleration_retracting.values.front() + 0.5),
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5));
-        fprintf(file, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
+        file.write_format("M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
             print.config().machine_max_jerk_x.values.front(),
             print.config().machine_max_jerk_y.values.front(),
             print.config().machine_max_jerk_z.values.front(),
             print.config().machine_max_jerk_e.values.front());
-        fprintf(file, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
+        file.write_format("M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
             int(print.config().machine_min_extruding_rate.values.front() + 0.5),
             int(print.config().machine_min_travel_rate.values.front() + 0.5));
     }
@@ -1222,7 +1322,7 @@ void GCode::print_machine_envelope(FILE *file, Print &print)
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M140 - Set Extruder Temperature
 // M190 - Set Extruder Temperature and Wait
-void GCode::_print_first_layer_bed_temperature(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+void GCode::_print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
     // Initial bed temperature based on the first extruder.
     int  temp = print.config().first_layer_bed_temperature.get_at(first_printing_extruder_id);
@@ -1242,7 +1342,7 @@ void GCode::_print_first_layer_bed_temperature(FILE *file, Print &print, const s
 // Only do that if the start G-code does not already contain any M-code controlling an extruder temperature.
 // M104 - Set Extruder Temperature
 // M109 - Set Extruder Temperature and Wait
-void GCode::_print_first_layer_extruder_temperatures(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
+void GCode::_print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait)
 {
     // Is the bed temperature set by the provided custom G-code?
     int  temp_by_gcode     = -1;
@@ -1297,21 +1397,48 @@ inline std::vector<GCode::ObjectByExtruder::Island>& object_islands_by_extruder(
     return islands;
 }
 
+// Calculate the parts of a layer, which only depend on the print, not on the state of the G-code generator:
+// The distance fields over the lower layers for the seam placement and the islands of the layers
+// for the avoid crossing perimeters motion planner. Called by the parallel stage of the export pipeline.
+GCode::PreparedLayer GCode::prepare_layer(const Print &print, const std::vector<LayerToPrint> &layers) const
+{
+    PreparedLayer out;
+    out.lower_layer_edge_grids.resize(layers.size());
+    if (print.config().avoid_crossing_perimeters)
+        out.islands.resize(layers.size());
+    for (size_t layer_id = 0; layer_id < layers.size(); ++ layer_id) {
+        const Layer *layer = layers[layer_id].layer();
+        if (layer == nullptr)
+            continue;
+        if (print.config().avoid_crossing_perimeters)
+            out.islands[layer_id] = union_ex(layer->slices, true);
+        // The same condition and the same grid as the one created lazily by extrude_loop() for the perimeters.
+        const Layer *object_layer = layers[layer_id].object_layer;
+        if (object_layer != nullptr && object_layer->lower_layer != nullptr && 
+            std::any_of(object_layer->regions().begin(), object_layer->regions().end(), [](const LayerRegion *layerm) { return ! layerm->perimeters.entities.empty(); })) {
+            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
+            out.lower_layer_edge_grids[layer_id] = make_unique<EdgeGrid::Grid>();
+            out.lower_layer_edge_grids[layer_id]->create(object_layer->lower_layer->slices, distance_field_resolution);
+            out.lower_layer_edge_grids[layer_id]->calculate_sdf();
+        }
+    }
+    return out;
+}
+
 // In sequential mode, process_layer is called once per each object and its copy, 
 // therefore layers will contain a single entry and single_object_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
 // For multi-material prints, this routine minimizes extruder switches by gathering extruder specific extrusion paths
 // and performing the extruder specific extrusions together.
-void GCode::process_layer(
-    // Write into the output file.
-    FILE                            *file,
+GCode::LayerResult GCode::process_layer(
     const Print                     &print,
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const std::vector<LayerToPrint> &layers,
     const LayerTools                &layer_tools,
     // If set to size_t(-1), then print all copies of all objects.
     // Otherwise print a single copy of a single object.
-    const size_t                     single_object_idx)
+    const size_t                     single_object_idx,
+    PreparedLayer                   *prepared)
 {
     assert(! layers.empty());
 //    assert(! layer_tools.extruders.empty());
@@ -1320,7 +1447,7 @@ void GCode::process_layer(
 
     if (layer_tools.extruders.empty())
         // Nothing to extrude.
-        return;
+        return LayerResult::make_nop_layer_result();
 
     // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
     const Layer         *object_layer  = nullptr;
@@ -1352,10 +1479,10 @@ void GCode::process_layer(
                     break;
                 }
         }
-        m_spiral_vase->enable = enable;
+        m_spiral_vase_enabled = enable;
     }
     // If we're going to apply spiralvase to this layer, disable loop clipping
-    m_enable_loop_clipping = ! m_spiral_vase || ! m_spiral_vase->enable;
+    m_enable_loop_clipping = ! m_spiral_vase || ! m_spiral_vase_enabled;
     
     std::string gcode;
 
@@ -1592,7 +1719,11 @@ void GCode::process_layer(
     } // for objects
 
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
-    std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
+    std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids;
+    if (prepared == nullptr)
+        lower_layer_edge_grids.resize(layers.size());
+    else
+        lower_layer_edge_grids = std::move(prepared->lower_layer_edge_grids);
     for (unsigned int extruder_id : layer_tools.extruders)
     {
         gcode += (layer_tools.has_wipe_tower && m_wipe_tower) ?
@@ -1662,7 +1793,8 @@ void GCode::process_layer(
                 m_config.apply(print_object->config(), true);
                 m_layer = layers[layer_id].layer();
                 if (m_config.avoid_crossing_perimeters)
-                    m_avoid_crossing_perimeters.init_layer_mp(union_ex(m_layer->slices, true));
+                    m_avoid_crossing_perimeters.init_layer_mp((prepared != nullptr && layer_id < prepared->islands.size()) ? 
+                        prepared->islands[layer_id] : union_ex(m_layer->slices, true));
                 Points copies;
                 if (single_object_idx == size_t(-1))
                     copies = print_object->copies();
@@ -1706,32 +1838,147 @@ void GCode::process_layer(
         }
     }
 
+    BOOST_LOG_TRIVIAL(trace) << "Generated layer " << layer.id() << " print_z " << print_z;
+    return { std::move(gcode), layer.id(), m_spiral_vase_enabled, false };
+}
+
+void GCode::process_layers(
+    const Print                             &print,
+    const ToolOrdering                      &tool_ordering,
+    const std::vector<LayerToPrint>         &layers_to_print,
+    const size_t                             single_object_idx,
+    GCodeOutputStream                       &file)
+{
+    this->_process_layers(layers_to_print.size(),
+        [this, &print, &layers_to_print](size_t layer_idx) {
+            return this->prepare_layer(print, { layers_to_print[layer_idx] });
+        },
+        [this, &print, &tool_ordering, &layers_to_print, single_object_idx](size_t layer_idx, PreparedLayer &prepared) {
+            const LayerToPrint &layer = layers_to_print[layer_idx];
+            LayerResult result = this->process_layer(print, { layer }, tool_ordering.tools_for_layer(layer.print_z()), single_object_idx, &prepared);
+            print.throw_if_canceled();
+            return result;
+        }, file);
+}
+
+void GCode::process_layers(
+    const Print                                                         &print,
+    const ToolOrdering                                                  &tool_ordering,
+    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+    GCodeOutputStream                                                   &file)
+{
+    this->_process_layers(layers_to_print.size(),
+        [this, &print, &layers_to_print](size_t layer_idx) {
+            return this->prepare_layer(print, layers_to_print[layer_idx].second);
+        },
+        [this, &print, &tool_ordering, &layers_to_print](size_t layer_idx, PreparedLayer &prepared) {
+            const std::pair<coordf_t, std::vector<LayerToPrint>> &layer = layers_to_print[layer_idx];
+            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
+            if (m_wipe_tower && layer_tools.has_wipe_tower)
+                m_wipe_tower->next_layer();
+            LayerResult result = this->process_layer(print, layer.second, layer_tools, size_t(-1), &prepared);
+            print.throw_if_canceled();
+            return result;
+        }, file);
+}
+
+// process_layer() as well as each of the post-processing filters keeps its own state (the print head position,
+// the extruders, the fan speed), therefore each of them has to see the layers in order. The pipeline runs
+// the G-code generation, the post-processing and the output (including the G-code analyzer and the time estimators)
+// as three serial in-order stages working concurrently on consecutive layers, thus the output is identical
+// to the serial export. Ahead of the G-code generation, prepare_layer() calculates the parts of the layers, which
+// do not depend on the state of the G-code generator (the distance fields for the seam placement, the islands
+// for the avoid crossing perimeters), in parallel for several layers.
+// Thread safety: The G-code generation and the cooling buffer share m_writer. The cooling buffer reads
+// m_writer.extruders() and calls m_writer.set_fan(), which updates the last fan speed stored inside m_writer.
+// The extruders are only modified by the set_extruder() / toolchange() calls, which do not reallocate the vector
+// of extruders during the export. The last fan speed is not accessed by the G-code generation, which emits
+// the fan commands exclusively through the cooling buffer markers. The other post-processing filters only read
+// the parts of the GCode state, which are not modified while generating the layers (the cooling and fan related
+// part of m_config, the G-code flavor).
+void GCode::_process_layers(size_t num_layers, 
+    const std::function<PreparedLayer(size_t)> &prepare_layer, const std::function<LayerResult(size_t, PreparedLayer&)> &generate_layer, GCodeOutputStream &file)
+{
+    auto write_layer = [this, &file](const LayerResult &layer) {
+        if (layer.nop_layer_result)
+            return;
+        _write(file, layer.gcode);
+        BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.layer_id <<
+            ", time estimator memory: " <<
+                format_memsize_MB(m_normal_time_estimator.memory_used() + (m_silent_time_estimator_enabled ? m_silent_time_estimator.memory_used() : 0)) <<
+            ", analyzer memory: " <<
+                format_memsize_MB(m_analyzer.memory_used());
+    };
+
+    if (m_pipelined_export && num_layers > 1) {
+        // Layer index and the prepared data, passed as a shared pointer, as the pipeline tokens have to be copyable.
+        struct LayerToken {
+            size_t        layer_idx;
+            PreparedLayer prepared;
+        };
+        typedef std::shared_ptr<LayerToken> LayerTokenPtr;
+        size_t layer_to_generate = 0;
+        // Allow the G-code generation to run a few layers ahead of the post-processing and output.
+        // Each token holds a single prepared layer or the G-code of a single layer, thus the memory is bounded.
+        const size_t max_tokens = 8;
+        tbb::parallel_pipeline(max_tokens,
+            tbb::make_filter<void, LayerTokenPtr>(tbb::filter::serial_in_order,
+                [&layer_to_generate, num_layers](tbb::flow_control &fc) -> LayerTokenPtr {
+                    if (layer_to_generate == num_layers) {
+                        fc.stop();
+                        return LayerTokenPtr();
+                    }
+                    LayerTokenPtr token = std::make_shared<LayerToken>();
+                    token->layer_idx = layer_to_generate ++;
+                    return token;
+                }) &
+            tbb::make_filter<LayerTokenPtr, LayerTokenPtr>(tbb::filter::parallel,
+                [&prepare_layer](LayerTokenPtr token) -> LayerTokenPtr {
+                    token->prepared = prepare_layer(token->layer_idx);
+                    return token;
+                }) &
+            tbb::make_filter<LayerTokenPtr, LayerResult>(tbb::filter::serial_in_order,
+                [&generate_layer](LayerTokenPtr token) -> LayerResult { return generate_layer(token->layer_idx, token->prepared); }) &
+            tbb::make_filter<LayerResult, LayerResult>(tbb::filter::serial_in_order,
+                [this](LayerResult in) -> LayerResult { return this->_postprocess_layer(std::move(in)); }) &
+            tbb::make_filter<LayerResult, void>(tbb::filter::serial_in_order,
+                [&write_layer](LayerResult in) { write_layer(in); }));
+    } else {
+        for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx) {
+            PreparedLayer prepared = prepare_layer(layer_idx);
+            write_layer(this->_postprocess_layer(generate_layer(layer_idx, prepared)));
+        }
+    }
+}
+
+GCode::LayerResult GCode::_postprocess_layer(LayerResult &&layer)
+{
+    if (layer.nop_layer_result)
+        return std::move(layer);
+
     // Apply spiral vase post-processing if this layer contains suitable geometry
     // (we must feed all the G-code into the post-processor, including the first 
     // bottom non-spiral layers otherwise it will mess with positions)
     // we apply spiral vase at this stage because it requires a full layer.
     // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
-    if (m_spiral_vase)
-        gcode = m_spiral_vase->process_layer(gcode);
+    if (m_spiral_vase) {
+        m_spiral_vase->enable = layer.spiral_vase_enable;
+        layer.gcode = m_spiral_vase->process_layer(layer.gcode);
+    }
 
     // Apply cooling logic; this may alter speeds.
     if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(gcode, layer.id());
+        layer.gcode = m_cooling_buffer->process_layer(layer.gcode, layer.layer_id);
 
 #ifdef HAS_PRESSURE_EQUALIZER
     // Apply pressure equalization if enabled;
     // printf("G-code before filter:\n%s\n", gcode.c_str());
     if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
+        layer.gcode = m_pressure_equalizer->process(layer.gcode.c_str(), false);
     // printf("G-code after filter:\n%s\n", out.c_str());
 #endif /* HAS_PRESSURE_EQUALIZER */
-    
-    _write(file, gcode);
-    BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z << 
-        ", time estimator memory: " <<
-            format_memsize_MB(m_normal_time_estimator.memory_used() + m_silent_time_estimator_enabled ? m_silent_time_estimator.memory_used() : 0) <<
-        ", analyzer memory: " <<
-            format_memsize_MB(m_analyzer.memory_used());
+
+    return std::move(layer);
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
@@ -2135,18 +2382,16 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
             // Use the edge grid distance field structure over the lower layer to calculate overhangs.
             coord_t nozzle_r = coord_t(floor(scale_(0.5 * nozzle_dmr) + 0.5));
             coord_t search_r = coord_t(floor(scale_(0.8 * nozzle_dmr) + 0.5));
-            for (size_t i = 0; i < polygon.points.size(); ++ i) {
-                const Point &p = polygon.points[i];
-                coordf_t dist;
-                // Signed distance is positive outside the object, negative inside the object.
-                // The point is considered at an overhang, if it is more than nozzle radius
-                // outside of the lower layer contour.
-                bool found = (*lower_layer_edge_grid)->signed_distance(p, search_r, dist);
-                // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
-                // then the signed distnace shall always be known.
-                assert(found);
-                penalties[i] += extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dist));
-            }
+            // Signed distance is positive outside the object, negative inside the object.
+            // The point is considered at an overhang, if it is more than nozzle radius
+            // outside of the lower layer contour.
+            std::vector<coordf_t> dists;
+            bool found = (*lower_layer_edge_grid)->signed_distances(polygon.points, search_r, dists);
+            // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
+            // then the signed distnace shall always be known.
+            assert(found);
+            for (size_t i = 0; i < polygon.points.size(); ++ i)
+                penalties[i] += extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dists[i]));
         }
 
         // Find a point with a minimum penalty.
@@ -2389,56 +2634,95 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
     return gcode;
 }
 
-void GCode::_write(FILE* file, const char *what)
+void GCode::_write(GCodeOutputStream &file, const char *what, size_t len)
 {
-    if (what != nullptr) {
-        // apply analyzer, if enabled
-        const char* gcode = m_enable_analyzer ? m_analyzer.process_gcode(what).c_str() : what;
+    assert(what[len] == 0);
+    if (len > 0) {
+        // Parse the G-code just once and pass the parsed lines to the analyzer and to the time estimators.
+        // The time estimators ignore the analyzer workcodes, which are comments, therefore they may be fed
+        // with the lines before the analyzer removes the workcodes.
+        if (m_enable_analyzer)
+            m_analyzer.clear_process_output();
+        auto process_line = [this](GCodeReader&, const GCodeReader::GCodeLine &line) {
+            if (m_enable_analyzer)
+                m_analyzer.process_gcode_line(line);
+            m_normal_time_estimator.add_gcode_line(line);
+            if (m_silent_time_estimator_enabled)
+                m_silent_time_estimator.add_gcode_line(line);
+        };
+        GCodeReader::GCodeLine gline;
+        // Start of the block not yet written to file.
+        const char *written = what;
+        for (const char *ptr = what; *ptr != 0;) {
+            gline.reset();
+            ptr = m_output_parser.parse_line(ptr, gline, process_line);
+            if (m_normal_time_estimator.remaining_time_placeholder_requested() ||
+                (m_silent_time_estimator_enabled && m_silent_time_estimator.remaining_time_placeholder_requested())) {
+                // The M73 placeholder follows the line just processed.
+                if (m_enable_analyzer) {
+                    file.write(m_analyzer.process_output());
+                    m_analyzer.clear_process_output();
+                } else
+                    file.write(written, ptr - written);
+                written = ptr;
+                _write_remaining_time_placeholders(file);
+            }
+        }
 
-        // writes string to file
-        fwrite(gcode, 1, ::strlen(gcode), file);
-        // updates time estimator and gcode lines vector
-        m_normal_time_estimator.add_gcode_block(gcode);
-        if (m_silent_time_estimator_enabled)
-            m_silent_time_estimator.add_gcode_block(gcode);
+        // writes string to file, with the analyzer workcodes removed if the analyzer is enabled
+        if (m_enable_analyzer)
+            file.write(m_analyzer.process_output());
+        else
+            file.write(written, what + len - written);
     }
 }
 
-void GCode::_writeln(FILE* file, const std::string &what)
+void GCode::_write_remaining_time_placeholders(GCodeOutputStream &file)
+{
+    if (m_normal_time_estimator.remaining_time_placeholder_requested())
+        file.write(m_normal_time_estimator.get_remaining_time_placeholder(file.position()));
+    if (m_silent_time_estimator_enabled && m_silent_time_estimator.remaining_time_placeholder_requested())
+        file.write(m_silent_time_estimator.get_remaining_time_placeholder(file.position()));
+}
+
+void GCode::_writeln(GCodeOutputStream &file, const std::string &what)
 {
     if (! what.empty())
         _write(file, (what.back() == '\n') ? what : (what + '\n'));
 }
 
-void GCode::_write_format(FILE* file, const char* format, ...)
+void GCode::_write_format(GCodeOutputStream &file, const char* format, ...)
 {
     va_list args;
     va_start(args, format);
+    // The first vsnprintf() consumes args, keep untouched copies for measuring and formatting a long line.
+    va_list args2;
+    va_copy(args2, args);
+    va_list args3;
+    va_copy(args3, args);
 
-    int buflen;
-    {
-        va_list args2;
-        va_copy(args2, args);
-        buflen =
+    // Format into a stack buffer first, only the rare long lines are formatted twice.
+    char buffer[1024];
+    int  res = ::vsnprintf(buffer, sizeof(buffer), format, args);
+    if (res >= 0 && res < int(sizeof(buffer))) {
+        _write(file, buffer, size_t(res));
+    } else {
+        int buflen =
     #ifdef _MSC_VER
-            ::_vscprintf(format, args2)
-    #else
-            ::vsnprintf(nullptr, 0, format, args2)
+            // Older MSVC runtimes return -1 instead of the length of the formatted string.
+            (res < 0) ? ::_vscprintf(format, args2) :
     #endif
-            + 1;
-        va_end(args2);
+            res;
+        std::string str(size_t(buflen) + 1, 0);
+        res = ::vsnprintf(&str[0], str.size(), format, args3);
+        if (res > 0) {
+            str.resize(res);
+            _write(file, str);
+        }
     }
 
-    char buffer[1024];
-    bool buffer_dynamic = buflen > 1024;
-    char *bufptr = buffer_dynamic ? (char*)malloc(buflen) : buffer;
-    int res = ::vsnprintf(bufptr, buflen, format, args);
-    if (res > 0)
-        _write(file, bufptr);
-
-    if (buffer_dynamic)
-        free(bufptr);
-
+    va_end(args3);
+    va_end(args2);
     va_end(args);
 }
 
@@ -18,6 +18,7 @@
 #include "EdgeGrid.hpp"
 #include "GCode/Analyzer.hpp"
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -42,17 +43,29 @@ public:
     // we enable it by default for the first travel move in print
     bool disable_once;
     
-    AvoidCrossingPerimeters() : use_external_mp(false), use_external_mp_once(false), disable_once(true) {}
+    AvoidCrossingPerimeters() : use_external_mp(false), use_external_mp_once(false), disable_once(true), m_layer_mp(nullptr) {}
     ~AvoidCrossingPerimeters() {}
 
     void init_external_mp(const ExPolygons &islands) { m_external_mp = Slic3r::make_unique<MotionPlanner>(islands); }
-    void init_layer_mp(const ExPolygons &islands) { m_layer_mp = Slic3r::make_unique<MotionPlanner>(islands); }
+    // Reuses the motion planner of recently seen identical islands, see m_layer_mps.
+    void init_layer_mp(const ExPolygons &islands);
 
     Polyline travel_to(const GCode &gcodegen, const Point &point);
 
 private:
     std::unique_ptr<MotionPlanner> m_external_mp;
-    std::unique_ptr<MotionPlanner> m_layer_mp;
+    // Motion planner of the active layer, owned by m_layer_mps.
+    MotionPlanner                 *m_layer_mp;
+
+    // Motion planners of the islands of the most recently printed layers, the most recently used last.
+    // Consecutive layers of an object (and the layers of the copies of an object) often have the same islands,
+    // then the motion planner including its lazily built graphs and memoized paths is reused.
+    struct LayerMotionPlanner {
+        size_t                         islands_hash;
+        ExPolygons                     islands;
+        std::unique_ptr<MotionPlanner> planner;
+    };
+    std::vector<LayerMotionPlanner> m_layer_mps;
 };
 
 class OozePrevention {
@@ -126,6 +139,47 @@ private:
     bool                                                         i_have_brim = false;
 };
 
+// Output of the G-code export. The G-code is emitted in many short pieces, which are collected
+// into a large buffer and handed over to fwrite() in large blocks.
+// The FILE is owned by the caller, the buffer has to be flushed explicitly before the FILE is closed.
+class GCodeOutputStream {
+public:
+    GCodeOutputStream(FILE *file, size_t buffer_size = 4 * 1024 * 1024) : m_file(file), m_position(0) { m_buffer.reserve(buffer_size); }
+
+    void write(const char *data, size_t len) {
+        m_position += len;
+        if (m_buffer.size() + len > m_buffer.capacity()) {
+            this->flush();
+            if (len >= m_buffer.capacity()) {
+                // Don't copy a block larger than the buffer.
+                ::fwrite(data, 1, len, m_file);
+                return;
+            }
+        }
+        m_buffer.append(data, len);
+    }
+    void write(const std::string &data) { this->write(data.data(), data.size()); }
+    // Write a formatted string bypassing the G-code analyzer and the time estimators.
+    void write_format(const char *format, ...);
+    void flush() {
+        if (! m_buffer.empty()) {
+            ::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+            m_buffer.clear();
+        }
+    }
+    FILE* file() const { return m_file; }
+    // Number of bytes written so far, including the bytes still buffered.
+    size_t position() const { return m_position; }
+
+private:
+    GCodeOutputStream(const GCodeOutputStream&) = delete;
+    GCodeOutputStream& operator=(const GCodeOutputStream&) = delete;
+
+    FILE        *m_file;
+    std::string  m_buffer;
+    size_t       m_position;
+};
+
 class GCode {
 public:        
     GCode() : 
@@ -146,6 +200,8 @@ public:
         m_last_height(GCodeAnalyzer::Default_Height),
         m_brim_done(false),
         m_second_layer_things_done(false),
+        m_spiral_vase_enabled(false),
+        m_pipelined_export(true),
         m_normal_time_estimator(GCodeTimeEstimator::Normal),
         m_silent_time_estimator(GCodeTimeEstimator::Silent),
         m_silent_time_estimator_enabled(false),
@@ -182,8 +238,14 @@ public:
     // append full config to the given string
     static void append_full_config(const Print& print, std::string& str);
 
+    // If enabled (the default), the layers are generated and post-processed by the spiral vase, cooling buffer
+    // and pressure equalizer filters concurrently, each stage processing the layers in order.
+    // Otherwise all the layers are processed one after the other. Both modes produce the same G-code.
+    void            set_pipelined_export(bool enable) { m_pipelined_export = enable; }
+    bool            pipelined_export() const { return m_pipelined_export; }
+
 protected:
-    void            _do_export(Print &print, FILE *file);
+    void            _do_export(Print &print, GCodeOutputStream &file);
 
     // Object and support extrusions of the same PrintObject at the same print_z.
     struct LayerToPrint
@@ -197,16 +259,54 @@ protected:
     };
     static std::vector<GCode::LayerToPrint>                            collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
-    void            process_layer(
-        // Write into the output file.
-        FILE                            *file,
+    // G-code of a single layer produced by process_layer(), to be post-processed and written into the output file.
+    struct LayerResult {
+        std::string gcode;
+        size_t      layer_id;
+        // Is spiral vase post-processing enabled for this layer?
+        bool        spiral_vase_enable;
+        // process_layer() has not produced anything, nothing to post-process.
+        bool        nop_layer_result;
+        static LayerResult make_nop_layer_result() { return { "", size_t(-1), false, true }; }
+    };
+    // Data of a set of layers to be printed at the same print_z, which does not depend on the state of the G-code generator.
+    // It is calculated by prepare_layer() in parallel for several layers ahead of process_layer().
+    struct PreparedLayer {
+        // Distance fields over the lower layers for the seam placement, one per LayerToPrint, see extrude_loop().
+        std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids;
+        // Islands of the layers for the avoid crossing perimeters motion planner, one per LayerToPrint.
+        std::vector<ExPolygons>                      islands;
+    };
+    PreparedLayer   prepare_layer(const Print &print, const std::vector<LayerToPrint> &layers) const;
+    LayerResult     process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
         const LayerTools  &layer_tools,
         // If set to size_t(-1), then print all copies of all objects.
         // Otherwise print a single copy of a single object.
-        const size_t                     single_object_idx = size_t(-1));
+        const size_t                     single_object_idx = size_t(-1),
+        // Result of prepare_layer() for these layers, or nullptr to calculate the data lazily.
+        PreparedLayer                   *prepared = nullptr);
+    // Generate and export all layers of a single object copy (sequential print, complete_objects).
+    void            process_layers(
+        const Print                             &print,
+        const ToolOrdering                      &tool_ordering,
+        const std::vector<LayerToPrint>         &layers_to_print,
+        const size_t                             single_object_idx,
+        GCodeOutputStream                       &file);
+    // Generate and export all layers of all objects and their copies, ordered by print_z.
+    void            process_layers(
+        const Print                                                         &print,
+        const ToolOrdering                                                  &tool_ordering,
+        const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+        GCodeOutputStream                                                   &file);
+    // Run the layer G-code produced by generate_layer() through the post-processing filters into the output file,
+    // either serially or as a pipeline, see set_pipelined_export(). The layers are prepared by prepare_layer() first.
+    void            _process_layers(size_t num_layers, 
+        const std::function<PreparedLayer(size_t)> &prepare_layer, const std::function<LayerResult(size_t, PreparedLayer&)> &generate_layer, GCodeOutputStream &file);
+    // Spiral vase, cooling buffer and pressure equalizer filters.
+    LayerResult     _postprocess_layer(LayerResult &&layer);
 
     void            set_last_pos(const Point &pos) { m_last_pos = pos; m_last_pos_defined = true; }
     bool            last_pos_defined() const { return m_last_pos_defined; }
@@ -320,6 +420,11 @@ protected:
     bool                                m_brim_done;
     // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
     bool                                m_second_layer_things_done;
+    // Spiral vase enabled for the last layer generated by process_layer().
+    // Tracked separately from m_spiral_vase->enable, which belongs to the post-processing stage.
+    bool                                m_spiral_vase_enabled;
+    // Generate and post-process the layers in a pipeline, see set_pipelined_export().
+    bool                                m_pipelined_export;
     // Index of a last object copy extruded.
     std::pair<const PrintObject*, Point> m_last_obj_copy;
     // Layer heights for colorprint - updated before the export and erased during the process
@@ -334,22 +439,30 @@ protected:
     // Analyzer
     GCodeAnalyzer m_analyzer;
 
+    // Parses the G-code written into the output file just once for both the analyzer and the time estimators.
+    GCodeReader m_output_parser;
+
     // Write a string into a file.
-    void _write(FILE* file, const std::string& what) { this->_write(file, what.c_str()); }
-    void _write(FILE* file, const char *what);
+    void _write(GCodeOutputStream &file, const std::string& what) { this->_write(file, what.c_str(), what.size()); }
+    void _write(GCodeOutputStream &file, const char *what) { if (what != nullptr) this->_write(file, what, ::strlen(what)); }
+    // what has to be zero terminated at what[len].
+    void _write(GCodeOutputStream &file, const char *what, size_t len);
 
     // Write a string into a file. 
     // Add a newline, if the string does not end with a newline already.
     // Used to export a custom G-code section processed by the PlaceholderParser.
-    void _writeln(FILE* file, const std::string& what);
+    void _writeln(GCodeOutputStream &file, const std::string& what);
 
     // Formats and write into a file the given data. 
-    void _write_format(FILE* file, const char* format, ...);
+    void _write_format(GCodeOutputStream &file, const char* format, ...);
+
+    // Writes the M73 placeholders requested by the time estimators, see GCodeTimeEstimator::set_streaming().
+    void _write_remaining_time_placeholders(GCodeOutputStream &file);
 
     std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
-    void print_machine_envelope(FILE *file, Print &print);
-    void _print_first_layer_bed_temperature(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
-    void _print_first_layer_extruder_temperatures(FILE *file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    void print_machine_envelope(GCodeOutputStream &file, Print &print);
+    void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
+    void _print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
     // this flag triggers first layer speeds
     bool                                on_first_layer() const { return m_layer != nullptr && m_layer->id() == 0; }
 
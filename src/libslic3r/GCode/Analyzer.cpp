@@ -128,7 +128,7 @@ void GCodeAnalyzer::reset()
 
 const std::string& GCodeAnalyzer::process_gcode(const std::string& gcode)
 {
-    m_process_output = "";
+    m_process_output.clear();
 
     m_parser.parse_buffer(gcode,
         [this](GCodeReader& reader, const GCodeReader::GCodeLine& line)
@@ -262,7 +262,8 @@ void GCodeAnalyzer::_process_gcode_line(GCodeReader&, const GCodeReader::GCodeLi
     }
 
     // puts the line back into the gcode
-    m_process_output += line.raw() + "\n";
+    m_process_output += line.raw();
+    m_process_output += '\n';
 }
 
 // Returns the new absolute position on the given axis in dependence of the given parameters
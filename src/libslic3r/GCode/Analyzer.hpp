@@ -121,6 +121,12 @@ public:
     // Adds the gcode contained in the given string to the analysis and returns it after removing the workcodes
     const std::string& process_gcode(const std::string& gcode);
 
+    // Adds a single gcode line already parsed by the caller to the analysis.
+    // The line is appended to process_output() unless it is a workcode.
+    void process_gcode_line(const GCodeReader::GCodeLine& line) { this->_process_gcode_line(m_parser, line); }
+    const std::string& process_output() const { return m_process_output; }
+    void clear_process_output() { m_process_output.clear(); }
+
     // Calculates all data needed for gcode visualization
     // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
     void calc_gcode_preview_data(GCodePreviewData& preview_data, std::function<void()> cancel_callback = std::function<void()>());
@@ -126,7 +126,7 @@ public:
 	// Find LayerTools with the closest print_z.
 	LayerTools&			tools_for_layer(coordf_t print_z);
 	const LayerTools&	tools_for_layer(coordf_t print_z) const 
-		{ return *const_cast<const LayerTools*>(&const_cast<const ToolOrdering*>(this)->tools_for_layer(print_z)); }
+		{ return *const_cast<const LayerTools*>(&const_cast<ToolOrdering*>(this)->tools_for_layer(print_z)); }
 
 	const LayerTools&   front()       const { return m_layer_tools.front(); }
 	const LayerTools&   back()        const { return m_layer_tools.back(); }
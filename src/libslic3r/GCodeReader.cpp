@@ -5,10 +5,39 @@
 #include <iostream>
 #include <iomanip>
 
+#include <boost/nowide/cstdio.hpp>
+
 #include <Shiny/Shiny.h>
 
 namespace Slic3r {
 
+// Fast path of strtod() for the plain decimal numbers produced by the G-code generators, for example "-12.345".
+// If the mantissa has at most 15 digits, both the mantissa and the power of ten are represented exactly
+// by a double and the single division rounds correctly, therefore the result is the same as of strtod().
+// Anything else (exponents, hexadecimal numbers, inf / nan, leading white spaces, long numbers) is passed to strtod().
+// Contrary to strtod(), the fast path does not depend on the C locale.
+static inline double parse_float(const char *str, char **pend)
+{
+    static const double pow_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    const char *c        = str;
+    bool        negative = *c == '-';
+    if (negative || *c == '+')
+        ++ c;
+    uint64_t mantissa    = 0;
+    int      num_digits  = 0;
+    int      frac_digits = 0;
+    for (; *c >= '0' && *c <= '9'; ++ c, ++ num_digits)
+        mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (*c == '.')
+        for (++ c; *c >= '0' && *c <= '9'; ++ c, ++ num_digits, ++ frac_digits)
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+    if (num_digits == 0 || num_digits > 15 || ! (*c == ' ' || *c == '\t' || *c == ';' || *c == '\r' || *c == '\n' || *c == 0))
+        return strtod(str, pend);
+    *pend = const_cast<char*>(c);
+    double v = double(mantissa) / pow_10[frac_digits];
+    return negative ? - v : v;
+}
+
 void GCodeReader::apply_config(const GCodeConfig &config)
 {
     m_config = config;
@@ -54,7 +83,7 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
             if (axis != NUM_AXES) {
                 // Try to parse the numeric value.
                 char   *pend = nullptr;
-                double  v = strtod(++ c, &pend);
+                double  v = parse_float(++ c, &pend);
                 if (pend != nullptr && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     gline.m_axis[int(axis)] = float(v);
@@ -109,10 +138,44 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 
 void GCodeReader::parse_file(const std::string &file, callback_t callback)
 {
-    std::ifstream f(file);
-    std::string line;
-    while (std::getline(f, line))
-        this->parse_line(line, callback);
+    FILE *f = boost::nowide::fopen(file.c_str(), "rb");
+    if (f == nullptr)
+        return;
+
+    // Read the file in large blocks, parse the complete lines of each block in place.
+    // The incomplete line at the end of a block is moved to the start of the buffer and completed by the next block.
+    std::vector<char> buffer(4 * 1024 * 1024 + 1);
+    size_t            buffer_used = 0;
+    GCodeLine         gline;
+    for (;;) {
+        size_t num_read = ::fread(buffer.data() + buffer_used, 1, buffer.size() - 1 - buffer_used, f);
+        bool   eof      = num_read == 0;
+        buffer_used += num_read;
+        char  *begin    = buffer.data();
+        char  *end      = begin + buffer_used;
+        // Past the last complete line.
+        char  *last     = end;
+        if (! eof) {
+            for (; last > begin && last[-1] != '\n'; -- last) ;
+            if (last == begin) {
+                // A line longer than the buffer.
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+        }
+        char saved = *last;
+        *last = 0;
+        for (const char *ptr = begin; *ptr != 0;) {
+            gline.reset();
+            ptr = this->parse_line(ptr, gline, callback);
+        }
+        *last = saved;
+        if (eof)
+            break;
+        buffer_used = end - last;
+        memmove(begin, last, buffer_used);
+    }
+    fclose(f);
 }
 
 bool GCodeReader::GCodeLine::has(char axis) const
@@ -154,7 +217,7 @@ bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
         if (*c == axis) {
             // Try to parse the numeric value.
             char   *pend = nullptr;
-            double  v = strtod(++ c, &pend);
+            double  v = parse_float(++ c, &pend);
             if (pend != nullptr && is_end_of_word(*pend)) {
                 // The axis value has been parsed correctly.
                 value = float(v);
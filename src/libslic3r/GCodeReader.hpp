@@ -90,7 +90,7 @@ public:
         { this->parse_buffer(buffer, [](GCodeReader&, const GCodeReader::GCodeLine&){}); }
 
     template<typename Callback>
-    const char* parse_line(const char *ptr, GCodeLine &gline, Callback &callback)
+    const char* parse_line(const char *ptr, GCodeLine &gline, Callback &&callback)
     {
         std::pair<const char*, const char*> cmd;
         const char *end = parse_line_internal(ptr, gline, cmd);
@@ -168,13 +168,11 @@ namespace Slic3r {
     }
 #endif // ENABLE_MOVE_STATS
 
-    const std::string GCodeTimeEstimator::Normal_First_M73_Output_Placeholder_Tag = "; NORMAL_FIRST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Silent_First_M73_Output_Placeholder_Tag = "; SILENT_FIRST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Normal_Last_M73_Output_Placeholder_Tag = "; NORMAL_LAST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Silent_Last_M73_Output_Placeholder_Tag = "; SILENT_LAST_M73_OUTPUT_PLACEHOLDER";
 
     GCodeTimeEstimator::GCodeTimeEstimator(EMode mode)
         : _mode(mode)
+        , _streaming_window_size(0)
+        , _remaining_times_interval(0.0f)
     {
         reset();
         set_default();
@@ -205,6 +203,8 @@ namespace Slic3r {
         PROFILE_FUNC();
         if (start_from_beginning)
         {
+            // The retired blocks are not available anymore in the streaming mode.
+            assert(!is_streaming());
             _reset_time();
             _last_st_synchronized_block_id = -1;
         }
@@ -257,130 +257,78 @@ namespace Slic3r {
 #endif // ENABLE_MOVE_STATS
     }
 
-    bool GCodeTimeEstimator::post_process_remaining_times(const std::string& filename, float interval)
+    void GCodeTimeEstimator::set_streaming(size_t window_size, float remaining_times_interval_sec)
     {
-        boost::nowide::ifstream in(filename);
-        if (!in.good())
-            throw std::runtime_error(std::string("Remaining times export failed.\nCannot open file for reading.\n"));
-
-        std::string path_tmp = filename + ".times";
-
-        FILE* out = boost::nowide::fopen(path_tmp.c_str(), "wb");
-        if (out == nullptr)
-            throw std::runtime_error(std::string("Remaining times export failed.\nCannot open file for writing.\n"));
-
-        std::string time_mask;
-        switch (_mode)
-        {
-        default:
-        case Normal:
-        {
-            time_mask = "M73 P%s R%s\n";
-            break;
-        }
-        case Silent:
-        {
-            time_mask = "M73 Q%s S%s\n";
-            break;
-        }
-        }
-
-        unsigned int g1_lines_count = 0;
-        float last_recorded_time = 0.0f;
-        std::string gcode_line;
-        // buffer line to export only when greater than 64K to reduce writing calls
-        std::string export_line;
-        char time_line[64];
-		G1LineIdToBlockIdMap::const_iterator it_line_id = _g1_line_ids.begin();
-		while (std::getline(in, gcode_line))
-        {
-            if (!in.good())
-            {
-                fclose(out);
-                throw std::runtime_error(std::string("Remaining times export failed.\nError while reading from file.\n"));
-            }
-
-            // replaces placeholders for initial line M73 with the real lines
-            if (((_mode == Normal) && (gcode_line == Normal_First_M73_Output_Placeholder_Tag)) ||
-                ((_mode == Silent) && (gcode_line == Silent_First_M73_Output_Placeholder_Tag)))
-            {
-                sprintf(time_line, time_mask.c_str(), "0", _get_time_minutes(_time).c_str());
-                gcode_line = time_line;
-            }
-            // replaces placeholders for final line M73 with the real lines
-            else if (((_mode == Normal) && (gcode_line == Normal_Last_M73_Output_Placeholder_Tag)) ||
-                     ((_mode == Silent) && (gcode_line == Silent_Last_M73_Output_Placeholder_Tag)))
-            {
-                sprintf(time_line, time_mask.c_str(), "100", "0");
-                gcode_line = time_line;
-            }
-            else
-               gcode_line += "\n";
-
+        // At least a couple of blocks have to stay in the window to plan the junctions.
+        _streaming_window_size = (window_size == 0) ? 0 : std::max<size_t>(window_size, 4);
+        _remaining_times_interval = (window_size == 0) ? 0.0f : remaining_times_interval_sec;
+    }
 
-            // add remaining time lines where needed
-            _parser.parse_line(gcode_line,
-                [this, &it_line_id, &g1_lines_count, &last_recorded_time, &time_line, &gcode_line, time_mask, interval](GCodeReader& reader, const GCodeReader::GCodeLine& line)
-            {
-                if (line.cmd_is("G1"))
-                {
-                    ++g1_lines_count;
+    const std::string& GCodeTimeEstimator::get_remaining_time_placeholder(size_t file_offset)
+    {
+        assert(is_streaming() && !_blocks.empty());
+        RemainingTimeMarker marker;
+        marker.file_offset = file_offset;
+        marker.block_id = _num_retired_blocks + _blocks.size() - 1;
+        // The last block may have been retired already by a st_synchronize().
+        marker.elapsed_time = ((int)_blocks.size() - 1 <= _last_st_synchronized_block_id) ? _blocks.back().elapsed_time : -1.0f;
+        if (marker.elapsed_time != -1.0f && _first_unresolved_marker == _remaining_time_markers.size())
+            ++_first_unresolved_marker;
+        _remaining_time_markers.emplace_back(marker);
+        _remaining_time_requested = false;
+        _remaining_time_placeholder = _get_remaining_time_line(0.0f);
+        return _remaining_time_placeholder;
+    }
 
-					assert(it_line_id == _g1_line_ids.end() || it_line_id->first >= g1_lines_count);
+    const std::string& GCodeTimeEstimator::get_first_remaining_time_placeholder(size_t file_offset)
+    {
+        assert(is_streaming() && _remaining_time_markers.empty());
+        RemainingTimeMarker marker;
+        marker.file_offset = file_offset;
+        marker.block_id = 0;
+        marker.elapsed_time = 0.0f;
+        _remaining_time_markers.emplace_back(marker);
+        ++_first_unresolved_marker;
+        _remaining_time_placeholder = _get_remaining_time_line(0.0f);
+        return _remaining_time_placeholder;
+    }
 
-					const Block *block = nullptr;
-					if (it_line_id != _g1_line_ids.end() && it_line_id->first == g1_lines_count) {
-						if (line.has_e() && it_line_id->second < (unsigned int)_blocks.size())
-							block = &_blocks[it_line_id->second];
-						++it_line_id;
-					}
+    std::string GCodeTimeEstimator::get_last_remaining_time_line() const
+    {
+        return (_mode == Silent) ? "M73 Q100 S0\n" : "M73 P100 R0\n";
+    }
 
-					if (block != nullptr && block->elapsed_time != -1.0f) {
-                        float block_remaining_time = _time - block->elapsed_time;
-                        if (std::abs(last_recorded_time - block_remaining_time) > interval)
-                        {
-                            sprintf(time_line, time_mask.c_str(), std::to_string((int)(100.0f * block->elapsed_time / _time)).c_str(), _get_time_minutes(block_remaining_time).c_str());
-                            gcode_line += time_line;
+    static int seek_file(FILE *file, size_t offset)
+    {
+#ifdef _WIN32
+        return ::_fseeki64(file, (__int64)offset, SEEK_SET);
+#else
+        return ::fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+    }
 
-                            last_recorded_time = block_remaining_time;
-                        }
-                    }
-                }
-            });
+    bool GCodeTimeEstimator::patch_remaining_times(const std::string& filename)
+    {
+        assert(_first_unresolved_marker == _remaining_time_markers.size());
+        if (_remaining_time_markers.empty())
+            return true;
 
-            export_line += gcode_line;
-            if (export_line.length() > 65535)
-            {
-                fwrite((const void*)export_line.c_str(), 1, export_line.length(), out);
-                if (ferror(out))
-                {
-                    in.close();
-                    fclose(out);
-                    boost::nowide::remove(path_tmp.c_str());
-                    throw std::runtime_error(std::string("Remaining times export failed.\nIs the disk full?\n"));
-                }
-                export_line.clear();
-            }
-        }
+        FILE* file = boost::nowide::fopen(filename.c_str(), "r+b");
+        if (file == nullptr)
+            throw std::runtime_error(std::string("Remaining times export failed.\nCannot open file for writing.\n"));
 
-        if (export_line.length() > 0)
+        for (const RemainingTimeMarker& marker : _remaining_time_markers)
         {
-            fwrite((const void*)export_line.c_str(), 1, export_line.length(), out);
-            if (ferror(out))
+            std::string line = _get_remaining_time_line((marker.elapsed_time == -1.0f) ? _time : marker.elapsed_time);
+            if (seek_file(file, marker.file_offset) != 0 || ::fwrite(line.data(), 1, line.size(), file) != line.size())
             {
-                in.close();
-                fclose(out);
-                boost::nowide::remove(path_tmp.c_str());
-                throw std::runtime_error(std::string("Remaining times export failed.\nIs the disk full?\n"));
+                fclose(file);
+                throw std::runtime_error(std::string("Remaining times export failed.\nError while writing to file.\n"));
             }
         }
 
-        fclose(out);
-        in.close();
-
-        if (rename_file(path_tmp, filename) != 0)
-            throw std::runtime_error(std::string("Failed to rename the output G-code file from ") + path_tmp + " to " + filename + '\n' +
-            "Is " + path_tmp + " locked?" + '\n');
+        if (fclose(file) != 0)
+            throw std::runtime_error(std::string("Remaining times export failed.\nIs the disk full?\n"));
 
         return true;
     }
@@ -575,21 +523,6 @@ namespace Slic3r {
         return _state.e_local_positioning_type;
     }
 
-    int GCodeTimeEstimator::get_g1_line_id() const
-    {
-        return _state.g1_line_id;
-    }
-
-    void GCodeTimeEstimator::increment_g1_line_id()
-    {
-        ++_state.g1_line_id;
-    }
-
-    void GCodeTimeEstimator::reset_g1_line_id()
-    {
-        _state.g1_line_id = 0;
-    }
-
     void GCodeTimeEstimator::set_extruder_id(unsigned int id)
     {
         _state.extruder_id = id;
@@ -682,7 +615,7 @@ namespace Slic3r {
     {
         size_t out = sizeof(*this);
 		out += SLIC3R_STDVEC_MEMSIZE(this->_blocks, Block);
-		out += SLIC3R_STDVEC_MEMSIZE(this->_g1_line_ids, G1LineIdToBlockId);
+		out += SLIC3R_STDVEC_MEMSIZE(this->_remaining_time_markers, RemainingTimeMarker);
         return out;
     }
 
@@ -700,10 +633,13 @@ namespace Slic3r {
         set_additional_time(0.0f);
 
         reset_extruder_id();
-        reset_g1_line_id();
-        _g1_line_ids.clear();
 
         _last_st_synchronized_block_id = -1;
+
+        _last_remaining_time_request = -1.0f;
+        _remaining_time_requested = false;
+        _remaining_time_markers.clear();
+        _first_unresolved_marker = 0;
     }
 
     void GCodeTimeEstimator::_reset_time()
@@ -714,6 +650,7 @@ namespace Slic3r {
     void GCodeTimeEstimator::_reset_blocks()
     {
         _blocks.clear();
+        _num_retired_blocks = 0;
     }
 
     void GCodeTimeEstimator::_calculate_time()
@@ -724,8 +661,23 @@ namespace Slic3r {
         _recalculate_trapezoids();
 
         _time += get_additional_time();
+        _accumulate_time((int)_blocks.size());
 
-        for (int i = _last_st_synchronized_block_id + 1; i < (int)_blocks.size(); ++i)
+        _last_st_synchronized_block_id = (int)_blocks.size() - 1;
+        // The additional time has been consumed (added to the total time), reset it to zero.
+        set_additional_time(0.);
+
+        if (is_streaming() && _blocks.size() > 1)
+        {
+            // Only the last block is needed to calculate the junction speed of the next block.
+            _erase_blocks((int)_blocks.size() - 1);
+            _last_st_synchronized_block_id = 0;
+        }
+    }
+
+    int GCodeTimeEstimator::_accumulate_time(int end_block_id, bool stop_at_request)
+    {
+        for (int i = _last_st_synchronized_block_id + 1; i < end_block_id; ++i)
         {
             Block& block = _blocks[i];
 
@@ -749,11 +701,65 @@ namespace Slic3r {
             _time += block.deceleration_time();
             block.elapsed_time = _time;
 #endif // ENABLE_MOVE_STATS
+
+            if (_remaining_times_interval > 0.0f)
+            {
+                // Request a M73 output for the first extrusion and then each time the interval elapses.
+                if (block.delta_pos[E] != 0.0f && (_last_remaining_time_request == -1.0f || block.elapsed_time - _last_remaining_time_request > _remaining_times_interval))
+                {
+                    _remaining_time_requested = true;
+                    _last_remaining_time_request = block.elapsed_time;
+                    if (stop_at_request)
+                        end_block_id = i + 1;
+                }
+                // Resolve the placeholders written after this block.
+                size_t block_id = _num_retired_blocks + (size_t)i;
+                for (; _first_unresolved_marker < _remaining_time_markers.size() && _remaining_time_markers[_first_unresolved_marker].block_id == block_id; ++_first_unresolved_marker)
+                    _remaining_time_markers[_first_unresolved_marker].elapsed_time = block.elapsed_time;
+            }
         }
+        return end_block_id;
+    }
 
-        _last_st_synchronized_block_id = (int)_blocks.size() - 1;
-        // The additional time has been consumed (added to the total time), reset it to zero.
-        set_additional_time(0.);
+    void GCodeTimeEstimator::_retire_blocks()
+    {
+        PROFILE_FUNC();
+        // Plan the window the same way _calculate_time() plans the blocks following the last st_synchronize().
+        _forward_pass();
+        _reverse_pass();
+        _recalculate_trapezoids();
+        // The last block was planned to stop, it has to be recalculated once the next block is known.
+        _blocks.back().flags.recalculate = true;
+
+        // Retire the older half of the window. Stop at a block requesting a M73 output, otherwise another request
+        // in the same half would be lost, as the caller writes a single placeholder after the current G-code line.
+        // The rest of the half is retired with the next G-code line.
+        int num_retired = _accumulate_time((int)_blocks.size() - (int)_streaming_window_size / 2, true);
+        // The retired blocks are not visible to the forward pass anymore. Don't let the reverse pass raise the entry speed
+        // of the first block left above the exit speed of the last block retired.
+        Block& first = _blocks[num_retired];
+        first.max_entry_speed = std::min(first.max_entry_speed, first.feedrate.entry);
+        _erase_blocks(num_retired);
+        _last_st_synchronized_block_id = -1;
+    }
+
+    void GCodeTimeEstimator::_erase_blocks(int num_blocks)
+    {
+        _blocks.erase(_blocks.begin(), _blocks.begin() + num_blocks);
+        _num_retired_blocks += (size_t)num_blocks;
+    }
+
+    std::string GCodeTimeEstimator::_get_remaining_time_line(float elapsed_time) const
+    {
+        // Fixed length including the new line, so that the line may be overwritten in place by patch_remaining_times().
+        static const size_t length = 24;
+        char buffer[64];
+        int percent = (_time > 0.0f) ? std::min(100, (int)(100.0f * elapsed_time / _time)) : 0;
+        int n = ::sprintf(buffer, (_mode == Silent) ? "M73 Q%d S%s" : "M73 P%d R%s", percent, _get_time_minutes(std::max(0.0f, _time - elapsed_time)).c_str());
+        std::string line(buffer, (size_t)n);
+        line.resize(length - 1, ' ');
+        line += '\n';
+        return line;
     }
 
     void GCodeTimeEstimator::_process_gcode_line(GCodeReader&, const GCodeReader::GCodeLine& line)
@@ -900,7 +906,6 @@ namespace Slic3r {
     void GCodeTimeEstimator::_processG1(const GCodeReader::GCodeLine& line)
     {
         PROFILE_FUNC();
-        increment_g1_line_id();
 
         // updates axes positions from line
         EUnits units = get_units();
@@ -1092,7 +1097,8 @@ namespace Slic3r {
 
         // adds block to blocks list
         _blocks.emplace_back(block);
-        _g1_line_ids.emplace_back(G1LineIdToBlockIdMap::value_type(get_g1_line_id(), (unsigned int)_blocks.size() - 1));
+        if (is_streaming() && (int)_blocks.size() - _last_st_synchronized_block_id - 1 > (int)_streaming_window_size)
+            _retire_blocks();
     }
 
     void GCodeTimeEstimator::_processG4(const GCodeReader::GCodeLine& line)
@@ -17,10 +17,8 @@ namespace Slic3r {
     class GCodeTimeEstimator
     {
     public:
-        static const std::string Normal_First_M73_Output_Placeholder_Tag;
-        static const std::string Silent_First_M73_Output_Placeholder_Tag;
-        static const std::string Normal_Last_M73_Output_Placeholder_Tag;
-        static const std::string Silent_Last_M73_Output_Placeholder_Tag;
+        // Number of blocks kept by the planner in the streaming mode, see set_streaming().
+        static const size_t Default_Streaming_Window_Size = 1024;
 
         enum EMode : unsigned char
         {
@@ -87,7 +85,6 @@ namespace Slic3r {
             // Additional load / unload times for a filament exchange sequence.
             std::vector<float> filament_load_times;
             std::vector<float> filament_unload_times;
-            unsigned int g1_line_id;
             // extruder_id is currently used to correctly calculate filament load / unload times 
             // into the total print time. This is currently only really used by the MK3 MMU2:
             // Extruder id (-1) means no filament is loaded yet, all the filaments are parked in the MK3 MMU2 unit.
@@ -211,8 +208,18 @@ namespace Slic3r {
         typedef std::map<Block::EMoveType, MoveStats> MovesStatsMap;
 #endif // ENABLE_MOVE_STATS
 
-        typedef std::pair<unsigned int, unsigned int> G1LineIdToBlockId;
-        typedef std::vector<G1LineIdToBlockId> G1LineIdToBlockIdMap;
+        // M73 line written in the streaming mode as a fixed width placeholder, filled in by patch_remaining_times().
+        struct RemainingTimeMarker
+        {
+            // Offset of the placeholder in the output file
+            size_t file_offset;
+            // Index of the block preceding the placeholder, counted from the start of the G-code
+            size_t block_id;
+            // Elapsed time at the end of the block, -1 until the block is retired
+            float elapsed_time;
+        };
+
+        typedef std::vector<RemainingTimeMarker> RemainingTimeMarkersList;
 
     private:
         EMode _mode;
@@ -221,12 +228,24 @@ namespace Slic3r {
         Feedrates _curr;
         Feedrates _prev;
         BlocksList _blocks;
-        // Map between g1 line id and blocks id, used to speed up export of remaining times
-        G1LineIdToBlockIdMap _g1_line_ids;
         // Index of the last block already st_synchronized
         int _last_st_synchronized_block_id;
         float _time; // s
 
+        // Streaming mode: size of the look-ahead window of the planner, zero if the streaming mode is disabled
+        size_t _streaming_window_size;
+        // Streaming mode: number of blocks already retired and removed from _blocks
+        size_t _num_retired_blocks;
+        // Streaming mode: interval of the M73 output, zero if disabled
+        float _remaining_times_interval; // s
+        // Streaming mode: elapsed time of the last retired block, which requested a M73 output
+        float _last_remaining_time_request; // s
+        bool _remaining_time_requested;
+        RemainingTimeMarkersList _remaining_time_markers;
+        // Index of the first marker waiting for its block to be retired
+        size_t _first_unresolved_marker;
+        std::string _remaining_time_placeholder;
+
 #if ENABLE_MOVE_STATS
         MovesStatsMap _moves_stats;
 #endif // ENABLE_MOVE_STATS
@@ -236,6 +255,8 @@ namespace Slic3r {
 
         // Adds the given gcode line
         void add_gcode_line(const std::string& gcode_line);
+        // Adds the given gcode line already parsed by the caller
+        void add_gcode_line(const GCodeReader::GCodeLine& gcode_line) { this->_process_gcode_line(_parser, gcode_line); }
 
         void add_gcode_block(const char *ptr);
         void add_gcode_block(const std::string &str) { this->add_gcode_block(str.c_str()); }
@@ -244,8 +265,34 @@ namespace Slic3r {
         // start_from_beginning:
         // if set to true all blocks will be used to calculate the time estimate,
         // if set to false only the blocks not yet processed will be used and the calculated time will be added to the current calculated time
+        // start_from_beginning is not supported in the streaming mode, as the retired blocks are released.
         void calculate_time(bool start_from_beginning);
 
+        // Enables the streaming mode, in which the memory consumption does not grow with the length of the G-code:
+        // The blocks are planned over a look-ahead window of window_size blocks with the same forward / reverse passes
+        // used by calculate_time(), and they are released as they leave the window. The estimate is exact up to the
+        // junction speeds limited by blocks further than window_size / 2 ahead.
+        // If remaining_times_interval_sec > 0, the M73 lines are produced while the G-code is being added:
+        // Once remaining_time_placeholder_requested() returns true, the caller shall write the line returned by
+        // get_remaining_time_placeholder() to its output. The M73 values depend on the total print time,
+        // therefore they are filled in by patch_remaining_times() once the G-code has been written.
+        // window_size == 0 disables the streaming mode. Call before adding the first G-code line.
+        void set_streaming(size_t window_size, float remaining_times_interval_sec);
+        bool is_streaming() const { return _streaming_window_size > 0; }
+
+        // Streaming mode: Returns true if a M73 line shall be written after the last G-code line added.
+        bool remaining_time_placeholder_requested() const { return _remaining_time_requested; }
+        // Streaming mode: Returns a fixed width M73 placeholder, which the caller writes at file_offset of its output file.
+        // The placeholder refers to the last G-code line added.
+        const std::string& get_remaining_time_placeholder(size_t file_offset);
+        // Streaming mode: Returns a fixed width placeholder for the M73 line at the start of the print (0% printed).
+        const std::string& get_first_remaining_time_placeholder(size_t file_offset);
+        // Returns the M73 line at the end of the print (100% printed).
+        std::string get_last_remaining_time_line() const;
+        // Streaming mode: Fills in the M73 placeholders written into the given file.
+        // To be called after calculate_time(false) once the whole G-code has been added and the file has been closed.
+        bool patch_remaining_times(const std::string& filename);
+
         // Calculates the time estimate from the given gcode in string format
         void calculate_time_from_text(const std::string& gcode);
 
@@ -255,13 +302,6 @@ namespace Slic3r {
         // Calculates the time estimate from the gcode contained in given list of gcode lines
         void calculate_time_from_lines(const std::vector<std::string>& gcode_lines);
 
-        // Process the gcode contained in the file with the given filename, 
-        // placing in it new lines (M73) containing the remaining time, at the given interval in seconds
-        // and saving the result back in the same file
-        // This time estimator should have been already used to calculate the time estimate for the gcode
-        // contained in the given file before to call this method
-        bool post_process_remaining_times(const std::string& filename, float interval_sec);
-
         // Set current position on the given axis with the given value
         void set_axis_position(EAxis axis, float position);
 
@@ -315,10 +355,6 @@ namespace Slic3r {
         void set_e_local_positioning_type(EPositioningType type);
         EPositioningType get_e_local_positioning_type() const;
 
-        int get_g1_line_id() const;
-        void increment_g1_line_id();
-        void reset_g1_line_id();
-
         void set_extruder_id(unsigned int id);
         unsigned int get_extruder_id() const;
         void reset_extruder_id();
@@ -352,6 +388,20 @@ namespace Slic3r {
         // Calculates the time estimate
         void _calculate_time();
 
+        // Adds the times of the blocks after the last st_synchronized block up to end_block_id (exclusive) to the total time.
+        // If stop_at_request, it stops after the first block requesting a M73 output.
+        // Returns the end of the blocks accumulated.
+        int _accumulate_time(int end_block_id, bool stop_at_request = false);
+
+        // Streaming mode: plans the look-ahead window and retires its older half, or its blocks up to the first one
+        // requesting a M73 output, so that the caller gets to write a placeholder for each request
+        void _retire_blocks();
+        // Streaming mode: removes the first num_blocks blocks, which have already been accounted for
+        void _erase_blocks(int num_blocks);
+
+        // Formats the M73 line of a fixed length for the given elapsed time
+        std::string _get_remaining_time_line(float elapsed_time) const;
+
         // Processes the given gcode line
         void _process_gcode_line(GCodeReader&, const GCodeReader::GCodeLine& line);
 
@@ -87,6 +87,57 @@ private:
     std::string _retract(double length, double restart_extra, const std::string &comment);
 };
 
+// Number of decimal digits of the X, Y, Z coordinates and of the feed rate, and of the extruder axis.
+static const int XYZF_EXPORT_DIGITS = 3;
+static const int E_EXPORT_DIGITS    = 5;
+
+// Fast replacement of printf("%.*f", digits, value) for the G-code export, digits <= 9.
+// Rounds to the given number of decimal digits, then removes the trailing zeros and the trailing decimal point.
+// A negative value rounding to zero is exported as "0".
+// Writes at most GCODE_FORMAT_FIXED_MAX_LEN characters (no zero terminator), returns a pointer past the last character written.
+static const size_t GCODE_FORMAT_FIXED_MAX_LEN = 32;
+char* gcode_format_fixed(char *dst, double value, int digits);
+
+// Composes a single G1 line without the overhead of std::ostringstream.
+class GCodeG1Formatter {
+public:
+    GCodeG1Formatter() { m_gcode.reserve(64); m_gcode = "G1"; }
+
+    void emit_axis(const char axis, const double value, const int digits) {
+        char buf[GCODE_FORMAT_FIXED_MAX_LEN + 2];
+        buf[0] = ' ';
+        buf[1] = axis;
+        m_gcode.append(buf, gcode_format_fixed(buf + 2, value, digits));
+    }
+    void emit_xy(const Vec2d &point) {
+        this->emit_axis('X', point(0), XYZF_EXPORT_DIGITS);
+        this->emit_axis('Y', point(1), XYZF_EXPORT_DIGITS);
+    }
+    void emit_xyz(const Vec3d &point) {
+        this->emit_xy(to_2d(point));
+        this->emit_axis('Z', point(2), XYZF_EXPORT_DIGITS);
+    }
+    // The extrusion axis may be empty for gcfNoExtrusion.
+    void emit_e(const std::string &axis, const double value) {
+        char buf[GCODE_FORMAT_FIXED_MAX_LEN];
+        m_gcode += ' ';
+        m_gcode += axis;
+        m_gcode.append(buf, gcode_format_fixed(buf, value, E_EXPORT_DIGITS));
+    }
+    void emit_f(const double speed) { this->emit_axis('F', speed, XYZF_EXPORT_DIGITS); }
+    void emit_comment(const bool allow_comments, const std::string &comment) {
+        if (allow_comments && ! comment.empty()) {
+            m_gcode += " ; ";
+            m_gcode += comment;
+        }
+    }
+    void emit_string(const std::string &str) { m_gcode += str; }
+    std::string string() { m_gcode += '\n'; return std::move(m_gcode); }
+
+private:
+    std::string m_gcode;
+};
+
 } /* namespace Slic3r */
 
 #endif /* slic3r_GCodeWriter_hpp_ */
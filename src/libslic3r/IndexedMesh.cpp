@@ -0,0 +1,154 @@
+#include "IndexedMesh.hpp"
+#include "TriangleMesh.hpp"
+#include "ClipperUtils.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace Slic3r {
+
+IndexedMesh::IndexedMesh(const TriangleMesh &mesh)
+{
+    if (! mesh.has_shared_vertices())
+        throw std::invalid_argument("IndexedMesh was passed a mesh without shared vertices.");
+    const stl_file &stl = mesh.stl;
+    this->reserve(stl.stats.shared_vertices, stl.stats.number_of_facets);
+    for (int i = 0; i < stl.stats.shared_vertices; ++ i)
+        this->add_vertex(stl.v_shared[i]);
+    for (uint32_t i = 0; i < stl.stats.number_of_facets; ++ i) {
+        const int *vertices = stl.v_indices[i].vertex;
+        this->add_facet(uint32_t(vertices[0]), uint32_t(vertices[1]), uint32_t(vertices[2]));
+    }
+}
+
+void IndexedMesh::reserve(size_t num_vertices, size_t num_facets)
+{
+    x.reserve(num_vertices);
+    y.reserve(num_vertices);
+    z.reserve(num_vertices);
+    indices.reserve(num_facets * 3);
+}
+
+Vec3f IndexedMesh::facet_normal(size_t facet_idx) const
+{
+    const uint32_t *f  = this->facet(facet_idx);
+    const Vec3f     v0 = this->vertex(f[0]);
+    return (this->vertex(f[1]) - v0).cross(this->vertex(f[2]) - v0);
+}
+
+void IndexedMesh::transform(const Transform3d &trafo)
+{
+    const Eigen::Matrix<double, 3, 3, Eigen::DontAlign> m = trafo.matrix().block<3, 3>(0, 0);
+    const Vec3d                                          t = trafo.translation();
+    for (size_t i = 0; i < x.size(); ++ i) {
+        const double vx = double(x[i]);
+        const double vy = double(y[i]);
+        const double vz = double(z[i]);
+        x[i] = float(m(0, 0) * vx + m(0, 1) * vy + m(0, 2) * vz + t(0));
+        y[i] = float(m(1, 0) * vx + m(1, 1) * vy + m(1, 2) * vz + t(1));
+        z[i] = float(m(2, 0) * vx + m(2, 1) * vy + m(2, 2) * vz + t(2));
+    }
+    if (m.determinant() < 0.) {
+        // Left handed transformation, flip the facets to keep their normals pointing outwards.
+        for (size_t i = 0; i < indices.size(); i += 3)
+            std::swap(indices[i + 1], indices[i + 2]);
+    }
+}
+
+void IndexedMesh::translate(float dx, float dy, float dz)
+{
+    for (float &v : x) v += dx;
+    for (float &v : y) v += dy;
+    for (float &v : z) v += dz;
+}
+
+// Minimum and maximum of a coordinate array. Written as two independent reductions over a contiguous array,
+// so that the compiler vectorizes the loop.
+static inline void min_max(const std::vector<float> &values, float &vmin, float &vmax)
+{
+    float lo =   FLT_MAX;
+    float hi = - FLT_MAX;
+    for (const float v : values) {
+        lo = (v < lo) ? v : lo;
+        hi = (v > hi) ? v : hi;
+    }
+    vmin = lo;
+    vmax = hi;
+}
+
+BoundingBoxf3 IndexedMesh::bounding_box() const
+{
+    BoundingBoxf3 bbox;
+    if (! x.empty()) {
+        float lo, hi;
+        min_max(x, lo, hi); bbox.min(0) = lo; bbox.max(0) = hi;
+        min_max(y, lo, hi); bbox.min(1) = lo; bbox.max(1) = hi;
+        min_max(z, lo, hi); bbox.min(2) = lo; bbox.max(2) = hi;
+        bbox.defined = true;
+    }
+    return bbox;
+}
+
+BoundingBoxf3 IndexedMesh::transformed_bounding_box(const Transform3d &trafo) const
+{
+    BoundingBoxf3 bbox;
+    if (x.empty())
+        return bbox;
+    const Eigen::Matrix<double, 3, 3, Eigen::DontAlign> m = trafo.matrix().block<3, 3>(0, 0);
+    const Vec3d                                          t = trafo.translation();
+    // One pass per output axis over the three coordinate arrays, each pass is a vectorizable min / max reduction.
+    for (int axis = 0; axis < 3; ++ axis) {
+        const double mx = m(axis, 0);
+        const double my = m(axis, 1);
+        const double mz = m(axis, 2);
+        double lo =   DBL_MAX;
+        double hi = - DBL_MAX;
+        for (size_t i = 0; i < x.size(); ++ i) {
+            const double v = mx * double(x[i]) + my * double(y[i]) + mz * double(z[i]);
+            lo = (v < lo) ? v : lo;
+            hi = (v > hi) ? v : hi;
+        }
+        bbox.min(axis) = lo + t(axis);
+        bbox.max(axis) = hi + t(axis);
+    }
+    bbox.defined = true;
+    return bbox;
+}
+
+TriangleMesh IndexedMesh::convex_hull_3d() const
+{
+    std::vector<float> points;
+    points.reserve(x.size() * 3);
+    for (size_t i = 0; i < x.size(); ++ i) {
+        points.emplace_back(x[i]);
+        points.emplace_back(y[i]);
+        points.emplace_back(z[i]);
+    }
+    return convex_hull_3d_from_points(points);
+}
+
+ExPolygons IndexedMesh::horizontal_projection() const
+{
+    // Project and scale the vertices once, they are shared by the facets.
+    Points projected;
+    projected.reserve(x.size());
+    for (size_t i = 0; i < x.size(); ++ i)
+        projected.emplace_back(Point::new_scale(x[i], y[i]));
+
+    Polygons pp;
+    pp.reserve(this->facets_count());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        Polygon p;
+        p.points.reserve(3);
+        p.points.emplace_back(projected[indices[i]]);
+        p.points.emplace_back(projected[indices[i + 1]]);
+        p.points.emplace_back(projected[indices[i + 2]]);
+        p.make_counter_clockwise();  // do this after scaling, as winding order might change while doing that
+        pp.emplace_back(std::move(p));
+    }
+
+    // the offset factor was tuned using groovemount.stl
+    return union_ex(offset(pp, scale_(0.01)), true);
+}
+
+}
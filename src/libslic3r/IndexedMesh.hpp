@@ -0,0 +1,68 @@
+#ifndef slic3r_IndexedMesh_hpp_
+#define slic3r_IndexedMesh_hpp_
+
+#include "libslic3r.h"
+#include <vector>
+#include "BoundingBox.hpp"
+#include "ExPolygon.hpp"
+#include "Point.hpp"
+
+namespace Slic3r {
+
+class TriangleMesh;
+
+// Compact indexed triangle mesh for the hot paths (slicing, bounding box, convex hull, projection).
+// The vertices are stored as a structure of arrays, so that the min / max / plane tests over the vertices vectorize,
+// the triangles are stored as a flat buffer of three vertex indices per triangle.
+// Compared to stl_file, which stores a 50 bytes record per facet with duplicated vertices and the topology
+// tables on top of that, the memory footprint is roughly a third.
+class IndexedMesh
+{
+public:
+    IndexedMesh() {}
+    // Copy of the shared vertices and the vertex indices of a TriangleMesh.
+    // Both the vertex and the facet indices of the TriangleMesh are retained.
+    // The TriangleMesh is required to have its shared vertices generated.
+    explicit IndexedMesh(const TriangleMesh &mesh);
+
+    void            clear() { x.clear(); y.clear(); z.clear(); indices.clear(); }
+    void            reserve(size_t num_vertices, size_t num_facets);
+    void            swap(IndexedMesh &other) { x.swap(other.x); y.swap(other.y); z.swap(other.z); indices.swap(other.indices); }
+
+    size_t          vertices_count() const { return x.size(); }
+    size_t          facets_count() const { return indices.size() / 3; }
+    bool            empty() const { return indices.empty(); }
+    // Memory occupied by the vertex and index buffers.
+    size_t          memsize() const { return (x.capacity() + y.capacity() + z.capacity()) * sizeof(float) + indices.capacity() * sizeof(uint32_t); }
+
+    Vec3f           vertex(size_t idx) const { return Vec3f(x[idx], y[idx], z[idx]); }
+    // Pointer to the three vertex indices of a facet.
+    const uint32_t* facet(size_t facet_idx) const { return indices.data() + 3 * facet_idx; }
+    // Normal of a facet, not normalized.
+    Vec3f           facet_normal(size_t facet_idx) const;
+
+    void            add_vertex(const Vec3f &v) { x.emplace_back(v(0)); y.emplace_back(v(1)); z.emplace_back(v(2)); }
+    void            add_facet(uint32_t a, uint32_t b, uint32_t c) { indices.emplace_back(a); indices.emplace_back(b); indices.emplace_back(c); }
+
+    void            transform(const Transform3d &trafo);
+    void            translate(float x, float y, float z);
+
+    BoundingBoxf3   bounding_box() const;
+    // Returns the bbox of this mesh transformed by the given transformation.
+    BoundingBoxf3   transformed_bounding_box(const Transform3d &trafo) const;
+    // Returns the convex hull of this mesh.
+    TriangleMesh    convex_hull_3d() const;
+    // Union of the facets projected into the Z=0 plane.
+    ExPolygons      horizontal_projection() const;
+
+    // Vertex coordinates, structure of arrays.
+    std::vector<float>      x;
+    std::vector<float>      y;
+    std::vector<float>      z;
+    // Three vertex indices per facet.
+    std::vector<uint32_t>   indices;
+};
+
+}
+
+#endif /* slic3r_IndexedMesh_hpp_ */
@@ -472,7 +472,7 @@ bool Model::looks_like_multipart_object() const
         if (obj->volumes.size() > 1 || obj->config.keys().size() > 1)
             return false;
         for (const ModelVolume *vol : obj->volumes) {
-            double zmin_this = vol->mesh.bounding_box().min(2);
+            double zmin_this = vol->mesh().bounding_box().min(2);
             if (zmin == std::numeric_limits<double>::max())
                 zmin = zmin_this;
             else if (std::abs(zmin - zmin_this) > EPSILON)
@@ -608,6 +608,11 @@ ModelObject& ModelObject::assign_copy(const ModelObject &rhs)
     m_raw_bounding_box_valid          = rhs.m_raw_bounding_box_valid;
     m_raw_mesh_bounding_box           = rhs.m_raw_mesh_bounding_box;
     m_raw_mesh_bounding_box_valid     = rhs.m_raw_mesh_bounding_box_valid;
+    // The volume meshes are shared with rhs, therefore the derived geometry is valid for this copy as well.
+    {
+        tbb::mutex::scoped_lock lock(rhs.m_geometry_cache_mutex);
+        m_geometry_cache              = rhs.m_geometry_cache;
+    }
 
     this->clear_volumes();
     this->volumes.reserve(rhs.volumes.size());
@@ -644,6 +649,7 @@ ModelObject& ModelObject::assign_copy(ModelObject &&rhs)
     m_raw_bounding_box_valid          = rhs.m_raw_bounding_box_valid;
     m_raw_mesh_bounding_box           = rhs.m_raw_mesh_bounding_box;
     m_raw_mesh_bounding_box_valid     = rhs.m_raw_mesh_bounding_box_valid;
+    m_geometry_cache                  = std::move(rhs.m_geometry_cache);
 
     this->clear_volumes();
 	this->volumes = std::move(rhs.volumes);
@@ -809,29 +815,119 @@ const BoundingBoxf3& ModelObject::bounding_box() const
 TriangleMesh ModelObject::mesh() const
 {
     TriangleMesh mesh;
-    TriangleMesh raw_mesh = this->raw_mesh();
+    std::shared_ptr<const TriangleMesh> raw_mesh = this->raw_mesh();
     for (const ModelInstance *i : this->instances) {
-        TriangleMesh m = raw_mesh;
+        TriangleMesh m = *raw_mesh;
         i->transform_mesh(&m);
         mesh.merge(m);
     }
     return mesh;
 }
 
+void ModelObject::validate_geometry_cache() const
+{
+    const std::vector<GeometryCache::VolumeKey> &key = m_geometry_cache.volumes;
+    size_t idx   = 0;
+    bool   valid = true;
+    for (const ModelVolume *v : this->volumes)
+        if (v->is_model_part()) {
+            if (idx == key.size() || key[idx].mesh.lock() != v->get_mesh_shared_ptr() || key[idx].convex_hull.lock() != v->get_convex_hull_shared_ptr() ||
+                key[idx].matrix != v->get_matrix().matrix()) {
+                valid = false;
+                break;
+            }
+            ++ idx;
+        }
+    if (valid && idx == key.size())
+        return;
+    m_geometry_cache = GeometryCache();
+    for (const ModelVolume *v : this->volumes)
+        if (v->is_model_part())
+            m_geometry_cache.volumes.push_back({ v->get_mesh_shared_ptr(), v->get_convex_hull_shared_ptr(), v->get_matrix().matrix() });
+}
+
 // Non-transformed (non-rotated, non-scaled, non-translated) sum of non-modifier object volumes.
 // Currently used by ModelObject::mesh(), to calculate the 2D envelope for 2D platter
 // and to display the object statistics at ModelObject::print_info().
-TriangleMesh ModelObject::raw_mesh() const
+std::shared_ptr<const TriangleMesh> ModelObject::raw_mesh() const
 {
-    TriangleMesh mesh;
-    for (const ModelVolume *v : this->volumes)
-        if (v->is_model_part())
-        {
-            TriangleMesh vol_mesh(v->mesh);
-            vol_mesh.transform(v->get_matrix());
-            mesh.merge(vol_mesh);
+    tbb::mutex::scoped_lock lock(m_geometry_cache_mutex);
+    this->validate_geometry_cache();
+    return this->raw_mesh_cached();
+}
+
+const std::shared_ptr<const TriangleMesh>& ModelObject::raw_mesh_cached() const
+{
+    if (! m_geometry_cache.raw_mesh) {
+        const ModelVolume *single_part = nullptr;
+        size_t             num_parts   = 0;
+        for (const ModelVolume *v : this->volumes)
+            if (v->is_model_part()) {
+                single_part = v;
+                ++ num_parts;
+            }
+        if (num_parts == 1 && single_part->get_matrix().matrix().isIdentity()) {
+            // Share the volume mesh.
+            m_geometry_cache.raw_mesh = single_part->get_mesh_shared_ptr();
+        } else {
+            auto mesh = std::make_shared<TriangleMesh>();
+            for (const ModelVolume *v : this->volumes)
+                if (v->is_model_part())
+                {
+                    TriangleMesh vol_mesh(v->mesh());
+                    vol_mesh.transform(v->get_matrix());
+                    mesh->merge(vol_mesh);
+                }
+            m_geometry_cache.raw_mesh = std::move(mesh);
         }
-    return mesh;
+    }
+    return m_geometry_cache.raw_mesh;
+}
+
+// Call fn for the vertices of a mesh transformed by trafo, using the shared vertices if available.
+template<typename Fn>
+static void transformed_vertices(const stl_file &stl, const Transform3d &trafo, Fn fn)
+{
+    if (stl.v_shared == nullptr) {
+        // Using the STL faces.
+        for (unsigned int i = 0; i < stl.stats.number_of_facets; ++ i) {
+            const stl_facet &facet = stl.facet_start[i];
+            for (size_t j = 0; j < 3; ++ j)
+                fn(trafo * facet.vertex[j].cast<double>());
+        }
+    } else {
+        // Using the shared vertices should be a bit quicker than using the STL faces.
+        for (int i = 0; i < stl.stats.shared_vertices; ++ i)
+            fn(trafo * stl.v_shared[i].cast<double>());
+    }
+}
+
+// The convex hull of the union of the volumes is the convex hull of the union of the convex hulls of the volumes,
+// which have got a small fraction of the vertices of the volume meshes.
+std::shared_ptr<const TriangleMesh> ModelObject::raw_convex_hull() const
+{
+    tbb::mutex::scoped_lock lock(m_geometry_cache_mutex);
+    this->validate_geometry_cache();
+    return this->raw_convex_hull_cached();
+}
+
+const std::shared_ptr<const TriangleMesh>& ModelObject::raw_convex_hull_cached() const
+{
+    if (! m_geometry_cache.raw_convex_hull) {
+        std::vector<float> points;
+        for (const ModelVolume *v : this->volumes)
+            if (v->is_model_part()) {
+                // The convex hull is not calculated for meshes with less than two facets.
+                const TriangleMesh &hull = v->get_convex_hull();
+                transformed_vertices((hull.stl.stats.number_of_facets > 0 ? hull : v->mesh()).stl, v->get_matrix(), [&points](const Vec3d &p) {
+                    points.emplace_back(float(p.x()));
+                    points.emplace_back(float(p.y()));
+                    points.emplace_back(float(p.z()));
+                });
+            }
+        m_geometry_cache.raw_convex_hull = std::make_shared<TriangleMesh>(points.empty() ? TriangleMesh() : convex_hull_3d_from_points(points));
+    }
+    return m_geometry_cache.raw_convex_hull;
 }
 
 // Non-transformed (non-rotated, non-scaled, non-translated) sum of all object volumes.
@@ -840,7 +936,7 @@ TriangleMesh ModelObject::full_raw_mesh() const
     TriangleMesh mesh;
     for (const ModelVolume *v : this->volumes)
     {
-        TriangleMesh vol_mesh(v->mesh);
+        TriangleMesh vol_mesh(v->mesh());
         vol_mesh.transform(v->get_matrix());
         mesh.merge(vol_mesh);
     }
@@ -854,7 +950,7 @@ const BoundingBoxf3& ModelObject::raw_mesh_bounding_box() const
         m_raw_mesh_bounding_box.reset();
         for (const ModelVolume *v : this->volumes)
             if (v->is_model_part())
-                m_raw_mesh_bounding_box.merge(v->mesh.transformed_bounding_box(v->get_matrix()));
+                m_raw_mesh_bounding_box.merge(v->mesh().transformed_bounding_box(v->get_matrix()));
     }
     return m_raw_mesh_bounding_box;
 }
@@ -863,7 +959,7 @@ BoundingBoxf3 ModelObject::full_raw_mesh_bounding_box() const
 {
 	BoundingBoxf3 bb;
 	for (const ModelVolume *v : this->volumes)
-		bb.merge(v->mesh.transformed_bounding_box(v->get_matrix()));
+		bb.merge(v->mesh().transformed_bounding_box(v->get_matrix()));
 	return bb;
 }
 
@@ -881,7 +977,7 @@ const BoundingBoxf3& ModelObject::raw_bounding_box() const
         for (const ModelVolume *v : this->volumes)
         {
             if (v->is_model_part())
-                m_raw_bounding_box.merge(v->mesh.transformed_bounding_box(inst_matrix * v->get_matrix()));
+                m_raw_bounding_box.merge(v->mesh().transformed_bounding_box(inst_matrix * v->get_matrix()));
         }
     }
 	return m_raw_bounding_box;
@@ -895,38 +991,32 @@ BoundingBoxf3 ModelObject::instance_bounding_box(size_t instance_idx, bool dont_
     for (ModelVolume *v : this->volumes)
     {
         if (v->is_model_part())
-            bb.merge(v->mesh.transformed_bounding_box(inst_matrix * v->get_matrix()));
+            bb.merge(v->mesh().transformed_bounding_box(inst_matrix * v->get_matrix()));
     }
     return bb;
 }
 
 // Calculate 2D convex hull of of a projection of the transformed printable volumes into the XY plane.
-// This method is cheap in that it does not make any unnecessary copy of the volume meshes.
+// This method is cheap in that it only projects the vertices of raw_convex_hull().
 // This method is used by the auto arrange function.
 Polygon ModelObject::convex_hull_2d(const Transform3d &trafo_instance) const
 {
+    tbb::mutex::scoped_lock lock(m_geometry_cache_mutex);
+    this->validate_geometry_cache();
+    if (m_geometry_cache.convex_hull_2d_valid && m_geometry_cache.convex_hull_2d_trafo == trafo_instance.matrix())
+        return m_geometry_cache.convex_hull_2d;
+
     Points pts;
-    for (const ModelVolume *v : this->volumes)
-        if (v->is_model_part()) {
-            const stl_file &stl = v->mesh.stl;
-            Transform3d trafo = trafo_instance * v->get_matrix();
-            if (stl.v_shared == nullptr) {
-                // Using the STL faces.
-                for (unsigned int i = 0; i < stl.stats.number_of_facets; ++ i) {
-                    const stl_facet &facet = stl.facet_start[i];
-                    for (size_t j = 0; j < 3; ++ j) {
-                        Vec3d p = trafo * facet.vertex[j].cast<double>();
-                        pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y())));
-                    }
-                }
-            } else {
-                // Using the shared vertices should be a bit quicker than using the STL faces.
-                for (int i = 0; i < stl.stats.shared_vertices; ++ i) {           
-                    Vec3d p = trafo * stl.v_shared[i].cast<double>();
-                    pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y())));
-                }
-            }
-        }
+    auto   append_point = [&pts](const Vec3d &p) { pts.emplace_back(coord_t(scale_(p.x())), coord_t(scale_(p.y()))); };
+    const TriangleMesh &raw_hull = *this->raw_convex_hull_cached();
+    if (raw_hull.stl.stats.number_of_facets > 0)
+        transformed_vertices(raw_hull.stl, trafo_instance, append_point);
+    else {
+        // Calculation of the 3D convex hull failed, for example for a flat object. Project the volume meshes.
+        for (const ModelVolume *v : this->volumes)
+            if (v->is_model_part())
+                transformed_vertices(v->mesh().stl, trafo_instance * v->get_matrix(), append_point);
+    }
     std::sort(pts.begin(), pts.end(), [](const Point& a, const Point& b) { return a(0) < b(0) || (a(0) == b(0) && a(1) < b(1)); });
     pts.erase(std::unique(pts.begin(), pts.end(), [](const Point& a, const Point& b) { return a(0) == b(0) && a(1) == b(1); }), pts.end());
 
@@ -951,6 +1041,10 @@ Polygon ModelObject::convex_hull_2d(const Transform3d &trafo_instance) const
         assert(hull.points.front() == hull.points.back());
         hull.points.pop_back();
     }
+
+    m_geometry_cache.convex_hull_2d_valid = true;
+    m_geometry_cache.convex_hull_2d_trafo = trafo_instance.matrix();
+    m_geometry_cache.convex_hull_2d       = hull;
     return hull;
 }
 
@@ -1062,14 +1156,14 @@ size_t ModelObject::facets_count() const
     size_t num = 0;
     for (const ModelVolume *v : this->volumes)
         if (v->is_model_part())
-            num += v->mesh.stl.stats.number_of_facets;
+            num += v->mesh().stl.stats.number_of_facets;
     return num;
 }
 
 bool ModelObject::needed_repair() const
 {
     for (const ModelVolume *v : this->volumes)
-        if (v->is_model_part() && v->mesh.needed_repair())
+        if (v->is_model_part() && v->mesh().needed_repair())
             return true;
     return false;
 }
@@ -1135,11 +1229,12 @@ ModelObjectPtrs ModelObject::cut(size_t instance, coordf_t z, bool keep_upper, b
 
             // Transform the mesh by the combined transformation matrix.
             // Flip the triangles in case the composite transformation is left handed.
-            volume->mesh.transform(instance_matrix * volume_matrix, true);
+            TriangleMesh &mesh = volume->mesh_mutable();
+            mesh.transform(instance_matrix * volume_matrix, true);
 
             // Perform cut
-            volume->mesh.require_shared_vertices(); // TriangleMeshSlicer needs this
-            TriangleMeshSlicer tms(&volume->mesh);
+            mesh.require_shared_vertices(); // TriangleMeshSlicer needs this
+            TriangleMeshSlicer tms(&mesh);
             tms.cut(float(z), &upper_mesh, &lower_mesh);
 
             // Reset volume transformation except for offset
@@ -1233,7 +1328,7 @@ void ModelObject::split(ModelObjectPtrs* new_objects)
     }
     
     ModelVolume* volume = this->volumes.front();
-    TriangleMeshPtrs meshptrs = volume->mesh.split();
+    TriangleMeshPtrs meshptrs = volume->mesh().split();
     for (TriangleMesh *mesh : meshptrs) {
         mesh->repair();
         
@@ -1263,7 +1358,7 @@ void ModelObject::split(ModelObjectPtrs* new_objects)
 void ModelObject::repair()
 {
     for (ModelVolume *v : this->volumes)
-        v->mesh.repair();
+        v->mesh_mutable().repair();
 }
 
 // Support for non-uniform scaling of instances. If an instance is rotated by angles, which are not multiples of ninety degrees,
@@ -1393,7 +1488,7 @@ void ModelObject::print_info() const
     cout << fixed;
     boost::nowide::cout << "[" << boost::filesystem::path(this->input_file).filename().string() << "]" << endl;
     
-    TriangleMesh mesh = this->raw_mesh();
+    TriangleMesh mesh = *this->raw_mesh();
     mesh.check_topology();
     BoundingBoxf3 bb = mesh.bounding_box();
     Vec3d size = bb.size();
@@ -1452,7 +1547,7 @@ std::string ModelObject::get_export_filename() const
 stl_stats ModelObject::get_object_stl_stats() const
 {
     if (this->volumes.size() == 1)
-        return this->volumes[0]->mesh.stl.stats;
+        return this->volumes[0]->mesh().stl.stats;
 
     stl_stats full_stats;
     memset(&full_stats, 0, sizeof(stl_stats));
@@ -1463,7 +1558,7 @@ stl_stats ModelObject::get_object_stl_stats() const
         if (volume->id() == this->volumes[0]->id())
             continue;
 
-        const stl_stats& stats = volume->mesh.stl.stats;
+        const stl_stats& stats = volume->mesh().stl.stats;
 
         // initialize full_stats (for repaired errors)
         full_stats.degenerate_facets    += stats.degenerate_facets;
@@ -1531,30 +1626,30 @@ bool ModelVolume::is_splittable() const
 {
     // the call mesh.is_splittable() is expensive, so cache the value to calculate it only once
     if (m_is_splittable == -1)
-        m_is_splittable = (int)mesh.is_splittable();
+        m_is_splittable = (int)this->mesh().is_splittable();
 
     return m_is_splittable == 1;
 }
 
 void ModelVolume::center_geometry()
 {
-    Vec3d shift = mesh.bounding_box().center();
+    Vec3d shift = this->mesh().bounding_box().center();
     if (!shift.isApprox(Vec3d::Zero()))
     {
-        mesh.translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
-        m_convex_hull.translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
+        this->mesh_mutable().translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
+        this->convex_hull_mutable().translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
         translate(shift);
     }
 }
 
 void ModelVolume::calculate_convex_hull()
 {
-    m_convex_hull = mesh.convex_hull_3d();
+    m_convex_hull = std::make_shared<TriangleMesh>(this->mesh().convex_hull_3d());
 }
 
 int ModelVolume::get_mesh_errors_count() const
 {
-    const stl_stats& stats = this->mesh.stl.stats;
+    const stl_stats& stats = this->mesh().stl.stats;
 
     return  stats.degenerate_facets + stats.edges_fixed     + stats.facets_removed +
             stats.facets_added      + stats.facets_reversed + stats.backwards_edges;
@@ -1562,7 +1657,7 @@ int ModelVolume::get_mesh_errors_count() const
 
 const TriangleMesh& ModelVolume::get_convex_hull() const
 {
-    return m_convex_hull;
+    return *m_convex_hull;
 }
 
 ModelVolumeType ModelVolume::type_from_string(const std::string &s)
@@ -1602,7 +1697,7 @@ std::string ModelVolume::type_to_string(const ModelVolumeType t)
 // This is useful to assign different materials to different volumes of an object.
 size_t ModelVolume::split(unsigned int max_extruders)
 {
-    TriangleMeshPtrs meshptrs = this->mesh.split();
+    TriangleMeshPtrs meshptrs = this->mesh().split();
     if (meshptrs.size() <= 1) {
         delete meshptrs.front();
         return 1;
@@ -1619,7 +1714,7 @@ size_t ModelVolume::split(unsigned int max_extruders)
         mesh->repair();
         if (idx == 0)
         {
-            this->mesh = std::move(*mesh);
+            this->set_mesh(std::move(*mesh));
             this->calculate_convex_hull();
             // Assign a new unique ID, so that a new GLVolume will be generated.
             this->set_new_unique_id();
@@ -1696,22 +1791,22 @@ void ModelVolume::mirror(Axis axis)
 
 void ModelVolume::scale_geometry(const Vec3d& versor)
 {
-    mesh.scale(versor);
-    m_convex_hull.scale(versor);
+    this->mesh_mutable().scale(versor);
+    this->convex_hull_mutable().scale(versor);
 }
 
 void ModelVolume::transform_mesh(const Transform3d &mesh_trafo, bool fix_left_handed)
 {
-    this->mesh.transform(mesh_trafo, fix_left_handed);
-    this->m_convex_hull.transform(mesh_trafo, fix_left_handed);
+    this->mesh_mutable().transform(mesh_trafo, fix_left_handed);
+    this->convex_hull_mutable().transform(mesh_trafo, fix_left_handed);
     // Let the rest of the application know that the geometry changed, so the meshes have to be reloaded.
     this->set_new_unique_id();
 }
 
 void ModelVolume::transform_mesh(const Matrix3d &matrix, bool fix_left_handed)
 {
-	this->mesh.transform(matrix, fix_left_handed);
-	this->m_convex_hull.transform(matrix, fix_left_handed);
+	this->mesh_mutable().transform(matrix, fix_left_handed);
+	this->convex_hull_mutable().transform(matrix, fix_left_handed);
     // Let the rest of the application know that the geometry changed, so the meshes have to be reloaded.
     this->set_new_unique_id();
 }
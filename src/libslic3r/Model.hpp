@@ -8,12 +8,19 @@
 #include "TriangleMesh.hpp"
 #include "Slicing.hpp"
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include "Geometry.hpp"
 #include <libslic3r/SLA/SLACommon.hpp>
 
+// tbb/mutex.h includes Windows, which in turn defines min/max macros. Convince Windows.h to not define these min/max macros.
+#ifndef NOMINMAX
+    #define NOMINMAX
+#endif
+#include "tbb/mutex.h"
+
 namespace Slic3r {
 
 class Model;
@@ -220,12 +227,18 @@ public:
     // This bounding box is being cached.
     const BoundingBoxf3& bounding_box() const;
     void invalidate_bounding_box() { m_bounding_box_valid = false; m_raw_bounding_box_valid = false; m_raw_mesh_bounding_box_valid = false; }
+    // Drop the cached raw_mesh(), raw_convex_hull() and convex_hull_2d(). Called by ModelVolume::mesh_mutable(),
+    // other changes of the volumes (replaced meshes, changed transformations) are detected by the cache itself.
+    void invalidate_geometry_cache() const { tbb::mutex::scoped_lock lock(m_geometry_cache_mutex); m_geometry_cache = GeometryCache(); }
 
     // A mesh containing all transformed instances of this object.
     TriangleMesh mesh() const;
     // Non-transformed (non-rotated, non-scaled, non-translated) sum of non-modifier object volumes.
     // Currently used by ModelObject::mesh() and to calculate the 2D envelope for 2D platter.
-    TriangleMesh raw_mesh() const;
+    // The mesh is cached. The returned pointer keeps the mesh alive after the volumes of this object are modified.
+    std::shared_ptr<const TriangleMesh> raw_mesh() const;
+    // 3D convex hull of raw_mesh(), calculated from the convex hulls of the non-modifier object volumes. Cached.
+    std::shared_ptr<const TriangleMesh> raw_convex_hull() const;
     // Non-transformed (non-rotated, non-scaled, non-translated) sum of all object volumes.
     TriangleMesh full_raw_mesh() const;
     // A transformed snug bounding box around the non-modifier object volumes, without the translation applied.
@@ -239,8 +252,9 @@ public:
     BoundingBoxf3 full_raw_mesh_bounding_box() const;
 
     // Calculate 2D convex hull of of a projection of the transformed printable volumes into the XY plane.
-    // This method is cheap in that it does not make any unnecessary copy of the volume meshes.
-    // This method is used by the auto arrange function.
+    // This method is cheap in that it only projects the vertices of raw_convex_hull().
+    // The hull is cached for the last trafo_instance, which is usually the same for the repeated calls
+    // by the auto arrange function and by Print::validate().
     Polygon       convex_hull_2d(const Transform3d &trafo_instance) const;
 
     void center_around_origin(bool include_modifiers = true);
@@ -322,6 +336,35 @@ private:
     mutable bool          m_raw_bounding_box_valid;
     mutable BoundingBoxf3 m_raw_mesh_bounding_box;
     mutable bool          m_raw_mesh_bounding_box_valid;    
+
+    // Geometry derived from the non-modifier volumes, cached. The cache is keyed by the meshes, the convex hulls
+    // and the transformations of the non-modifier volumes and it is validated against them on each access.
+    // As the meshes are shared by the copies of a ModelObject, the cache is shared by the copies as well.
+    struct GeometryCache {
+        // Eigen::DontAlign, so that the matrices may be stored into a std::vector.
+        typedef Eigen::Matrix<double, 4, 4, Eigen::DontAlign> Matrix4d;
+        struct VolumeKey {
+            std::weak_ptr<const TriangleMesh>   mesh;
+            std::weak_ptr<const TriangleMesh>   convex_hull;
+            Matrix4d                            matrix;
+        };
+        std::vector<VolumeKey>                  volumes;
+        std::shared_ptr<const TriangleMesh>     raw_mesh;
+        std::shared_ptr<const TriangleMesh>     raw_convex_hull;
+        // 2D convex hull for the last instance transformation queried.
+        bool                                    convex_hull_2d_valid = false;
+        Matrix4d                                convex_hull_2d_trafo;
+        Polygon                                 convex_hull_2d;
+    };
+    mutable GeometryCache m_geometry_cache;
+    // The getters are called from the UI thread and from the background processing thread at the same time,
+    // for example by Print::validate() and by the SLA supports step.
+    mutable tbb::mutex    m_geometry_cache_mutex;
+    // The following methods are called with m_geometry_cache_mutex locked.
+    // Drop the cache if the non-modifier volumes do not match the cache key.
+    void                  validate_geometry_cache() const;
+    const std::shared_ptr<const TriangleMesh>& raw_mesh_cached() const;
+    const std::shared_ptr<const TriangleMesh>& raw_convex_hull_cached() const;
 };
 
 // Declared outside of ModelVolume, so it could be forward declared.
@@ -340,7 +383,16 @@ class ModelVolume : public ModelBase
 public:
     std::string         name;
     // The triangular model.
-    TriangleMesh        mesh;
+    // The mesh is immutable and shared by the copies of this ModelVolume, for example by the copy of the Model
+    // held by the background processing, or by the volumes of a duplicated object.
+    const TriangleMesh& mesh() const { return *m_mesh; }
+    const std::shared_ptr<const TriangleMesh>& get_mesh_shared_ptr() const { return m_mesh; }
+    void                set_mesh(const TriangleMesh &mesh) { m_mesh = std::make_shared<TriangleMesh>(mesh); }
+    void                set_mesh(TriangleMesh &&mesh) { m_mesh = std::make_shared<TriangleMesh>(std::move(mesh)); }
+    void                set_mesh(const std::shared_ptr<const TriangleMesh> &mesh) { m_mesh = mesh; }
+    // Mutable access to the mesh. If the mesh is shared with another ModelVolume, it is copied first (copy on write).
+    // The geometry cached by the parent ModelObject is dropped.
+    TriangleMesh&       mesh_mutable() { this->invalidate_object_geometry_cache(); return make_unique_mesh(m_mesh); }
     // Configuration parameters specific to an object model geometry or a modifier volume, 
     // overriding the global Slic3r settings and the ModelObject settings.
     DynamicPrintConfig  config;
@@ -384,6 +436,7 @@ public:
 
     void                calculate_convex_hull();
     const TriangleMesh& get_convex_hull() const;
+    const std::shared_ptr<const TriangleMesh>& get_convex_hull_shared_ptr() const { return m_convex_hull; }
     // Get count of errors in the mesh
     int                 get_mesh_errors_count() const;
 
@@ -439,8 +492,10 @@ private:
     // Is it an object to be printed, or a modifier volume?
     ModelVolumeType         m_type;
     t_model_material_id     m_material_id;
+    // The triangular model, see mesh().
+    std::shared_ptr<const TriangleMesh> m_mesh;
     // The convex hull of this model's mesh.
-    TriangleMesh             m_convex_hull;
+    std::shared_ptr<const TriangleMesh> m_convex_hull;
     Geometry::Transformation m_transformation;
 
     // flag to optimize the checking if the volume is splittable
@@ -449,27 +504,45 @@ private:
     //      1   ->   is splittable
     mutable int               m_is_splittable{ -1 };
 
-	ModelVolume(ModelObject *object, const TriangleMesh &mesh) : mesh(mesh), m_type(ModelVolumeType::MODEL_PART), object(object)
+    // The meshes are always allocated as mutable, so that make_unique_mesh() may hand out a mutable reference to a mesh,
+    // which is not shared.
+    static TriangleMesh& make_unique_mesh(std::shared_ptr<const TriangleMesh> &mesh) {
+        if (mesh.use_count() > 1)
+            mesh = std::make_shared<TriangleMesh>(*mesh);
+        return const_cast<TriangleMesh&>(*mesh);
+    }
+    TriangleMesh& convex_hull_mutable() { this->invalidate_object_geometry_cache(); return make_unique_mesh(m_convex_hull); }
+    void          invalidate_object_geometry_cache() const { if (this->object != nullptr) this->object->invalidate_geometry_cache(); }
+
+	ModelVolume(ModelObject *object, const TriangleMesh &mesh) : 
+        m_type(ModelVolumeType::MODEL_PART), object(object), m_mesh(std::make_shared<TriangleMesh>(mesh)), m_convex_hull(std::make_shared<TriangleMesh>())
     {
         if (mesh.stl.stats.number_of_facets > 1)
             calculate_convex_hull();
+    }
+	ModelVolume(ModelObject *object, TriangleMesh &&mesh) : 
+        m_type(ModelVolumeType::MODEL_PART), object(object), m_mesh(std::make_shared<TriangleMesh>(std::move(mesh))), m_convex_hull(std::make_shared<TriangleMesh>())
+    {
+        if (m_mesh->stl.stats.number_of_facets > 1)
+            calculate_convex_hull();
     }
     ModelVolume(ModelObject *object, TriangleMesh &&mesh, TriangleMesh &&convex_hull) :
-		mesh(std::move(mesh)), m_convex_hull(std::move(convex_hull)), m_type(ModelVolumeType::MODEL_PART), object(object) {}
+		m_type(ModelVolumeType::MODEL_PART), object(object), m_mesh(std::make_shared<TriangleMesh>(std::move(mesh))), m_convex_hull(std::make_shared<TriangleMesh>(std::move(convex_hull))) {}
 
     // Copying an existing volume, therefore this volume will get a copy of the ID assigned.
+    // The mesh and the convex hull are shared with the other volume.
     ModelVolume(ModelObject *object, const ModelVolume &other) :
         ModelBase(other), // copy the ID
-        name(other.name), mesh(other.mesh), m_convex_hull(other.m_convex_hull), config(other.config), m_type(other.m_type), object(object), m_transformation(other.m_transformation)
+        name(other.name), config(other.config), m_type(other.m_type), object(object), m_mesh(other.m_mesh), m_convex_hull(other.m_convex_hull), m_transformation(other.m_transformation)
     {
         this->set_material_id(other.material_id());
     }
     // Providing a new mesh, therefore this volume will get a new unique ID assigned.
-    ModelVolume(ModelObject *object, const ModelVolume &other, const TriangleMesh &&mesh) :
-        name(other.name), mesh(std::move(mesh)), config(other.config), m_type(other.m_type), object(object), m_transformation(other.m_transformation)
+    ModelVolume(ModelObject *object, const ModelVolume &other, TriangleMesh &&mesh) :
+        name(other.name), config(other.config), m_type(other.m_type), object(object), m_mesh(std::make_shared<TriangleMesh>(std::move(mesh))), m_convex_hull(std::make_shared<TriangleMesh>()), m_transformation(other.m_transformation)
     {
         this->set_material_id(other.material_id());
-        if (mesh.stl.stats.number_of_facets > 1)
+        if (m_mesh->stl.stats.number_of_facets > 1)
             calculate_convex_hull();
     }
 
@@ -30,7 +30,7 @@ std::string toString(const Model& model, bool holes = true) {
         for(auto objinst : objptr->instances) {
             if(!objinst) continue;
 
-            Slic3r::TriangleMesh tmpmesh = rmesh;
+            Slic3r::TriangleMesh tmpmesh = *rmesh;
             // CHECK_ME -> Is the following correct ?
             tmpmesh.scale(objinst->get_scaling_factor());
             objinst->transform_mesh(&tmpmesh);
@@ -90,7 +90,7 @@ void toSVG(SVG& svg, const Model& model) {
         for(auto objinst : objptr->instances) {
             if(!objinst) continue;
 
-            Slic3r::TriangleMesh tmpmesh = rmesh;
+            Slic3r::TriangleMesh tmpmesh = *rmesh;
             tmpmesh.scale(objinst->get_scaling_factor());
             objinst->transform_mesh(&tmpmesh);
             ExPolygons expolys = tmpmesh.horizontal_projection();
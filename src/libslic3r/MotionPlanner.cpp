@@ -36,6 +36,7 @@ void MotionPlanner::initialize()
         // we'll use these inner rings for motion planning (endpoints of the Voronoi-based
         // graph, visibility check) in order to avoid moving too close to the boundaries.
         island.m_env = ExPolygonCollection(offset_ex(island.m_island, -MP_INNER_MARGIN));
+        island.init_env_grown();
         // Island contours are holes of our external environment.
         outer_holes.push_back(island.m_island.contour);
     }
@@ -50,11 +51,33 @@ void MotionPlanner::initialize()
     // from Clipper data structure into the Slic3r expolygons inside diff_ex().
     m_outer = MotionPlannerEnv(outer.front());
     m_outer.m_env = ExPolygonCollection(diff_ex(contour, offset(outer_holes, +MP_OUTER_MARGIN)));
+    m_outer.init_env_grown();
     m_graphs.resize(m_islands.size() + 1);
     m_initialized = true;
 }
 
 Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
+{
+    // Limit the memory held by the memoized paths.
+    const size_t max_memoized_paths = 16384;
+    const std::pair<Point, Point> ends(from, to);
+    auto it = m_paths_map.find(ends);
+    if (it != m_paths_map.end()) {
+        m_paths.splice(m_paths.begin(), m_paths, it->second);
+        return it->second->second;
+    }
+    if (m_paths.size() >= max_memoized_paths) {
+        // Drop the least recently used path.
+        m_paths_map.erase(m_paths.back().first);
+        m_paths.pop_back();
+    }
+    Polyline polyline = this->plan_path(from, to);
+    m_paths.emplace_front(ends, polyline);
+    m_paths_map.emplace(ends, m_paths.begin());
+    return polyline;
+}
+
+Polyline MotionPlanner::plan_path(const Point &from, const Point &to)
 {
     // If we have an empty configuration space, return a straight move.
     if (m_islands.empty())
@@ -121,9 +144,8 @@ Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
     polyline.points.emplace_back(to);
     
     {
-        // grow our environment slightly in order for simplify_by_visibility()
-        // to work best by considering moves on boundaries valid as well
-        ExPolygonCollection grown_env(offset_ex(env.m_env.expolygons, float(+SCALED_EPSILON)));
+        // Our environment is grown slightly (env.m_env_grown) in order for simplify_by_visibility()
+        // to work best by considering moves on boundaries valid as well.
         
         if (island_idx == -1) {
             /*  If 'from' or 'to' are not inside our env, they were connected using the 
@@ -133,14 +155,14 @@ Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
                 grown_env (whose contour was arbitrarily constructed with MP_OUTER_MARGIN,
                 which may not be enough for, say, including a skirt point). So we prune
                 the extra points manually. */
-            if (! grown_env.contains(from)) {
+            if (! env.env_grown_contains(from)) {
                 // delete second point while the line connecting first to third crosses the
                 // boundaries as many times as the current first to second
-                while (polyline.points.size() > 2 && intersection_ln(Line(from, polyline.points[2]), grown_env).size() == 1)
+                while (polyline.points.size() > 2 && env.num_env_grown_pieces(Line(from, polyline.points[2])) == 1)
                     polyline.points.erase(polyline.points.begin() + 1);
             }
-            if (! grown_env.contains(to))
-                while (polyline.points.size() > 2 && intersection_ln(Line(*(polyline.points.end() - 3), to), grown_env).size() == 1)
+            if (! env.env_grown_contains(to))
+                while (polyline.points.size() > 2 && env.num_env_grown_pieces(Line(*(polyline.points.end() - 3), to)) == 1)
                     polyline.points.erase(polyline.points.end() - 2);
         }
 
@@ -291,6 +313,93 @@ Point MotionPlannerEnv::nearest_env_point(const Point &from, const Point &to) co
     return pp.empty() ? from : pp.front();
 }
 
+void MotionPlannerEnv::init_env_grown()
+{
+    m_env_grown = ExPolygonCollection(offset_ex(m_env.expolygons, float(+SCALED_EPSILON)));
+    m_env_grown_bboxes.clear();
+    for (const ExPolygon &expoly : m_env_grown.expolygons) {
+        m_env_grown_bboxes.emplace_back(get_extents(expoly.contour));
+        for (const Polygon &hole : expoly.holes)
+            m_env_grown_bboxes.emplace_back(get_extents(hole));
+    }
+}
+
+bool MotionPlannerEnv::env_grown_contains(const Point &pt) const
+{
+    const BoundingBox *bbox = m_env_grown_bboxes.data();
+    for (const ExPolygon &expoly : m_env_grown.expolygons) {
+        if (bbox->contains(pt) && expoly.contour.contains(pt)) {
+            ++ bbox;
+            for (const Polygon &hole : expoly.holes)
+                if ((bbox ++)->contains(pt) && hole.contains(pt))
+                    return false;
+            return true;
+        }
+        bbox += expoly.holes.size() + 1;
+    }
+    return false;
+}
+
+static inline int64_t cross2_int64(const Point &v1, const Point &v2)
+{
+    return int64_t(v1(0)) * int64_t(v2(1)) - int64_t(v1(1)) * int64_t(v2(0));
+}
+
+size_t MotionPlannerEnv::num_env_grown_pieces(const Line &line) const
+{
+    // Split the line at its intersections with the boundaries of m_env_grown, then classify the parts by their middle points.
+    // Only the contours and holes with their bounding boxes overlapping the line are visited, the others may be many.
+    const Point  v = line.b - line.a;
+    BoundingBox  bbox_line(Points { line.a, line.b });
+    std::vector<double> params { 0., 1. };
+    const BoundingBox *bbox = m_env_grown_bboxes.data();
+    for (const ExPolygon &expoly : m_env_grown.expolygons)
+        for (size_t i = 0; i <= expoly.holes.size(); ++ i, ++ bbox) {
+            if (! bbox_line.overlap(*bbox))
+                continue;
+            const Points &pts = (i == 0) ? expoly.contour.points : expoly.holes[i - 1].points;
+            for (size_t j = 0, k = pts.size() - 1; j < pts.size(); k = j ++) {
+                const Point &c = pts[k];
+                const Point &d = pts[j];
+                if (std::max(c(0), d(0)) < bbox_line.min(0) || std::min(c(0), d(0)) > bbox_line.max(0) ||
+                    std::max(c(1), d(1)) < bbox_line.min(1) || std::min(c(1), d(1)) > bbox_line.max(1))
+                    continue;
+                // Signed distances of c, d from the line and of the line end points from the edge.
+                int64_t dc = cross2_int64(v, c - line.a);
+                int64_t dd = cross2_int64(v, d - line.a);
+                if ((dc > 0 && dd > 0) || (dc < 0 && dd < 0))
+                    continue;
+                const Point w  = d - c;
+                int64_t     da = cross2_int64(w, line.a - c);
+                int64_t     db = cross2_int64(w, line.b - c);
+                if ((da > 0 && db > 0) || (da < 0 && db < 0))
+                    continue;
+                if (da != db)
+                    params.emplace_back(double(da) / double(da - db));
+                else if (v != Point(0, 0)) {
+                    // The edge is collinear with the line, split the line at the end points of the edge.
+                    double l2 = v.cast<double>().squaredNorm();
+                    params.emplace_back(std::min(1., std::max(0., (c - line.a).cast<double>().dot(v.cast<double>()) / l2)));
+                    params.emplace_back(std::min(1., std::max(0., (d - line.a).cast<double>().dot(v.cast<double>()) / l2)));
+                }
+            }
+        }
+    std::sort(params.begin(), params.end());
+    // Parts shorter than a unit of the scaled coordinates are ignored.
+    const double min_part = 1. / std::max(1., v.cast<double>().norm());
+    size_t num_pieces = 0;
+    bool   inside     = false;
+    for (size_t i = 1; i < params.size(); ++ i)
+        if (params[i] - params[i - 1] > min_part) {
+            double t = 0.5 * (params[i - 1] + params[i]);
+            bool   inside_this = this->env_grown_contains(Point(line.a(0) + coord_t(v(0) * t), line.a(1) + coord_t(v(1) * t)));
+            if (inside_this && ! inside)
+                ++ num_pieces;
+            inside = inside_this;
+        }
+    return num_pieces;
+}
+
 // Add a new directed edge to the adjacency graph.
 void MotionPlannerGraph::add_edge(size_t from, size_t to, double weight)
 {
@@ -304,7 +413,7 @@ void MotionPlannerGraph::add_edge(size_t from, size_t to, double weight)
     m_adjacency_list[from].emplace_back(Neighbor(node_t(to), weight));
 }
 
-// Dijkstra's shortest path in a weighted graph from node_start to node_end.
+// A* shortest path in a weighted graph from node_start to node_end.
 // The returned path contains the end points.
 // If no path exists from node_start to node_end, a straight segment is returned.
 Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) const
@@ -313,37 +422,49 @@ Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) c
     if (this->empty())
         return Polyline();
 
-    // Dijkstra algorithm, previous node of the current node 'u' in the shortest path towards node_start.
-    std::vector<node_t>   previous(m_adjacency_list.size(), -1);
-    std::vector<weight_t> distance(m_adjacency_list.size(), std::numeric_limits<weight_t>::infinity());
-    std::vector<size_t>   map_node_to_queue_id(m_adjacency_list.size(), size_t(-1));
+    // The nodes are expanded in the order of their distance from node_start plus their Euclidean distance to node_end.
+    // As the edge weights are Euclidean lengths of the edges, this estimate never exceeds the length of the shortest path
+    // through the node, therefore the path found is the shortest one, as with Dijkstra, while expanding much fewer nodes.
+    // Previous node of the current node 'u' in the shortest path towards node_start.
+    std::vector<node_t>   previous(m_nodes.size(), -1);
+    std::vector<weight_t> distance(m_nodes.size(), std::numeric_limits<weight_t>::infinity());
+    std::vector<weight_t> estimate(m_nodes.size(), std::numeric_limits<weight_t>::infinity());
+    // Index of a node in the queue, size_t(-1) if not queued yet, size_t(-2) if already expanded.
+    std::vector<size_t>   map_node_to_queue_id(m_nodes.size(), size_t(-1));
+    const size_t          expanded = size_t(-2);
+    const Vec2d           pt_end   = m_nodes[node_end].cast<double>();
     distance[node_start] = 0.;
+    estimate[node_start] = (pt_end - m_nodes[node_start].cast<double>()).norm();
 
     auto queue = make_mutable_priority_queue<node_t>(
         [&map_node_to_queue_id](const node_t node, size_t idx) { map_node_to_queue_id[node] = idx; },
-        [&distance](const node_t node1, const node_t node2) { return distance[node1] < distance[node2]; });
-    queue.reserve(m_adjacency_list.size());
-    for (size_t i = 0; i < m_adjacency_list.size(); ++ i)
-        queue.push(node_t(i));
+        [&estimate](const node_t node1, const node_t node2) { return estimate[node1] < estimate[node2]; });
+    queue.push(node_t(node_start));
 
     while (! queue.empty()) {
-        // Get the next node with the lowest distance to node_start.
+        // Get the next node with the lowest estimate of the path length from node_start to node_end.
         node_t u = node_t(queue.top());
         queue.pop();
-        map_node_to_queue_id[u] = size_t(-1);
+        map_node_to_queue_id[u] = expanded;
         // Stop searching if we reached our destination.
         if (u == node_end)
             break;
+        if (size_t(u) >= m_adjacency_list.size())
+            continue;
         // Visit each edge starting at node u.
         for (const Neighbor& neighbor : m_adjacency_list[u])
-            if (map_node_to_queue_id[neighbor.target] != size_t(-1)) {
+            if (map_node_to_queue_id[neighbor.target] != expanded) {
                 weight_t alt = distance[u] + neighbor.weight;
                 // If total distance through u is shorter than the previous
                 // distance (if any) between node_start and neighbor.target, replace it.
                 if (alt < distance[neighbor.target]) {
                     distance[neighbor.target] = alt;
+                    estimate[neighbor.target] = alt + (pt_end - m_nodes[neighbor.target].cast<double>()).norm();
                     previous[neighbor.target] = u;
-                    queue.update(map_node_to_queue_id[neighbor.target]);
+                    if (map_node_to_queue_id[neighbor.target] == size_t(-1))
+                        queue.push(neighbor.target);
+                    else
+                        queue.update(map_node_to_queue_id[neighbor.target]);
                 }
             }
     }
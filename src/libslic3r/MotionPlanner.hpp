@@ -6,7 +6,9 @@
 #include "ClipperUtils.hpp"
 #include "ExPolygonCollection.hpp"
 #include "Polyline.hpp"
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <utility>
 #include <memory>
 #include <vector>
@@ -30,15 +32,26 @@ public:
         { return m_island_bbox.contains(pt) && m_island.contains(pt); }
     bool  island_contains_b(const Point &pt) const
         { return m_island_bbox.contains(pt) && m_island.contains_b(pt); }
+    // Number of pieces of the line inside m_env_grown, the same as intersection_ln(line, m_env_grown).size()
+    // up to the degenerate cases of the line running along the boundary.
+    size_t num_env_grown_pieces(const Line &line) const;
 
 private:
+    // Initialize m_env_grown and m_env_grown_bboxes from m_env.
+    void                init_env_grown();
+    bool                env_grown_contains(const Point &pt) const;
+
     ExPolygon           m_island;
     BoundingBox         m_island_bbox;
     // Region, where the travel is allowed.
     ExPolygonCollection m_env;
+    // m_env grown by SCALED_EPSILON, so that the moves along its boundaries are considered inside.
+    ExPolygonCollection m_env_grown;
+    // Bounding boxes of the contours and holes of m_env_grown, in the order of to_polygons(m_env_grown).
+    std::vector<BoundingBox> m_env_grown_bboxes;
 };
 
-// A 2D directed graph for searching a shortest path using the famous Dijkstra algorithm.
+// A 2D directed graph for searching a shortest path using the A* algorithm.
 class MotionPlannerGraph
 {    
 public:
@@ -70,6 +83,9 @@ public:
     MotionPlanner(const ExPolygons &islands);
     ~MotionPlanner() {}
 
+    // The paths are memoized, as the travel moves are often repeated between the same end points,
+    // for example between the layers of the same islands. The least recently used paths are dropped
+    // when the memo is full.
     Polyline    shortest_path(const Point &from, const Point &to);
     size_t      islands_count() const { return m_islands.size(); }
 
@@ -79,7 +95,18 @@ private:
     MotionPlannerEnv                    m_outer;
     // 0th graph is the graph for m_outer. Other graphs are 1 indexed.
     std::vector<std::unique_ptr<MotionPlannerGraph>> m_graphs;
-    
+
+    struct PathEndsHash {
+        size_t operator()(const std::pair<Point, Point> &ends) const
+            { return PointHash()(ends.first) * 31 + PointHash()(ends.second); }
+    };
+    typedef std::list<std::pair<std::pair<Point, Point>, Polyline>> MemoizedPaths;
+    // Memoized results of shortest_path(), the most recently used first.
+    MemoizedPaths                       m_paths;
+    // Index into m_paths by the end points.
+    std::unordered_map<std::pair<Point, Point>, MemoizedPaths::iterator, PathEndsHash> m_paths_map;
+
+    Polyline                  plan_path(const Point &from, const Point &to);
     void                      initialize();
     const MotionPlannerGraph& init_graph(int island_idx);
     const MotionPlannerEnv&   get_env(int island_idx) const
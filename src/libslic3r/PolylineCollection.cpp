@@ -1,76 +1,46 @@
 #include "PolylineCollection.hpp"
+#include "ShortestPath.hpp"
 
 namespace Slic3r {
 
-struct Chaining
+// Order of the polylines in the chain and their reversal.
+static std::vector<std::pair<size_t, bool>> chain_polylines(const Polylines &src, Point start_near, bool no_reverse)
 {
-    Point first;
-    Point last;
-    size_t idx;
-};
-
-template<typename T>
-inline int nearest_point_index(const std::vector<Chaining> &pairs, const Point &start_near, bool no_reverse)
-{
-    T dmin = std::numeric_limits<T>::max();
-    int idx = 0;
-    for (std::vector<Chaining>::const_iterator it = pairs.begin(); it != pairs.end(); ++it) {
-        T d = sqr(T(start_near(0) - it->first(0)));
-        if (d <= dmin) {
-            d += sqr(T(start_near(1) - it->first(1)));
-            if (d < dmin) {
-                idx = (it - pairs.begin()) * 2;
-                dmin = d;
-                if (dmin < EPSILON)
-                    break;
-            }
-        }
-        if (! no_reverse) {
-            d = sqr(T(start_near(0) - it->last(0)));
-            if (d <= dmin) {
-                d += sqr(T(start_near(1) - it->last(1)));
-                if (d < dmin) {
-                    idx = (it - pairs.begin()) * 2 + 1;
-                    dmin = d;
-                    if (dmin < EPSILON)
-                        break;
-                }
-            }
-        }
+    Points endpoints;
+    endpoints.reserve(src.size() * 2);
+    for (const Polyline &polyline : src) {
+        endpoints.emplace_back(polyline.first_point());
+        endpoints.emplace_back(polyline.last_point());
     }
-    return idx;
+    return chain_segments(endpoints, start_near, no_reverse, ChainTieBreak::FirstIndex);
 }
 
 Polylines PolylineCollection::_chained_path_from(
     const Polylines &src,
     Point start_near,
-    bool  no_reverse, 
-    bool  move_from_src)
+    bool  no_reverse)
 {
-    std::vector<Chaining> endpoints;
-    endpoints.reserve(src.size());
-    for (size_t i = 0; i < src.size(); ++ i) {
-        Chaining c;
-        c.first = src[i].first_point();
-        if (! no_reverse)
-            c.last = src[i].last_point();
-        c.idx = i;
-        endpoints.push_back(c);
+    Polylines retval;
+    retval.reserve(src.size());
+    for (const std::pair<size_t, bool> &segment : chain_polylines(src, start_near, no_reverse)) {
+        retval.push_back(src[segment.first]);
+        if (segment.second)
+            retval.back().reverse();
     }
+    return retval;
+}
+
+Polylines PolylineCollection::_chained_path_from(
+    Polylines &&src,
+    Point start_near,
+    bool  no_reverse)
+{
     Polylines retval;
-    while (! endpoints.empty()) {
-        // find nearest point
-        int endpoint_index = nearest_point_index<double>(endpoints, start_near, no_reverse);
-        assert(endpoint_index >= 0 && endpoint_index < endpoints.size() * 2);
-        if (move_from_src) {
-            retval.push_back(std::move(src[endpoints[endpoint_index/2].idx]));
-        } else {
-            retval.push_back(src[endpoints[endpoint_index/2].idx]);
-        }
-        if (endpoint_index & 1)
+    retval.reserve(src.size());
+    for (const std::pair<size_t, bool> &segment : chain_polylines(src, start_near, no_reverse)) {
+        retval.push_back(std::move(src[segment.first]));
+        if (segment.second)
             retval.back().reverse();
-        endpoints.erase(endpoints.begin() + endpoint_index/2);
-        start_near = retval.back().last_point();
     }
     return retval;
 }
@@ -8,11 +8,16 @@ namespace Slic3r {
 
 class PolylineCollection
 {
+    // Copy the polylines from src.
     static Polylines _chained_path_from(
         const Polylines &src,
         Point start_near,
-        bool no_reverse, 
-        bool move_from_src);
+        bool no_reverse);
+    // Move the polylines from src.
+    static Polylines _chained_path_from(
+        Polylines &&src,
+        Point start_near,
+        bool no_reverse);
 
 public:
     Polylines polylines;
@@ -29,17 +34,17 @@ public:
 	static Polylines chained_path(Polylines &&src, bool no_reverse = false) {
         return (src.empty() || src.front().points.empty()) ?
             Polylines() :
-            _chained_path_from(src, src.front().first_point(), no_reverse, true);
+            _chained_path_from(std::move(src), src.front().first_point(), no_reverse);
     }
 	static Polylines chained_path_from(Polylines &&src, Point start_near, bool no_reverse = false)
-        { return _chained_path_from(src, start_near, no_reverse, true); }
+        { return _chained_path_from(std::move(src), start_near, no_reverse); }
     static Polylines chained_path(const Polylines &src, bool no_reverse = false) {
         return (src.empty() || src.front().points.empty()) ?
             Polylines() :
-            _chained_path_from(src, src.front().first_point(), no_reverse, false);
+            _chained_path_from(src, src.front().first_point(), no_reverse);
     }
     static Polylines chained_path_from(const Polylines &src, Point start_near, bool no_reverse = false)
-        { return _chained_path_from(src, start_near, no_reverse, false); }
+        { return _chained_path_from(src, start_near, no_reverse); }
 };
 
 }
@@ -18,6 +18,8 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/flow_graph.h>
+
 //! macro used to mark string used at localization, 
 //! return same string
 #define L(s) Slic3r::I18N::translate(s)
@@ -874,8 +876,7 @@ Print::ApplyStatus Print::apply(const Model &model, const DynamicPrintConfig &co
         bool support_enforcers_differ   = model_volume_list_changed(model_object, model_object_new, ModelVolumeType::SUPPORT_ENFORCER);
         if (model_parts_differ || modifiers_differ || 
             model_object.origin_translation         != model_object_new.origin_translation   ||
-            model_object.layer_height_ranges        != model_object_new.layer_height_ranges  || 
-            model_object.layer_height_profile       != model_object_new.layer_height_profile) {
+            model_object.layer_height_ranges        != model_object_new.layer_height_ranges) {
             // The very first step (the slicing step) is invalidated. One may freely remove all associated PrintObjects.
             auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
             for (auto it = range.first; it != range.second; ++ it) {
@@ -884,6 +885,19 @@ Print::ApplyStatus Print::apply(const Model &model, const DynamicPrintConfig &co
             }
             // Copy content of the ModelObject including its ID, do not change the parent.
             model_object.assign_copy(model_object_new);
+        } else if (model_object.layer_height_profile != model_object_new.layer_height_profile) {
+            // Just the layer height profile changed, typically by the variable layer height editor.
+            // The slicing step is invalidated, but the PrintObjects are kept, so that they may reuse the slices
+            // of the layers not affected by the change of the layer height profile.
+            // First stop background processing before modifying the ModelObject.
+            this->call_cancel_callback();
+            update_apply_status(false);
+            auto range = print_object_status.equal_range(PrintObjectStatus(model_object.id()));
+            for (auto it = range.first; it != range.second; ++ it)
+                update_apply_status(it->print_object->invalidate_all_steps());
+            model_object.layer_height_profile = model_object_new.layer_height_profile;
+            if (support_blockers_differ || support_enforcers_differ)
+                model_volume_list_update_supports(model_object, model_object_new);
         } else if (support_blockers_differ || support_enforcers_differ) {
             // First stop background processing before shuffling or deleting the ModelVolumes in the ModelObject's list.
             this->call_cancel_callback();
@@ -1489,17 +1503,56 @@ void Print::auto_assign_extruders(ModelObject* model_object) const
     }
 }
 
+void Print::set_object_status(int percent, const std::string &message)
+{
+    tbb::mutex::scoped_lock lock(m_object_status_mutex);
+    if (percent > m_object_status_percent) {
+        m_object_status_percent = percent;
+        this->set_status(percent, message);
+    }
+}
+
 // Slicing process, running at a background thread.
 void Print::process()
 {
     BOOST_LOG_TRIVIAL(info) << "Staring the slicing process." << log_memory_info();
-    for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
-    this->set_status(70, L("Infilling layers"));
-    for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+    m_object_status_percent = 0;
+    {
+        // A task graph with a node per PrintObject and step. The steps of a single object are chained,
+        // the objects are processed concurrently, so that for example the support material of one object
+        // is generated while another object is being infilled. Each step parallelizes over the layers of its object,
+        // the nested parallelism is scheduled by TBB.
+        // The steps keep entering and leaving their states with set_started() / set_done(). An exception thrown
+        // by a step (including the CanceledException) cancels the graph and it is rethrown by wait_for_all().
+        typedef tbb::flow::continue_node<tbb::flow::continue_msg> StepNode;
+        tbb::flow::graph                        graph;
+        std::vector<std::unique_ptr<StepNode>>  nodes;
+        std::vector<StepNode*>                  roots;
+        for (PrintObject *obj : m_objects) {
+            StepNode *prev = nullptr;
+            auto add_step = [&graph, &nodes, &roots, &prev](std::function<void()> step) {
+                nodes.emplace_back(new StepNode(graph, [step](const tbb::flow::continue_msg&) -> tbb::flow::continue_msg { step(); return tbb::flow::continue_msg(); }));
+                if (prev == nullptr)
+                    roots.emplace_back(nodes.back().get());
+                else
+                    tbb::flow::make_edge(*prev, *nodes.back());
+                prev = nodes.back().get();
+            };
+            add_step([obj]() { obj->slice(); });
+            add_step([obj]() { obj->make_perimeters(); });
+            add_step([obj]() { obj->prepare_infill(); });
+            add_step([this, obj]() {
+                if (! obj->is_step_done(posInfill))
+                    this->set_object_status(70, L("Infilling layers"));
+                obj->infill();
+            });
+            // The support generator uses the surface types, the bridging perimeters and the bridging infill of its object.
+            add_step([obj]() { obj->generate_support_material(); });
+        }
+        for (StepNode *root : roots)
+            root->try_put(tbb::flow::continue_msg());
+        graph.wait_for_all();
+    }
     if (this->set_started(psSkirt)) {
         m_skirt.clear();
         if (this->has_skirt()) {
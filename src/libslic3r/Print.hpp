@@ -174,6 +174,10 @@ private:
     void generate_support_material();
 
     void _slice(const std::vector<coordf_t> &layer_height_profile);
+    // Key of the persistent slice cache, see SliceCache.hpp: A hash of everything the posSlice step depends on.
+    std::string _slice_cache_key(const std::vector<coordf_t> &layer_height_profile) const;
+    // Replace the layers with the layers stored in the slice cache under the key. Returns false on cache miss.
+    bool _load_slices_from_cache(const std::string &key);
     std::string _fix_slicing_errors();
     void _simplify_slices(double distance);
     void _make_perimeters();
@@ -201,7 +205,29 @@ private:
     LayerPtrs                               m_layers;
     SupportLayerPtrs                        m_support_layers;
 
+    // Raw slices of a set of volumes sliced together, retained from the last _slice() call while the layer height profile
+    // is being edited, so that only the layers with a changed slice_z are sliced again.
+    // The profile is considered being edited if it differs from the profile of the previous _slice() call.
+    struct RetainedSlices {
+        std::vector<ModelID>    volume_ids;
+        float                   closing_radius;
+        Point                   copies_shift;
+        // Sorted slice_z.
+        std::vector<float>      zs;
+        std::vector<ExPolygons> layers;
+    };
+    // Slices produced by the current _slice() call.
+    std::vector<RetainedSlices>             m_retained_slices;
+    // Slices produced by the previous _slice() call, consumed by the current _slice() call.
+    std::vector<RetainedSlices>             m_retained_slices_prev;
+    // Layer height profile of the last _slice() call, to detect the editing of the profile.
+    std::vector<coordf_t>                   m_layer_height_profile_sliced;
+    // Whether the current _slice() call retains its slices.
+    bool                                    m_retain_slices = false;
+
     std::vector<ExPolygons> _slice_region(size_t region_id, const std::vector<float> &z, bool modifier);
+    // Slice the volumes at z, reuse the layers retained from the previous _slice() call at the same slice_z.
+    std::vector<ExPolygons> _slice_volumes_retained(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes);
     std::vector<ExPolygons> _slice_volumes(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes) const;
     std::vector<ExPolygons> _slice_volume(const std::vector<float> &z, const ModelVolume &volume) const;
 };
@@ -297,9 +323,17 @@ public:
     bool                apply_config_perl_tests_only(DynamicPrintConfig config);
 
     void                process() override;
+    // Status update of the PrintObject steps, which run concurrently in process(). Only a status with a percentage
+    // higher than the last one reported is passed to set_status(), so that the progress does not jump back
+    // when an object enters a step, which another object has already finished.
+    void                set_object_status(int percent, const std::string &message);
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string &path_template, GCodePreviewData *preview_data);
+    // Store the sliced layers of the objects into a directory and reuse them when slicing the same objects again,
+    // see SliceCache.hpp. The cache is disabled if the path is empty (the default).
+    void                set_slice_cache_dir(const std::string &dir) { m_slice_cache_dir = dir; }
+    const std::string&  slice_cache_dir() const { return m_slice_cache_dir; }
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -389,9 +423,16 @@ private:
     // Following section will be consumed by the GCodeGenerator.
     WipeTowerData                           m_wipe_tower_data;
 
+    // Directory of the persistent slice cache, empty if disabled.
+    std::string                             m_slice_cache_dir;
+
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // Last percentage reported by set_object_status() during process().
+    tbb::mutex                              m_object_status_mutex;
+    int                                     m_object_status_percent = 0;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
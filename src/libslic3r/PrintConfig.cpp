@@ -2297,6 +2297,21 @@ void PrintConfigDef::init_sla_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloat(50.));
 
+    def = this->add("png_filter", coEnum);
+    def->label = L("Scanline filter");
+    def->full_label = L("Layer image scanline filter");
+    def->tooltip = L("PNG filter applied to the rows of the layer images before the compression. "
+                     "The anti-aliased masks usually compress best without a filter.");
+    def->enum_keys_map = &ConfigOptionEnum<SLAPNGFilter>::get_enum_values();
+    def->enum_values.push_back("none");
+    def->enum_values.push_back("sub");
+    def->enum_values.push_back("up");
+    def->enum_labels.push_back(L("None"));
+    def->enum_labels.push_back(L("Sub"));
+    def->enum_labels.push_back(L("Up"));
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionEnum<SLAPNGFilter>(slapngfNone));
+
     def = this->add("relative_correction", coFloats);
     def->label = L("Printer scaling correction");
     def->full_label = L("Printer scaling correction");
@@ -3151,6 +3166,12 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("slice_cache", coString);
+    def->label = L("Slice cache directory");
+    def->tooltip = L("Store the sliced layers of the objects into the given directory and reuse them when the same objects "
+                     "are sliced again with the same slicing parameters. This is useful for slicing the same models repeatedly "
+                     "with a couple of configuration variants.");
+
     def = this->add("loglevel", coInt);
     def->label = L("Logging level");
     def->tooltip = L("Messages with severity lower or eqal to the loglevel will be printed out. 0:trace, 1:debug, 2:info, 3:warning, 4:error, 5:fatal");
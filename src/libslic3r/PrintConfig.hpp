@@ -57,6 +57,12 @@ enum SLADisplayOrientation {
     sladoPortrait
 };
 
+enum SLAPNGFilter {
+    slapngfNone,
+    slapngfSub,
+    slapngfUp
+};
+
 enum SLAPillarConnectionMode {
     slapcmZigZag,
     slapcmCross,
@@ -166,6 +172,16 @@ template<> inline const t_config_enum_values& ConfigOptionEnum<SLADisplayOrienta
     return keys_map;
 }
 
+template<> inline const t_config_enum_values& ConfigOptionEnum<SLAPNGFilter>::get_enum_values() {
+    static const t_config_enum_values keys_map = {
+        { "none", slapngfNone},
+        { "sub",  slapngfSub},
+        { "up",   slapngfUp}
+    };
+
+    return keys_map;
+}
+
 template<> inline const t_config_enum_values& ConfigOptionEnum<SLAPillarConnectionMode>::get_enum_values() {
     static const t_config_enum_values keys_map = {
         {"zigzag", slapcmZigZag},
@@ -1089,6 +1105,7 @@ public:
     ConfigOptionFloat                       fast_tilt_time;
     ConfigOptionFloat                       slow_tilt_time;
     ConfigOptionFloat                       area_fill;
+    ConfigOptionEnum<SLAPNGFilter>          png_filter;
 protected:
     void initialize(StaticCacheBase &cache, const char *base_ptr)
     {
@@ -1106,6 +1123,7 @@ protected:
         OPT_PTR(fast_tilt_time);
         OPT_PTR(slow_tilt_time);
         OPT_PTR(area_fill);
+        OPT_PTR(png_filter);
     }
 };
 
@@ -10,6 +10,8 @@
 #include <boost/filesystem/path.hpp>
 
 #include "Rasterizer/Rasterizer.hpp"
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
 //#include <tbb/parallel_for.h>
 //#include <tbb/spin_mutex.h>//#include "tbb/mutex.h"
 
@@ -116,7 +118,8 @@ public:
 
 // Implementation for PNG raster output
 // Be aware that if a large number of layers are allocated, it can very well
-// exhaust the available memory especially on 32 bit platform.
+// exhaust the available memory especially on 32 bit platform. Use
+// save_streamed() instead of allocating the layers to avoid that.
 template<> class FilePrinter<FilePrinterFormat::SLA_PNGZIP>
 {
     struct Layer {
@@ -140,6 +143,13 @@ template<> class FilePrinter<FilePrinterFormat::SLA_PNGZIP>
     Raster::Origin m_o = Raster::Origin::TOP_LEFT;
     double m_gamma;
 
+    // The layers are mostly empty, the run-length encoded rasterizer does not
+    // waste time on the empty areas. It produces the same pixels as AGG.
+    Raster::Backend m_backend = Raster::Backend::RLE;
+
+    // Compression level and scanline filter of the layer images.
+    Raster::PNGOptions m_png_opts;
+
     double m_used_material = 0.0;
     int    m_cnt_fade_layers = 0;
     int    m_cnt_slow_layers = 0;
@@ -216,6 +226,8 @@ public:
         m_res(m.m_res),
         m_pxdim(m.m_pxdim) {}
 
+    inline void png_options(const Raster::PNGOptions& opts) { m_png_opts = opts; }
+
     inline void layers(unsigned cnt) { if(cnt > 0) m_layers_rst.resize(cnt); }
     inline unsigned layers() const { return unsigned(m_layers_rst.size()); }
 
@@ -231,25 +243,25 @@ public:
 
     inline void begin_layer(unsigned lyr) {
         if(m_layers_rst.size() <= lyr) m_layers_rst.resize(lyr+1);
-        m_layers_rst[lyr].raster.reset(m_res, m_pxdim, m_o, m_gamma);
+        m_layers_rst[lyr].raster.reset(m_res, m_pxdim, m_o, m_gamma, m_backend);
     }
 
     inline void begin_layer() {
         m_layers_rst.emplace_back();
-        m_layers_rst.front().raster.reset(m_res, m_pxdim, m_o, m_gamma);
+        m_layers_rst.front().raster.reset(m_res, m_pxdim, m_o, m_gamma, m_backend);
     }
 
     inline void finish_layer(unsigned lyr_id) {
         assert(lyr_id < m_layers_rst.size());
         m_layers_rst[lyr_id].rawbytes =
-                m_layers_rst[lyr_id].raster.save(Raster::Compression::PNG);
+                m_layers_rst[lyr_id].raster.save(Raster::Compression::PNG, m_png_opts);
         m_layers_rst[lyr_id].raster.reset();
     }
 
     inline void finish_layer() {
         if(!m_layers_rst.empty()) {
             m_layers_rst.back().rawbytes =
-                    m_layers_rst.back().raster.save(Raster::Compression::PNG);
+                    m_layers_rst.back().raster.save(Raster::Compression::PNG, m_png_opts);
             m_layers_rst.back().raster.reset();
         }
     }
@@ -291,6 +303,92 @@ public:
         }
     }
 
+    // Rasterize the layers and save them into the file specified in the path
+    // argument without allocating them in the printer. The layers are drawn
+    // by draw_layer(Raster&, unsigned layer_id) and compressed to PNG by
+    // a pool of workers in parallel, while the finished layers are written
+    // into the archive in order. At most max_layers_in_flight layers are
+    // held in memory at any time (twice the number of the worker threads
+    // if zero), therefore the peak memory does not depend on the number of
+    // the layers. The archive is the same as written by save() with the
+    // layers drawn by the same draw_layer() calls.
+    // throw_if_canceled() is called before drawing each layer, the exception
+    // it throws stops the pipeline and it is rethrown to the caller.
+    // on_layer_written(unsigned layers_written) reports the progress from
+    // the writing stage.
+    template<class LyrFmt, class DrawFn, class CancelFn, class StatusFn>
+    inline void save_streamed(const std::string& fpath,
+                              const std::string& prjname,
+                              unsigned layer_count,
+                              DrawFn draw_layer,
+                              CancelFn throw_if_canceled,
+                              StatusFn on_layer_written,
+                              size_t max_layers_in_flight = 0)
+    {
+        try {
+            LayerWriter<LyrFmt> writer(fpath);
+            if(!writer.is_ok()) return;
+
+            std::string project = prjname.empty()?
+                       boost::filesystem::path(fpath).stem().string() : prjname;
+
+            writer.next_entry("config.ini");
+            if(!writer.is_ok()) return;
+
+            writer << createIniContent(project);
+
+            if(max_layers_in_flight == 0) max_layers_in_flight =
+                    2 * size_t(tbb::task_scheduler_init::default_num_threads());
+
+            struct StreamedLayer {
+                unsigned id;
+                RawBytes rawbytes;
+
+                StreamedLayer(unsigned i, RawBytes&& b):
+                    id(i), rawbytes(std::move(b)) {}
+
+                // FIXME: needed for MSVC2013 compatibility
+                StreamedLayer(StreamedLayer&& m):
+                    id(m.id), rawbytes(std::move(m.rawbytes)) {}
+            };
+
+            unsigned next_layer = 0;
+            tbb::parallel_pipeline(max_layers_in_flight,
+                tbb::make_filter<void, unsigned>(tbb::filter::serial_in_order,
+                    [&next_layer, layer_count](tbb::flow_control &fc) -> unsigned
+                {
+                    if(next_layer >= layer_count) { fc.stop(); return 0u; }
+                    return next_layer++;
+                }) &
+                tbb::make_filter<unsigned, StreamedLayer>(tbb::filter::parallel,
+                    [this, &draw_layer, &throw_if_canceled](unsigned lyr) -> StreamedLayer
+                {
+                    throw_if_canceled();
+                    Raster raster(m_res, m_pxdim, m_o, m_gamma, m_backend);
+                    draw_layer(raster, lyr);
+                    return StreamedLayer(lyr, raster.save(Raster::Compression::PNG, m_png_opts));
+                }) &
+                tbb::make_filter<StreamedLayer, void>(tbb::filter::serial_in_order,
+                    [&writer, &project, &on_layer_written](const StreamedLayer &lyr)
+                {
+                    if(lyr.rawbytes.size() > 0 && writer.is_ok()) {
+                        char lyrnum[6];
+                        std::sprintf(lyrnum, "%.5d", lyr.id);
+                        writer.binary_entry(project + lyrnum + ".png",
+                                            lyr.rawbytes.data(),
+                                            lyr.rawbytes.size());
+                    }
+                    on_layer_written(lyr.id + 1);
+                }));
+
+            writer.finalize();
+        } catch(std::exception& e) {
+            BOOST_LOG_TRIVIAL(error) << e.what();
+            // Rethrow the exception
+            throw;
+        }
+    }
+
     void save_layer(unsigned lyr, const std::string& path) {
         unsigned i = lyr;
         assert(i < m_layers_rst.size());
@@ -301,7 +399,7 @@ public:
 
         std::fstream out(loc, std::fstream::out | std::fstream::binary);
         if(out.good()) {
-            m_layers_rst[i].raster.save(out, Raster::Compression::PNG);
+            m_layers_rst[i].raster.save(out, Raster::Compression::PNG, m_png_opts);
         } else {
             BOOST_LOG_TRIVIAL(error) << "Can't create file for layer";
         }
@@ -3,6 +3,7 @@
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
 #include "I18N.hpp"
+#include "SliceCache.hpp"
 #include "SupportMaterial.hpp"
 #include "Surface.hpp"
 #include "Slicing.hpp"
@@ -107,10 +108,19 @@ void PrintObject::slice()
 {
     if (! this->set_started(posSlice))
         return;
-    m_print->set_status(10, L("Processing triangulated mesh"));
+    m_print->set_object_status(10, L("Processing triangulated mesh"));
     std::vector<coordf_t> layer_height_profile;
     this->update_layer_height_profile(*this->model_object(), m_slicing_params, layer_height_profile);
     m_print->throw_if_canceled();
+    std::string cache_key;
+    if (! m_print->slice_cache_dir().empty()) {
+        // Persistent slice cache is enabled, see SliceCache.hpp.
+        cache_key = this->_slice_cache_key(layer_height_profile);
+        if (this->_load_slices_from_cache(cache_key)) {
+            this->set_done(posSlice);
+            return;
+        }
+    }
     this->_slice(layer_height_profile);
     m_print->throw_if_canceled();
     // Fix the model.
@@ -124,6 +134,8 @@ void PrintObject::slice()
         this->_simplify_slices(scale_(this->print()->config().resolution));
     if (m_layers.empty())
         throw std::runtime_error("No layers were detected. You might want to repair your STL file(s) or check their size or thickness and retry.\n");    
+    if (! cache_key.empty())
+        slice_cache_store(m_print->slice_cache_dir(), cache_key, m_layers);
     this->set_done(posSlice);
 }
 
@@ -138,7 +150,7 @@ void PrintObject::make_perimeters()
     if (! this->set_started(posPerimeters))
         return;
 
-    m_print->set_status(20, L("Generating perimeters"));
+    m_print->set_object_status(20, L("Generating perimeters"));
     BOOST_LOG_TRIVIAL(info) << "Generating perimeters..." << log_memory_info();
     
     // merge slices if they were split into types
@@ -171,8 +183,7 @@ void PrintObject::make_perimeters()
                     LayerRegion &layerm                     = *m_layers[layer_idx]->m_regions[region_id];
                     const LayerRegion &upper_layerm         = *m_layers[layer_idx+1]->m_regions[region_id];
                     const Polygons upper_layerm_polygons    = upper_layerm.slices;
-                    // Filter upper layer polygons in intersection_ppl by their bounding boxes?
-                    // my $upper_layerm_poly_bboxes= [ map $_->bounding_box, @{$upper_layerm_polygons} ];
+                    const Polylines upper_layerm_polylines  = to_polylines(upper_layerm_polygons);
                     const double total_loop_length      = total_length(upper_layerm_polygons);
                     const coord_t perimeter_spacing     = layerm.flow(frPerimeter).scaled_spacing();
                     const Flow ext_perimeter_flow       = layerm.flow(frExternalPerimeter);
@@ -191,8 +202,9 @@ void PrintObject::make_perimeters()
                                 offset(slice.expolygon, float(- perimeters_thickness)),
                                 offset(slice.expolygon, float(- perimeters_thickness - critical_area_depth))
                             );
-                            // check whether a portion of the upper slices falls inside the critical area
-                            const Polylines intersection = intersection_pl(to_polylines(upper_layerm_polygons), critical_area);
+                            // check whether a portion of the upper slices falls inside the critical area,
+                            // the upper slices are filtered by the bounding box of the critical area
+                            const Polylines intersection = intersection_pl_bbox(upper_layerm_polylines, critical_area);
                             // only add an additional loop if at least 30% of the slice loop would benefit from it
                             if (total_length(intersection) <=  total_loop_length*0.3)
                                 break;
@@ -248,7 +260,7 @@ void PrintObject::prepare_infill()
     if (! this->set_started(posPrepareInfill))
         return;
 
-    m_print->set_status(30, L("Preparing infill"));
+    m_print->set_object_status(30, L("Preparing infill"));
 
     // This will assign a type (top/bottom/internal) to $layerm->slices.
     // Then the classifcation of $layerm->slices is transfered onto 
@@ -388,7 +400,7 @@ void PrintObject::generate_support_material()
     if (this->set_started(posSupportMaterial)) {
         this->clear_support_layers();
         if ((m_config.support_material || m_config.raft_layers > 0) && m_layers.size() > 1) {
-            m_print->set_status(85, L("Generating support material"));    
+            m_print->set_object_status(85, L("Generating support material"));    
             this->_generate_support_material();
             m_print->throw_if_canceled();
         } else {
@@ -1229,111 +1241,138 @@ void PrintObject::bridge_over_infill()
             -1,     // custom width, not relevant for bridge flow
             *this
         );
-        
-		for (LayerPtrs::iterator layer_it = m_layers.begin(); layer_it != m_layers.end(); ++ layer_it) {
+
+        // The bridges of a layer are detected over the stInternal surfaces of the layers below, while the bridges
+        // replace the stInternalSolid surfaces. To process the layers in parallel, the bridges are detected first
+        // for all the layers, and only then the fill_surfaces are updated.
+        struct BridgeOverInfill {
+            bool        valid = false;
+            ExPolygons  to_bridge;
+            ExPolygons  not_to_bridge;
+        };
+        std::vector<BridgeOverInfill> bridges(m_layers.size());
+
+        BOOST_LOG_TRIVIAL(debug) << "Bridge over infill for region " << region_id << " in parallel - start : detect";
+        tbb::parallel_for(
             // skip first layer
-			if (layer_it == m_layers.begin())
-                continue;
-            
-            Layer* layer        = *layer_it;
-            LayerRegion* layerm = layer->m_regions[region_id];
-            
-            // extract the stInternalSolid surfaces that might be transformed into bridges
-            Polygons internal_solid;
-            layerm->fill_surfaces.filter_by_type(stInternalSolid, &internal_solid);
-            
-            // check whether the lower area is deep enough for absorbing the extra flow
-            // (for obvious physical reasons but also for preventing the bridge extrudates
-            // from overflowing in 3D preview)
-            ExPolygons to_bridge;
-            {
-                Polygons to_bridge_pp = internal_solid;
-                
-                // iterate through lower layers spanned by bridge_flow
-                double bottom_z = layer->print_z - bridge_flow.height;
-                for (int i = int(layer_it - m_layers.begin()) - 1; i >= 0; --i) {
-                    const Layer* lower_layer = m_layers[i];
-                    
-                    // stop iterating if layer is lower than bottom_z
-                    if (lower_layer->print_z < bottom_z) break;
+            tbb::blocked_range<size_t>(1, std::max(m_layers.size(), size_t(1))),
+            [this, region_id, &bridge_flow, &bridges](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    m_print->throw_if_canceled();
+                    const Layer       *layer  = m_layers[layer_idx];
+                    const LayerRegion *layerm = layer->m_regions[region_id];
                     
-                    // iterate through regions and collect internal surfaces
-                    Polygons lower_internal;
-                    for (LayerRegion *lower_layerm : lower_layer->m_regions)
-                        lower_layerm->fill_surfaces.filter_by_type(stInternal, &lower_internal);
+                    // extract the stInternalSolid surfaces that might be transformed into bridges
+                    Polygons internal_solid;
+                    layerm->fill_surfaces.filter_by_type(stInternalSolid, &internal_solid);
                     
-                    // intersect such lower internal surfaces with the candidate solid surfaces
-                    to_bridge_pp = intersection(to_bridge_pp, lower_internal);
-                }
-                
-                // there's no point in bridging too thin/short regions
-                //FIXME Vojtech: The offset2 function is not a geometric offset, 
-                // therefore it may create 1) gaps, and 2) sharp corners, which are outside the original contour.
-                // The gaps will be filled by a separate region, which makes the infill less stable and it takes longer.
-                {
-                    float min_width = float(bridge_flow.scaled_width()) * 3.f;
-                    to_bridge_pp = offset2(to_bridge_pp, -min_width, +min_width);
-                }
-                
-                if (to_bridge_pp.empty()) continue;
-                
-                // convert into ExPolygons
-                to_bridge = union_ex(to_bridge_pp);
-            }
-            
-            #ifdef SLIC3R_DEBUG
-            printf("Bridging " PRINTF_ZU " internal areas at layer " PRINTF_ZU "\n", to_bridge.size(), layer->id());
-            #endif
-            
-            // compute the remaning internal solid surfaces as difference
-            ExPolygons not_to_bridge = diff_ex(internal_solid, to_polygons(to_bridge), true);
-            to_bridge = intersection_ex(to_polygons(to_bridge), internal_solid, true);
-            // build the new collection of fill_surfaces
-            layerm->fill_surfaces.remove_type(stInternalSolid);
-            for (ExPolygon &ex : to_bridge)
-                layerm->fill_surfaces.surfaces.push_back(Surface(stInternalBridge, ex));
-            for (ExPolygon &ex : not_to_bridge)
-                layerm->fill_surfaces.surfaces.push_back(Surface(stInternalSolid, ex));            
-            /*
-            # exclude infill from the layers below if needed
-            # see discussion at https://github.com/alexrj/Slic3r/issues/240
-            # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
-            if (0) {
-                my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
-                for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
-                    Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
-                    foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
-                        my @new_surfaces = ();
-                        # subtract the area from all types of surfaces
-                        foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
-                            push @new_surfaces, map $group->[0]->clone(expolygon => $_),
-                                @{diff_ex(
-                                    [ map $_->p, @$group ],
-                                    [ map @$_, @$to_bridge ],
-                                )};
-                            push @new_surfaces, map Slic3r::Surface->new(
-                                expolygon       => $_,
-                                surface_type    => S_TYPE_INTERNALVOID,
-                            ), @{intersection_ex(
-                                [ map $_->p, @$group ],
-                                [ map @$_, @$to_bridge ],
-                            )};
+                    // check whether the lower area is deep enough for absorbing the extra flow
+                    // (for obvious physical reasons but also for preventing the bridge extrudates
+                    // from overflowing in 3D preview)
+                    ExPolygons to_bridge;
+                    {
+                        Polygons to_bridge_pp = internal_solid;
+                        
+                        // iterate through lower layers spanned by bridge_flow
+                        double bottom_z = layer->print_z - bridge_flow.height;
+                        for (int i = int(layer_idx) - 1; i >= 0; --i) {
+                            const Layer* lower_layer = m_layers[i];
+                            
+                            // stop iterating if layer is lower than bottom_z
+                            if (lower_layer->print_z < bottom_z) break;
+                            
+                            // iterate through regions and collect internal surfaces
+                            Polygons lower_internal;
+                            for (LayerRegion *lower_layerm : lower_layer->m_regions)
+                                lower_layerm->fill_surfaces.filter_by_type(stInternal, &lower_internal);
+                            
+                            // intersect such lower internal surfaces with the candidate solid surfaces
+                            to_bridge_pp = intersection(to_bridge_pp, lower_internal);
+                        }
+                        
+                        // there's no point in bridging too thin/short regions
+                        //FIXME Vojtech: The offset2 function is not a geometric offset, 
+                        // therefore it may create 1) gaps, and 2) sharp corners, which are outside the original contour.
+                        // The gaps will be filled by a separate region, which makes the infill less stable and it takes longer.
+                        {
+                            float min_width = float(bridge_flow.scaled_width()) * 3.f;
+                            to_bridge_pp = offset2(to_bridge_pp, -min_width, +min_width);
                         }
-                        $lower_layerm->fill_surfaces->clear;
-                        $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
+                        
+                        if (to_bridge_pp.empty()) continue;
+                        
+                        // convert into ExPolygons
+                        to_bridge = union_ex(to_bridge_pp);
                     }
                     
-                    $excess -= $self->get_layer($i)->height;
+                    #ifdef SLIC3R_DEBUG
+                    printf("Bridging " PRINTF_ZU " internal areas at layer " PRINTF_ZU "\n", to_bridge.size(), layer->id());
+                    #endif
+                    
+                    // compute the remaning internal solid surfaces as difference
+                    BridgeOverInfill &out = bridges[layer_idx];
+                    out.valid         = true;
+                    out.not_to_bridge = diff_ex(internal_solid, to_polygons(to_bridge), true);
+                    out.to_bridge     = intersection_ex(to_polygons(to_bridge), internal_solid, true);
                 }
-            }
-            */
+            });
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Bridge over infill for region " << region_id << " in parallel - end : detect";
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, region_id, &bridges](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    BridgeOverInfill &bridge = bridges[layer_idx];
+                    if (! bridge.valid)
+                        continue;
+                    LayerRegion *layerm = m_layers[layer_idx]->m_regions[region_id];
+                    // build the new collection of fill_surfaces
+                    layerm->fill_surfaces.remove_type(stInternalSolid);
+                    for (ExPolygon &ex : bridge.to_bridge)
+                        layerm->fill_surfaces.surfaces.push_back(Surface(stInternalBridge, std::move(ex)));
+                    for (ExPolygon &ex : bridge.not_to_bridge)
+                        layerm->fill_surfaces.surfaces.push_back(Surface(stInternalSolid, std::move(ex)));
+                    /*
+                    # exclude infill from the layers below if needed
+                    # see discussion at https://github.com/alexrj/Slic3r/issues/240
+                    # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
+                    if (0) {
+                        my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
+                        for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
+                            Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
+                            foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
+                                my @new_surfaces = ();
+                                # subtract the area from all types of surfaces
+                                foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
+                                    push @new_surfaces, map $group->[0]->clone(expolygon => $_),
+                                        @{diff_ex(
+                                            [ map $_->p, @$group ],
+                                            [ map @$_, @$to_bridge ],
+                                        )};
+                                    push @new_surfaces, map Slic3r::Surface->new(
+                                        expolygon       => $_,
+                                        surface_type    => S_TYPE_INTERNALVOID,
+                                    ), @{intersection_ex(
+                                        [ map $_->p, @$group ],
+                                        [ map @$_, @$to_bridge ],
+                                    )};
+                                }
+                                $lower_layerm->fill_surfaces->clear;
+                                $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
+                            }
+                            
+                            $excess -= $self->get_layer($i)->height;
+                        }
+                    }
+                    */
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-            layerm->export_region_slices_to_svg_debug("7_bridge_over_infill");
-            layerm->export_region_fill_surfaces_to_svg_debug("7_bridge_over_infill");
+                    layerm->export_region_slices_to_svg_debug("7_bridge_over_infill");
+                    layerm->export_region_fill_surfaces_to_svg_debug("7_bridge_over_infill");
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
-            m_print->throw_if_canceled();
-        }
+                }
+            });
     }
 }
 
@@ -1461,6 +1500,16 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
     tbb_init = new tbb::task_scheduler_init(1);
 #endif
 
+    // The slices retained by the previous call are consumed by this call. Retain the new slices only while
+    // the layer height profile is being edited, as the next change of the profile is likely a local one.
+    // Retaining the slices costs a copy of them, therefore a profile loaded with the model or generated from
+    // the layer height ranges does not retain the slices until it is edited.
+    m_retained_slices_prev.clear();
+    m_retained_slices_prev.swap(m_retained_slices);
+    m_retain_slices = ! this->model_object()->layer_height_profile.empty() && 
+        ! m_layer_height_profile_sliced.empty() && m_layer_height_profile_sliced != layer_height_profile;
+    m_layer_height_profile_sliced = layer_height_profile;
+
     // 1) Initialize layers and their slice heights.
     std::vector<float> slice_zs;
     {
@@ -1547,7 +1596,7 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
 				if (model_volume->is_model_part()) {
 					BOOST_LOG_TRIVIAL(debug) << "Slicing objects - volume " << volume_id;
                     // slicing in parallel
-					sliced_volumes.emplace_back(volume_id, map_volume_to_region[volume_id], this->_slice_volume(slice_zs, *model_volume));
+					sliced_volumes.emplace_back(volume_id, map_volume_to_region[volume_id], this->_slice_volumes_retained(slice_zs, { model_volume }));
 				}
 			}
         // Second clip the volumes in the order they are presented at the user interface.
@@ -1637,6 +1686,9 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
         }
     }
     
+    // Retained slices of volumes, which were not sliced by this call, are no more valid.
+    m_retained_slices_prev.clear();
+
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - removing top empty layers";
     while (! m_layers.empty()) {
         const Layer *layer = m_layers.back();
@@ -1752,6 +1804,77 @@ end:
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - make_slices in parallel - end";
 }
 
+std::string PrintObject::_slice_cache_key(const std::vector<coordf_t> &layer_height_profile) const
+{
+    SliceCacheHasher hasher;
+    // Invalidate the cache entries produced by the other versions of the slicer.
+    hasher.update(std::string(SLIC3R_VERSION));
+    // The layers to be sliced, see _slice().
+    std::vector<coordf_t> object_layers = generate_object_layers(m_slicing_params, layer_height_profile);
+    hasher.update(uint64_t(object_layers.size()));
+    hasher.update(object_layers.data(), object_layers.size() * sizeof(coordf_t));
+    hasher.update(uint64_t(m_slicing_params.raft_layers()));
+    hasher.update(m_slicing_params.object_print_z_min);
+    // The transformed meshes of the volumes and their assignment to regions, see _slice_volumes().
+    hasher.update(m_trafo.matrix().eval());
+    hasher.update(m_copies_shift);
+    hasher.update(uint64_t(this->region_volumes.size()));
+    for (const std::vector<int> &volumes : this->region_volumes) {
+        hasher.update(uint64_t(volumes.size()));
+        for (int volume_id : volumes) {
+            const ModelVolume  *volume = this->model_object()->volumes[volume_id];
+            const TriangleMesh &mesh   = volume->mesh();
+            hasher.update(int(volume->type()));
+            hasher.update(volume->get_matrix().matrix().eval());
+            hasher.update(mesh.repaired);
+            hasher.update(uint64_t(mesh.stl.stats.number_of_facets));
+            for (const stl_facet *facet = mesh.stl.facet_start; facet < mesh.stl.facet_start + mesh.stl.stats.number_of_facets; ++ facet)
+                hasher.update(facet->vertex, sizeof(facet->vertex));
+        }
+    }
+    // The options invalidating posSlice, see invalidate_state_by_config_options().
+    for (const char *opt_key : { "layer_height", "first_layer_height", "raft_layers", "slice_closing_radius",
+                                 "clip_multipart_objects", "elefant_foot_compensation", "support_material_contact_distance", "xy_size_compensation" })
+        hasher.update(m_config.serialize(opt_key));
+    // Simplification of the slices in slice().
+    hasher.update(m_print->config().resolution.value);
+    if (m_config.elefant_foot_compensation.value > 0. && object_layers.size() >= 2) {
+        // The elephant foot compensation depends on the external perimeter flow of the 1st layer.
+        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
+            const PrintRegion *region = m_print->regions()[region_id];
+            Flow flow = region->flow(frExternalPerimeter, object_layers[1] - object_layers[0], false, m_slicing_params.raft_layers() == 0, -1, *this);
+            hasher.update(flow.scaled_elephant_foot_spacing());
+            hasher.update(m_print->config().nozzle_diameter.get_at(region->config().perimeter_extruder.value - 1));
+        }
+    }
+    return hasher.digest();
+}
+
+bool PrintObject::_load_slices_from_cache(const std::string &key)
+{
+    std::vector<SliceCacheLayer> layers;
+    if (! slice_cache_load(m_print->slice_cache_dir(), key, this->region_volumes.size(), layers) || layers.empty())
+        return false;
+    BOOST_LOG_TRIVIAL(info) << "Slicing objects - loaded " << layers.size() << " layers from the slice cache";
+    this->typed_slices = false;
+    m_retained_slices.clear();
+    m_retained_slices_prev.clear();
+    this->clear_layers();
+    Layer *prev = nullptr;
+    for (SliceCacheLayer &cached : layers) {
+        Layer *layer = this->add_layer(int(cached.id), cached.height, cached.print_z, cached.slice_z);
+        if (prev != nullptr) {
+            prev->upper_layer = layer;
+            layer->lower_layer = prev;
+        }
+        for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id)
+            layer->add_region(this->print()->regions()[region_id])->slices.append(std::move(cached.region_slices[region_id]), stInternal);
+        layer->slices.expolygons = std::move(cached.slices);
+        prev = layer;
+    }
+    return true;
+}
+
 std::vector<ExPolygons> PrintObject::_slice_region(size_t region_id, const std::vector<float> &z, bool modifier)
 {
     std::vector<const ModelVolume*> volumes;
@@ -1762,7 +1885,62 @@ std::vector<ExPolygons> PrintObject::_slice_region(size_t region_id, const std::
                 volumes.emplace_back(volume);
         }
     }
-    return this->_slice_volumes(z, volumes);
+    return this->_slice_volumes_retained(z, volumes);
+}
+
+std::vector<ExPolygons> PrintObject::_slice_volumes_retained(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes)
+{
+    if (volumes.empty())
+        return std::vector<ExPolygons>();
+
+    RetainedSlices key;
+    key.volume_ids.reserve(volumes.size());
+    for (const ModelVolume *volume : volumes)
+        key.volume_ids.emplace_back(volume->id());
+    key.closing_radius = float(m_config.slice_closing_radius.value);
+    key.copies_shift   = m_copies_shift;
+    auto it_retained = std::find_if(m_retained_slices_prev.begin(), m_retained_slices_prev.end(), [&key](const RetainedSlices &rs) 
+        { return rs.volume_ids == key.volume_ids && rs.closing_radius == key.closing_radius && rs.copies_shift == key.copies_shift; });
+
+    // Reuse the layers sliced at the same Z by the previous call, collect the remaining Z coordinates.
+    std::vector<ExPolygons> layers(z.size());
+    std::vector<float>      z_missing;
+    std::vector<size_t>     idx_missing;
+    if (it_retained == m_retained_slices_prev.end()) {
+        z_missing = z;
+    } else {
+        auto it_z = it_retained->zs.begin();
+        for (size_t i = 0; i < z.size(); ++ i) {
+            it_z = std::lower_bound(it_z, it_retained->zs.end(), z[i]);
+            if (it_z != it_retained->zs.end() && *it_z == z[i])
+                layers[i] = std::move(it_retained->layers[it_z - it_retained->zs.begin()]);
+            else {
+                z_missing.emplace_back(z[i]);
+                idx_missing.emplace_back(i);
+            }
+        }
+        BOOST_LOG_TRIVIAL(debug) << "Slicing objects - reusing " << (z.size() - z_missing.size()) << " retained layers out of " << z.size();
+        // The retained layers were moved out.
+        m_retained_slices_prev.erase(it_retained);
+    }
+
+    if (! z_missing.empty()) {
+        std::vector<ExPolygons> sliced = (volumes.size() == 1) ? this->_slice_volume(z_missing, *volumes.front()) : this->_slice_volumes(z_missing, volumes);
+        if (idx_missing.empty()) {
+            if (sliced.size() == z.size())
+                layers = std::move(sliced);
+        } else {
+            for (size_t i = 0; i < sliced.size(); ++ i)
+                layers[idx_missing[i]] = std::move(sliced[i]);
+        }
+    }
+
+    if (m_retain_slices) {
+        key.zs     = z;
+        key.layers = layers;
+        m_retained_slices.emplace_back(std::move(key));
+    }
+    return layers;
 }
 
 std::vector<ExPolygons> PrintObject::slice_support_enforcers() const
@@ -1797,7 +1975,7 @@ std::vector<ExPolygons> PrintObject::_slice_volumes(const std::vector<float> &z,
     if (! volumes.empty()) {
         // Compose mesh.
         //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-		TriangleMesh mesh(volumes.front()->mesh);
+		TriangleMesh mesh(volumes.front()->mesh());
         mesh.transform(volumes.front()->get_matrix(), true);
 		assert(mesh.repaired);
 		if (volumes.size() == 1 && mesh.repaired) {
@@ -1806,7 +1984,7 @@ std::vector<ExPolygons> PrintObject::_slice_volumes(const std::vector<float> &z,
 		}
         for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
             const ModelVolume &model_volume = *volumes[idx_volume];
-            TriangleMesh vol_mesh(model_volume.mesh);
+            TriangleMesh vol_mesh(model_volume.mesh());
             vol_mesh.transform(model_volume.get_matrix(), true);
             mesh.merge(vol_mesh);
         }
@@ -1819,6 +1997,9 @@ std::vector<ExPolygons> PrintObject::_slice_volumes(const std::vector<float> &z,
             const Print *print = this->print();
             auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
             mesh.require_shared_vertices(); // TriangleMeshSlicer needs this
+            // Sweep the sorted facets, so that only the facets close to the slicing planes are visited
+            // when just the layers affected by a local change of the layer height profile are sliced.
+            mslicer.set_sweep(true);
             mslicer.init(&mesh, callback);
 			mslicer.slice(z, float(m_config.slice_closing_radius.value), &layers, callback);
             m_print->throw_if_canceled();
@@ -1832,7 +2013,7 @@ std::vector<ExPolygons> PrintObject::_slice_volume(const std::vector<float> &z,
     std::vector<ExPolygons> layers;
     // Compose mesh.
     //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-    TriangleMesh mesh(volume.mesh);
+    TriangleMesh mesh(volume.mesh());
     mesh.transform(volume.get_matrix(), true);
 	if (mesh.repaired) {
 		//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
@@ -1847,6 +2028,7 @@ std::vector<ExPolygons> PrintObject::_slice_volume(const std::vector<float> &z,
         const Print *print = this->print();
         auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
         mesh.require_shared_vertices(); // TriangleMeshSlicer needs this
+        mslicer.set_sweep(true);
         mslicer.init(&mesh, callback);
         mslicer.slice(z, float(m_config.slice_closing_radius.value), &layers, callback);
         m_print->throw_if_canceled();
@@ -1992,8 +2174,7 @@ void PrintObject::_make_perimeters()
                     LayerRegion &layerm                     = *m_layers[layer_idx]->regions()[region_id];
                     const LayerRegion &upper_layerm         = *m_layers[layer_idx+1]->regions()[region_id];
                     const Polygons upper_layerm_polygons    = upper_layerm.slices;
-                    // Filter upper layer polygons in intersection_ppl by their bounding boxes?
-                    // my $upper_layerm_poly_bboxes= [ map $_->bounding_box, @{$upper_layerm_polygons} ];
+                    const Polylines upper_layerm_polylines  = to_polylines(upper_layerm_polygons);
                     const double total_loop_length      = total_length(upper_layerm_polygons);
                     const coord_t perimeter_spacing     = layerm.flow(frPerimeter).scaled_spacing();
                     const Flow ext_perimeter_flow       = layerm.flow(frExternalPerimeter);
@@ -2012,8 +2193,9 @@ void PrintObject::_make_perimeters()
                                 offset(slice.expolygon, float(- perimeters_thickness)),
                                 offset(slice.expolygon, float(- perimeters_thickness - critical_area_depth))
                             );
-                            // check whether a portion of the upper slices falls inside the critical area
-                            const Polylines intersection = intersection_pl(to_polylines(upper_layerm_polygons), critical_area);
+                            // check whether a portion of the upper slices falls inside the critical area,
+                            // the upper slices are filtered by the bounding box of the critical area
+                            const Polylines intersection = intersection_pl_bbox(upper_layerm_polylines, critical_area);
                             // only add an additional loop if at least 30% of the slice loop would benefit from it
                             if (total_length(intersection) <=  total_loop_length*0.3)
                                 break;
@@ -2152,176 +2334,244 @@ void PrintObject::discover_horizontal_shells()
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
     
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
-        for (int i = 0; i < int(m_layers.size()); ++ i) {
-            m_print->throw_if_canceled();
-            LayerRegion             *layerm = m_layers[i]->regions()[region_id];
-            const PrintRegionConfig &region_config = layerm->region()->config();
-            if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
-                (i % region_config.solid_infill_every_layers) == 0) {
-                // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
-                SurfaceType type = (region_config.fill_density == 100) ? stInternalSolid : stInternalBridge;
-                for (Surface &surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == stInternal)
-                        surface.surface_type = type;
-            }
+        const PrintRegionConfig &region_config = m_print->regions()[region_id]->config();
+        // Insert a solid internal layer every solid_infill_every_layers. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
+        auto              solid_infill_layer = [&region_config](int idx_layer) {
+            return region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
+                   (idx_layer % region_config.solid_infill_every_layers) == 0;
+        };
+        const SurfaceType solid_infill_type  = (region_config.fill_density == 100) ? stInternalSolid : stInternalBridge;
+        auto              insert_solid_infill = [solid_infill_type](LayerRegion *layerm) {
+            for (Surface &surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == stInternal)
+                    surface.surface_type = solid_infill_type;
+        };
 
-            // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
-            if (region_config.ensure_vertical_shell_thickness.value)
-                continue;
-            
-            for (int idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
-                m_print->throw_if_canceled();
-                SurfaceType type = (idx_surface_type == 0) ? stTop : (idx_surface_type == 1) ? stBottom : stBottomBridge;
-                // Find slices of current type for current layer.
-                // Use slices instead of fill_surfaces, because they also include the perimeter area,
-                // which needs to be propagated in shells; we need to grow slices like we did for
-                // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
-                // not work in some situations, as there won't be any grown region in the perimeter 
-                // area (this was seen in a model where the top layer had one extra perimeter, thus
-                // its fill_surfaces were thinner than the lower layer's infill), however it's the best
-                // solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
-                // too much solid infill inside nearly-vertical slopes.
-
-                // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
-                // (not covered by a layer above / below).
-                // This does not contain the areas covered by perimeters!
-                Polygons solid;
-                for (const Surface &surface : layerm->slices.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                // Infill areas (slices without the perimeters).
-                for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                if (solid.empty())
-                    continue;
-//                Slic3r::debugf "Layer %d has %s surfaces\n", $i, ($type == S_TYPE_TOP) ? 'top' : 'bottom';
-                
-                size_t solid_layers = (type == stTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;                
-                for (int n = (type == stTop) ? i-1 : i+1; std::abs(n - i) < solid_layers; (type == stTop) ? -- n : ++ n) {
-                    if (n < 0 || n >= int(m_layers.size()))
-                        continue;
-//                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;                  
-                    // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
-                    LayerRegion *neighbor_layerm = m_layers[n]->regions()[region_id];
-                    
-                    // find intersection between neighbor and current layer's surfaces
-                    // intersections have contours and holes
-                    // we update $solid so that we limit the next neighbor layer to the areas that were
-                    // found on this one - in other words, solid shells on one layer (for a given external surface)
-                    // are always a subset of the shells found on the previous shell layer
-                    // this approach allows for DWIM in hollow sloping vases, where we want bottom
-                    // shells to be generated in the base but not in the walls (where there are many
-                    // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
-                    // upper perimeter as an obstacle and shell will not be propagated to more upper layers
-                    //FIXME How does it work for S_TYPE_INTERNALBRIDGE? This is set for sparse infill. Likely this does not work.
-                    Polygons new_internal_solid;
-                    {
-                        Polygons internal;
-                        for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                            if (surface.surface_type == stInternal || surface.surface_type == stInternalSolid)
-                                polygons_append(internal, to_polygons(surface.expolygon));
-                        new_internal_solid = intersection(solid, internal, true);
-                    }
-                    if (new_internal_solid.empty()) {
-                        // No internal solid needed on this layer. In order to decide whether to continue
-                        // searching on the next neighbor (thus enforcing the configured number of solid
-                        // layers, use different strategies according to configured infill density:
-                        if (region_config.fill_density.value == 0) {
-                            // If user expects the object to be void (for example a hollow sloping vase),
-                            // don't continue the search. In this case, we only generate the external solid
-                            // shell if the object would otherwise show a hole (gap between perimeters of 
-                            // the two layers), and internal solid shells are a subset of the shells found 
-                            // on each previous layer.
-                            goto EXTERNAL;
-                        } else {
-                            // If we have internal infill, we can generate internal solid shells freely.
+        // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
+        if (region_config.ensure_vertical_shell_thickness.value) {
+            if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0)
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, m_layers.size()),
+                    [this, region_id, &solid_infill_layer, &insert_solid_infill](const tbb::blocked_range<size_t>& range) {
+                        for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer)
+                            if (solid_infill_layer(int(idx_layer)))
+                                insert_solid_infill(m_layers[idx_layer]->regions()[region_id]);
+                    });
+            continue;
+        }
+
+        // The shells are discovered in two passes, so that the layers may be processed in parallel with a deterministic result:
+        // First the internal solid shells of the top / bottom surfaces are collected while the fill_surfaces are only read,
+        // then each layer merges the shells found for it by its neighbors into its fill_surfaces.
+        // Only the stInternal surfaces of a layer are turned into stInternalSolid by the shells, so the union
+        // of the stInternal and stInternalSolid surfaces the shells are clipped with does not change between the passes.
+        struct Shell {
+            // Layer receiving the shell.
+            int         idx_layer;
+            Polygons    polygons;
+        };
+        // Shells indexed by the layer of the top / bottom surface they were created for.
+        std::vector<std::vector<Shell>> shells(m_layers.size());
+
+        BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - start : collect shells";
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, region_id, &region_config, &solid_infill_layer, solid_infill_type, &shells](const tbb::blocked_range<size_t>& range) {
+                for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
+                    const int          i      = int(idx_layer);
+                    const LayerRegion *layerm = m_layers[i]->regions()[region_id];
+                    for (int idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
+                        m_print->throw_if_canceled();
+                        SurfaceType type = (idx_surface_type == 0) ? stTop : (idx_surface_type == 1) ? stBottom : stBottomBridge;
+                        // Find slices of current type for current layer.
+                        // Use slices instead of fill_surfaces, because they also include the perimeter area,
+                        // which needs to be propagated in shells; we need to grow slices like we did for
+                        // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
+                        // not work in some situations, as there won't be any grown region in the perimeter 
+                        // area (this was seen in a model where the top layer had one extra perimeter, thus
+                        // its fill_surfaces were thinner than the lower layer's infill), however it's the best
+                        // solution so far. Growing the external slices by EXTERNAL_INFILL_MARGIN will put
+                        // too much solid infill inside nearly-vertical slopes.
+
+                        // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
+                        // (not covered by a layer above / below).
+                        // This does not contain the areas covered by perimeters!
+                        Polygons solid;
+                        for (const Surface &surface : layerm->slices.surfaces)
+                            if (surface.surface_type == type)
+                                polygons_append(solid, to_polygons(surface.expolygon));
+                        // Infill areas (slices without the perimeters).
+                        for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                            if (surface.surface_type == type)
+                                polygons_append(solid, to_polygons(surface.expolygon));
+                        if (solid.empty())
                             continue;
-                        }
-                    }
-                    
-                    if (region_config.fill_density.value == 0) {
-                        // if we're printing a hollow object we discard any solid shell thinner
-                        // than a perimeter width, since it's probably just crossing a sloping wall
-                        // and it's not wanted in a hollow print even if it would make sense when
-                        // obeying the solid shell count option strictly (DWIM!)
-                        float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
-                        Polygons too_narrow = diff(
-                            new_internal_solid, 
-                            offset2(new_internal_solid, -margin, +margin, jtMiter, 5), 
-                            true);
-                        // Trim the regularized region by the original region.
-                        if (! too_narrow.empty())
-                            new_internal_solid = solid = diff(new_internal_solid, too_narrow);
-                    }
+                        
+                        size_t solid_layers = (type == stTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;
+                        for (int n = (type == stTop) ? i-1 : i+1; std::abs(n - i) < solid_layers; (type == stTop) ? -- n : ++ n) {
+                            if (n < 0 || n >= int(m_layers.size()))
+                                continue;
+                            // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
+                            const LayerRegion *neighbor_layerm = m_layers[n]->regions()[region_id];
+                            // The layers are processed from the bottom up, therefore the sparse infill of a solid infill layer
+                            // below a TOP surface has already been turned into a bridge, while the solid infill layers above
+                            // a BOTTOM surface receive their shells first.
+                            bool sparse_infill = ! (type == stTop && solid_infill_type == stInternalBridge && solid_infill_layer(n));
+                            
+                            // find intersection between neighbor and current layer's surfaces
+                            // intersections have contours and holes
+                            // we update $solid so that we limit the next neighbor layer to the areas that were
+                            // found on this one - in other words, solid shells on one layer (for a given external surface)
+                            // are always a subset of the shells found on the previous shell layer
+                            // this approach allows for DWIM in hollow sloping vases, where we want bottom
+                            // shells to be generated in the base but not in the walls (where there are many
+                            // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
+                            // upper perimeter as an obstacle and shell will not be propagated to more upper layers
+                            //FIXME How does it work for S_TYPE_INTERNALBRIDGE? This is set for sparse infill. Likely this does not work.
+                            Polygons new_internal_solid;
+                            {
+                                Polygons internal;
+                                for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                                    if ((surface.surface_type == stInternal && sparse_infill) || surface.surface_type == stInternalSolid)
+                                        polygons_append(internal, to_polygons(surface.expolygon));
+                                new_internal_solid = intersection(solid, internal, true);
+                            }
+                            if (new_internal_solid.empty()) {
+                                // No internal solid needed on this layer. In order to decide whether to continue
+                                // searching on the next neighbor (thus enforcing the configured number of solid
+                                // layers, use different strategies according to configured infill density:
+                                if (region_config.fill_density.value == 0) {
+                                    // If user expects the object to be void (for example a hollow sloping vase),
+                                    // don't continue the search. In this case, we only generate the external solid
+                                    // shell if the object would otherwise show a hole (gap between perimeters of 
+                                    // the two layers), and internal solid shells are a subset of the shells found 
+                                    // on each previous layer.
+                                    break;
+                                } else {
+                                    // If we have internal infill, we can generate internal solid shells freely.
+                                    continue;
+                                }
+                            }
+                            
+                            if (region_config.fill_density.value == 0) {
+                                // if we're printing a hollow object we discard any solid shell thinner
+                                // than a perimeter width, since it's probably just crossing a sloping wall
+                                // and it's not wanted in a hollow print even if it would make sense when
+                                // obeying the solid shell count option strictly (DWIM!)
+                                float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
+                                Polygons too_narrow = diff(
+                                    new_internal_solid, 
+                                    offset2(new_internal_solid, -margin, +margin, jtMiter, 5), 
+                                    true);
+                                // Trim the regularized region by the original region.
+                                if (! too_narrow.empty())
+                                    new_internal_solid = solid = diff(new_internal_solid, too_narrow);
+                            }
 
-                    // make sure the new internal solid is wide enough, as it might get collapsed
-                    // when spacing is added in Fill.pm
-                    {
-                        //FIXME Vojtech: Disable this and you will be sorry.
-                        // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
-                        float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
-                        // we use a higher miterLimit here to handle areas with acute angles
-                        // in those cases, the default miterLimit would cut the corner and we'd
-                        // get a triangle in $too_narrow; if we grow it below then the shell
-                        // would have a different shape from the external surface and we'd still
-                        // have the same angle, so the next shell would be grown even more and so on.
-                        Polygons too_narrow = diff(
-                            new_internal_solid,
-                            offset2(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
-                            true);
-                        if (! too_narrow.empty()) {
-                            // grow the collapsing parts and add the extra area to  the neighbor layer 
-                            // as well as to our original surfaces so that we support this 
-                            // additional area in the next shell too
-                            // make sure our grown surfaces don't exceed the fill area
-                            Polygons internal;
-                            for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                                if (surface.is_internal() && !surface.is_bridge())
-                                    polygons_append(internal, to_polygons(surface.expolygon));
-                            polygons_append(new_internal_solid, 
-                                intersection(
-                                    offset(too_narrow, +margin),
-                                    // Discard bridges as they are grown for anchoring and we can't
-                                    // remove such anchors. (This may happen when a bridge is being 
-                                    // anchored onto a wall where little space remains after the bridge
-                                    // is grown, and that little space is an internal solid shell so 
-                                    // it triggers this too_narrow logic.)
-                                    internal));
-                            solid = new_internal_solid;
+                            // make sure the new internal solid is wide enough, as it might get collapsed
+                            // when spacing is added in Fill.pm
+                            {
+                                //FIXME Vojtech: Disable this and you will be sorry.
+                                // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
+                                float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
+                                // we use a higher miterLimit here to handle areas with acute angles
+                                // in those cases, the default miterLimit would cut the corner and we'd
+                                // get a triangle in $too_narrow; if we grow it below then the shell
+                                // would have a different shape from the external surface and we'd still
+                                // have the same angle, so the next shell would be grown even more and so on.
+                                Polygons too_narrow = diff(
+                                    new_internal_solid,
+                                    offset2(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
+                                    true);
+                                if (! too_narrow.empty()) {
+                                    // grow the collapsing parts and add the extra area to  the neighbor layer 
+                                    // as well as to our original surfaces so that we support this 
+                                    // additional area in the next shell too
+                                    // make sure our grown surfaces don't exceed the fill area
+                                    Polygons internal;
+                                    for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                                        if (surface.is_internal() && !surface.is_bridge() && (surface.surface_type != stInternal || sparse_infill))
+                                            polygons_append(internal, to_polygons(surface.expolygon));
+                                    polygons_append(new_internal_solid, 
+                                        intersection(
+                                            offset(too_narrow, +margin),
+                                            // Discard bridges as they are grown for anchoring and we can't
+                                            // remove such anchors. (This may happen when a bridge is being 
+                                            // anchored onto a wall where little space remains after the bridge
+                                            // is grown, and that little space is an internal solid shell so 
+                                            // it triggers this too_narrow logic.)
+                                            internal));
+                                    solid = new_internal_solid;
+                                }
+                            }
+
+                            shells[i].push_back({ n, std::move(new_internal_solid) });
                         }
-                    }
-                    
-                    // internal-solid are the union of the existing internal-solid surfaces
-                    // and new ones
-                    SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
-                    polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stInternalSolid)));
-                    ExPolygons internal_solid = union_ex(new_internal_solid, false);
-                    // assign new internal-solid surfaces to layer
-                    neighbor_layerm->fill_surfaces.set(internal_solid, stInternalSolid);
-                    // subtract intersections from layer surfaces to get resulting internal surfaces
-                    Polygons polygons_internal = to_polygons(std::move(internal_solid));
-                    ExPolygons internal = diff_ex(
-                        to_polygons(backup.filter_by_type(stInternal)),
-                        polygons_internal,
-                        true);
-                    // assign resulting internal surfaces to layer
-                    neighbor_layerm->fill_surfaces.append(internal, stInternal);
-                    polygons_append(polygons_internal, to_polygons(std::move(internal)));
-                    // assign top and bottom surfaces to layer
-                    SurfaceType surface_types_solid[] = { stTop, stBottom, stBottomBridge };
-                    backup.keep_types(surface_types_solid, 3);
-                    std::vector<SurfacesPtr> top_bottom_groups;
-                    backup.group(&top_bottom_groups);
-                    for (SurfacesPtr &group : top_bottom_groups)
-                        neighbor_layerm->fill_surfaces.append(
-                            diff_ex(to_polygons(group), polygons_internal),
-                            // Use an existing surface as a template, it carries the bridge angle etc.
-                            *group.front());
+                    } // foreach type (stTop, stBottom, stBottomBridge)
+                } // for each layer
+            });
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - end : collect shells";
+
+        BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - start : merge shells";
+        auto merge_shells = [](LayerRegion *layerm, Polygons &&new_internal_solid) {
+            if (new_internal_solid.empty())
+                return;
+            // internal-solid are the union of the existing internal-solid surfaces
+            // and new ones
+            SurfaceCollection backup = std::move(layerm->fill_surfaces);
+            polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stInternalSolid)));
+            ExPolygons internal_solid = union_ex(new_internal_solid, false);
+            // assign new internal-solid surfaces to layer
+            layerm->fill_surfaces.set(internal_solid, stInternalSolid);
+            // subtract intersections from layer surfaces to get resulting internal surfaces
+            Polygons polygons_internal = to_polygons(std::move(internal_solid));
+            ExPolygons internal = diff_ex(
+                to_polygons(backup.filter_by_type(stInternal)),
+                polygons_internal,
+                true);
+            // assign resulting internal surfaces to layer
+            layerm->fill_surfaces.append(internal, stInternal);
+            polygons_append(polygons_internal, to_polygons(std::move(internal)));
+            // assign top and bottom surfaces to layer
+            SurfaceType surface_types_solid[] = { stTop, stBottom, stBottomBridge };
+            backup.keep_types(surface_types_solid, 3);
+            std::vector<SurfacesPtr> top_bottom_groups;
+            backup.group(&top_bottom_groups);
+            for (SurfacesPtr &group : top_bottom_groups)
+                layerm->fill_surfaces.append(
+                    diff_ex(to_polygons(group), polygons_internal),
+                    // Use an existing surface as a template, it carries the bridge angle etc.
+                    *group.front());
+        };
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, region_id, &region_config, &solid_infill_layer, &insert_solid_infill, &merge_shells, &shells](const tbb::blocked_range<size_t>& range) {
+                for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
+                    m_print->throw_if_canceled();
+                    const int    n      = int(idx_layer);
+                    LayerRegion *layerm = m_layers[n]->regions()[region_id];
+                    // Collect the shells of the BOTTOM surfaces below and of the TOP surfaces above this layer,
+                    // in the order of the source layers.
+                    auto collect_shells = [n, &shells](int i_begin, int i_end) {
+                        Polygons out;
+                        for (int i = i_begin; i < i_end; ++ i)
+                            for (const Shell &shell : shells[i])
+                                if (shell.idx_layer == n)
+                                    polygons_append(out, shell.polygons);
+                        return out;
+                    };
+                    // Replicate the order of the bottom up loop over the layers: The shells of the BOTTOM surfaces below
+                    // this layer are merged first, then the sparse infill of a solid infill layer is turned into solid infill,
+                    // then the shells of the TOP surfaces above this layer are merged.
+                    merge_shells(layerm, collect_shells(std::max(0, n - region_config.bottom_solid_layers.value), n));
+                    if (solid_infill_layer(n))
+                        insert_solid_infill(layerm);
+                    merge_shells(layerm, collect_shells(n + 1, std::min(int(m_layers.size()), n + region_config.top_solid_layers.value + 1)));
                 }
-		EXTERNAL:;
-            } // foreach type (stTop, stBottom, stBottomBridge)
-        } // for each layer
+            });
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Discovering horizontal shells for region " << region_id << " in parallel - end : merge shells";
     } // for each region
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
@@ -2379,71 +2629,79 @@ void PrintObject::combine_infill()
         }
         
         // loop through layers to which we have assigned layers to combine
-        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
-            m_print->throw_if_canceled();
-            size_t num_layers = combine[layer_idx];
-			if (num_layers <= 1)
-                continue;
-            // Get all the LayerRegion objects to be combined.
-            std::vector<LayerRegion*> layerms;
-            layerms.reserve(num_layers);
-			for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
-                layerms.emplace_back(m_layers[i]->regions()[region_id]);
-            // We need to perform a multi-layer intersection, so let's split it in pairs.
-            // Initialize the intersection with the candidates of the lowest layer.
-            ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stInternal));
-            // Start looping from the second layer and intersect the current intersection with it.
-            for (size_t i = 1; i < layerms.size(); ++ i)
-                intersection = intersection_ex(
-                    to_polygons(intersection),
-                    to_polygons(layerms[i]->fill_surfaces.filter_by_type(stInternal)),
-                    false);
-            double area_threshold = layerms.front()->infill_area_threshold();
-            if (! intersection.empty() && area_threshold > 0.)
-                intersection.erase(std::remove_if(intersection.begin(), intersection.end(), 
-                    [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }), 
-                    intersection.end());
-            if (intersection.empty())
-                continue;
+        // The combined layer ranges do not overlap, thus they are processed in parallel.
+        BOOST_LOG_TRIVIAL(debug) << "Combining infill for region " << region_id << " in parallel - start";
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, region, region_id, &combine](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    m_print->throw_if_canceled();
+                    size_t num_layers = combine[layer_idx];
+			        if (num_layers <= 1)
+                        continue;
+                    // Get all the LayerRegion objects to be combined.
+                    std::vector<LayerRegion*> layerms;
+                    layerms.reserve(num_layers);
+			        for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
+                        layerms.emplace_back(m_layers[i]->regions()[region_id]);
+                    // We need to perform a multi-layer intersection, so let's split it in pairs.
+                    // Initialize the intersection with the candidates of the lowest layer.
+                    ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stInternal));
+                    // Start looping from the second layer and intersect the current intersection with it.
+                    for (size_t i = 1; i < layerms.size(); ++ i)
+                        intersection = intersection_ex(
+                            to_polygons(intersection),
+                            to_polygons(layerms[i]->fill_surfaces.filter_by_type(stInternal)),
+                            false);
+                    double area_threshold = layerms.front()->infill_area_threshold();
+                    if (! intersection.empty() && area_threshold > 0.)
+                        intersection.erase(std::remove_if(intersection.begin(), intersection.end(), 
+                            [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }), 
+                            intersection.end());
+                    if (intersection.empty())
+                        continue;
 //            Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
 //                scalar(@$intersection),
 //                ($type == S_TYPE_INTERNAL ? 'internal' : 'internal-solid'),
 //                $layer_idx-($every-1), $layer_idx;
-            // intersection now contains the regions that can be combined across the full amount of layers,
-            // so let's remove those areas from all layers.
-            Polygons intersection_with_clearance;
-            intersection_with_clearance.reserve(intersection.size());
-            float clearance_offset = 
-                0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
-             // Because fill areas for rectilinear and honeycomb are grown 
-             // later to overlap perimeters, we need to counteract that too.
-                ((region->config().fill_pattern == ipRectilinear   ||
-                  region->config().fill_pattern == ipGrid          ||
-                  region->config().fill_pattern == ipLine          ||
-                  region->config().fill_pattern == ipHoneycomb) ? 1.5f : 0.5f) * 
-                    layerms.back()->flow(frSolidInfill).scaled_width();
-            for (ExPolygon &expoly : intersection)
-                polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
-            for (LayerRegion *layerm : layerms) {
-                Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stInternal));
-                layerm->fill_surfaces.remove_type(stInternal);
-                layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stInternal);
-                if (layerm == layerms.back()) {
-                    // Apply surfaces back with adjusted depth to the uppermost layer.
-                    Surface templ(stInternal, ExPolygon());
-                    templ.thickness = 0.;
-                    for (LayerRegion *layerm2 : layerms)
-                        templ.thickness += layerm2->layer()->height;
-                    templ.thickness_layers = (unsigned short)layerms.size();
-                    layerm->fill_surfaces.append(intersection, templ);
-                } else {
-                    // Save void surfaces.
-                    layerm->fill_surfaces.append(
-                        intersection_ex(internal, intersection_with_clearance, false),
-                        stInternalVoid);
+                    // intersection now contains the regions that can be combined across the full amount of layers,
+                    // so let's remove those areas from all layers.
+                    Polygons intersection_with_clearance;
+                    intersection_with_clearance.reserve(intersection.size());
+                    float clearance_offset = 
+                        0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
+                     // Because fill areas for rectilinear and honeycomb are grown 
+                     // later to overlap perimeters, we need to counteract that too.
+                        ((region->config().fill_pattern == ipRectilinear   ||
+                          region->config().fill_pattern == ipGrid          ||
+                          region->config().fill_pattern == ipLine          ||
+                          region->config().fill_pattern == ipHoneycomb) ? 1.5f : 0.5f) * 
+                            layerms.back()->flow(frSolidInfill).scaled_width();
+                    for (ExPolygon &expoly : intersection)
+                        polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
+                    for (LayerRegion *layerm : layerms) {
+                        Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stInternal));
+                        layerm->fill_surfaces.remove_type(stInternal);
+                        layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stInternal);
+                        if (layerm == layerms.back()) {
+                            // Apply surfaces back with adjusted depth to the uppermost layer.
+                            Surface templ(stInternal, ExPolygon());
+                            templ.thickness = 0.;
+                            for (LayerRegion *layerm2 : layerms)
+                                templ.thickness += layerm2->layer()->height;
+                            templ.thickness_layers = (unsigned short)layerms.size();
+                            layerm->fill_surfaces.append(intersection, templ);
+                        } else {
+                            // Save void surfaces.
+                            layerm->fill_surfaces.append(
+                                intersection_ex(internal, intersection_with_clearance, false),
+                                stInternalVoid);
+                        }
+                    }
                 }
-            }
-        }
+            });
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Combining infill for region " << region_id << " in parallel - end";
     }
 }
 
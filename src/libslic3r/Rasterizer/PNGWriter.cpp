@@ -0,0 +1,141 @@
+#include "PNGWriter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <tbb/parallel_for.h>
+
+#include <miniz/miniz.h>
+
+namespace Slic3r {
+
+static void put_u32_be(std::vector<std::uint8_t> &out, std::uint32_t v)
+{
+    out.push_back(std::uint8_t(v >> 24));
+    out.push_back(std::uint8_t(v >> 16));
+    out.push_back(std::uint8_t(v >> 8));
+    out.push_back(std::uint8_t(v));
+}
+
+static void put_png_chunk(std::vector<std::uint8_t> &out, const char *type, const std::uint8_t *data, size_t size)
+{
+    put_u32_be(out, std::uint32_t(size));
+    size_t type_pos = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    put_u32_be(out, std::uint32_t(mz_crc32(MZ_CRC32_INIT, out.data() + type_pos, size + 4)));
+}
+
+std::vector<std::uint8_t> png_encode_bands(unsigned width, unsigned height, const PNGBandEncoder &encode_band, size_t band_size)
+{
+    const size_t   row_size  = size_t(width) + 1;
+    const unsigned band_rows = unsigned(std::max<size_t>(1, band_size / row_size));
+    const unsigned num_bands = std::max(1u, (height + band_rows - 1) / band_rows);
+
+    struct Band {
+        std::vector<std::uint8_t> idat;
+        std::uint32_t             adler;
+        std::uint64_t             size;
+    };
+    std::vector<Band> bands(num_bands);
+    auto encode = [&bands, &encode_band, width, height, row_size, band_rows, num_bands](unsigned band_id) {
+        Band                     &band      = bands[band_id];
+        unsigned                  row_begin = band_id * band_rows;
+        unsigned                  row_end   = std::min(height, row_begin + band_rows);
+        std::vector<std::uint8_t> data;
+        if (band_id == 0) {
+            // zlib header: deflate with 32K window, no preset dictionary
+            data.push_back(0x78);
+            data.push_back(0x01);
+        }
+        band.adler = encode_band(row_begin, row_end, band_id + 1 == num_bands, data);
+        band.size  = std::uint64_t(row_end - row_begin) * row_size;
+        put_png_chunk(band.idat, "IDAT", data.data(), data.size());
+    };
+    if (num_bands == 1)
+        encode(0);
+    else
+        tbb::parallel_for(tbb::blocked_range<unsigned>(0, num_bands, 1), [&encode](const tbb::blocked_range<unsigned> &range) {
+            for (unsigned band_id = range.begin(); band_id < range.end(); ++ band_id)
+                encode(band_id);
+        });
+
+    std::vector<std::uint8_t> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    std::vector<std::uint8_t> header;
+    put_u32_be(header, width);
+    put_u32_be(header, height);
+    // 8 bit depth, grayscale, deflate, adaptive filtering, no interlace
+    header.insert(header.end(), { 8, 0, 0, 0, 0 });
+    put_png_chunk(out, "IHDR", header.data(), header.size());
+    std::uint32_t adler = MZ_ADLER32_INIT;
+    for (const Band &band : bands) {
+        out.insert(out.end(), band.idat.begin(), band.idat.end());
+        adler = adler32_combine(adler, band.adler, band.size);
+    }
+    // The Adler-32 closing the zlib stream gets its own IDAT chunk.
+    std::vector<std::uint8_t> trailer;
+    put_u32_be(trailer, adler);
+    put_png_chunk(out, "IDAT", trailer.data(), trailer.size());
+    put_png_chunk(out, "IEND", nullptr, 0);
+    return out;
+}
+
+void png_filter_row(PNGFilter filter, const std::uint8_t *row, const std::uint8_t *prev_row, unsigned width, std::uint8_t *out)
+{
+    *out ++ = std::uint8_t(filter);
+    switch (filter) {
+    case PNGFilter::NONE:
+        std::copy(row, row + width, out);
+        break;
+    case PNGFilter::SUB:
+        if (width > 0)
+            out[0] = row[0];
+        for (unsigned x = 1; x < width; ++ x)
+            out[x] = std::uint8_t(row[x] - row[x - 1]);
+        break;
+    case PNGFilter::UP:
+        if (prev_row == nullptr)
+            std::copy(row, row + width, out);
+        else
+            for (unsigned x = 0; x < width; ++ x)
+                out[x] = std::uint8_t(row[x] - prev_row[x]);
+        break;
+    }
+}
+
+static mz_bool png_deflate_put_buf(const void *buf, int len, void *user)
+{
+    auto &out = *static_cast<std::vector<std::uint8_t>*>(user);
+    auto *src = static_cast<const std::uint8_t*>(buf);
+    out.insert(out.end(), src, src + len);
+    return MZ_TRUE;
+}
+
+bool png_deflate(const std::uint8_t *data, size_t size, int level, bool last, std::vector<std::uint8_t> &out)
+{
+    tdefl_compressor *comp = static_cast<tdefl_compressor*>(malloc(sizeof(tdefl_compressor)));
+    if (comp == nullptr)
+        return false;
+    // Negative window bits: raw deflate stream, without the zlib header and the Adler-32.
+    tdefl_init(comp, png_deflate_put_buf, &out, int(tdefl_create_comp_flags_from_zip_params(level, - MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY)));
+    tdefl_status status = tdefl_compress_buffer(comp, data, size, last ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+    free(comp);
+    return status == (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+std::uint32_t adler32_combine(std::uint32_t adler1, std::uint32_t adler2, std::uint64_t len2)
+{
+    const std::uint32_t base = 65521;
+    std::uint32_t rem  = std::uint32_t(len2 % base);
+    std::uint32_t sum1 = adler1 & 0xffff;
+    std::uint32_t sum2 = std::uint32_t((std::uint64_t(rem) * sum1) % base);
+    sum1 += (adler2 & 0xffff) + base - 1;
+    sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+    if (sum1 >= base) sum1 -= base;
+    if (sum1 >= base) sum1 -= base;
+    if (sum2 >= (base << 1)) sum2 -= (base << 1);
+    if (sum2 >= base) sum2 -= base;
+    return sum1 | (sum2 << 16);
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef PNGWRITER_HPP
+#define PNGWRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Slic3r {
+
+/// Filter applied to the rows of a PNG image before the compression. The
+/// values are the PNG filter type bytes. The UP filter turns the repeated rows
+/// of binary masks into zeros, SUB turns the long runs into zeros.
+enum class PNGFilter : std::uint8_t {
+    NONE = 0,
+    SUB  = 1,
+    UP   = 2
+};
+
+/// Encodes the rows [row_begin, row_end) of an image, each prefixed with its
+/// filter type byte, into a raw deflate stream appended to out. The stream has
+/// to end at a byte boundary, with a final block only if last is set (a sync
+/// flush otherwise). Returns the Adler-32 of the filtered rows.
+using PNGBandEncoder = std::function<std::uint32_t(
+    unsigned row_begin, unsigned row_end, bool last, std::vector<std::uint8_t> &out)>;
+
+/// Writes an 8 bit grayscale PNG file. Large images are split into bands of
+/// about band_size bytes of the filtered rows, compressed in parallel by
+/// encode_band, each into its own IDAT chunk, in the manner of pigz. The
+/// Adler-32 of the zlib stream is combined from the Adler-32 of the bands.
+std::vector<std::uint8_t> png_encode_bands(unsigned width, unsigned height,
+                                           const PNGBandEncoder &encode_band,
+                                           size_t band_size = 256 * 1024);
+
+/// Writes the filter type byte and the filtered row of width pixels to out.
+/// prev_row is the previous row of the image, nullptr for the first row.
+void png_filter_row(PNGFilter filter, const std::uint8_t *row,
+                    const std::uint8_t *prev_row, unsigned width,
+                    std::uint8_t *out);
+
+/// Compresses the data with miniz at the compression level 0..10 into a raw
+/// deflate stream appended to out, ended as expected from a PNGBandEncoder.
+bool png_deflate(const std::uint8_t *data, size_t size, int level, bool last,
+                 std::vector<std::uint8_t> &out);
+
+/// Adler-32 of the concatenation of two blocks of data, the second one of
+/// len2 bytes, as zlib's adler32_combine().
+std::uint32_t adler32_combine(std::uint32_t adler1, std::uint32_t adler2,
+                              std::uint64_t len2);
+
+}
+#endif // PNGWRITER_HPP
@@ -1,4 +1,5 @@
 #include "Rasterizer.hpp"
+#include "RunLengthRaster.hpp"
 #include <ExPolygon.hpp>
 #include <libnest2d/backends/clipper/clipper_polygon.hpp>
 
@@ -14,8 +15,9 @@
 #include <agg/agg_rasterizer_scanline_aa.h>
 #include <agg/agg_path_storage.h>
 
-// Experimental minz image write:
-#include <miniz/miniz_tdef.h>
+#include <miniz/miniz.h>
+
+#include <stdexcept>
 
 namespace Slic3r {
 
@@ -25,7 +27,74 @@ const ClipperLib::Path& contour(const ClipperLib::Polygon& p) { return p.Contour
 const Polygons& holes(const ExPolygon& p) { return p.holes; }
 const ClipperLib::Paths& holes(const ClipperLib::Polygon& p) { return p.Holes; }
 
+// Common interface of the rasterizer backends.
 class Raster::Impl {
+public:
+    using Origin = Raster::Origin;
+    using Backend = Raster::Backend;
+
+    class AGG;
+    class RLE;
+
+    static Impl* create(const Raster::Resolution& res,
+                        const Raster::PixelDim &pd,
+                        Origin o, double gamma, Backend b);
+
+    inline Impl(const Raster::Resolution& res, const Raster::PixelDim &pd,
+                Origin o, double gamma):
+        m_resolution(res),
+//        m_pxdim(pd),
+        m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm),
+        m_o(o)
+    {
+        if(gamma > 0) m_gammafn = agg::gamma_power(gamma);
+        else m_gammafn = agg::gamma_threshold(0.5);
+    }
+
+    virtual ~Impl() {}
+
+    virtual void draw(const ExPolygon& poly) = 0;
+    virtual void draw(const ClipperLib::Polygon& poly) = 0;
+    virtual void clear() = 0;
+
+    // Row major buffer of the pixels of the whole raster.
+    virtual const std::uint8_t* pixels() = 0;
+
+    virtual std::vector<std::uint8_t> png(const Raster::PNGOptions& opts) = 0;
+
+    virtual Backend backend() const = 0;
+
+    inline const Raster::Resolution resolution() { return m_resolution; }
+
+    inline Origin origin() const /*noexcept*/ { return m_o; }
+
+protected:
+    Raster::Resolution m_resolution;
+//    Raster::PixelDim m_pxdim;
+    Raster::PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
+    std::function<double(double)> m_gammafn;
+    Origin m_o;
+
+    inline double getPx(const Point& p) {
+        return p(0) * m_pxdim_scaled.w_mm;
+    }
+
+    inline double getPy(const Point& p) {
+        return p(1) * m_pxdim_scaled.h_mm;
+    }
+
+    inline double getPx(const ClipperLib::IntPoint& p) {
+        return p.X * m_pxdim_scaled.w_mm;
+    }
+
+    inline double getPy(const ClipperLib::IntPoint& p) {
+        return p.Y * m_pxdim_scaled.h_mm;
+    }
+};
+
+// Rasterizer using the Anti-Grain Geometry library, rendering into a full
+// pixel buffer.
+class Raster::Impl::AGG: public Raster::Impl {
 public:
     using TPixelRenderer = agg::pixfmt_gray8; // agg::pixfmt_rgb24;
     using TRawRenderer = agg::renderer_base<TPixelRenderer>;
@@ -39,50 +108,35 @@ public:
     static const TPixel ColorWhite;
     static const TPixel ColorBlack;
 
-    using Origin = Raster::Origin;
-
 private:
-    Raster::Resolution m_resolution;
-//    Raster::PixelDim m_pxdim;
-    Raster::PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
     TBuffer m_buf;
     TRawBuffer m_rbuf;
     TPixelRenderer m_pixfmt;
     TRawRenderer m_raw_renderer;
     TRendererAA m_renderer;
-    
-    std::function<double(double)> m_gammafn;
-    Origin m_o;
-    
+
     inline void flipy(agg::path_storage& path) const {
         path.flip_y(0, m_resolution.height_px);
     }
 
 public:
 
-    inline Impl(const Raster::Resolution& res, const Raster::PixelDim &pd,
-                Origin o, double gamma = 1.0):
-        m_resolution(res), 
-//        m_pxdim(pd), 
-        m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm),
+    inline AGG(const Raster::Resolution& res, const Raster::PixelDim &pd,
+               Origin o, double gamma = 1.0):
+        Impl(res, pd, o, gamma),
         m_buf(res.pixels()),
         m_rbuf(reinterpret_cast<TPixelRenderer::value_type*>(m_buf.data()),
               res.width_px, res.height_px,
               int(res.width_px*TPixelRenderer::num_components)),
         m_pixfmt(m_rbuf),
         m_raw_renderer(m_pixfmt),
-        m_renderer(m_raw_renderer),
-        m_o(o)
+        m_renderer(m_raw_renderer)
     {
         m_renderer.color(ColorWhite);
-        
-        if(gamma > 0) m_gammafn = agg::gamma_power(gamma);
-        else m_gammafn = agg::gamma_threshold(0.5);
-        
         clear();
     }
 
-    template<class P> void draw(const P &poly) {
+    template<class P> void draw_poly(const P &poly) {
         agg::rasterizer_scanline_aa<> ras;
         agg::scanline_p8 scanlines;
         
@@ -103,38 +157,47 @@ public:
         agg::render_scanlines(ras, scanlines, m_renderer);
     }
 
-    inline void clear() {
+    void draw(const ExPolygon& poly) override { draw_poly(poly); }
+    void draw(const ClipperLib::Polygon& poly) override { draw_poly(poly); }
+
+    void clear() override {
         m_raw_renderer.clear(ColorBlack);
     }
 
-    inline TBuffer& buffer()  { return m_buf; }
-
-    inline const Raster::Resolution resolution() { return m_resolution; }
-
-    inline Origin origin() const /*noexcept*/ { return m_o; }
-
-private:
-    inline double getPx(const Point& p) {
-        return p(0) * m_pxdim_scaled.w_mm;
+    const std::uint8_t* pixels() override {
+        return reinterpret_cast<const std::uint8_t*>(m_buf.data());
     }
 
-    inline double getPy(const Point& p) {
-        return p(1) * m_pxdim_scaled.h_mm;
+    std::vector<std::uint8_t> png(const Raster::PNGOptions& opts) override {
+        const unsigned w = m_resolution.width_px;
+        auto pixels = reinterpret_cast<const std::uint8_t*>(m_buf.data());
+
+        return png_encode_bands(w, m_resolution.height_px,
+            [pixels, w, &opts](unsigned row_begin, unsigned row_end, bool last,
+                               std::vector<std::uint8_t>& out)
+        {
+            std::vector<std::uint8_t> filtered(size_t(row_end - row_begin) * (w + 1));
+            for(unsigned y = row_begin; y < row_end; ++y) {
+                const std::uint8_t *row = pixels + size_t(y) * w;
+                png_filter_row(opts.filter, row, y > 0 ? row - w : nullptr, w,
+                               filtered.data() + size_t(y - row_begin) * (w + 1));
+            }
+
+            if(!png_deflate(filtered.data(), filtered.size(), opts.level, last, out))
+                throw std::runtime_error("Failed to compress the raster to PNG");
+            return std::uint32_t(mz_adler32(MZ_ADLER32_INIT, filtered.data(),
+                                            filtered.size()));
+        });
     }
 
+    Backend backend() const override { return Backend::AGG; }
+
+private:
     inline agg::path_storage to_path(const Polygon& poly)
     {
         return to_path(poly.points);
     }
 
-    inline double getPx(const ClipperLib::IntPoint& p) {
-        return p.X * m_pxdim_scaled.w_mm;
-    }
-
-    inline double getPy(const ClipperLib::IntPoint& p) {
-        return p.Y * m_pxdim_scaled.h_mm;
-    }
-
     template<class PointVec> agg::path_storage to_path(const PointVec& poly)
     {
         agg::path_storage path;
@@ -151,11 +214,95 @@ private:
 
 };
 
-const Raster::Impl::TPixel Raster::Impl::ColorWhite = Raster::Impl::TPixel(255);
-const Raster::Impl::TPixel Raster::Impl::ColorBlack = Raster::Impl::TPixel(0);
+// Scanline rasterizer keeping the rows run-length encoded. The vertices are
+// converted to the fixed point coordinates exactly as the AGG path does, so
+// that both backends produce identical pixels.
+class Raster::Impl::RLE: public Raster::Impl {
+    RunLengthRaster m_raster;
+    std::vector<RunLengthRaster::Path> m_paths;
+    std::vector<std::uint8_t> m_buf;    // decoded pixels, only for pixels()
+
+    static RunLengthRaster::GammaTable gamma_table(
+            const std::function<double(double)>& gammafn)
+    {
+        // Use the gamma table of the AGG rasterizer to get the same rounding.
+        agg::rasterizer_scanline_aa<> ras;
+        ras.gamma(gammafn);
+        RunLengthRaster::GammaTable table;
+        for(unsigned i = 0; i < table.size(); ++i)
+            table[i] = std::uint8_t(ras.apply_gamma(i));
+        return table;
+    }
+
+public:
+
+    inline RLE(const Raster::Resolution& res, const Raster::PixelDim &pd,
+               Origin o, double gamma = 1.0):
+        Impl(res, pd, o, gamma),
+        m_raster(res.width_px, res.height_px, gamma_table(m_gammafn)) {}
+
+    template<class P> void draw_poly(const P &poly) {
+        m_paths.resize(1 + holes(poly).size());
+        to_path(points(contour(poly)), m_paths.front());
+        for(size_t i = 0; i < holes(poly).size(); ++i)
+            to_path(points(holes(poly)[i]), m_paths[i + 1]);
+
+        m_raster.draw(m_paths);
+    }
+
+    void draw(const ExPolygon& poly) override { draw_poly(poly); }
+    void draw(const ClipperLib::Polygon& poly) override { draw_poly(poly); }
+
+    void clear() override { m_raster.clear(); }
+
+    const std::uint8_t* pixels() override {
+        m_buf.resize(m_resolution.pixels());
+        m_raster.decode(m_buf.data());
+        return m_buf.data();
+    }
+
+    std::vector<std::uint8_t> png(const Raster::PNGOptions& opts) override {
+        return m_raster.png(opts.filter);
+    }
+
+    Backend backend() const override { return Backend::RLE; }
+
+    inline const RunLengthRaster& raster() const { return m_raster; }
+
+private:
+    static const Points& points(const Polygon& poly) { return poly.points; }
+    static const ClipperLib::Path& points(const ClipperLib::Path& p) { return p; }
+
+    template<class PointVec>
+    void to_path(const PointVec& poly, RunLengthRaster::Path& path)
+    {
+        // Same as agg::path_storage::flip_y() and agg::ras_conv_int::upscale()
+        double h = m_resolution.height_px;
+        path.clear();
+        path.reserve(poly.size());
+        for(auto& p : poly) {
+            double y = getPy(p);
+            if(m_o == Origin::TOP_LEFT) y = h - y + 0.;
+            path.emplace_back(agg::iround(getPx(p) * agg::poly_subpixel_scale),
+                              agg::iround(y * agg::poly_subpixel_scale));
+        }
+    }
+};
+
+const Raster::Impl::AGG::TPixel Raster::Impl::AGG::ColorWhite = Raster::Impl::AGG::TPixel(255);
+const Raster::Impl::AGG::TPixel Raster::Impl::AGG::ColorBlack = Raster::Impl::AGG::TPixel(0);
+
+Raster::Impl* Raster::Impl::create(const Raster::Resolution &r,
+                                   const Raster::PixelDim &pd,
+                                   Origin o, double g, Backend b)
+{
+    if(b == Backend::RLE) return new RLE(r, pd, o, g);
+    return new AGG(r, pd, o, g);
+}
 
-Raster::Raster(const Resolution &r, const PixelDim &pd, Origin o, double g):
-    m_impl(new Impl(r, pd, o, g)) {}
+Raster::Raster(const Resolution &r, const PixelDim &pd, Origin o, double g,
+               Backend b):
+    m_impl(Impl::create(r, pd, o, g, b)) {}
 
 Raster::Raster() {}
 
@@ -170,14 +317,15 @@ void Raster::reset(const Raster::Resolution &r, const Raster::PixelDim &pd,
     // Free up the unnecessary memory and make sure it stays clear after
     // an exception
     auto o = m_impl? m_impl->origin() : Origin::TOP_LEFT;
-    reset(r, pd, o, g);
+    auto b = m_impl? m_impl->backend() : Backend::AGG;
+    reset(r, pd, o, g, b);
 }
 
 void Raster::reset(const Raster::Resolution &r, const Raster::PixelDim &pd,
-                   Raster::Origin o, double gamma)
+                   Raster::Origin o, double gamma, Backend b)
 {
     m_impl.reset();
-    m_impl.reset(new Impl(r, pd, o, gamma));
+    m_impl.reset(Impl::create(r, pd, o, gamma, b));
 }
 
 void Raster::reset()
@@ -192,6 +340,11 @@ Raster::Resolution Raster::resolution() const
     return Resolution(0, 0);
 }
 
+Raster::Backend Raster::backend() const
+{
+    return m_impl ? m_impl->backend() : Backend::AGG;
+}
+
 void Raster::clear()
 {
     assert(m_impl);
@@ -208,27 +361,17 @@ void Raster::draw(const ClipperLib::Polygon &poly)
     m_impl->draw(poly);
 }
 
-void Raster::save(std::ostream& stream, Compression comp)
+void Raster::save(std::ostream& stream, Compression comp,
+                  const PNGOptions& png)
 {
     assert(m_impl);
     if(!stream.good()) return;
 
     switch(comp) {
     case Compression::PNG: {
-        auto& b = m_impl->buffer();
-        size_t out_len = 0;
-        void * rawdata = tdefl_write_image_to_png_file_in_memory(
-                    b.data(),
-                    int(resolution().width_px),
-                    int(resolution().height_px), 1, &out_len);
-
-        if(rawdata == nullptr) break;
-
-        stream.write(static_cast<const char*>(rawdata),
-                     std::streamsize(out_len));
-
-        MZ_FREE(rawdata);
-
+        auto data = m_impl->png(png);
+        stream.write(reinterpret_cast<const char*>(data.data()),
+                     std::streamsize(data.size()));
         break;
     }
     case Compression::RAW: {
@@ -237,14 +380,14 @@ void Raster::save(std::ostream& stream, Compression comp)
                << m_impl->resolution().height_px << " "
                << "255 ";
 
-        auto sz = m_impl->buffer().size()*sizeof(Impl::TBuffer::value_type);
-        stream.write(reinterpret_cast<const char*>(m_impl->buffer().data()),
+        auto sz = m_impl->resolution().pixels();
+        stream.write(reinterpret_cast<const char*>(m_impl->pixels()),
                      std::streamsize(sz));
     }
     }
 }
 
-RawBytes Raster::save(Raster::Compression comp)
+RawBytes Raster::save(Raster::Compression comp, const PNGOptions& png)
 {
     assert(m_impl);
 
@@ -252,17 +395,7 @@ RawBytes Raster::save(Raster::Compression comp)
 
     switch(comp) {
     case Compression::PNG: {
-        void *rawdata = tdefl_write_image_to_png_file_in_memory(
-                    m_impl->buffer().data(),
-                    int(resolution().width_px),
-                    int(resolution().height_px), 1, &s);
-
-        if(rawdata == nullptr) break;
-        auto ptr = static_cast<std::uint8_t*>(rawdata);
-        
-        data.reserve(s); std::copy(ptr, ptr + s, std::back_inserter(data));
-        
-        MZ_FREE(rawdata);
+        data = m_impl->png(png);
         break;
     }
     case Compression::RAW: {
@@ -270,12 +403,12 @@ RawBytes Raster::save(Raster::Compression comp)
                 std::to_string(m_impl->resolution().width_px) + " " +
                 std::to_string(m_impl->resolution().height_px) + " " + "255 ";
 
-        auto sz = m_impl->buffer().size()*sizeof(Impl::TBuffer::value_type);
+        auto sz = m_impl->resolution().pixels();
         s = sz + header.size();
         
         data.reserve(s);
         
-        auto buff = reinterpret_cast<std::uint8_t*>(m_impl->buffer().data());
+        auto buff = m_impl->pixels();
         std::copy(header.begin(), header.end(), std::back_inserter(data));
         std::copy(buff, buff+sz, std::back_inserter(data));
         
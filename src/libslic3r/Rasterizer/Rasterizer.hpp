@@ -6,6 +6,8 @@
 #include <vector>
 #include <cstdint>
 
+#include "PNGWriter.hpp"
+
 namespace ClipperLib { struct Polygon; }
 
 namespace Slic3r {
@@ -22,7 +24,7 @@ public:
     RawBytes(std::vector<std::uint8_t>&& data): m_buffer(std::move(data)) {}
     
     size_t size() const { return m_buffer.size(); }
-    const uint8_t * data() { return m_buffer.data(); }
+    const uint8_t * data() const { return m_buffer.data(); }
 
     // /////////////////////////////////////////////////////////////////////////
     // FIXME: the following is needed for MSVC2013 compatibility
@@ -59,6 +61,16 @@ public:
         PNG     //!> PNG compression
     };
 
+    /// Parameters of the PNG compression. The compression level 0..10 is
+    /// only used by the AGG backend. The RLE backend ignores it and always
+    /// deflates the runs as matches of distance 1 with dynamic Huffman codes.
+    struct PNGOptions {
+        int level;
+        PNGFilter filter;
+        inline PNGOptions(int lvl = 6, PNGFilter f = PNGFilter::NONE):
+            level(lvl), filter(f) {}
+    };
+
     /// The Rasterizer expects the input polygons to have their coordinate
     /// system origin in the bottom left corner. If the raster is then
     /// configured with the TOP_LEFT origin parameter (in the constructor) than
@@ -71,6 +83,15 @@ public:
         BOTTOM_LEFT
     };
 
+    /// The rasterizer implementations, both producing the same pixels. AGG
+    /// renders into a full pixel buffer. RLE keeps only the non-empty runs of
+    /// each row, thus neither drawing nor the PNG compression touch the empty
+    /// areas, which is faster for the mostly empty layers of SLA prints.
+    enum class Backend {
+        AGG,
+        RLE
+    };
+
     /// Type that represents a resolution in pixels.
     struct Resolution {
         unsigned width_px;
@@ -91,7 +112,8 @@ public:
 
     /// Constructor taking the resolution and the pixel dimension.
     Raster(const Resolution& r,  const PixelDim& pd, 
-           Origin o = Origin::BOTTOM_LEFT, double gamma = 1.0);
+           Origin o = Origin::BOTTOM_LEFT, double gamma = 1.0,
+           Backend b = Backend::AGG);
     
     Raster();
     Raster(const Raster& cpy) = delete;
@@ -101,7 +123,8 @@ public:
 
     /// Reallocated everything for the given resolution and pixel dimension.
     void reset(const Resolution& r, const PixelDim& pd, double gamma = 1.0);
-    void reset(const Resolution& r, const PixelDim& pd, Origin o, double gamma);
+    void reset(const Resolution& r, const PixelDim& pd, Origin o, double gamma,
+               Backend b = Backend::AGG);
 
     /**
      * Release the allocated resources. Drawing in this state ends in
@@ -112,6 +135,9 @@ public:
     /// Get the resolution of the raster.
     Resolution resolution() const;
 
+    /// Get the rasterizer implementation in use.
+    Backend backend() const;
+
     /// Clear the raster with black color.
     void clear();
 
@@ -119,10 +145,13 @@ public:
     void draw(const ExPolygon& poly);
     void draw(const ClipperLib::Polygon& poly);
 
-    /// Save the raster on the specified stream.
-    void save(std::ostream& stream, Compression comp = Compression::RAW);
+    /// Save the raster on the specified stream. Large rasters are compressed
+    /// to PNG in parallel, in bands of rows.
+    void save(std::ostream& stream, Compression comp = Compression::RAW,
+              const PNGOptions& png = PNGOptions());
 
-    RawBytes save(Compression comp = Compression::RAW);
+    RawBytes save(Compression comp = Compression::RAW,
+                  const PNGOptions& png = PNGOptions());
 };
 
 }
@@ -0,0 +1,736 @@
+#include "RunLengthRaster.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <queue>
+
+namespace Slic3r {
+
+// Same as in agg_basics.h
+enum {
+    poly_subpixel_shift = 8,
+    poly_subpixel_scale = 1 << poly_subpixel_shift,
+    poly_subpixel_mask  = poly_subpixel_scale - 1,
+    aa_shift            = 8,
+    aa_mask             = (1 << aa_shift) - 1
+};
+
+RunLengthRaster::RunLengthRaster(unsigned width, unsigned height, const GammaTable &gamma) :
+    m_width(width), m_height(height), m_gamma(gamma), m_rows(height)
+{
+}
+
+void RunLengthRaster::clear()
+{
+    for (Row &row : m_rows)
+        row.clear();
+}
+
+void RunLengthRaster::draw(const std::vector<Path> &paths)
+{
+    m_cells.clear();
+    m_curr_cell.x = m_curr_cell.y = INT_MAX;
+    m_curr_cell.cover = m_curr_cell.area = 0;
+    for (const Path &path : paths)
+        if (! path.empty()) {
+            for (size_t i = 1; i < path.size(); ++ i)
+                line(path[i - 1].x, path[i - 1].y, path[i].x, path[i].y);
+            // Close the path.
+            line(path.back().x, path.back().y, path.front().x, path.front().y);
+        }
+    add_curr_cell();
+    if (m_cells.empty())
+        return;
+
+    // Sort the cells by rows (counting sort), only the rows inside the image are rendered.
+    int min_y = INT_MAX;
+    int max_y = INT_MIN;
+    for (const Cell &cell : m_cells) {
+        min_y = std::min(min_y, cell.y);
+        max_y = std::max(max_y, cell.y);
+    }
+    min_y = std::max(min_y, 0);
+    max_y = std::min(max_y, int(m_height) - 1);
+    if (min_y > max_y)
+        return;
+    m_row_offsets.assign(size_t(max_y - min_y + 2), 0);
+    for (const Cell &cell : m_cells)
+        if (cell.y >= min_y && cell.y <= max_y)
+            ++ m_row_offsets[cell.y - min_y + 1];
+    for (size_t i = 1; i < m_row_offsets.size(); ++ i)
+        m_row_offsets[i] += m_row_offsets[i - 1];
+    m_sorted_cells.resize(size_t(m_row_offsets.back()));
+    for (const Cell &cell : m_cells)
+        if (cell.y >= min_y && cell.y <= max_y)
+            m_sorted_cells[m_row_offsets[cell.y - min_y] ++] = cell;
+    // m_row_offsets[i] now points to the end of the row min_y + i.
+
+    const Cell *begin = m_sorted_cells.data();
+    for (int y = min_y; y <= max_y; ++ y) {
+        const Cell *end = m_sorted_cells.data() + m_row_offsets[y - min_y];
+        if (begin != end) {
+            std::sort(const_cast<Cell*>(begin), const_cast<Cell*>(end), [](const Cell &c1, const Cell &c2) { return c1.x < c2.x; });
+            this->sweep_row(begin, end);
+            if (! m_spans.empty())
+                this->blend_row(unsigned(y));
+        }
+        begin = end;
+    }
+}
+
+void RunLengthRaster::add_curr_cell()
+{
+    if (m_curr_cell.area | m_curr_cell.cover)
+        m_cells.emplace_back(m_curr_cell);
+}
+
+inline void RunLengthRaster::set_curr_cell(int x, int y)
+{
+    if (m_curr_cell.x != x || m_curr_cell.y != y) {
+        add_curr_cell();
+        m_curr_cell.x     = x;
+        m_curr_cell.y     = y;
+        m_curr_cell.cover = 0;
+        m_curr_cell.area  = 0;
+    }
+}
+
+inline void RunLengthRaster::render_hline(int ey, int x1, int y1, int x2, int y2)
+{
+    int ex1 = x1 >> poly_subpixel_shift;
+    int ex2 = x2 >> poly_subpixel_shift;
+    int fx1 = x1 & poly_subpixel_mask;
+    int fx2 = x2 & poly_subpixel_mask;
+
+    // Trivial case. Happens often.
+    if (y1 == y2) {
+        set_curr_cell(ex2, ey);
+        return;
+    }
+
+    // Everything is located in a single cell.
+    if (ex1 == ex2) {
+        int delta = y2 - y1;
+        m_curr_cell.cover += delta;
+        m_curr_cell.area  += (fx1 + fx2) * delta;
+        return;
+    }
+
+    // Render a run of adjacent cells on the same hline.
+    int       p     = (poly_subpixel_scale - fx1) * (y2 - y1);
+    int       first = poly_subpixel_scale;
+    int       incr  = 1;
+    long long dx    = (long long)x2 - (long long)x1;
+    if (dx < 0) {
+        p     = fx1 * (y2 - y1);
+        first = 0;
+        incr  = -1;
+        dx    = -dx;
+    }
+
+    int delta = (int)(p / dx);
+    int mod   = (int)(p % dx);
+    if (mod < 0) {
+        -- delta;
+        mod += static_cast<int>(dx);
+    }
+
+    m_curr_cell.cover += delta;
+    m_curr_cell.area  += (fx1 + first) * delta;
+
+    ex1 += incr;
+    set_curr_cell(ex1, ey);
+    y1 += delta;
+
+    if (ex1 != ex2) {
+        p        = poly_subpixel_scale * (y2 - y1 + delta);
+        int lift = (int)(p / dx);
+        int rem  = (int)(p % dx);
+        if (rem < 0) {
+            -- lift;
+            rem += static_cast<int>(dx);
+        }
+        mod -= static_cast<int>(dx);
+        while (ex1 != ex2) {
+            delta = lift;
+            mod  += rem;
+            if (mod >= 0) {
+                mod -= static_cast<int>(dx);
+                ++ delta;
+            }
+            m_curr_cell.cover += delta;
+            m_curr_cell.area  += poly_subpixel_scale * delta;
+            y1  += delta;
+            ex1 += incr;
+            set_curr_cell(ex1, ey);
+        }
+    }
+    delta = y2 - y1;
+    m_curr_cell.cover += delta;
+    m_curr_cell.area  += (fx2 + poly_subpixel_scale - first) * delta;
+}
+
+void RunLengthRaster::line(int x1, int y1, int x2, int y2)
+{
+    enum { dx_limit = 16384 << poly_subpixel_shift };
+
+    long long dx = (long long)x2 - (long long)x1;
+    if (dx >= dx_limit || dx <= -dx_limit) {
+        int cx = (int)(((long long)x1 + (long long)x2) >> 1);
+        int cy = (int)(((long long)y1 + (long long)y2) >> 1);
+        line(x1, y1, cx, cy);
+        line(cx, cy, x2, y2);
+        return;
+    }
+
+    long long dy  = (long long)y2 - (long long)y1;
+    int       ex1 = x1 >> poly_subpixel_shift;
+    int       ey1 = y1 >> poly_subpixel_shift;
+    int       ey2 = y2 >> poly_subpixel_shift;
+    int       fy1 = y1 & poly_subpixel_mask;
+    int       fy2 = y2 & poly_subpixel_mask;
+
+    set_curr_cell(ex1, ey1);
+
+    // Everything is on a single hline.
+    if (ey1 == ey2) {
+        render_hline(ey1, x1, fy1, x2, fy2);
+        return;
+    }
+
+    // Vertical line: calculate the start and end cells and the common values
+    // of the area and coverage for all the cells of the line.
+    int incr = 1;
+    if (dx == 0) {
+        int ex     = x1 >> poly_subpixel_shift;
+        int two_fx = (x1 - (ex << poly_subpixel_shift)) << 1;
+        int first  = poly_subpixel_scale;
+        if (dy < 0) {
+            first = 0;
+            incr  = -1;
+        }
+        int delta = first - fy1;
+        m_curr_cell.cover += delta;
+        m_curr_cell.area  += two_fx * delta;
+        ey1 += incr;
+        set_curr_cell(ex, ey1);
+        delta = first + first - poly_subpixel_scale;
+        int area = two_fx * delta;
+        while (ey1 != ey2) {
+            m_curr_cell.cover = delta;
+            m_curr_cell.area  = area;
+            ey1 += incr;
+            set_curr_cell(ex, ey1);
+        }
+        delta = fy2 - poly_subpixel_scale + first;
+        m_curr_cell.cover += delta;
+        m_curr_cell.area  += two_fx * delta;
+        return;
+    }
+
+    // Render several hlines.
+    long long p     = (poly_subpixel_scale - fy1) * dx;
+    int       first = poly_subpixel_scale;
+    if (dy < 0) {
+        p     = fy1 * dx;
+        first = 0;
+        incr  = -1;
+        dy    = -dy;
+    }
+
+    int delta = (int)(p / dy);
+    int mod   = (int)(p % dy);
+    if (mod < 0) {
+        -- delta;
+        mod += static_cast<int>(dy);
+    }
+
+    int x_from = x1 + delta;
+    render_hline(ey1, x1, fy1, x_from, first);
+    ey1 += incr;
+    set_curr_cell(x_from >> poly_subpixel_shift, ey1);
+
+    if (ey1 != ey2) {
+        p        = poly_subpixel_scale * dx;
+        int lift = (int)(p / dy);
+        int rem  = (int)(p % dy);
+        if (rem < 0) {
+            -- lift;
+            rem += static_cast<int>(dy);
+        }
+        mod -= static_cast<int>(dy);
+        while (ey1 != ey2) {
+            delta = lift;
+            mod  += rem;
+            if (mod >= 0) {
+                mod -= static_cast<int>(dy);
+                ++ delta;
+            }
+            int x_to = x_from + delta;
+            render_hline(ey1, x_from, poly_subpixel_scale - first, x_to, first);
+            x_from = x_to;
+            ey1 += incr;
+            set_curr_cell(x_from >> poly_subpixel_shift, ey1);
+        }
+    }
+    render_hline(ey1, x_from, poly_subpixel_scale - first, x2, fy2);
+}
+
+inline unsigned RunLengthRaster::calculate_alpha(int area) const
+{
+    int cover = area >> (poly_subpixel_shift * 2 + 1 - aa_shift);
+    if (cover < 0)
+        cover = - cover;
+    if (cover > aa_mask)
+        cover = aa_mask;
+    return m_gamma[cover];
+}
+
+inline void RunLengthRaster::add_span(int x, int len, unsigned alpha)
+{
+    // Clip to the image, as agg::renderer_base does.
+    int x2 = std::min(x + len, int(m_width));
+    x = std::max(x, 0);
+    if (x >= x2)
+        return;
+    if (! m_spans.empty() && m_spans.back().x + m_spans.back().len == std::uint32_t(x) && m_spans.back().value == alpha)
+        m_spans.back().len += std::uint32_t(x2 - x);
+    else
+        m_spans.push_back({ std::uint32_t(x), std::uint32_t(x2 - x), std::uint8_t(alpha) });
+}
+
+void RunLengthRaster::sweep_row(const Cell *begin, const Cell *end)
+{
+    m_spans.clear();
+    int cover = 0;
+    for (const Cell *cell = begin; cell != end;) {
+        int x    = cell->x;
+        int area = cell->area;
+        cover += cell->cover;
+        // Accumulate all the cells with the same x.
+        for (++ cell; cell != end && cell->x == x; ++ cell) {
+            area  += cell->area;
+            cover += cell->cover;
+        }
+        if (area) {
+            unsigned alpha = calculate_alpha(cover * (1 << (poly_subpixel_shift + 1)) - area);
+            if (alpha)
+                add_span(x, 1, alpha);
+            ++ x;
+        }
+        if (cell != end && cell->x > x) {
+            unsigned alpha = calculate_alpha(cover * (1 << (poly_subpixel_shift + 1)));
+            if (alpha)
+                add_span(x, cell->x - x, alpha);
+        }
+    }
+}
+
+// agg::pixfmt_gray8 blending of the white color with the given alpha onto pixel p.
+static inline std::uint8_t blend_white(unsigned p, unsigned alpha)
+{
+    if (alpha == aa_mask)
+        return aa_mask;
+    // agg::gray8::lerp(p, 255, alpha)
+    int t = int(aa_mask - p) * int(alpha) + (1 << 7);
+    return std::uint8_t(int(p) + (((t >> 8) + t) >> 8));
+}
+
+void RunLengthRaster::blend_row(unsigned y)
+{
+    Row &row = m_rows[y];
+    if (row.empty()) {
+        // Blending onto black produces the alpha.
+        row.swap(m_spans);
+        return;
+    }
+
+    // Merge the sorted runs of the row with the sorted spans of the polygon.
+    m_blended.clear();
+    auto emit = [this](std::uint32_t x, std::uint32_t len, std::uint8_t value) {
+        if (! m_blended.empty() && m_blended.back().x + m_blended.back().len == x && m_blended.back().value == value)
+            m_blended.back().len += len;
+        else
+            m_blended.push_back({ x, len, value });
+    };
+    size_t        i = 0;
+    size_t        j = 0;
+    std::uint32_t x = 0;
+    while (i < row.size() || j < m_spans.size()) {
+        const Run    *run   = i < row.size() ? &row[i] : nullptr;
+        const Run    *span  = j < m_spans.size() ? &m_spans[j] : nullptr;
+        std::uint32_t run1  = run  ? std::max(run->x, x)  : UINT32_MAX;
+        std::uint32_t run2  = run  ? run->x + run->len    : UINT32_MAX;
+        std::uint32_t span1 = span ? std::max(span->x, x) : UINT32_MAX;
+        std::uint32_t span2 = span ? span->x + span->len  : UINT32_MAX;
+        std::uint32_t start = std::min(run1, span1);
+        bool          in_run  = run1  == start;
+        bool          in_span = span1 == start;
+        x = std::min(in_run ? run2 : run1, in_span ? span2 : span1);
+        emit(start, x - start, in_span ? blend_white(in_run ? run->value : 0, span->value) : run->value);
+        if (run2 <= x)
+            ++ i;
+        if (span2 <= x)
+            ++ j;
+    }
+    row.swap(m_blended);
+}
+
+void RunLengthRaster::decode(std::uint8_t *dst) const
+{
+    for (const Row &row : m_rows) {
+        memset(dst, 0, m_width);
+        for (const Run &run : row)
+            memset(dst + run.x, run.value, run.len);
+        dst += m_width;
+    }
+}
+
+namespace {
+
+// Writes the bits of a deflate stream, least significant bit first.
+class BitWriter {
+public:
+    BitWriter(std::vector<std::uint8_t> &out) : m_out(out), m_bits(0), m_num_bits(0) {}
+
+    void put(std::uint32_t bits, unsigned num_bits) {
+        m_bits |= std::uint64_t(bits) << m_num_bits;
+        m_num_bits += num_bits;
+        while (m_num_bits >= 8) {
+            m_out.push_back(std::uint8_t(m_bits));
+            m_bits >>= 8;
+            m_num_bits -= 8;
+        }
+    }
+
+    void flush() {
+        if (m_num_bits > 0)
+            m_out.push_back(std::uint8_t(m_bits));
+        m_bits = 0;
+        m_num_bits = 0;
+    }
+
+private:
+    std::vector<std::uint8_t> &m_out;
+    std::uint64_t              m_bits;
+    unsigned                   m_num_bits;
+};
+
+// Lengths of the Huffman codes of the symbols with the given frequencies, limited to max_bits.
+// If only a single symbol is used, a second one is added to keep the code complete.
+static std::vector<std::uint8_t> huffman_code_lengths(std::vector<std::uint32_t> freq, unsigned max_bits)
+{
+    const size_t              num_symbols = freq.size();
+    std::vector<std::uint8_t> lengths(num_symbols, 0);
+    std::vector<int>          parent(2 * num_symbols, -1);
+    for (;;) {
+        typedef std::pair<std::uint64_t, int> Node;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        for (size_t i = 0; i < num_symbols; ++ i)
+            if (freq[i] > 0)
+                queue.emplace(freq[i], int(i));
+        if (queue.size() <= 1) {
+            size_t used = queue.empty() ? 0 : size_t(queue.top().second);
+            lengths[used] = 1;
+            lengths[used == 0 ? 1 : 0] = 1;
+            return lengths;
+        }
+        int next_node = int(num_symbols);
+        while (queue.size() > 1) {
+            Node n1 = queue.top(); queue.pop();
+            Node n2 = queue.top(); queue.pop();
+            parent[n1.second] = parent[n2.second] = next_node;
+            queue.emplace(n1.first + n2.first, next_node ++);
+        }
+        parent[next_node - 1] = -1;
+        unsigned max_length = 0;
+        for (size_t i = 0; i < num_symbols; ++ i)
+            if (freq[i] > 0) {
+                unsigned length = 0;
+                for (int node = int(i); parent[node] != -1; node = parent[node])
+                    ++ length;
+                lengths[i] = std::uint8_t(length);
+                max_length = std::max(max_length, length);
+            }
+        if (max_length <= max_bits)
+            return lengths;
+        // Flatten the distribution and try again.
+        for (std::uint32_t &f : freq)
+            if (f > 0)
+                f = (f + 1) / 2;
+    }
+}
+
+// Canonical Huffman codes for the code lengths, bit reversed to be written least significant bit first.
+static std::vector<std::uint16_t> huffman_codes(const std::vector<std::uint8_t> &lengths)
+{
+    unsigned length_count[16] = { 0 };
+    for (std::uint8_t length : lengths)
+        ++ length_count[length];
+    length_count[0] = 0;
+    unsigned next_code[16] = { 0 };
+    for (unsigned bits = 1, code = 0; bits < 16; ++ bits)
+        next_code[bits] = code = (code + length_count[bits - 1]) << 1;
+    std::vector<std::uint16_t> codes(lengths.size(), 0);
+    for (size_t i = 0; i < lengths.size(); ++ i)
+        if (lengths[i] > 0) {
+            unsigned code     = next_code[lengths[i]] ++;
+            unsigned reversed = 0;
+            for (unsigned bit = 0; bit < lengths[i]; ++ bit, code >>= 1)
+                reversed = (reversed << 1) | (code & 1);
+            codes[i] = std::uint16_t(reversed);
+        }
+    return codes;
+}
+
+// Deflate length symbol (257..285) and its extra bits for a match length 3..258.
+static inline void length_symbol(unsigned length, unsigned &symbol, unsigned &extra_bits, unsigned &extra)
+{
+    static const unsigned short base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const unsigned char  bits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    int i = 28;
+    while (base[i] > length)
+        -- i;
+    symbol     = 257 + unsigned(i);
+    extra_bits = bits[i];
+    extra      = length - base[i];
+}
+
+// Tokens of the deflate stream: literals 0..255 and matches of distance 1, stored as 256 + length.
+typedef std::uint16_t Token;
+static const Token TOKEN_MATCH = 256;
+
+// Writes a deflate block with dynamic Huffman codes.
+static void deflate_block(BitWriter &writer, const Token *begin, const Token *end, bool final)
+{
+    std::vector<std::uint32_t> lit_freq(286, 0);
+    std::vector<std::uint32_t> dist_freq(30, 0);
+    for (const Token *token = begin; token != end; ++ token)
+        if (*token < TOKEN_MATCH)
+            ++ lit_freq[*token];
+        else {
+            unsigned symbol, extra_bits, extra;
+            length_symbol(*token - TOKEN_MATCH, symbol, extra_bits, extra);
+            ++ lit_freq[symbol];
+            ++ dist_freq[0];
+        }
+    // End of block
+    ++ lit_freq[256];
+
+    std::vector<std::uint8_t>  lit_lengths  = huffman_code_lengths(lit_freq, 15);
+    std::vector<std::uint8_t>  dist_lengths = huffman_code_lengths(dist_freq, 15);
+    std::vector<std::uint16_t> lit_codes    = huffman_codes(lit_lengths);
+    std::vector<std::uint16_t> dist_codes   = huffman_codes(dist_lengths);
+    unsigned num_lit  = 286;
+    unsigned num_dist = 30;
+    while (num_lit > 257 && lit_lengths[num_lit - 1] == 0)
+        -- num_lit;
+    while (num_dist > 1 && dist_lengths[num_dist - 1] == 0)
+        -- num_dist;
+
+    // Run length encode the code lengths of both alphabets with the code length alphabet.
+    std::vector<std::uint8_t> lengths(lit_lengths.begin(), lit_lengths.begin() + num_lit);
+    lengths.insert(lengths.end(), dist_lengths.begin(), dist_lengths.begin() + num_dist);
+    struct CodeLength { std::uint8_t symbol, extra; };
+    std::vector<CodeLength>    code_lengths;
+    std::vector<std::uint32_t> cl_freq(19, 0);
+    auto emit = [&code_lengths, &cl_freq](unsigned symbol, unsigned extra) {
+        code_lengths.push_back({ std::uint8_t(symbol), std::uint8_t(extra) });
+        ++ cl_freq[symbol];
+    };
+    for (size_t i = 0; i < lengths.size();) {
+        unsigned length = lengths[i];
+        size_t   run    = 1;
+        while (i + run < lengths.size() && lengths[i + run] == length)
+            ++ run;
+        i += run;
+        if (length == 0) {
+            for (; run >= 11; run -= std::min<size_t>(run, 138))
+                emit(18, unsigned(std::min<size_t>(run, 138) - 11));
+            if (run >= 3) {
+                emit(17, unsigned(run - 3));
+                run = 0;
+            }
+        } else {
+            emit(length, 0);
+            -- run;
+            for (; run >= 3; run -= std::min<size_t>(run, 6))
+                emit(16, unsigned(std::min<size_t>(run, 6) - 3));
+        }
+        for (; run > 0; -- run)
+            emit(length, 0);
+    }
+    std::vector<std::uint8_t>  cl_lengths = huffman_code_lengths(cl_freq, 7);
+    std::vector<std::uint16_t> cl_codes   = huffman_codes(cl_lengths);
+    static const unsigned char cl_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    unsigned num_cl = 19;
+    while (num_cl > 4 && cl_lengths[cl_order[num_cl - 1]] == 0)
+        -- num_cl;
+
+    // Block header
+    writer.put(final ? 1 : 0, 1);
+    writer.put(2, 2);
+    writer.put(num_lit - 257, 5);
+    writer.put(num_dist - 1, 5);
+    writer.put(num_cl - 4, 4);
+    for (unsigned i = 0; i < num_cl; ++ i)
+        writer.put(cl_lengths[cl_order[i]], 3);
+    static const unsigned char cl_extra_bits[3] = { 2, 3, 7 };
+    for (const CodeLength &cl : code_lengths) {
+        writer.put(cl_codes[cl.symbol], cl_lengths[cl.symbol]);
+        if (cl.symbol >= 16)
+            writer.put(cl.extra, cl_extra_bits[cl.symbol - 16]);
+    }
+
+    // Block data
+    for (const Token *token = begin; token != end; ++ token)
+        if (*token < TOKEN_MATCH)
+            writer.put(lit_codes[*token], lit_lengths[*token]);
+        else {
+            unsigned symbol, extra_bits, extra;
+            length_symbol(*token - TOKEN_MATCH, symbol, extra_bits, extra);
+            writer.put(lit_codes[symbol], lit_lengths[symbol]);
+            if (extra_bits > 0)
+                writer.put(extra, extra_bits);
+            writer.put(dist_codes[0], dist_lengths[0]);
+        }
+    writer.put(lit_codes[256], lit_lengths[256]);
+}
+
+// Deflates the filtered image data given as a sequence of runs of equal bytes and calculates its Adler-32.
+// Each run is deflated as a literal followed by matches of distance 1, its Adler-32 is calculated in a closed form.
+class RunDeflater {
+public:
+    RunDeflater() : m_adler_a(1), m_adler_b(0), m_run_value(0), m_run_len(0) {}
+
+    void add(std::uint8_t value, std::uint64_t len) {
+        if (value != m_run_value) {
+            flush_run();
+            m_run_value = value;
+        }
+        m_run_len += len;
+    }
+
+    // Append the deflate stream to out, ended with a final block if last, with a sync flush otherwise.
+    // Returns the Adler-32 of the data.
+    std::uint32_t finish(bool last, std::vector<std::uint8_t> &out) {
+        flush_run();
+        BitWriter writer(out);
+        const size_t block_size = 1 << 16;
+        size_t i = 0;
+        do {
+            size_t end = std::min(i + block_size, m_tokens.size());
+            deflate_block(writer, m_tokens.data() + i, m_tokens.data() + end, last && end == m_tokens.size());
+            i = end;
+        } while (i < m_tokens.size());
+        if (! last) {
+            // Empty stored block aligning the stream to a byte boundary.
+            writer.put(0, 3);
+            writer.flush();
+            out.insert(out.end(), { 0, 0, 0xff, 0xff });
+        }
+        writer.flush();
+        return std::uint32_t((m_adler_b << 16) | m_adler_a);
+    }
+
+private:
+    void flush_run() {
+        std::uint64_t len = m_run_len;
+        if (len == 0)
+            return;
+        const std::uint64_t adler_mod = 65521;
+        m_adler_b = (m_adler_b + (len % adler_mod) * m_adler_a + m_run_value * ((len * (len + 1) / 2) % adler_mod)) % adler_mod;
+        m_adler_a = (m_adler_a + len * m_run_value) % adler_mod;
+        m_tokens.push_back(m_run_value);
+        for (-- len; len >= 3;) {
+            unsigned match = unsigned(std::min<std::uint64_t>(len, 258));
+            m_tokens.push_back(Token(TOKEN_MATCH + match));
+            len -= match;
+        }
+        for (; len > 0; -- len)
+            m_tokens.push_back(m_run_value);
+        m_run_len = 0;
+    }
+
+    std::vector<Token> m_tokens;
+    std::uint64_t      m_adler_a;
+    std::uint64_t      m_adler_b;
+    std::uint8_t       m_run_value;
+    std::uint64_t      m_run_len;
+};
+
+// A part of a row of pixels of the same value, including the empty parts.
+struct Segment {
+    std::uint32_t len;
+    std::uint8_t  value;
+};
+
+static void row_segments(const RunLengthRaster::Row &row, std::uint32_t width, std::vector<Segment> &out)
+{
+    out.clear();
+    std::uint32_t x = 0;
+    for (const RunLengthRaster::Run &run : row) {
+        if (run.x > x)
+            out.push_back({ run.x - x, 0 });
+        out.push_back({ run.len, run.value });
+        x = run.x + run.len;
+    }
+    if (x < width)
+        out.push_back({ width - x, 0 });
+}
+
+} // namespace
+
+std::vector<std::uint8_t> RunLengthRaster::png(PNGFilter filter) const
+{
+    // The rows are filtered on the runs: SUB produces the differences at the run boundaries, UP the differences
+    // of the overlapping runs of the two rows. The filtered rows are passed to the deflater as runs again,
+    // merged over the row boundaries.
+    return png_encode_bands(m_width, m_height, [this, filter](unsigned row_begin, unsigned row_end, bool last, std::vector<std::uint8_t> &out) {
+        RunDeflater          deflater;
+        std::vector<Segment> segments;
+        std::vector<Segment> prev_segments;
+        if (filter == PNGFilter::UP && row_begin > 0)
+            row_segments(m_rows[row_begin - 1], m_width, prev_segments);
+        for (unsigned y = row_begin; y < row_end; ++ y) {
+            deflater.add(std::uint8_t(filter), 1);
+            row_segments(m_rows[y], m_width, segments);
+            if (filter == PNGFilter::SUB) {
+                std::uint8_t prev = 0;
+                for (const Segment &segment : segments) {
+                    deflater.add(std::uint8_t(segment.value - prev), 1);
+                    deflater.add(0, segment.len - 1);
+                    prev = segment.value;
+                }
+            } else if (filter == PNGFilter::UP && y > 0) {
+                size_t        i        = 0;
+                size_t        j        = 0;
+                std::uint32_t left     = segments.empty() ? 0 : segments.front().len;
+                std::uint32_t left_up  = prev_segments.empty() ? 0 : prev_segments.front().len;
+                while (i < segments.size()) {
+                    std::uint32_t len = std::min(left, left_up);
+                    deflater.add(std::uint8_t(segments[i].value - prev_segments[j].value), len);
+                    left    -= len;
+                    left_up -= len;
+                    if (left == 0 && ++ i < segments.size())
+                        left = segments[i].len;
+                    if (left_up == 0 && ++ j < prev_segments.size())
+                        left_up = prev_segments[j].len;
+                }
+            } else {
+                for (const Segment &segment : segments)
+                    deflater.add(segment.value, segment.len);
+            }
+            if (filter == PNGFilter::UP)
+                segments.swap(prev_segments);
+        }
+        return deflater.finish(last, out);
+    },
+    // Deflating the runs is cheap, thus the bands are larger than those of the pixel buffers, but small enough
+    // to split the 4K rasters (8.3 MB of the filtered rows) into 4 bands.
+    2 * 1024 * 1024);
+}
+
+}
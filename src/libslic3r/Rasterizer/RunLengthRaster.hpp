@@ -0,0 +1,102 @@
+#ifndef RUNLENGTHRASTER_HPP
+#define RUNLENGTHRASTER_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "PNGWriter.hpp"
+
+namespace Slic3r {
+
+/**
+ * @brief Monochrome raster image stored as runs of equal non-zero pixels on
+ * each row, with a scanline rasterizer drawing into it.
+ *
+ * The polygons are rasterized with the integer cell algorithm of AGG's
+ * rasterizer_scanline_aa (vertices in 24.8 fixed point pixel coordinates,
+ * cells accumulating the cover and area, non-zero filling rule, the 8 bit
+ * coverage passed through a gamma table) and blended with the white color the
+ * same way agg::pixfmt_gray8 does, so the pixels are identical to the AGG
+ * backend of Raster. Neither drawing nor the PNG encoding touch the empty
+ * areas of the image, as only the non-empty runs are stored and the runs are
+ * deflated directly, without expanding them into a pixel buffer.
+ */
+class RunLengthRaster {
+public:
+    /// A run of pixels with the same non-zero value on a row.
+    struct Run {
+        std::uint32_t x;
+        std::uint32_t len;
+        std::uint8_t  value;
+    };
+    using Row = std::vector<Run>;
+
+    /// Vertex in pixel coordinates multiplied by 256 (AGG's poly_subpixel_scale).
+    struct Vertex {
+        int x, y;
+        Vertex(int px, int py): x(px), y(py) {}
+    };
+    using Path = std::vector<Vertex>;
+
+    /// Maps the 8 bit coverage of a pixel to its alpha.
+    using GammaTable = std::array<std::uint8_t, 256>;
+
+    RunLengthRaster(unsigned width, unsigned height, const GammaTable &gamma);
+
+    unsigned width() const { return m_width; }
+    unsigned height() const { return m_height; }
+    const Row& row(unsigned y) const { return m_rows[y]; }
+
+    /// Clear the image with black color.
+    void clear();
+
+    /// Rasterize a polygon given by its closed paths (the contour and the
+    /// holes, filled with the non-zero rule) and blend it onto the image.
+    void draw(const std::vector<Path> &paths);
+
+    /// Expand the runs into a row major buffer of width() * height() pixels.
+    void decode(std::uint8_t *dst) const;
+
+    /// Encode the image into an 8 bit grayscale PNG file in memory. The
+    /// rows are filtered and deflated as runs, large images in parallel. There
+    /// is no compression level, the runs are always deflated the same way.
+    std::vector<std::uint8_t> png(PNGFilter filter = PNGFilter::NONE) const;
+
+private:
+    struct Cell {
+        int x, y;
+        int cover, area;
+    };
+
+    // Port of agg::rasterizer_cells_aa, which generates the cells crossed by
+    // the polygon edges into m_cells.
+    void line(int x1, int y1, int x2, int y2);
+    void render_hline(int ey, int x1, int y1, int x2, int y2);
+    void set_curr_cell(int x, int y);
+    void add_curr_cell();
+
+    // Port of agg::rasterizer_scanline_aa::sweep_scanline() for a single row,
+    // producing the spans of the polygon into m_spans.
+    void sweep_row(const Cell *begin, const Cell *end);
+    void add_span(int x, int len, unsigned alpha);
+    unsigned calculate_alpha(int area) const;
+    // Blend m_spans onto the row y of the image.
+    void blend_row(unsigned y);
+
+    unsigned          m_width;
+    unsigned          m_height;
+    GammaTable        m_gamma;
+    std::vector<Row>  m_rows;
+
+    // Work buffers, kept to reuse their memory between the draw() calls.
+    Cell              m_curr_cell;
+    std::vector<Cell> m_cells;
+    std::vector<Cell> m_sorted_cells;
+    std::vector<int>  m_row_offsets;
+    Row               m_spans;
+    Row               m_blended;
+};
+
+}
+#endif // RUNLENGTHRASTER_HPP
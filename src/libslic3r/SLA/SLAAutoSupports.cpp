@@ -65,17 +65,25 @@ void SLAAutoSupports::project_onto_mesh(std::vector<sla::SupportPoint>& points)
     // Use a reasonable granularity to account for the worker thread synchronization cost.
     tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size(), 64),
         [this, &points](const tbb::blocked_range<size_t>& range) {
+            // The points are generated island by island, so the neighbors are close to each other. Their vertical rays
+            // are cast in packets, all the upward rays first, then all the downward ones.
+            std::vector<Vec3d> sources;
+            sources.reserve(range.size());
+            for (size_t point_id = range.begin(); point_id < range.end(); ++ point_id)
+                sources.emplace_back(points[point_id].pos.cast<double>());
+            m_throw_on_cancel();
+            std::vector<sla::EigenMesh3D::hit_result> hits_up   = m_emesh.query_ray_hits(sources, std::vector<Vec3d>(sources.size(), Vec3d(0., 0., 1.)));
+            m_throw_on_cancel();
+            std::vector<sla::EigenMesh3D::hit_result> hits_down = m_emesh.query_ray_hits(sources, std::vector<Vec3d>(sources.size(), Vec3d(0., 0., -1.)));
+
             for (size_t point_id = range.begin(); point_id < range.end(); ++ point_id) {
-                if ((point_id % 16) == 0)
-                    // Don't call the following function too often as it flushes CPU write caches due to synchronization primitves.
-                    m_throw_on_cancel();
                 Vec3f& p = points[point_id].pos;
                 // Project the point upward and downward and choose the closer intersection with the mesh.
                 //bool up   = igl::ray_mesh_intersect(p.cast<float>(), Vec3f(0., 0., 1.), m_V, m_F, hit_up);
                 //bool down = igl::ray_mesh_intersect(p.cast<float>(), Vec3f(0., 0., -1.), m_V, m_F, hit_down);
 
-                sla::EigenMesh3D::hit_result hit_up   = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., 1.));
-                sla::EigenMesh3D::hit_result hit_down = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., -1.));
+                sla::EigenMesh3D::hit_result &hit_up   = hits_up[point_id - range.begin()];
+                sla::EigenMesh3D::hit_result &hit_down = hits_down[point_id - range.begin()];
 
                 bool up   = hit_up.face() != -1;
                 bool down = hit_down.face() != -1;
@@ -3,6 +3,7 @@
 
 #include <Eigen/Geometry>
 #include <memory>
+#include <vector>
 
 // #define SLIC3R_SLA_NEEDS_WINDTREE
 
@@ -92,8 +93,10 @@ public:
 
         // This can create a placeholder object which is invalid (not created
         // by a query_ray_hit call) but the distance can be preset to
-        // a specific value for distinguishing the placeholder.
-        inline hit_result(double val = std::nan("")): m_t(val) {}
+        // a specific value for distinguishing the placeholder. The direction
+        // and the source are zeroed, so that the placeholder may be copied.
+        inline hit_result(double val = std::nan("")):
+            m_t(val), m_dir(Vec3d::Zero()), m_source(Vec3d::Zero()) {}
 
         inline double distance() const { return m_t; }
         inline const Vec3d& direction() const { return m_dir; }
@@ -123,6 +126,13 @@ public:
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
 
+    // Casting a bundle of rays on the mesh, one hit result for each pair of
+    // source and direction. The rays are traversed together in packets of
+    // consecutive rays, which is much faster than casting them one by one if
+    // they are coherent: their sources are close and their directions similar.
+    std::vector<hit_result> query_ray_hits(const std::vector<Vec3d> &sources,
+                                           const std::vector<Vec3d> &dirs) const;
+
     class si_result {
         double m_value;
         int m_fidx;
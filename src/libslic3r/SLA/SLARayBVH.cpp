@@ -0,0 +1,320 @@
+#include "SLARayBVH.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace Slic3r {
+namespace sla {
+
+namespace {
+
+// The maximum number of the triangles in a leaf.
+const size_t MAX_LEAF_SIZE = 4;
+
+// The number of the bins the surface area heuristic evaluates the splits in.
+const size_t SAH_BINS = 16;
+
+// Below this depth the nodes are split at the median, so that the depth (and
+// the traversal stack) stays bounded even for badly shaped meshes.
+const unsigned SAH_MAX_DEPTH = 40;
+
+const size_t TRAVERSAL_STACK_SIZE = 128;
+
+// The same threshold of the determinant as in igl::ray_mesh_intersect().
+const double DET_EPSILON = 0.000001;
+
+float round_down(double v)
+{
+    float f = float(v);
+    return double(f) > v ? std::nextafter(f, - std::numeric_limits<float>::infinity()) : f;
+}
+
+float round_up(double v)
+{
+    float f = float(v);
+    return double(f) < v ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+}
+
+struct Box {
+    Vec3d min = Vec3d::Constant(  std::numeric_limits<double>::max());
+    Vec3d max = Vec3d::Constant(- std::numeric_limits<double>::max());
+
+    void extend(const Vec3d &p) { min = min.cwiseMin(p); max = max.cwiseMax(p); }
+    void extend(const Box &b) { min = min.cwiseMin(b.min); max = max.cwiseMax(b.max); }
+    bool empty() const { return min(0) > max(0); }
+
+    double half_area() const {
+        if (empty()) return 0.;
+        Vec3d d = max - min;
+        return d(0) * d(1) + d(1) * d(2) + d(2) * d(0);
+    }
+};
+
+}
+
+struct RayBVH::BuildItem {
+    Box   box;
+    Vec3d centroid;
+    int   face;
+};
+
+RayBVH::RayBVH(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+{
+    if (F.rows() == 0) return;
+
+    std::vector<BuildItem> items(size_t(F.rows()));
+    for (Eigen::Index i = 0; i < F.rows(); ++ i) {
+        BuildItem &item = items[size_t(i)];
+        for (int j = 0; j < 3; ++ j)
+            item.box.extend(Vec3d(V.row(F(i, j))));
+        item.centroid = 0.5 * (item.box.min + item.box.max);
+        item.face     = int(i);
+    }
+
+    m_nodes.reserve(2 * items.size() / MAX_LEAF_SIZE + 1);
+    m_triangles.reserve(items.size());
+
+    build(items, 0, items.size(), 0);
+
+    // The edges are computed the same way as igl does, so that the hits are
+    // the same.
+    for (Triangle &tri : m_triangles) {
+        auto   idx = F.row(tri.face);
+        Vec3d  v0  = V.row(idx(0)), v1 = V.row(idx(1)), v2 = V.row(idx(2));
+        tri.v0 = v0;
+        tri.e1 = v1 - v0;
+        tri.e2 = v2 - v0;
+    }
+}
+
+size_t RayBVH::build(std::vector<BuildItem> &items, size_t begin, size_t end,
+                     unsigned depth)
+{
+    size_t idx = m_nodes.size();
+    m_nodes.emplace_back();
+
+    Box box, cbox;
+    for (size_t i = begin; i < end; ++ i) {
+        box.extend(items[i].box);
+        cbox.extend(items[i].centroid);
+    }
+
+    {
+        Node &node = m_nodes[idx];
+        for (int k = 0; k < 3; ++ k) {
+            node.bmin[k] = round_down(box.min(k));
+            node.bmax[k] = round_up(box.max(k));
+        }
+    }
+
+    size_t n = end - begin;
+    if (n <= MAX_LEAF_SIZE) {
+        Node &node = m_nodes[idx];
+        node.index = uint32_t(m_triangles.size());
+        node.count = uint16_t(n);
+        node.axis  = 0;
+        for (size_t i = begin; i < end; ++ i) {
+            m_triangles.emplace_back();
+            m_triangles.back().face = items[i].face;
+        }
+        return idx;
+    }
+
+    Vec3d    cext = cbox.max - cbox.min;
+    unsigned axis = 0;
+    if (cext(1) > cext(axis)) axis = 1;
+    if (cext(2) > cext(axis)) axis = 2;
+
+    auto by_axis = [axis](const BuildItem &a, const BuildItem &b) {
+        return a.centroid(axis) < b.centroid(axis);
+    };
+
+    size_t mid = begin;
+    if (cext(axis) <= 0.) {
+        // All the centroids are the same, any split will do.
+        mid = begin + n / 2;
+    } else if (depth < SAH_MAX_DEPTH) {
+        // Binned surface area heuristic along the longest axis of the
+        // centroids.
+        double scale = double(SAH_BINS) / cext(axis);
+        auto   bin_of = [&cbox, axis, scale](const BuildItem &item) {
+            size_t b = size_t((item.centroid(axis) - cbox.min(axis)) * scale);
+            return std::min(b, SAH_BINS - 1);
+        };
+
+        std::array<Box, SAH_BINS>    bins;
+        std::array<size_t, SAH_BINS> counts {};
+        for (size_t i = begin; i < end; ++ i) {
+            size_t b = bin_of(items[i]);
+            bins[b].extend(items[i].box);
+            ++ counts[b];
+        }
+
+        // Cost of the right parts of the splits, the split b puts the bins
+        // below b to the left.
+        std::array<double, SAH_BINS> right_cost {};
+        Box    acc;
+        size_t cnt = 0;
+        for (size_t b = SAH_BINS - 1; b > 0; -- b) {
+            acc.extend(bins[b]);
+            cnt += counts[b];
+            right_cost[b] = acc.half_area() * double(cnt);
+        }
+
+        size_t best      = 0;
+        double best_cost = std::numeric_limits<double>::max();
+        acc = Box();
+        cnt = 0;
+        for (size_t b = 1; b < SAH_BINS; ++ b) {
+            acc.extend(bins[b - 1]);
+            cnt += counts[b - 1];
+            double cost = acc.half_area() * double(cnt) + right_cost[b];
+            if (cnt > 0 && cnt < n && cost < best_cost) {
+                best      = b;
+                best_cost = cost;
+            }
+        }
+
+        if (best > 0)
+            mid = size_t(std::partition(items.begin() + long(begin), items.begin() + long(end),
+                                        [&bin_of, best](const BuildItem &item) {
+                                            return bin_of(item) < best;
+                                        }) - items.begin());
+    }
+
+    if (mid <= begin || mid >= end) {
+        mid = begin + n / 2;
+        std::nth_element(items.begin() + long(begin), items.begin() + long(mid),
+                         items.begin() + long(end), by_axis);
+    }
+
+    build(items, begin, mid, depth + 1);
+    size_t right = build(items, mid, end, depth + 1);
+
+    Node &node = m_nodes[idx];
+    node.index = uint32_t(right);
+    node.count = 0;
+    node.axis  = uint16_t(axis);
+
+    return idx;
+}
+
+void RayBVH::intersect(const Vec3d *sources, const Vec3d *dirs, size_t n,
+                       Hit *hits) const
+{
+    for (size_t i = 0; i < n; i += PACKET_SIZE)
+        intersect_packet(sources + i, dirs + i, std::min(PACKET_SIZE, n - i),
+                         hits + i);
+}
+
+void RayBVH::intersect_packet(const Vec3d *sources, const Vec3d *dirs,
+                              size_t n, Hit *hits) const
+{
+    static const size_t N = PACKET_SIZE;
+    assert(n > 0 && n <= N);
+
+    for (size_t l = 0; l < n; ++ l) hits[l] = Hit();
+    if (m_nodes.empty()) return;
+
+    // The rays in the structure of arrays layout. The unused lanes repeat the
+    // first ray with a negative limit of t, so they never hit anything.
+    alignas(64) double ox[N], oy[N], oz[N], dx[N], dy[N], dz[N];
+    alignas(64) double ix[N], iy[N], iz[N], tbest[N];
+    alignas(64) int    face[N];
+    for (size_t l = 0; l < N; ++ l) {
+        size_t r = l < n ? l : 0;
+        ox[l] = sources[r](0); oy[l] = sources[r](1); oz[l] = sources[r](2);
+        dx[l] = dirs[r](0);    dy[l] = dirs[r](1);    dz[l] = dirs[r](2);
+        // Division by zero gives an infinity, the slab test handles it.
+        ix[l] = 1. / dx[l];    iy[l] = 1. / dy[l];    iz[l] = 1. / dz[l];
+        tbest[l] = l < n ? std::numeric_limits<double>::infinity() :
+                           - std::numeric_limits<double>::infinity();
+        face[l]  = -1;
+    }
+
+    // The children are visited in the order of the mean direction.
+    double dsum[3] = { 0., 0., 0. };
+    for (size_t l = 0; l < n; ++ l) {
+        dsum[0] += dx[l]; dsum[1] += dy[l]; dsum[2] += dz[l];
+    }
+
+    std::array<uint32_t, TRAVERSAL_STACK_SIZE> stack;
+    size_t top = 0;
+    stack[top ++] = 0;
+
+    while (top > 0) {
+        const Node &node = m_nodes[stack[-- top]];
+
+        // The slab test of all the lanes. A ray starting on a slab and
+        // parallel to it gives 0 * inf = NaN, the comparisons are ordered so
+        // that the slab is ignored then.
+        alignas(64) int mask[N];
+        int any = 0;
+        for (size_t l = 0; l < N; ++ l) {
+            double tnear = 0., tfar = tbest[l];
+            auto slab = [&tnear, &tfar](double t1, double t2) {
+                tnear = (t1 > tnear && t2 > tnear) ? (t1 < t2 ? t1 : t2) : tnear;
+                tfar  = (t1 < tfar  && t2 < tfar)  ? (t1 < t2 ? t2 : t1) : tfar;
+            };
+            slab((double(node.bmin[0]) - ox[l]) * ix[l], (double(node.bmax[0]) - ox[l]) * ix[l]);
+            slab((double(node.bmin[1]) - oy[l]) * iy[l], (double(node.bmax[1]) - oy[l]) * iy[l]);
+            slab((double(node.bmin[2]) - oz[l]) * iz[l], (double(node.bmax[2]) - oz[l]) * iz[l]);
+            mask[l] = tnear <= tfar;
+            any |= mask[l];
+        }
+
+        if (! any) continue;
+
+        if (node.count == 0) {
+            uint32_t first = uint32_t(&node - m_nodes.data()) + 1;
+            uint32_t second = node.index;
+            if (dsum[node.axis] < 0.) std::swap(first, second);
+            assert(top + 2 <= stack.size());
+            stack[top ++] = second;
+            stack[top ++] = first;
+            continue;
+        }
+
+        for (uint32_t i = node.index; i < node.index + node.count; ++ i) {
+            const Triangle &tri = m_triangles[i];
+            for (size_t l = 0; l < N; ++ l) {
+                if (! mask[l]) continue;
+
+                // Möller-Trumbore as in igl::intersect_triangle1().
+                double px = dy[l] * tri.e2(2) - dz[l] * tri.e2(1);
+                double py = dz[l] * tri.e2(0) - dx[l] * tri.e2(2);
+                double pz = dx[l] * tri.e2(1) - dy[l] * tri.e2(0);
+                double det = tri.e1(0) * px + tri.e1(1) * py + tri.e1(2) * pz;
+                if (det > - DET_EPSILON && det < DET_EPSILON) continue;
+
+                double tx = ox[l] - tri.v0(0);
+                double ty = oy[l] - tri.v0(1);
+                double tz = oz[l] - tri.v0(2);
+                double u  = tx * px + ty * py + tz * pz;
+                double qx = ty * tri.e1(2) - tz * tri.e1(1);
+                double qy = tz * tri.e1(0) - tx * tri.e1(2);
+                double qz = tx * tri.e1(1) - ty * tri.e1(0);
+                double v  = dx[l] * qx + dy[l] * qy + dz[l] * qz;
+                if (det > 0. ? (u < 0. || u > det || v < 0. || u + v > det) :
+                               (u > 0. || u < det || v > 0. || u + v < det))
+                    continue;
+
+                double t = (tri.e2(0) * qx + tri.e2(1) * qy + tri.e2(2) * qz) * (1. / det);
+                if (t > 0. && t < tbest[l]) {
+                    tbest[l] = t;
+                    face[l]  = tri.face;
+                }
+            }
+        }
+    }
+
+    for (size_t l = 0; l < n; ++ l) {
+        hits[l].t    = tbest[l];
+        hits[l].face = face[l];
+    }
+}
+
+} // namespace sla
+} // namespace Slic3r
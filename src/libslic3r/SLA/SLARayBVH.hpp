@@ -0,0 +1,84 @@
+#ifndef SLARAYBVH_HPP
+#define SLARAYBVH_HPP
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include "SLACommon.hpp"
+
+namespace Slic3r {
+namespace sla {
+
+/// A bounding volume hierarchy over the triangles of an indexed mesh, built
+/// for casting rays. The nodes are stored in a flat array in depth first
+/// order with their boxes in single precision, so a node takes 32 bytes and
+/// its first child follows it in the memory. The triangles are stored in the
+/// order of the leaves with their edges precomputed.
+///
+/// The rays are cast in packets of up to PACKET_SIZE rays, which visit the
+/// nodes together: each node is loaded once for the whole packet and its box
+/// is tested against all the rays of the packet at once. This pays off for
+/// coherent rays, like the rays sampled around a support head, which mostly
+/// visit the same nodes.
+///
+/// The intersections are computed as igl::ray_mesh_intersect() does: the
+/// closest hit at t > 0 of a double sided triangle.
+class RayBVH {
+public:
+    static const size_t PACKET_SIZE = 8;
+
+    struct Hit {
+        double t    = std::numeric_limits<double>::infinity();
+        int    face = -1;
+    };
+
+    RayBVH() = default;
+    RayBVH(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F);
+
+    // Cast the n rays, sources[i] + t * dirs[i], and fill in the closest
+    // hits. The face is -1 and t is infinity where the ray misses the mesh.
+    // The consecutive rays are grouped into packets, so the coherent rays
+    // should be next to each other.
+    void intersect(const Vec3d *sources, const Vec3d *dirs, size_t n,
+                   Hit *hits) const;
+
+    Hit intersect(const Vec3d& source, const Vec3d& dir) const {
+        Hit hit; intersect(&source, &dir, 1, &hit); return hit;
+    }
+
+    bool empty() const { return m_nodes.empty(); }
+
+private:
+    struct Node {
+        float bmin[3], bmax[3];
+        // The index of the second child of an inner node (the first child
+        // follows the node) or the index of the first triangle of a leaf.
+        uint32_t index;
+        // The number of the triangles of a leaf, 0 for an inner node.
+        uint16_t count;
+        // The axis along which the children of an inner node were split.
+        uint16_t axis;
+    };
+
+    struct Triangle {
+        Vec3d v0, e1, e2;
+        int   face;
+    };
+
+    struct BuildItem;
+
+    size_t build(std::vector<BuildItem>& items, size_t begin, size_t end,
+                 unsigned depth);
+
+    void intersect_packet(const Vec3d *sources, const Vec3d *dirs, size_t n,
+                          Hit *hits) const;
+
+    std::vector<Node>     m_nodes;
+    std::vector<Triangle> m_triangles;
+};
+
+} // namespace sla
+} // namespace Slic3r
+
+#endif // SLARAYBVH_HPP
@@ -28,7 +28,7 @@ std::array<double, 3> find_best_rotation(const ModelObject& modelobj,
 
     // We will use only one instance of this converted mesh to examine different
     // rotations
-    EigenMesh3D emesh(modelobj.raw_mesh());
+    EigenMesh3D emesh(*modelobj.raw_mesh());
 
     // For current iteration number
     unsigned status = 0;
@@ -0,0 +1,243 @@
+#include "SLASupportSolids.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Geometry.hpp>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// Intersect the interval [lo, hi] with the solutions of c * x <= m.
+bool clip_interval(double c, double m, double &lo, double &hi)
+{
+    if (std::abs(c) < 1e-12) {
+        if (m < 0) return false;
+    } else if (c > 0)
+        hi = std::min(hi, m / c);
+    else
+        lo = std::max(lo, m / c);
+
+    return lo <= hi;
+}
+
+// The i-th of the n samples of the interval [lo, hi], denser at its ends. On
+// an ellipse of a cylinder section this is an even distribution of the angle.
+double sample(double lo, double hi, unsigned i, unsigned n)
+{
+    if (n < 2) return lo;
+    return 0.5 * (lo + hi) - 0.5 * (hi - lo) * std::cos(PI * i / (n - 1));
+}
+
+void append_circle(Points &out, double cx, double cy, double r, unsigned steps)
+{
+    out.reserve(out.size() + steps);
+    for (unsigned i = 0; i < steps; ++ i) {
+        double a = 2 * PI * i / steps;
+        out.emplace_back(Point::new_scale(cx + r * std::cos(a),
+                                          cy + r * std::sin(a)));
+    }
+}
+
+Polygon section_disks(const SupportSolid &s, double z)
+{
+    Vec3d  d = s.p2 - s.p1;
+    double l = d.norm();
+    if (l < EPSILON) return Polygon();
+    d /= l;
+
+    double k    = (s.r2 - s.r1) / l;
+    double hlen = std::sqrt(d(X) * d(X) + d(Y) * d(Y));
+
+    Polygon out;
+    if (hlen < 1e-6) { // Vertical axis, the section is a circle.
+        double sz = (z - s.p1(Z)) / d(Z);
+        if (sz < 0. || sz > l) return Polygon();
+        double r = s.r1 + k * sz;
+        if (r <= 0.) return Polygon();
+        append_circle(out.points, s.p1(X), s.p1(Y), r, s.steps);
+        return out;
+    }
+
+    // Coordinates of a point p = p1 + s * d + w * e + t * f of the plane z in
+    // the frame of the axis. The vector e is horizontal and f_z == hlen, so
+    // t is a linear function of s.
+    Vec3d  e(- d(Y) / hlen, d(X) / hlen, 0.);
+    Vec3d  f = d.cross(e);
+    double a = (z - s.p1(Z)) / hlen;
+    double b = d(Z) / hlen;
+
+    auto tfn = [a, b](double sz) { return a - b * sz; };
+    auto rfn = [&s, k](double sz) { return s.r1 + k * sz; };
+
+    // The part of the axis where the plane is within the radius:
+    // |t(s)| <= r(s), 0 <= s <= l
+    double lo = 0., hi = l;
+    if (! clip_interval(- b - k, s.r1 - a, lo, hi) ||
+        ! clip_interval(b - k, s.r1 + a, lo, hi))
+        return Polygon();
+
+    auto angle = [&tfn, &rfn](double sz) {
+        double r = rfn(sz);
+        return r > 0. ? std::acos(std::min(1., std::max(-1., tfn(sz) / r))) : 0.;
+    };
+
+    unsigned n = 2 + unsigned(std::ceil(std::abs(angle(hi) - angle(lo)) *
+                                        s.steps / (2 * PI)));
+
+    std::vector<double> svals(n), wvals(n);
+    for (unsigned i = 0; i < n; ++ i) {
+        double sz = sample(lo, hi, i, n), t = tfn(sz), r = rfn(sz);
+        svals[i] = sz;
+        wvals[i] = std::sqrt(std::max(0., r * r - t * t));
+    }
+
+    auto point = [&s, &d, &e, &f, &tfn](double sz, double w) {
+        Vec3d p = s.p1 + sz * d + w * e + tfn(sz) * f;
+        return Point::new_scale(p(X), p(Y));
+    };
+
+    out.points.reserve(2 * n);
+    for (unsigned i = 0; i < n; ++ i)
+        out.points.emplace_back(point(svals[i], wvals[i]));
+    for (unsigned i = n; i > 0; -- i)
+        if (wvals[i - 1] > 0.)
+            out.points.emplace_back(point(svals[i - 1], - wvals[i - 1]));
+
+    out.remove_duplicate_points();
+    if (out.points.size() < 3) return Polygon();
+    out.make_counter_clockwise();
+    return out;
+}
+
+void append_sphere_section(Points &out, const Vec3d &c, double r, double z,
+                           unsigned steps)
+{
+    double rho2 = r * r - (z - c(Z)) * (z - c(Z));
+    if (rho2 > 0.) append_circle(out, c(X), c(Y), std::sqrt(rho2), steps);
+}
+
+// The hull of two spheres is the union of the spheres and of the truncated
+// cone touching both of them, so its convex section is the hull of their
+// sections.
+Polygon section_spheres(const SupportSolid &s, double z)
+{
+    Vec3d  u = s.p2 - s.p1;
+    double l = u.norm();
+
+    Points pts;
+    if (l <= std::abs(s.r1 - s.r2)) { // One of the spheres contains the other.
+        if (s.r1 >= s.r2) append_sphere_section(pts, s.p1, s.r1, z, s.steps);
+        else              append_sphere_section(pts, s.p2, s.r2, z, s.steps);
+        return Polygon(std::move(pts));
+    }
+
+    append_sphere_section(pts, s.p1, s.r1, z, s.steps);
+    append_sphere_section(pts, s.p2, s.r2, z, s.steps);
+
+    // The cone touches the spheres on circles shifted along the axis by
+    // r * sin(phi), with the radii r * cos(phi).
+    u /= l;
+    double sinphi = (s.r1 - s.r2) / l;
+    double cosphi = std::sqrt(1. - sinphi * sinphi);
+    SupportSolid cone(SupportSolid::DISKS,
+                      s.p1 + s.r1 * sinphi * u, s.p2 + s.r2 * sinphi * u,
+                      s.r1 * cosphi, s.r2 * cosphi, s.steps);
+    Polygon cone_section = section_disks(cone, z);
+    pts.insert(pts.end(), cone_section.points.begin(), cone_section.points.end());
+
+    if (pts.size() < 3) return Polygon();
+    Polygon out = Geometry::convex_hull(std::move(pts));
+    return out.points.size() < 3 ? Polygon() : out;
+}
+
+}
+
+double SupportSolid::min_z() const
+{
+    if (shape == SPHERES)
+        return std::max(zcut_bottom, std::min(p1(Z) - r1, p2(Z) - r2));
+
+    // The disks reach below their centers by r times the sine of the tilt.
+    Vec3d  d = p2 - p1;
+    double l = d.norm();
+    double h = l > 0. ? std::sqrt(d(X) * d(X) + d(Y) * d(Y)) / l : 0.;
+    return std::max(zcut_bottom, std::min(p1(Z) - r1 * h, p2(Z) - r2 * h));
+}
+
+double SupportSolid::max_z() const
+{
+    if (shape == SPHERES)
+        return std::min(zcut_top, std::max(p1(Z) + r1, p2(Z) + r2));
+
+    Vec3d  d = p2 - p1;
+    double l = d.norm();
+    double h = l > 0. ? std::sqrt(d(X) * d(X) + d(Y) * d(Y)) / l : 0.;
+    return std::min(zcut_top, std::max(p1(Z) + r1 * h, p2(Z) + r2 * h));
+}
+
+Polygon section(const SupportSolid &solid, double z)
+{
+    if (z < solid.zcut_bottom || z > solid.zcut_top) return Polygon();
+    return solid.shape == SupportSolid::SPHERES ? section_spheres(solid, z) :
+                                                  section_disks(solid, z);
+}
+
+void slice(const std::vector<SupportSolid> &solids,
+           const std::vector<float> &heights,
+           float closing_radius,
+           std::vector<ExPolygons> &layers,
+           std::function<void(void)> throw_on_cancel)
+{
+    if (layers.empty()) layers.resize(heights.size());
+    assert(layers.size() == heights.size());
+
+    // The Z interval index: the solids crossing each of the layers, found
+    // by a binary search of the ends of their intervals in the sorted heights.
+    std::vector<size_t> order(heights.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&heights](size_t i, size_t j) {
+        return heights[i] < heights[j];
+    });
+
+    std::vector<std::vector<unsigned>> layer_solids(heights.size());
+    for (size_t idx = 0; idx < solids.size(); ++ idx) {
+        double zmin = solids[idx].min_z(), zmax = solids[idx].max_z();
+        auto it = std::lower_bound(order.begin(), order.end(), zmin,
+                                   [&heights](size_t i, double z) {
+                                       return heights[i] < z;
+                                   });
+        for (; it != order.end() && heights[*it] <= zmax; ++ it)
+            layer_solids[*it].emplace_back(unsigned(idx));
+    }
+
+    float delta = float(scale_(closing_radius));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, heights.size()),
+        [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+            throw_on_cancel();
+            const std::vector<unsigned> &idx = layer_solids[layer_id];
+            if (idx.empty()) continue;
+
+            Polygons polys = to_polygons(std::move(layers[layer_id]));
+            polys.reserve(polys.size() + idx.size());
+            for (unsigned i : idx) {
+                Polygon p = section(solids[i], double(heights[layer_id]));
+                if (! p.points.empty()) polys.emplace_back(std::move(p));
+            }
+
+            layers[layer_id] = delta > 0 ?
+                offset2_ex(union_(polys, false), + delta, - delta) :
+                union_ex(polys, false);
+        }
+    });
+}
+
+}
+}
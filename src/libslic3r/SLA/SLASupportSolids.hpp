@@ -0,0 +1,84 @@
+#ifndef SLASUPPORTSOLIDS_HPP
+#define SLASUPPORTSOLIDS_HPP
+
+#include <vector>
+#include <functional>
+#include <limits>
+
+#include "SLACommon.hpp"
+
+namespace Slic3r {
+
+class Polygon;
+class ExPolygon;
+using ExPolygons = std::vector<ExPolygon>;
+
+namespace sla {
+
+/// One of the convex solids the support tree is built from, described by its
+/// parameters instead of a triangle mesh, so that it can be sliced in closed
+/// form.
+struct SupportSolid {
+    enum Shape {
+        // Convex hull of the spheres centered at p1 and p2 with the radii r1
+        // and r2: a sphere, a capsule or the tapered head of a support.
+        SPHERES,
+        // Convex hull of the disks centered at p1 and p2 with the radii r1
+        // and r2, both perpendicular to p2 - p1: a cylinder or a truncated
+        // cone.
+        DISKS
+    };
+
+    Shape    shape;
+    Vec3d    p1, p2;
+    double   r1, r2;
+    // Number of the segments of the circles, as in the support mesh.
+    unsigned steps;
+    // The solid is cut by the horizontal planes at these heights.
+    double   zcut_bottom = -std::numeric_limits<double>::infinity();
+    double   zcut_top    =  std::numeric_limits<double>::infinity();
+
+    SupportSolid(Shape s, const Vec3d& c1, const Vec3d& c2,
+                 double rad1, double rad2, unsigned st):
+        shape(s), p1(c1), p2(c2), r1(rad1), r2(rad2),
+        steps(st < 3 ? 3 : st) {}
+
+    static SupportSolid sphere(const Vec3d& c, double r, unsigned st) {
+        return SupportSolid(SPHERES, c, c, r, r, st);
+    }
+
+    // A sphere cut by the horizontal planes at zbottom and ztop.
+    static SupportSolid cut_sphere(const Vec3d& c, double r,
+                                   double zbottom, double ztop, unsigned st)
+    {
+        SupportSolid ret = sphere(c, r, st);
+        ret.zcut_bottom = zbottom;
+        ret.zcut_top    = ztop;
+        return ret;
+    }
+
+    double min_z() const;
+    double max_z() const;
+};
+
+/// Cross section of the solid with the horizontal plane at the height z, a
+/// convex counter-clockwise polygon in scaled coordinates with its vertices on
+/// the surface of the solid. Empty if the plane misses the solid.
+Polygon section(const SupportSolid& solid, double z);
+
+/// Slice the solids at the given heights. The sections are united on each
+/// layer together with the polygons already in layers (if not empty, it has to
+/// have the size of heights), with the same closing of the gaps narrower than
+/// 2 * closing_radius as TriangleMeshSlicer does. The solids crossing a layer
+/// are looked up in an index of their Z intervals and the layers are processed
+/// in parallel.
+void slice(const std::vector<SupportSolid>& solids,
+           const std::vector<float>& heights,
+           float closing_radius,
+           std::vector<ExPolygons>& layers,
+           std::function<void(void)> throw_on_cancel = [](){});
+
+}
+}
+
+#endif // SLASUPPORTSOLIDS_HPP
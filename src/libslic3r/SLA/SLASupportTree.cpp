@@ -8,6 +8,7 @@
 #include "SLABoilerPlate.hpp"
 #include "SLASpatIndex.hpp"
 #include "SLABasePool.hpp"
+#include "SLASupportSolids.hpp"
 
 #include <libslic3r/ClipperUtils.hpp>
 #include <libslic3r/Model.hpp>
@@ -394,6 +395,10 @@ struct Pillar {
     Vec3d endpt;
     double height = 0;
 
+    // The dimensions of the base cone, if there is one.
+    double base_r = 0;
+    double base_height = 0;
+
     long id = -1;
 
     // If the pillar connects to a head, this is the id of that head
@@ -447,6 +452,9 @@ struct Pillar {
 
         if(radius < r ) radius = r;
 
+        base_r = radius;
+        base_height = baseheight;
+
         double a = 2*PI/steps;
         double z = endpt(Z) + baseheight;
 
@@ -493,6 +501,8 @@ struct Pillar {
 struct Bridge {
     Contour3D mesh;
     double r = 0.8;
+    size_t steps = 45;
+    Vec3d startp, endp;
 
     long id = -1;
     long start_jid = -1;
@@ -501,7 +511,7 @@ struct Bridge {
     // We should reduce the radius a tiny bit to help the convex hull algorithm
     Bridge(const Vec3d& j1, const Vec3d& j2,
            double r_mm = 0.8, size_t steps = 45):
-        r(r_mm)
+        r(r_mm), steps(steps), startp(j1), endp(j2)
     {
         using Quaternion = Eigen::Quaternion<double>;
         Vec3d dir = (j2 - j1).normalized();
@@ -522,17 +532,21 @@ struct Bridge {
 // edges on the endpoints. Used for headless support points.
 struct CompactBridge {
     Contour3D mesh;
+    double r = 0.8;
+    size_t steps = 45;
+    Vec3d startp, endp;
     long id = -1;
 
     CompactBridge(const Vec3d& sp,
                   const Vec3d& ep,
                   const Vec3d& n,
-                  double r,
-                  size_t steps = 45)
+                  double r_mm,
+                  size_t stepnum = 45):
+        r(r_mm), steps(stepnum)
     {
-        Vec3d startp = sp + r * n;
+        startp = sp + r * n;
         Vec3d dir = (ep - startp).normalized();
-        Vec3d endp = ep - r * dir;
+        endp = ep - r * dir;
 
         Bridge br(startp, endp, r, steps);
         mesh.merge(br.mesh);
@@ -646,6 +660,8 @@ class SLASupportTree::Impl {
 
     Pad m_pad;
     mutable TriangleMesh meshcache; mutable bool meshcache_valid = false;
+    mutable std::vector<SupportSolid> solidcache;
+    mutable bool solidcache_valid = false;
     mutable double model_height = 0; // the full height of the model
 public:
     double ground_level = 0;
@@ -661,6 +677,7 @@ public:
                             std::forward_as_tuple(std::forward<Args>(args)...));
         el.first->second.id = id;
         meshcache_valid = false;
+        solidcache_valid = false;
         return el.first->second;
     }
 
@@ -675,6 +692,7 @@ public:
         pillar.start_junction_id = head.id;
         pillar.starts_from_head = true;
         meshcache_valid = false;
+        solidcache_valid = false;
         return m_pillars.back();
     }
 
@@ -699,6 +717,7 @@ public:
         pillar.id = long(m_pillars.size() - 1);
         pillar.starts_from_head = false;
         meshcache_valid = false;
+        solidcache_valid = false;
         return m_pillars.back();
     }
 
@@ -723,6 +742,7 @@ public:
         m_junctions.emplace_back(std::forward<Args>(args)...);
         m_junctions.back().id = long(m_junctions.size() - 1);
         meshcache_valid = false;
+        solidcache_valid = false;
         return m_junctions.back();
     }
 
@@ -730,6 +750,7 @@ public:
         m_bridges.emplace_back(std::forward<Args>(args)...);
         m_bridges.back().id = long(m_bridges.size() - 1);
         meshcache_valid = false;
+        solidcache_valid = false;
         return m_bridges.back();
     }
 
@@ -738,12 +759,14 @@ public:
         m_compact_bridges.emplace_back(std::forward<Args>(args)...);
         m_compact_bridges.back().id = long(m_compact_bridges.size() - 1);
         meshcache_valid = false;
+        solidcache_valid = false;
         return m_compact_bridges.back();
     }
 
     const std::map<unsigned, Head>& heads() const { return m_heads; }
     Head& head(unsigned idx) {
         meshcache_valid = false;
+        solidcache_valid = false;
         auto it = m_heads.find(idx);
         assert(it != m_heads.end());
         return it->second;
@@ -831,6 +854,65 @@ public:
         return meshcache;
     }
 
+    // The support geometry (WITHOUT THE PAD) as the solids it is made of, to
+    // be sliced in closed form instead of slicing the merged mesh.
+    const std::vector<SupportSolid>& solids() const {
+        if(solidcache_valid) return solidcache;
+
+        std::vector<SupportSolid>& ret = solidcache;
+        ret.clear();
+        ret.reserve(m_heads.size() + 2 * m_pillars.size() +
+                    m_junctions.size() + m_bridges.size() +
+                    3 * m_compact_bridges.size());
+
+        for(auto& headel : heads()) {
+            const Head& h = headel.second;
+            if(!h.is_valid()) continue;
+            Vec3d pinc = h.tr + (h.r_pin_mm - h.penetration_mm) * h.dir;
+            ret.emplace_back(SupportSolid::SPHERES, h.junction_point(), pinc,
+                             h.r_back_mm, h.r_pin_mm, unsigned(h.steps));
+        }
+
+        for(auto& stick : pillars()) {
+            if(stick.height > 0)
+                ret.emplace_back(SupportSolid::DISKS, stick.endpoint(),
+                                 stick.startpoint(), stick.r, stick.r,
+                                 unsigned(stick.steps));
+            if(stick.has_base()) {
+                Vec3d top = stick.endpoint(); top(Z) += stick.base_height;
+                ret.emplace_back(SupportSolid::DISKS, stick.endpoint(), top,
+                                 stick.base_r, stick.r, unsigned(stick.steps));
+            }
+        }
+
+        for(auto& j : junctions())
+            ret.emplace_back(SupportSolid::sphere(j.pos, j.r,
+                                                  unsigned(j.steps)));
+
+        // The mesh of a compact bridge is a cylinder capped with the upper
+        // half of a sphere at its start and the lower half of a sphere at its
+        // end, both cut horizontally slightly past their centers (see the
+        // portions of the spheres in CompactBridge).
+        for(auto& cb : compact_bridges()) {
+            double fa = 2 * PI / cb.steps;
+            ret.emplace_back(SupportSolid::DISKS, cb.startp, cb.endp,
+                             cb.r, cb.r, unsigned(cb.steps));
+            ret.emplace_back(SupportSolid::cut_sphere(
+                cb.startp, cb.r, cb.startp(Z) - cb.r * 2 * fa / PI,
+                std::numeric_limits<double>::infinity(), unsigned(cb.steps)));
+            ret.emplace_back(SupportSolid::cut_sphere(
+                cb.endp, cb.r, - std::numeric_limits<double>::infinity(),
+                cb.endp(Z) + cb.r * 4 * fa / PI, unsigned(cb.steps)));
+        }
+
+        for(auto& bs : bridges())
+            ret.emplace_back(SupportSolid::DISKS, bs.startp, bs.endp,
+                             bs.r, bs.r, unsigned(bs.steps));
+
+        solidcache_valid = true;
+        return ret;
+    }
+
     // WITH THE PAD
     double full_height() const {
         if(merged_mesh().empty() && !pad().empty())
@@ -847,9 +929,12 @@ public:
         return model_height;
     }
     
-    // Intended to be called after the generation is fully complete
+    // Intended to be called after the generation is fully complete. The
+    // merged mesh is still built here, because the parts it is made of are
+    // dropped and the mesh is needed for the preview and for the pad.
     void clear_support_data() {
-        merged_mesh(); // in case the mesh is not generated, it should be...
+        merged_mesh();
+        solids();
         m_heads.clear();
         m_pillars.clear();
         m_junctions.clear();
@@ -1022,13 +1107,14 @@ class SLASupportTree::Algorithm {
             b = a.cross(v);
         }
 
+        // The rays are cast together as one packet, they start close to
+        // each other and have similar directions.
+        std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES);
+
         // Now a and b vectors are perpendicular to v and to each other.
         // Together they define the plane where we have to iterate with the
         // given angles in the 'phis' vector
-        tbb::parallel_for(size_t(0), phis.size(),
-                          [&phis, &hits, &m, sd, r_pin, r_back, s, a, b, c]
-                          (size_t i)
-        {
+        for(size_t i = 0; i < phis.size(); ++i) {
             double& phi = phis[i];
             double sinphi = std::sin(phi);
             double cosphi = std::cos(phi);
@@ -1055,8 +1141,18 @@ class SLASupportTree::Algorithm {
                     c(Z) + rpbcos * a(Z) + rpbsin * b(Z));
 
             Vec3d n = (p - ps).normalized();
-            auto q = m.query_ray_hit(ps + sd*n, n);
+            sources[i] = ps + sd*n;
+            dirs[i] = n;
+        }
+
+        std::vector<HitResult> qs = m.query_ray_hits(sources, dirs);
 
+        // The rays to re-cast and their indices
+        std::vector<Vec3d> resources, redirs;
+        std::vector<size_t> reidx;
+
+        for(size_t i = 0; i < qs.size(); ++i) {
+            auto& q = qs[i];
             if(q.is_inside()) { // the hit is inside the model
                 if(q.distance() > r_pin + sd)  {
                     // If we are inside the model and the hit distance is bigger
@@ -1072,11 +1168,19 @@ class SLASupportTree::Algorithm {
                     // re-cast the ray from the outside of the object.
                     // The starting point has an offset of 2*safety_distance
                     // because the original ray has also had an offset
-                    auto q2 = m.query_ray_hit(ps + (q.distance() + 2*sd)*n, n);
-                    hits[i] = q2;
+                    // (sources[i] is already offset by sd).
+                    resources.emplace_back(sources[i] +
+                                           (q.distance() + sd)*dirs[i]);
+                    redirs.emplace_back(dirs[i]);
+                    reidx.emplace_back(i);
                 }
             } else hits[i] = q;
-        });
+        }
+
+        if(!reidx.empty()) {
+            std::vector<HitResult> q2s = m.query_ray_hits(resources, redirs);
+            for(size_t j = 0; j < reidx.size(); ++j) hits[reidx[j]] = q2s[j];
+        }
 
         auto mit = std::min_element(hits.begin(), hits.end());
 
@@ -1129,10 +1233,11 @@ class SLASupportTree::Algorithm {
         // Hit results
         std::array<HitResult, SAMPLES> hits;
 
-        tbb::parallel_for(size_t(0), phis.size(),
-                          [&m, &phis, a, b, sd, dir, r, s, ins_check, &hits]
-                          (size_t i)
-        {
+        // The rays are parallel and close to each other, they are cast
+        // together as one packet.
+        std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES, dir);
+
+        for(size_t i = 0; i < phis.size(); ++i) {
             double& phi = phis[i];
             double sinphi = std::sin(phi);
             double cosphi = std::cos(phi);
@@ -1146,19 +1251,32 @@ class SLASupportTree::Algorithm {
                      s(Y) + rcos * a(Y) + rsin * b(Y),
                      s(Z) + rcos * a(Z) + rsin * b(Z));
 
-            auto hr = m.query_ray_hit(p + sd*dir, dir);
+            sources[i] = p + sd*dir;
+        }
+
+        std::vector<HitResult> hrs = m.query_ray_hits(sources, dirs);
 
+        // The rays to re-cast and their indices
+        std::vector<Vec3d> resources;
+        std::vector<size_t> reidx;
+
+        for(size_t i = 0; i < hrs.size(); ++i) {
+            auto& hr = hrs[i];
             if(ins_check && hr.is_inside()) {
                 if(hr.distance() > r + sd) hits[i] = HitResult(0.0);
                 else {
                     // re-cast the ray from the outside of the object
-                    auto hr2 =
-                           m.query_ray_hit(p + (hr.distance() + 2*sd)*dir, dir);
-
-                    hits[i] = hr2;
+                    resources.emplace_back(sources[i] + (hr.distance() + sd)*dir);
+                    reidx.emplace_back(i);
                 }
             } else hits[i] = hr;
-        });
+        }
+
+        if(!reidx.empty()) {
+            std::vector<HitResult> hr2s = m.query_ray_hits(
+                        resources, std::vector<Vec3d>(resources.size(), dir));
+            for(size_t j = 0; j < reidx.size(); ++j) hits[reidx[j]] = hr2s[j];
+        }
 
         auto mit = std::min_element(hits.begin(), hits.end());
 
@@ -1433,11 +1551,19 @@ public:
         using libnest2d::opt::GeneticOptimizer;
         using libnest2d::opt::StopCriteria;
 
-        for(unsigned i = 0, fidx = 0; i < filtered_indices.size(); ++i)
+        // The points are filtered independently of each other in parallel.
+        // The heads and the headless supports are collected in the order of
+        // the points afterwards, so that the result is deterministic.
+        enum PointClass : char { pcNone, pcHead, pcHeadless };
+        std::vector<PointClass> point_classes(filtered_indices.size(), pcNone);
+
+        tbb::parallel_for(size_t(0), filtered_indices.size(),
+                          [this, &filtered_indices, &nmls, &point_classes]
+                          (size_t i)
         {
             m_thr();
 
-            fidx = filtered_indices[i];
+            unsigned fidx = filtered_indices[i];
             auto n = nmls.row(i);
 
             // for all normals we generate the spherical coordinates and
@@ -1525,16 +1651,23 @@ public:
 
                 if(t > w) {
                     // mark the point for needing a head.
-                    m_iheads.emplace_back(fidx);
+                    point_classes[i] = pcHead;
                 } else if( polar >= 3*PI/4 ) {
                     // Headless supports do not tilt like the headed ones so
                     // the normal should point almost to the ground.
-                    m_iheadless.emplace_back(fidx);
+                    point_classes[i] = pcHeadless;
                 }
             }
-        }
+        });
 
         m_thr();
+
+        for(size_t i = 0; i < filtered_indices.size(); ++i)
+            switch(point_classes[i]) {
+            case pcHead:     m_iheads.emplace_back(filtered_indices[i]); break;
+            case pcHeadless: m_iheadless.emplace_back(filtered_indices[i]); break;
+            default: break;
+            }
     }
 
     // Pinhead creation: based on the filtering results, the Head objects
@@ -1574,16 +1707,36 @@ public:
         // pillars and which shall be connected to the model surface (or
         // search a suitable path around the surface that leads to the
         // ground -- TODO)
+        // The collision checks of the heads are independent, they run in
+        // parallel.
+        std::vector<Vec3d> junction_points;
+        std::vector<double> back_radii;
+        junction_points.reserve(m_iheads.size());
+        back_radii.reserve(m_iheads.size());
         for(unsigned i : m_iheads) {
+            const Head& head = m_result.head(i);
+            junction_points.emplace_back(head.junction_point());
+            back_radii.emplace_back(head.r_back_mm);
+        }
+
+        std::vector<EigenMesh3D::hit_result> hits(m_iheads.size(),
+                                                  EigenMesh3D::hit_result(0.0));
+        tbb::parallel_for(size_t(0), m_iheads.size(),
+                          [this, &junction_points, &back_radii, &hits]
+                          (size_t k)
+        {
             m_thr();
+            // collision check
+            hits[k] = bridge_mesh_intersect(junction_points[k], Vec3d(0, 0, -1),
+                                            back_radii[k]);
+        });
 
-            auto& head = m_result.head(i);
-            Vec3d n(0, 0, -1);
-            double r = head.r_back_mm;
-            Vec3d headjp = head.junction_point();
+        for(size_t k = 0; k < m_iheads.size(); ++k) {
+            m_thr();
 
-            // collision check
-            auto hit = bridge_mesh_intersect(headjp, n, r);
+            unsigned i = m_iheads[k];
+            auto& head = m_result.head(i);
+            const EigenMesh3D::hit_result& hit = hits[k];
 
             if(std::isinf(hit.distance())) ground_head_indices.emplace_back(i);
             else if(m_cfg.ground_facing_only)  head.invalidate();
@@ -2243,25 +2396,24 @@ SlicedSupports SLASupportTree::slice(float layerh, float init_layerh) const
         heights.emplace_back(h);
     }
 
-    TriangleMesh fullmesh = m_impl->merged_mesh();
-    fullmesh.merge(get_pad());
-    fullmesh.require_shared_vertices(); // TriangleMeshSlicer needs this
-    TriangleMeshSlicer slicer(&fullmesh);
-    SlicedSupports ret;
-    slicer.slice(heights, 0.f, &ret, get().ctl().cancelfn);
-
-    return ret;
+    return slice(heights, 0.f);
 }
 
 SlicedSupports SLASupportTree::slice(const std::vector<float> &heights,
                                      float cr) const
 {
-    TriangleMesh fullmesh = m_impl->merged_mesh();
-    fullmesh.merge(get_pad());
-    fullmesh.require_shared_vertices(); // TriangleMeshSlicer needs this
-    TriangleMeshSlicer slicer(&fullmesh);
     SlicedSupports ret;
-    slicer.slice(heights, cr, &ret, get().ctl().cancelfn);
+
+    // Only the pad is sliced as a mesh, the rest of the support tree is made
+    // of spheres, cylinders and cones which are sliced in closed form.
+    TriangleMesh padmesh = get_pad();
+    if(!padmesh.empty()) {
+        padmesh.require_shared_vertices(); // TriangleMeshSlicer needs this
+        TriangleMeshSlicer slicer(&padmesh);
+        slicer.slice(heights, cr, &ret, get().ctl().cancelfn);
+    }
+
+    sla::slice(m_impl->solids(), heights, cr, ret, get().ctl().cancelfn);
 
     return ret;
 }
@@ -2,6 +2,7 @@
 #include "SLA/SLASupportTree.hpp"
 #include "SLA/SLABoilerPlate.hpp"
 #include "SLA/SLASpatIndex.hpp"
+#include "SLA/SLARayBVH.hpp"
 
 // Workaround: IGL signed_distance.h will define PI in the igl namespace.
 #undef PI
@@ -102,6 +103,8 @@ void SpatIndex::foreach(std::function<void (const SpatElement &)> fn)
 
 class EigenMesh3D::AABBImpl: public igl::AABB<Eigen::MatrixXd, 3> {
 public:
+    // The ray casting has its own tree, see SLARayBVH.hpp
+    RayBVH raybvh;
 #ifdef SLIC3R_SLA_NEEDS_WINDTREE
     igl::WindingNumberAABB<Vec3d, Eigen::MatrixXd, Eigen::MatrixXi> windtree;
 #endif /* SLIC3R_SLA_NEEDS_WINDTREE */
@@ -145,6 +148,7 @@ EigenMesh3D::EigenMesh3D(const TriangleMesh& tmesh): m_aabb(new AABBImpl()) {
 
     // Build the AABB accelaration tree
     m_aabb->init(m_V, m_F);
+    m_aabb->raybvh = RayBVH(m_V, m_F);
 #ifdef SLIC3R_SLA_NEEDS_WINDTREE
     m_aabb->windtree.set_mesh(m_V, m_F);
 #endif /* SLIC3R_SLA_NEEDS_WINDTREE */
@@ -167,15 +171,34 @@ EigenMesh3D &EigenMesh3D::operator=(const EigenMesh3D &other)
 EigenMesh3D::hit_result
 EigenMesh3D::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
 {
-    igl::Hit hit;
-    hit.t = std::numeric_limits<float>::infinity();
-    m_aabb->intersect_ray(m_V, m_F, s, dir, hit);
+    RayBVH::Hit hit = m_aabb->raybvh.intersect(s, dir);
 
     hit_result ret(*this);
-    ret.m_t = double(hit.t);
+    ret.m_t = hit.t;
     ret.m_dir = dir;
     ret.m_source = s;
-    if(!std::isinf(hit.t) && !std::isnan(hit.t)) ret.m_face_id = hit.id;
+    ret.m_face_id = hit.face;
+
+    return ret;
+}
+
+std::vector<EigenMesh3D::hit_result>
+EigenMesh3D::query_ray_hits(const std::vector<Vec3d> &sources,
+                            const std::vector<Vec3d> &dirs) const
+{
+    assert(sources.size() == dirs.size());
+
+    std::vector<RayBVH::Hit> hits(sources.size());
+    m_aabb->raybvh.intersect(sources.data(), dirs.data(), sources.size(),
+                             hits.data());
+
+    std::vector<hit_result> ret(sources.size(), hit_result(*this));
+    for(size_t i = 0; i < ret.size(); ++i) {
+        ret[i].m_t = hits[i].t;
+        ret[i].m_dir = dirs[i];
+        ret[i].m_source = sources[i];
+        ret[i].m_face_id = hits[i].face;
+    }
 
     return ret;
 }
@@ -1313,6 +1313,31 @@ void SLAPrint::process()
                                flpXY? SLAPrinter::RO_PORTRAIT : 
                                       SLAPrinter::RO_LANDSCAPE, 
                                gamma));
+
+            // The layers are rasterized by the RLE backend, which has no
+            // compression level, only the scanline filter is configurable.
+            Raster::PNGOptions png_opts;
+            switch(printcfg.png_filter.value) {
+            case slapngfSub: png_opts.filter = PNGFilter::SUB; break;
+            case slapngfUp:  png_opts.filter = PNGFilter::UP; break;
+            default: break;
+            }
+            m_printer->png_options(png_opts);
+        }
+
+        // Set statistics values to the printer
+        auto set_statistics = [this]() {
+            m_printer->set_statistics({(m_print_statistics.objects_used_material + m_print_statistics.support_used_material)/1000,
+                                    double(m_default_object_config.faded_layers.getInt()),
+                                    double(m_print_statistics.slow_layers_count),
+                                    double(m_print_statistics.fast_layers_count)
+                                    });
+        };
+
+        // The layers will be rasterized by export_raster().
+        if(m_streaming_export) {
+            set_statistics();
+            return;
         }
 
         // Allocate space for all the layers
@@ -1375,12 +1400,7 @@ void SLAPrint::process()
         // Print all the layers in parallel
         tbb::parallel_for<unsigned, decltype(lvlfn)>(0, lvlcnt, lvlfn);
 
-        // Set statistics values to the printer
-        m_printer->set_statistics({(m_print_statistics.objects_used_material + m_print_statistics.support_used_material)/1000,
-                                double(m_default_object_config.faded_layers.getInt()),
-                                double(m_print_statistics.slow_layers_count),
-                                double(m_print_statistics.fast_layers_count)
-                                });
+        set_statistics();
     };
 
     using slaposFn = std::function<void(SLAPrintObject&)>;
@@ -1488,7 +1508,8 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "display_height",
         "display_pixels_x",
         "display_pixels_y",
-        "display_orientation"
+        "display_orientation",
+        "png_filter"
     };
 
     static std::unordered_set<std::string> steps_ignore = {
@@ -1548,7 +1569,7 @@ SLAPrintObject::SLAPrintObject(SLAPrint *print, ModelObject *model_object):
     Inherited(print, model_object),
     m_stepmask(slaposCount, true),
     m_transformed_rmesh( [this](TriangleMesh& obj){
-            obj = m_model_object->raw_mesh(); obj.transform(m_trafo); obj.require_shared_vertices();
+            obj = *m_model_object->raw_mesh(); obj.transform(m_trafo); obj.require_shared_vertices();
         })
 {
 }
@@ -1833,6 +1854,15 @@ std::string SLAPrintStatistics::finalize_output_path(const std::string &path_in)
     return final_path;
 }
 
+void SLAPrint::report_streamed_status(unsigned layers_written)
+{
+    // Report each percent of the layers written once.
+    size_t cnt = m_printer_input.size();
+    int    st  = int(100 * size_t(layers_written) / cnt);
+    if (layers_written == 1 || st != int(100 * size_t(layers_written - 1) / cnt))
+        m_report_status(*this, st, PRINT_STEP_LABELS(slapsRasterize));
+}
+
 void SLAPrint::StatusReporter::operator()(
         SLAPrint &p, double st, const std::string &msg, unsigned flags)
 {
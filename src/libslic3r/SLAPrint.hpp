@@ -368,7 +368,7 @@ private: // Prevents erroneous use by other classes.
 
 public:
 
-    SLAPrint(): m_stepmask(slapsCount, true) {}
+    SLAPrint(): m_stepmask(slapsCount, true), m_streaming_export(false) {}
 
     virtual ~SLAPrint() override { this->clear(); }
 
@@ -385,11 +385,38 @@ public:
     // Returns true if the last step was finished with success.
     bool                finished() const override { return this->is_step_done(slaposSliceSupports) && this->Inherited::is_step_done(slapsRasterize); }
 
+    // If enabled, the slapsRasterize step does not rasterize the layers,
+    // export_raster() rasterizes them and writes them into the archive as they
+    // are finished instead. Only a couple of the layers are then held in
+    // memory at any time, while all the compressed layers are held in memory
+    // from the slapsRasterize step to the export otherwise. The streamed
+    // export reports the progress of the rasterization and it may be canceled
+    // like the slapsRasterize step. To be set before process(), disabled by
+    // default.
+    void set_streaming_export(bool enable) { m_streaming_export = enable; }
+    bool streaming_export() const { return m_streaming_export; }
+
     template<class Fmt = Zipper>
     inline void export_raster(const std::string& fpath,
                        const std::string& projectname = "")
     {
-        if(m_printer) m_printer->save<Fmt>(fpath, projectname);
+        if(!m_printer) return;
+
+        // The layers were not rasterized by the slapsRasterize step.
+        if(m_printer->layers() == 0)
+            m_printer->save_streamed<Fmt>(fpath, projectname,
+                unsigned(m_printer_input.size()),
+                [this](Raster& raster, unsigned lyr) {
+                    for(const ClipperLib::Polygon& poly :
+                        m_printer_input[lyr].transformed_slices())
+                        raster.draw(poly);
+                },
+                [this]() { this->throw_if_canceled(); },
+                [this](unsigned layers_written) {
+                    this->report_streamed_status(layers_written);
+                });
+        else
+            m_printer->save<Fmt>(fpath, projectname);
     }
 
     const PrintObjects& objects() const { return m_objects; }
@@ -459,6 +486,9 @@ private:
     // Invalidate steps based on a set of parameters changed.
     bool invalidate_state_by_config_options(const std::vector<t_config_option_key> &opt_keys, bool &invalidate_all_model_objects);
 
+    // Progress of the streamed export by export_raster().
+    void report_streamed_status(unsigned layers_written);
+
     SLAPrintConfig                  m_print_config;
     SLAPrinterConfig                m_printer_config;
     SLAMaterialConfig               m_material_config;
@@ -473,6 +503,9 @@ private:
     // The printer itself
     SLAPrinterPtr                           m_printer;
 
+    // Rasterize the layers while exporting, see set_streaming_export().
+    bool                                    m_streaming_export;
+
     // Estimated print time, material consumed.
     SLAPrintStatistics                      m_print_statistics;
 
@@ -0,0 +1,298 @@
+#include "ShortestPath.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace Slic3r {
+
+namespace {
+
+static const size_t npos = std::numeric_limits<size_t>::max();
+
+// Uniform grid over a subset of points, which may be removed from the grid one by one.
+// The grid is rebuilt over the remaining points once most of the indexed points were removed,
+// so that the search for the closest point does not walk over too many empty cells.
+class PointGrid
+{
+public:
+    PointGrid(const Points &points, const std::vector<size_t> &indices) : m_points(points), m_alive(points.size(), false), m_num_alive(indices.size()) {
+        for (size_t idx : indices)
+            m_alive[idx] = true;
+        this->rebuild();
+    }
+
+    bool empty() const { return m_num_alive == 0; }
+
+    void remove(size_t idx) {
+        assert(m_alive[idx]);
+        m_alive[idx] = false;
+        -- m_cell_alive[this->cell_of(m_points[idx])];
+        -- m_num_alive;
+        if (m_num_alive > 0 && m_num_alive * 4 < m_num_indexed && m_num_indexed > 256)
+            this->rebuild();
+    }
+
+    // Closest point to pt not removed yet, npos if the grid is empty.
+    size_t closest(const Point &pt, ChainTieBreak tie_break) const {
+        size_t best    = npos;
+        double best_d2 = 0.;
+        this->visit(pt,
+            [&best, &best_d2, tie_break](size_t idx, double d2) {
+                if (best == npos || d2 < best_d2 ||
+                    (d2 == best_d2 && ((tie_break == ChainTieBreak::FirstIndex || d2 == 0.) ? idx < best : idx > best))) {
+                    best    = idx;
+                    best_d2 = d2;
+                }
+            },
+            // Continue over the rings, which may contain a point at the same distance, to resolve the ties.
+            [&best, &best_d2](double lower_bound_d2) { return best != npos && lower_bound_d2 > best_d2; });
+        return best;
+    }
+
+    // Up to k points closest to pt, sorted by their distance.
+    std::vector<size_t> k_closest(const Point &pt, size_t k) const {
+        std::priority_queue<std::pair<double, size_t>> heap;
+        this->visit(pt,
+            [&heap, k](size_t idx, double d2) {
+                if (heap.size() < k)
+                    heap.emplace(d2, idx);
+                else if (d2 < heap.top().first) {
+                    heap.pop();
+                    heap.emplace(d2, idx);
+                }
+            },
+            [&heap, k](double lower_bound_d2) { return heap.size() == k && lower_bound_d2 > heap.top().first; });
+        std::vector<size_t> out(heap.size());
+        for (size_t i = out.size(); i > 0; -- i) {
+            out[i - 1] = heap.top().second;
+            heap.pop();
+        }
+        return out;
+    }
+
+private:
+    void rebuild() {
+        std::vector<size_t> indices;
+        indices.reserve(m_num_alive);
+        for (size_t i = 0; i < m_alive.size(); ++ i)
+            if (m_alive[i])
+                indices.emplace_back(i);
+        m_num_indexed = indices.size();
+        int64_t max_x = 0, max_y = 0;
+        m_min_x = m_min_y = 0;
+        if (! indices.empty()) {
+            m_min_x = max_x = m_points[indices.front()].x();
+            m_min_y = max_y = m_points[indices.front()].y();
+            for (size_t idx : indices) {
+                const Point &pt = m_points[idx];
+                m_min_x = std::min<int64_t>(m_min_x, pt.x());
+                m_min_y = std::min<int64_t>(m_min_y, pt.y());
+                max_x   = std::max<int64_t>(max_x, pt.x());
+                max_y   = std::max<int64_t>(max_y, pt.y());
+            }
+        }
+        // About two points per cell, but not too many cells for the points aligned along a line.
+        double area  = double(max_x - m_min_x + 1) * double(max_y - m_min_y + 1);
+        m_cell_size  = std::max<int64_t>(1, int64_t(std::ceil(std::sqrt(2. * area / double(std::max<size_t>(1, indices.size()))))));
+        for (;;) {
+            m_cols = (max_x - m_min_x) / m_cell_size + 1;
+            m_rows = (max_y - m_min_y) / m_cell_size + 1;
+            if (m_cols * m_rows <= 4 * int64_t(indices.size()) + 16)
+                break;
+            m_cell_size *= 2;
+        }
+        // Counting sort of the points into the cells, keeping the points of a cell sorted by their indices.
+        m_cell_start.assign(size_t(m_cols * m_rows) + 1, 0);
+        m_cell_alive.assign(size_t(m_cols * m_rows), 0);
+        for (size_t idx : indices)
+            ++ m_cell_alive[this->cell_of(m_points[idx])];
+        for (size_t i = 0; i < m_cell_alive.size(); ++ i)
+            m_cell_start[i + 1] = m_cell_start[i] + m_cell_alive[i];
+        m_cell_points.assign(indices.size(), 0);
+        std::vector<size_t> fill(m_cell_start.begin(), m_cell_start.end() - 1);
+        for (size_t idx : indices)
+            m_cell_points[fill[this->cell_of(m_points[idx])] ++] = idx;
+    }
+
+    size_t cell_of(const Point &pt) const {
+        return size_t(((int64_t(pt.y()) - m_min_y) / m_cell_size) * m_cols + (int64_t(pt.x()) - m_min_x) / m_cell_size);
+    }
+
+    // Visit the points not removed yet ring by ring of cells around pt. Before visiting a ring,
+    // stop(d2) is asked whether to stop the search, where d2 is a lower bound of the squared distance of the ring from pt.
+    template<typename Visitor, typename Stop> void visit(const Point &pt, Visitor &&visitor, Stop &&stop) const {
+        if (m_num_alive == 0)
+            return;
+        // For a point outside the grid, the search starts at the closest cell.
+        // The lower bounds of the ring distances hold, as the distances from pt are even larger.
+        int64_t cx = std::min(std::max<int64_t>(0, (int64_t(pt.x()) - m_min_x) / m_cell_size), m_cols - 1);
+        int64_t cy = std::min(std::max<int64_t>(0, (int64_t(pt.y()) - m_min_y) / m_cell_size), m_rows - 1);
+        auto visit_cell = [this, &pt, &visitor](int64_t x, int64_t y) {
+            size_t cell = size_t(y * m_cols + x);
+            if (m_cell_alive[cell] == 0)
+                return;
+            for (size_t i = m_cell_start[cell]; i < m_cell_start[cell + 1]; ++ i) {
+                size_t idx = m_cell_points[i];
+                if (m_alive[idx]) {
+                    const Point &p = m_points[idx];
+                    visitor(idx, sqr(double(pt.x()) - double(p.x())) + sqr(double(pt.y()) - double(p.y())));
+                }
+            }
+        };
+        int64_t max_ring = std::max(std::max(cx, m_cols - 1 - cx), std::max(cy, m_rows - 1 - cy));
+        for (int64_t r = 0; r <= max_ring; ++ r) {
+            if (r > 1 && stop(sqr(double((r - 1) * m_cell_size))))
+                break;
+            for (int64_t y = std::max<int64_t>(0, cy - r); y <= std::min(cy + r, m_rows - 1); ++ y) {
+                if (y == cy - r || y == cy + r) {
+                    for (int64_t x = std::max<int64_t>(0, cx - r); x <= std::min(cx + r, m_cols - 1); ++ x)
+                        visit_cell(x, y);
+                } else {
+                    if (cx - r >= 0)
+                        visit_cell(cx - r, y);
+                    if (cx + r < m_cols)
+                        visit_cell(cx + r, y);
+                }
+            }
+        }
+    }
+
+    const Points           &m_points;
+    std::vector<bool>       m_alive;
+    size_t                  m_num_alive;
+    size_t                  m_num_indexed = 0;
+    int64_t                 m_min_x;
+    int64_t                 m_min_y;
+    int64_t                 m_cell_size;
+    int64_t                 m_cols;
+    int64_t                 m_rows;
+    // Compressed rows of point indices per cell.
+    std::vector<size_t>     m_cell_start;
+    std::vector<size_t>     m_cell_points;
+    // Number of points of a cell not removed yet.
+    std::vector<size_t>     m_cell_alive;
+};
+
+} // namespace
+
+std::vector<size_t> chain_points(const Points &points, const Point &start_near, ChainTieBreak tie_break)
+{
+    std::vector<size_t> indices(points.size());
+    for (size_t i = 0; i < indices.size(); ++ i)
+        indices[i] = i;
+    PointGrid grid(points, indices);
+    std::vector<size_t> out;
+    out.reserve(points.size());
+    Point last = start_near;
+    while (! grid.empty()) {
+        size_t idx = grid.closest(last, tie_break);
+        grid.remove(idx);
+        out.emplace_back(idx);
+        last = points[idx];
+    }
+    return out;
+}
+
+std::vector<std::pair<size_t, bool>> chain_segments(const Points &end_points, const Point &start_near, const std::vector<bool> &can_reverse, ChainTieBreak tie_break)
+{
+    assert(end_points.size() % 2 == 0 && can_reverse.size() * 2 == end_points.size());
+    std::vector<size_t> indices;
+    indices.reserve(end_points.size());
+    for (size_t i = 0; i < end_points.size(); ++ i)
+        if ((i & 1) == 0 || can_reverse[i / 2])
+            indices.emplace_back(i);
+    PointGrid grid(end_points, indices);
+    std::vector<std::pair<size_t, bool>> out;
+    out.reserve(can_reverse.size());
+    Point last = start_near;
+    while (! grid.empty()) {
+        size_t idx      = grid.closest(last, tie_break);
+        size_t segment  = idx / 2;
+        bool   reversed = (idx & 1) != 0;
+        grid.remove(segment * 2);
+        if (can_reverse[segment])
+            grid.remove(segment * 2 + 1);
+        out.emplace_back(segment, reversed);
+        last = end_points[reversed ? segment * 2 : segment * 2 + 1];
+    }
+    return out;
+}
+
+std::vector<std::pair<size_t, bool>> chain_segments(const Points &end_points, const Point &start_near, bool no_reverse, ChainTieBreak tie_break)
+{
+    return chain_segments(end_points, start_near, std::vector<bool>(end_points.size() / 2, ! no_reverse), tie_break);
+}
+
+static inline const Point& chain_first_point(const Points &end_points, const std::pair<size_t, bool> &segment)
+    { return end_points[segment.first * 2 + (segment.second ? 1 : 0)]; }
+static inline const Point& chain_last_point(const Points &end_points, const std::pair<size_t, bool> &segment)
+    { return end_points[segment.first * 2 + (segment.second ? 0 : 1)]; }
+
+double chain_travel_length(const Points &end_points, const Point &start_near, const std::vector<std::pair<size_t, bool>> &chain)
+{
+    double length = 0.;
+    Point  last   = start_near;
+    for (const std::pair<size_t, bool> &segment : chain) {
+        length += (chain_first_point(end_points, segment) - last).cast<double>().norm();
+        last    = chain_last_point(end_points, segment);
+    }
+    return length;
+}
+
+void improve_chain_by_two_opt(const Points &end_points, const Point &start_near, std::vector<std::pair<size_t, bool>> &chain, double time_limit_seconds)
+{
+    // Number of the closest end points tested as the end of the reversed run.
+    static const size_t num_candidates = 8;
+    if (chain.size() < 2 || time_limit_seconds <= 0.)
+        return;
+    auto time_limit = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_limit_seconds));
+
+    std::vector<size_t> indices(end_points.size());
+    for (size_t i = 0; i < indices.size(); ++ i)
+        indices[i] = i;
+    PointGrid grid(end_points, indices);
+    // Position of a segment in the chain.
+    std::vector<size_t> position(end_points.size() / 2, npos);
+    for (size_t i = 0; i < chain.size(); ++ i)
+        position[chain[i].first] = i;
+
+    auto distance = [](const Point &a, const Point &b) { return (b - a).cast<double>().norm(); };
+    size_t num_tests = 0;
+    for (bool improved = true; improved;) {
+        improved = false;
+        for (size_t i = 0; i < chain.size(); ++ i) {
+            // Travel from prev to the first point of the i-th segment.
+            Point prev = (i == 0) ? start_near : chain_last_point(end_points, chain[i - 1]);
+            for (size_t idx : grid.k_closest(prev, num_candidates)) {
+                size_t j = position[idx / 2];
+                // The run i..j is reversed, so that the travel from prev goes to the last point of the j-th segment.
+                if (j == npos || j < i || &chain_last_point(end_points, chain[j]) != &end_points[idx])
+                    continue;
+                const Point &first_i = chain_first_point(end_points, chain[i]);
+                const Point &last_j  = end_points[idx];
+                double delta = distance(prev, last_j) - distance(prev, first_i);
+                if (j + 1 < chain.size()) {
+                    const Point &next = chain_first_point(end_points, chain[j + 1]);
+                    delta += distance(first_i, next) - distance(last_j, next);
+                }
+                if (delta < - EPSILON) {
+                    std::reverse(chain.begin() + i, chain.begin() + j + 1);
+                    for (size_t k = i; k <= j; ++ k) {
+                        chain[k].second = ! chain[k].second;
+                        position[chain[k].first] = k;
+                    }
+                    improved = true;
+                    break;
+                }
+            }
+            if ((++ num_tests & 255) == 0 && std::chrono::steady_clock::now() > time_limit)
+                return;
+        }
+    }
+}
+
+} // namespace Slic3r
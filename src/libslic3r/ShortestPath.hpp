@@ -0,0 +1,48 @@
+#ifndef slic3r_ShortestPath_hpp_
+#define slic3r_ShortestPath_hpp_
+
+// Greedy nearest neighbour ordering of points and of segments (polylines, extrusions) to shorten the travel moves,
+// accelerated by a grid of the not yet visited end points, and a 2-opt improvement of such an ordering.
+
+#include <utility>
+#include <vector>
+
+#include "libslic3r.h"
+#include "Point.hpp"
+
+namespace Slic3r {
+
+// Which of the end points at the same distance is picked by the greedy chaining. The two variants replicate
+// the former linear scans: PolylineCollection picked the first one, while Point::nearest_point_index()
+// picked the last one, unless the distance was zero.
+enum class ChainTieBreak {
+    FirstIndex,
+    LastIndex,
+};
+
+// Starting at start_near, visit the closest point not visited yet.
+// Returns indices of the points in the order of visiting.
+std::vector<size_t> chain_points(const Points &points, const Point &start_near, ChainTieBreak tie_break = ChainTieBreak::LastIndex);
+
+// Starting at start_near, visit the closest end point of a segment not visited yet, then continue from the other end of that segment.
+// end_points[2 * i] and end_points[2 * i + 1] are the first and the last point of the i-th segment.
+// If no_reverse is set, the segments are only entered at their first points.
+// Returns pairs of (segment index, reversed) in the order of visiting.
+std::vector<std::pair<size_t, bool>> chain_segments(const Points &end_points, const Point &start_near, bool no_reverse,
+                                                    ChainTieBreak tie_break = ChainTieBreak::FirstIndex);
+// Same as above, but only the segments marked by can_reverse may be entered at their last points.
+std::vector<std::pair<size_t, bool>> chain_segments(const Points &end_points, const Point &start_near, const std::vector<bool> &can_reverse,
+                                                    ChainTieBreak tie_break = ChainTieBreak::FirstIndex);
+
+// Length of the travel moves from start_near through the chained segments returned by chain_segments().
+double chain_travel_length(const Points &end_points, const Point &start_near, const std::vector<std::pair<size_t, bool>> &chain);
+
+// Shorten the travel moves of a chain returned by chain_segments() by 2-opt moves: A run of the chain is reversed
+// (the order of its segments and the segments themselves) if that shortens the travel moves at both ends of the run.
+// Only the runs ending near the current end point are considered. All segments have to be reversible.
+// The improvement stops at a local optimum or once time_limit_seconds is exceeded.
+void improve_chain_by_two_opt(const Points &end_points, const Point &start_near, std::vector<std::pair<size_t, bool>> &chain, double time_limit_seconds);
+
+} // namespace Slic3r
+
+#endif /* slic3r_ShortestPath_hpp_ */
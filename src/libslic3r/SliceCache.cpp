@@ -0,0 +1,302 @@
+#include "SliceCache.hpp"
+#include "Layer.hpp"
+
+#include <cstring>
+#include <cstdio>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+namespace Slic3r {
+
+static inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static const uint64_t murmur_c1 = 0x87c37b91114253d5ULL;
+static const uint64_t murmur_c2 = 0x4cf5ad432745937fULL;
+
+void SliceCacheHasher::process_block(const unsigned char *block)
+{
+    uint64_t k1, k2;
+    memcpy(&k1, block, 8);
+    memcpy(&k2, block + 8, 8);
+    k1 *= murmur_c1; k1 = rotl64(k1, 31); k1 *= murmur_c2; m_h1 ^= k1;
+    m_h1 = rotl64(m_h1, 27); m_h1 += m_h2; m_h1 = m_h1 * 5 + 0x52dce729;
+    k2 *= murmur_c2; k2 = rotl64(k2, 33); k2 *= murmur_c1; m_h2 ^= k2;
+    m_h2 = rotl64(m_h2, 31); m_h2 += m_h1; m_h2 = m_h2 * 5 + 0x38495ab5;
+}
+
+void SliceCacheHasher::update(const void *data, size_t size)
+{
+    const unsigned char *ptr = (const unsigned char*)data;
+    const unsigned char *end = ptr + size;
+    m_length += size;
+    if (m_buffer_size > 0) {
+        size_t n = std::min(size_t(16) - m_buffer_size, size);
+        memcpy(m_buffer + m_buffer_size, ptr, n);
+        m_buffer_size += n;
+        ptr += n;
+        if (m_buffer_size < 16)
+            return;
+        this->process_block(m_buffer);
+        m_buffer_size = 0;
+    }
+    for (; end - ptr >= 16; ptr += 16)
+        this->process_block(ptr);
+    m_buffer_size = end - ptr;
+    memcpy(m_buffer, ptr, m_buffer_size);
+}
+
+std::string SliceCacheHasher::digest() const
+{
+    uint64_t h1 = m_h1;
+    uint64_t h2 = m_h2;
+    // Process the tail.
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    for (size_t i = m_buffer_size; i > 8; -- i)
+        k2 ^= uint64_t(m_buffer[i - 1]) << ((i - 9) * 8);
+    for (size_t i = std::min(m_buffer_size, size_t(8)); i > 0; -- i)
+        k1 ^= uint64_t(m_buffer[i - 1]) << ((i - 1) * 8);
+    if (m_buffer_size > 8) {
+        k2 *= murmur_c2; k2 = rotl64(k2, 33); k2 *= murmur_c1; h2 ^= k2;
+    }
+    if (m_buffer_size > 0) {
+        k1 *= murmur_c1; k1 = rotl64(k1, 31); k1 *= murmur_c2; h1 ^= k1;
+    }
+    // Finalization.
+    h1 ^= m_length;
+    h2 ^= m_length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    char buf[33];
+    sprintf(buf, "%016llx%016llx", (unsigned long long)h1, (unsigned long long)h2);
+    return buf;
+}
+
+// The cache entry format:
+//     header:      char[8] magic, uint32_t version, uint32_t number of regions, uint64_t number of layers
+//     layer:       uint64_t id, double height, print_z, slice_z,
+//                  ExPolygons of each LayerRegion::slices, ExPolygons of Layer::slices
+//     ExPolygons:  uint64_t number of ExPolygons, for each ExPolygon: uint32_t number of holes,
+//                  the contour and the holes as uint32_t number of points followed by the points.
+// The points are stored as pairs of coord_t in the native byte order, so that they may be copied
+// from the memory mapped file directly.
+static const char     slice_cache_magic[8] = { 'P', 'S', 'S', 'L', 'I', 'C', 'E', 'S' };
+static const uint32_t slice_cache_version  = 1;
+
+static_assert(sizeof(Point) == 2 * sizeof(coord_t), "Point is expected to be a packed pair of coord_t");
+
+static boost::filesystem::path slice_cache_path(const std::string &dir, const std::string &key)
+{
+    return boost::filesystem::path(dir) / (key + ".slices");
+}
+
+namespace {
+
+class SliceCacheReader
+{
+public:
+    SliceCacheReader(const char *data, size_t size) : m_ptr(data), m_end(data + size) {}
+
+    bool ok() const { return m_ok; }
+    bool at_end() const { return m_ptr == m_end; }
+    // Are there at least count items of item_size bytes left? Sets the error state if not.
+    // The count is read from the file, therefore it is not multiplied by the item size to not overflow.
+    bool reserve(uint64_t count, size_t item_size) {
+        if (m_ok && count > uint64_t(m_end - m_ptr) / item_size)
+            m_ok = false;
+        return m_ok;
+    }
+
+    template<typename T> T read() {
+        T value = T();
+        if (this->reserve(sizeof(T))) {
+            memcpy(&value, m_ptr, sizeof(T));
+            m_ptr += sizeof(T);
+        }
+        return value;
+    }
+
+    void read(Points &points) {
+        uint32_t n = this->read<uint32_t>();
+        if (this->reserve(n, sizeof(Point))) {
+            points.resize(n);
+            memcpy((void*)points.data(), m_ptr, size_t(n) * sizeof(Point));
+            m_ptr += size_t(n) * sizeof(Point);
+        }
+    }
+
+    void read(ExPolygons &expolygons) {
+        uint64_t n = this->read<uint64_t>();
+        // Each ExPolygon occupies at least 8 bytes, don't allocate memory for a bogus count.
+        if (! this->reserve(n, 8))
+            return;
+        expolygons.assign(size_t(n), ExPolygon());
+        for (ExPolygon &expoly : expolygons) {
+            uint32_t num_holes = this->read<uint32_t>();
+            this->read(expoly.contour.points);
+            if (! this->reserve(num_holes, 4))
+                return;
+            expoly.holes.assign(num_holes, Polygon());
+            for (Polygon &hole : expoly.holes)
+                this->read(hole.points);
+            if (! m_ok)
+                return;
+        }
+    }
+
+private:
+    bool reserve(size_t size) {
+        if (m_ok && size_t(m_end - m_ptr) < size)
+            m_ok = false;
+        return m_ok;
+    }
+
+    const char *m_ptr;
+    const char *m_end;
+    bool        m_ok = true;
+};
+
+class SliceCacheWriter
+{
+public:
+    SliceCacheWriter(FILE *file) : m_file(file) {}
+
+    bool ok() const { return m_ok; }
+
+    void write(const void *data, size_t size) {
+        if (m_ok && size > 0 && ::fwrite(data, 1, size, m_file) != size)
+            m_ok = false;
+    }
+    template<typename T> void write(const T &value) { this->write(&value, sizeof(T)); }
+
+    void write(const Points &points) {
+        this->write(uint32_t(points.size()));
+        this->write(points.data(), points.size() * sizeof(Point));
+    }
+    void write(const ExPolygon &expoly) {
+        this->write(uint32_t(expoly.holes.size()));
+        this->write(expoly.contour.points);
+        for (const Polygon &hole : expoly.holes)
+            this->write(hole.points);
+    }
+
+private:
+    FILE *m_file;
+    bool  m_ok = true;
+};
+
+} // namespace
+
+bool slice_cache_load(const std::string &dir, const std::string &key, size_t num_regions, std::vector<SliceCacheLayer> &layers)
+{
+    namespace bip = boost::interprocess;
+    boost::filesystem::path path = slice_cache_path(dir, key);
+    layers.clear();
+    boost::system::error_code ec;
+    if (! boost::filesystem::is_regular_file(path, ec))
+        return false;
+    try {
+        bip::file_mapping  mapping(path.string().c_str(), bip::read_only);
+        bip::mapped_region region(mapping, bip::read_only);
+        region.advise(bip::mapped_region::advice_sequential);
+        SliceCacheReader reader((const char*)region.get_address(), region.get_size());
+        char magic[8];
+        for (char &c : magic)
+            c = reader.read<char>();
+        if (! reader.ok() || memcmp(magic, slice_cache_magic, 8) != 0 ||
+            reader.read<uint32_t>() != slice_cache_version || reader.read<uint32_t>() != uint32_t(num_regions)) {
+            BOOST_LOG_TRIVIAL(warning) << "Slice cache entry " << path.string() << " is not compatible, ignoring it";
+            return false;
+        }
+        uint64_t num_layers = reader.read<uint64_t>();
+        // Each layer occupies at least 32 bytes.
+        if (reader.reserve(num_layers, 32)) {
+            layers.assign(size_t(num_layers), SliceCacheLayer());
+            for (SliceCacheLayer &layer : layers) {
+                layer.id      = size_t(reader.read<uint64_t>());
+                layer.height  = reader.read<double>();
+                layer.print_z = reader.read<double>();
+                layer.slice_z = reader.read<double>();
+                layer.region_slices.assign(num_regions, ExPolygons());
+                for (ExPolygons &expolygons : layer.region_slices)
+                    reader.read(expolygons);
+                reader.read(layer.slices);
+                if (! reader.ok())
+                    break;
+            }
+        }
+        if (! reader.ok() || ! reader.at_end()) {
+            BOOST_LOG_TRIVIAL(warning) << "Slice cache entry " << path.string() << " is corrupted, ignoring it";
+            layers.clear();
+            return false;
+        }
+    } catch (const bip::interprocess_exception &ex) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to read the slice cache entry " << path.string() << ": " << ex.what();
+        layers.clear();
+        return false;
+    }
+    return true;
+}
+
+void slice_cache_store(const std::string &dir, const std::string &key, const std::vector<Layer*> &layers)
+{
+    boost::filesystem::path path     = slice_cache_path(dir, key);
+    boost::filesystem::path path_tmp = path;
+    path_tmp += "." + boost::filesystem::unique_path().string();
+    try {
+        boost::filesystem::create_directories(path.parent_path());
+        FILE *file = boost::nowide::fopen(path_tmp.string().c_str(), "wb");
+        if (file == nullptr)
+            throw std::runtime_error("Cannot create the file");
+        SliceCacheWriter writer(file);
+        writer.write(slice_cache_magic, 8);
+        writer.write(slice_cache_version);
+        writer.write(uint32_t(layers.empty() ? 0 : layers.front()->region_count()));
+        writer.write(uint64_t(layers.size()));
+        for (const Layer *layer : layers) {
+            writer.write(uint64_t(layer->id()));
+            writer.write(layer->height);
+            writer.write(layer->print_z);
+            writer.write(layer->slice_z);
+            for (const LayerRegion *layerm : layer->regions()) {
+                writer.write(uint64_t(layerm->slices.surfaces.size()));
+                for (const Surface &surface : layerm->slices.surfaces) {
+                    assert(surface.surface_type == stInternal);
+                    writer.write(surface.expolygon);
+                }
+            }
+            writer.write(uint64_t(layer->slices.expolygons.size()));
+            for (const ExPolygon &expoly : layer->slices.expolygons)
+                writer.write(expoly);
+        }
+        bool ok = writer.ok();
+        if (::fclose(file) != 0 || ! ok)
+            throw std::runtime_error("Failed to write the file");
+        boost::filesystem::rename(path_tmp, path);
+        BOOST_LOG_TRIVIAL(info) << "Sliced layers stored to the slice cache " << path.string();
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to store the sliced layers to the slice cache " << path.string() << ": " << ex.what();
+        boost::system::error_code ec;
+        boost::filesystem::remove(path_tmp, ec);
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,65 @@
+#ifndef slic3r_SliceCache_hpp_
+#define slic3r_SliceCache_hpp_
+
+// Persistent cache of the sliced layers of the PrintObjects (the output of the posSlice step).
+// The cache is meant for the command line batch processing, where the same models are sliced
+// again and again with a couple of configuration variants. The cache entries are stored into a directory
+// set by Print::set_slice_cache_dir(), one file per entry, keyed by a hash of the transformed meshes
+// and of the slicing parameters, see PrintObject::_slice_cache_key().
+
+#include <string>
+#include <vector>
+
+#include "libslic3r.h"
+#include "ExPolygon.hpp"
+
+namespace Slic3r {
+
+class Layer;
+
+// 128bit non-cryptographic hash of a stream of bytes (MurmurHash3 x64_128), used as a key into the slice cache.
+// The hash is stable between runs, but it depends on the endianity and on the sizes of the hashed types.
+class SliceCacheHasher
+{
+public:
+    void update(const void *data, size_t size);
+    template<typename T> void update(const T &value) { this->update(&value, sizeof(T)); }
+    void update(const std::string &str) { this->update(uint64_t(str.size())); this->update(str.data(), str.size()); }
+
+    // Hexadecimal digest of the bytes hashed so far.
+    std::string digest() const;
+
+private:
+    void        process_block(const unsigned char *block);
+
+    uint64_t        m_h1          = 0;
+    uint64_t        m_h2          = 0;
+    uint64_t        m_length      = 0;
+    unsigned char   m_buffer[16];
+    size_t          m_buffer_size = 0;
+};
+
+// A single sliced layer loaded from the slice cache.
+struct SliceCacheLayer
+{
+    size_t                  id;
+    coordf_t                height;
+    coordf_t                print_z;
+    coordf_t                slice_z;
+    // LayerRegion::slices, all of them of stInternal type.
+    std::vector<ExPolygons> region_slices;
+    // Layer::slices
+    ExPolygons              slices;
+};
+
+// Load the sliced layers stored in the cache directory under the key by a memory mapped read of the cache entry.
+// Returns false if there is no such entry or if the entry does not match the number of regions.
+extern bool slice_cache_load(const std::string &dir, const std::string &key, size_t num_regions, std::vector<SliceCacheLayer> &layers);
+// Store the sliced layers under the key. The cache entry is written into a temporary file first, which is then renamed,
+// so that the concurrently running slicers sharing the cache directory never see a partially written entry.
+// Failure to write the cache entry is logged and otherwise ignored.
+extern void slice_cache_store(const std::string &dir, const std::string &key, const std::vector<Layer*> &layers);
+
+} // namespace Slic3r
+
+#endif /* slic3r_SliceCache_hpp_ */
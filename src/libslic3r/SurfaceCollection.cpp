@@ -80,9 +80,9 @@ SurfaceCollection::filter_by_types(const SurfaceType *types, int ntypes)
 }
 
 void
-SurfaceCollection::filter_by_type(SurfaceType type, Polygons* polygons)
+SurfaceCollection::filter_by_type(SurfaceType type, Polygons* polygons) const
 {
-    for (Surfaces::iterator surface = this->surfaces.begin(); surface != this->surfaces.end(); ++surface) {
+    for (Surfaces::const_iterator surface = this->surfaces.begin(); surface != this->surfaces.end(); ++surface) {
         if (surface->surface_type == type) {
             Polygons pp = surface->expolygon;
             polygons->insert(polygons->end(), pp.begin(), pp.end());
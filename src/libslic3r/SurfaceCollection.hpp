@@ -33,7 +33,7 @@ public:
     void keep_types(const SurfaceType *types, int ntypes);
     void remove_type(const SurfaceType type);
     void remove_types(const SurfaceType *types, int ntypes);
-    void filter_by_type(SurfaceType type, Polygons* polygons);
+    void filter_by_type(SurfaceType type, Polygons* polygons) const;
 
     void clear() { surfaces.clear(); }
     bool empty() const { return surfaces.empty(); }
@@ -1,4 +1,5 @@
 #include "TriangleMesh.hpp"
+#include "IndexedMesh.hpp"
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
 #include "Tesselate.hpp"
@@ -13,12 +14,15 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <limits>
 #include <math.h>
 #include <type_traits>
 
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/enumerable_thread_specific.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -534,32 +538,30 @@ BoundingBoxf3 TriangleMesh::transformed_bounding_box(const Transform3d &trafo) c
 
 TriangleMesh TriangleMesh::convex_hull_3d() const
 {
-    // Helper struct for qhull:
-    struct PointForQHull{
-        PointForQHull(float x_p, float y_p, float z_p) : x((realT)x_p), y((realT)y_p), z((realT)z_p) {}
-        realT x, y, z;
-    };
-    std::vector<PointForQHull> src_vertices;
-
     // We will now fill the vector with input points for computation:
-    stl_facet* facet_ptr = stl.facet_start;
-    while (facet_ptr < stl.facet_start + stl.stats.number_of_facets)
-    {
-        for (int i = 0; i < 3; ++i)
-        {
+    std::vector<float> points;
+    points.reserve(stl.stats.number_of_facets * 9);
+    for (const stl_facet *facet_ptr = stl.facet_start; facet_ptr < stl.facet_start + stl.stats.number_of_facets; ++ facet_ptr)
+        for (int i = 0; i < 3; ++ i) {
             const stl_vertex& v = facet_ptr->vertex[i];
-            src_vertices.emplace_back(v(0), v(1), v(2));
+            points.emplace_back(v(0));
+            points.emplace_back(v(1));
+            points.emplace_back(v(2));
         }
+    return convex_hull_3d_from_points(points);
+}
 
-        facet_ptr += 1;
-    }
+TriangleMesh convex_hull_3d_from_points(const std::vector<float> &points)
+{
+    // The reentrant qhull is compiled with single precision coordinates (REALfloat), the points are passed in directly.
+    static_assert(std::is_same<realT, float>::value, "qhull is expected to be compiled with single precision coordinates");
 
     // The qhull call:
     orgQhull::Qhull qhull;
     qhull.disableOutputStream(); // we want qhull to be quiet
     try
     {
-        qhull.runQhull("", 3, (int)src_vertices.size(), (const realT*)(src_vertices.data()), "Qt");
+        qhull.runQhull("", 3, (int)(points.size() / 3), (const realT*)(points.data()), "Qt");
     }
     catch (...)
     {
@@ -621,15 +623,66 @@ void TriangleMesh::require_shared_vertices()
 void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callback_type throw_on_cancel)
 {
     mesh = _mesh;
+    m_indexed_mesh = nullptr;
     if (! mesh->has_shared_vertices())
         throw std::invalid_argument("TriangleMeshSlicer was passed a mesh without shared vertices.");
 
     throw_on_cancel();
-    facets_edges.assign(_mesh->stl.stats.number_of_facets * 3, -1);
     v_scaled_shared.assign(_mesh->stl.v_shared, _mesh->stl.v_shared + _mesh->stl.stats.shared_vertices);
+    this->_init(throw_on_cancel);
+}
+
+void TriangleMeshSlicer::init(const IndexedMesh *_mesh, throw_on_cancel_callback_type throw_on_cancel)
+{
+    mesh = nullptr;
+    m_indexed_mesh = _mesh;
+
+    throw_on_cancel();
+    v_scaled_shared.clear();
+    v_scaled_shared.reserve(_mesh->vertices_count());
+    for (size_t i = 0; i < _mesh->vertices_count(); ++ i)
+        v_scaled_shared.emplace_back(_mesh->x[i], _mesh->y[i], _mesh->z[i]);
+    this->_init(throw_on_cancel);
+}
+
+size_t TriangleMeshSlicer::_facets_count() const
+{
+    return (this->mesh != nullptr) ? size_t(this->mesh->stl.stats.number_of_facets) : m_indexed_mesh->facets_count();
+}
+
+stl_facet TriangleMeshSlicer::_facet(int facet_idx) const
+{
+    if (this->mesh != nullptr)
+        return m_use_quaternion ? this->mesh->stl.facet_start[facet_idx].rotated(m_quaternion) : this->mesh->stl.facet_start[facet_idx];
+    const uint32_t *vertices = m_indexed_mesh->facet(facet_idx);
+    stl_facet facet;
+    facet.vertex[0] = m_indexed_mesh->vertex(vertices[0]);
+    facet.vertex[1] = m_indexed_mesh->vertex(vertices[1]);
+    facet.vertex[2] = m_indexed_mesh->vertex(vertices[2]);
+    // Only the orientation of the normal is used by the slicer, it does not need to be normalized.
+    facet.normal    = m_indexed_mesh->facet_normal(facet_idx);
+    facet.extra[0]  = 0;
+    facet.extra[1]  = 0;
+    return m_use_quaternion ? facet.rotated(m_quaternion) : facet;
+}
+
+Vec3i TriangleMeshSlicer::_facet_vertices(int facet_idx) const
+{
+    if (this->mesh != nullptr) {
+        const int *vertices = this->mesh->stl.v_indices[facet_idx].vertex;
+        return Vec3i(vertices[0], vertices[1], vertices[2]);
+    }
+    const uint32_t *vertices = m_indexed_mesh->facet(facet_idx);
+    return Vec3i(int(vertices[0]), int(vertices[1]), int(vertices[2]));
+}
+
+void TriangleMeshSlicer::_init(throw_on_cancel_callback_type throw_on_cancel)
+{
+    const size_t num_facets = this->_facets_count();
+    facets_edges.assign(num_facets * 3, -1);
     // Scale the copied vertices.
-    for (int i = 0; i < this->mesh->stl.stats.shared_vertices; ++ i)
-        this->v_scaled_shared[i] *= float(1. / SCALING_FACTOR);
+    for (stl_vertex &v : this->v_scaled_shared)
+        v *= float(1. / SCALING_FACTOR);
 
     // Create a mapping from triangle edge into face.
     struct EdgeToFace {
@@ -645,12 +698,13 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
         bool operator<(const EdgeToFace &other) const { return vertex_low < other.vertex_low || (vertex_low == other.vertex_low && vertex_high < other.vertex_high); }
     };
     std::vector<EdgeToFace> edges_map;
-    edges_map.assign(this->mesh->stl.stats.number_of_facets * 3, EdgeToFace());
-    for (uint32_t facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; ++ facet_idx)
+    edges_map.assign(num_facets * 3, EdgeToFace());
+    for (uint32_t facet_idx = 0; facet_idx < num_facets; ++ facet_idx) {
+        const Vec3i vertices = this->_facet_vertices(facet_idx);
         for (int i = 0; i < 3; ++ i) {
             EdgeToFace &e2f = edges_map[facet_idx*3+i];
-            e2f.vertex_low  = this->mesh->stl.v_indices[facet_idx].vertex[i];
-            e2f.vertex_high = this->mesh->stl.v_indices[facet_idx].vertex[(i + 1) % 3];
+            e2f.vertex_low  = vertices[i];
+            e2f.vertex_high = vertices[(i + 1) % 3];
             e2f.face        = facet_idx;
             // 1 based indexing, to be always strictly positive.
             e2f.face_edge   = i + 1;
@@ -661,6 +715,7 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
                 e2f.face_edge = - e2f.face_edge;
             }
         }
+    }
     throw_on_cancel();
     std::sort(edges_map.begin(), edges_map.end());
 
@@ -704,6 +759,9 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
         if ((i & 0x0ffff) == 0)
             throw_on_cancel();
     }
+
+    if (m_sweep)
+        this->_build_z_index();
 }
 
 
@@ -712,6 +770,51 @@ void TriangleMeshSlicer::set_up_direction(const Vec3f& up)
 {
     m_quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
     m_use_quaternion = true;
+    // The Z extents of the facets changed.
+    if (m_sweep && this->_initialized())
+        this->_build_z_index();
+}
+
+void TriangleMeshSlicer::set_sweep(bool sweep)
+{
+    if (sweep == m_sweep)
+        return;
+    m_sweep = sweep;
+    if (! m_sweep) {
+        m_facets_z_sorted.clear();
+        m_facets_z_sorted.shrink_to_fit();
+        m_facets_z_block_max.clear();
+        m_facets_z_block_max.shrink_to_fit();
+    } else if (this->_initialized())
+        this->_build_z_index();
+}
+
+void TriangleMeshSlicer::_build_z_index()
+{
+    BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::_build_z_index - start";
+    m_facets_z_sorted.assign(this->_facets_count(), FacetZSpan());
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, int(m_facets_z_sorted.size())),
+        [this](const tbb::blocked_range<int>& range) {
+            for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                // The Z extents have to be calculated exactly the same way as in _slice_do(),
+                // as slice_facet() identifies the lowest vertex by comparing its Z with min_z.
+                const stl_facet facet = this->_facet(facet_idx);
+                FacetZSpan &span = m_facets_z_sorted[facet_idx];
+                span.min_z     = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
+                span.max_z     = fmaxf(facet.vertex[0](2), fmaxf(facet.vertex[1](2), facet.vertex[2](2)));
+                span.facet_idx = facet_idx;
+            }
+        });
+    // Sort by min_z, facet_idx to make the order of the intersection lines deterministic.
+    tbb::parallel_sort(m_facets_z_sorted.begin(), m_facets_z_sorted.end(), 
+        [](const FacetZSpan &l, const FacetZSpan &r) { return l.min_z < r.min_z || (l.min_z == r.min_z && l.facet_idx < r.facet_idx); });
+    m_facets_z_block_max.assign((m_facets_z_sorted.size() + facets_z_block_size - 1) / facets_z_block_size, -std::numeric_limits<float>::max());
+    for (size_t i = 0; i < m_facets_z_sorted.size(); ++ i) {
+        float &block_max = m_facets_z_block_max[i / facets_z_block_size];
+        block_max = std::max(block_max, m_facets_z_sorted[i].max_z);
+    }
+    BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::_build_z_index - end";
 }
 
 
@@ -747,20 +850,59 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons
         type is float.
     */
     
-    BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
     std::vector<IntersectionLines> lines(z.size());
-    {
-        boost::mutex lines_mutex;
+    if (m_sweep) {
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_sweep";
+        this->_slice_sweep(z, &lines, throw_on_cancel);
+    } else {
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
+        // Each worker thread collects its intersection lines into its own set of per layer buckets,
+        // so that no lock is taken when storing an intersection line.
+        typedef tbb::enumerable_thread_specific<std::vector<IntersectionLines>> IntersectionLinesTLS;
+        IntersectionLinesTLS lines_tls([&z]() { return std::vector<IntersectionLines>(z.size()); });
         tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
-            [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
+            tbb::blocked_range<int>(0, int(this->_facets_count())),
+            [&lines_tls, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
+                std::vector<IntersectionLines> &lines = lines_tls.local();
                 for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
                     if ((facet_idx & 0x0ffff) == 0)
                         throw_on_cancel();
-                    this->_slice_do(facet_idx, &lines, &lines_mutex, z);
+                    this->_slice_do(facet_idx, &lines, z);
                 }
             }
         );
+        throw_on_cancel();
+
+        // Merge the per thread buckets layer by layer.
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do - merging";
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, z.size()),
+            [&lines_tls, &lines, throw_on_cancel](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    if ((layer_idx & 0x0ffff) == 0)
+                        throw_on_cancel();
+                    IntersectionLines &dst = lines[layer_idx];
+                    size_t num_lines = 0;
+                    for (const std::vector<IntersectionLines> &src : lines_tls)
+                        num_lines += src[layer_idx].size();
+                    for (std::vector<IntersectionLines> &src : lines_tls) {
+                        IntersectionLines &src_lines = src[layer_idx];
+                        if (src_lines.empty())
+                            continue;
+                        if (dst.empty()) {
+                            // Steal the first non-empty bucket.
+                            dst.swap(src_lines);
+                            dst.reserve(num_lines);
+                        } else {
+                            dst.insert(dst.end(), src_lines.begin(), src_lines.end());
+                            // Release the memory of the thread local bucket early.
+                            IntersectionLines().swap(src_lines);
+                        }
+                    }
+                }
+            }
+        );
+        lines_tls.clear();
     }
     throw_on_cancel();
 
@@ -815,10 +957,9 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons
 #endif
 }
 
-void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const
 {
-    const stl_facet &facet = m_use_quaternion ? this->mesh->stl.facet_start[facet_idx].rotated(m_quaternion) : this->mesh->stl.facet_start[facet_idx];
+    const stl_facet facet = this->_facet(int(facet_idx));
     
     // find facet extents
     const float min_z = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
@@ -844,7 +985,6 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
         std::vector<float>::size_type layer_idx = it - z.begin();
         IntersectionLine il;
         if (this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &il) == TriangleMeshSlicer::Slicing) {
-            boost::lock_guard<boost::mutex> l(*lines_mutex);
             if (il.edge_type == feHorizontal) {
                 // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
             } else
@@ -853,6 +993,52 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
     }
 }
 
+void TriangleMeshSlicer::_slice_sweep(const std::vector<float> &z, std::vector<IntersectionLines>* lines, throw_on_cancel_callback_type throw_on_cancel) const
+{
+    assert(m_sweep);
+    assert(m_facets_z_sorted.size() == this->_facets_count());
+    // Bands of consecutive layers are swept in parallel. Each band owns its layers, therefore the intersection lines
+    // are stored without locking and in the order of m_facets_z_sorted.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, z.size(), 16),
+        [this, &z, lines, throw_on_cancel](const tbb::blocked_range<size_t>& range) {
+            throw_on_cancel();
+            const float z_begin = z[range.begin()];
+            // Facets starting above the first plane of this band are activated by the sweep.
+            auto it_next  = std::upper_bound(m_facets_z_sorted.begin(), m_facets_z_sorted.end(), z_begin, 
+                [](float z, const FacetZSpan &span) { return z < span.min_z; });
+            // Facets intersected by the current plane, in the order of m_facets_z_sorted.
+            // The facets starting below the first plane are collected from the blocks reaching the first plane,
+            // so that a few tall facets do not make each band visit all the facets below it.
+            std::vector<const FacetZSpan*> active;
+            const size_t num_below = size_t(it_next - m_facets_z_sorted.begin());
+            for (size_t block_idx = 0; block_idx * facets_z_block_size < num_below; ++ block_idx)
+                if (m_facets_z_block_max[block_idx] >= z_begin)
+                    for (size_t i = block_idx * facets_z_block_size; i < std::min(num_below, (block_idx + 1) * facets_z_block_size); ++ i)
+                        if (m_facets_z_sorted[i].max_z >= z_begin)
+                            active.emplace_back(&m_facets_z_sorted[i]);
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                const float slice_z = z[layer_idx];
+                // Retire the facets ending below the current plane.
+                active.erase(std::remove_if(active.begin(), active.end(), [slice_z](const FacetZSpan *span) { return span->max_z < slice_z; }), active.end());
+                // Activate the facets starting at or below the current plane.
+                for (; it_next != m_facets_z_sorted.end() && it_next->min_z <= slice_z; ++ it_next)
+                    if (it_next->max_z >= slice_z)
+                        active.emplace_back(&(*it_next));
+                IntersectionLines &layer_lines = (*lines)[layer_idx];
+                for (const FacetZSpan *span : active) {
+                    const stl_facet facet = this->_facet(span->facet_idx);
+                    IntersectionLine il;
+                    // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+                    if (this->slice_facet(slice_z / SCALING_FACTOR, facet, span->facet_idx, span->min_z, span->max_z, &il) == TriangleMeshSlicer::Slicing &&
+                        il.edge_type != feHorizontal)
+                        layer_lines.emplace_back(il);
+                }
+            }
+        }
+    );
+}
+
 void TriangleMeshSlicer::slice(const std::vector<float> &z, const float closing_radius, std::vector<ExPolygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const
 {
     std::vector<Polygons> layers_p;
@@ -887,7 +1073,7 @@ TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
     // Reorder vertices so that the first one is the one with lowest Z.
     // This is needed to get all intersection lines in a consistent order
     // (external on the right of the line)
-    const int *vertices = this->mesh->stl.v_indices[facet_idx].vertex;
+    const Vec3i vertices = this->_facet_vertices(facet_idx);
     int i = (facet.vertex[1].z() == min_z) ? 1 : ((facet.vertex[2].z() == min_z) ? 2 : 0);
 
     // These are used only if the cut plane is tilted:
@@ -1709,6 +1895,9 @@ void TriangleMeshSlicer::make_expolygons(std::vector<IntersectionLine> &lines, c
 
 void TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower) const
 {
+    if (this->mesh == nullptr)
+        throw std::invalid_argument("TriangleMeshSlicer::cut() requires a TriangleMesh.");
+
     IntersectionLines upper_lines, lower_lines;
     
     BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::cut - slicing object";
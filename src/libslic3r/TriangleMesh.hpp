@@ -16,6 +16,7 @@ namespace Slic3r {
 
 class TriangleMesh;
 class TriangleMeshSlicer;
+class IndexedMesh;
 typedef std::vector<TriangleMesh*> TriangleMeshPtrs;
 
 class TriangleMesh
@@ -161,6 +162,10 @@ public:
     TriangleMeshSlicer() : mesh(nullptr) {}
 	TriangleMeshSlicer(const TriangleMesh* mesh) { this->init(mesh, [](){}); }
     void init(const TriangleMesh *mesh, throw_on_cancel_callback_type throw_on_cancel);
+    // Slice a compact indexed mesh directly. Its vertices are expected to be shared by the facets
+    // (for example an IndexedMesh constructed from a TriangleMesh with shared vertices).
+    // cut() is not supported for an indexed mesh.
+    void init(const IndexedMesh *mesh, throw_on_cancel_callback_type throw_on_cancel);
     void slice(const std::vector<float> &z, std::vector<Polygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const;
     void slice(const std::vector<float> &z, const float closing_radius, std::vector<ExPolygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const;
     enum FacetSliceType {
@@ -172,9 +177,16 @@ public:
         const float min_z, const float max_z, IntersectionLine *line_out) const;
     void cut(float z, TriangleMesh* upper, TriangleMesh* lower) const;
     void set_up_direction(const Vec3f& up);
+    // Enable the sweep plane slicing: The facets are sorted by their minimum Z once, then each band of layers
+    // is swept by a plane in parallel, visiting just the facets active at the current plane.
+    // Slicing a sparse set of Z coordinates only touches the facets close to these coordinates.
+    void set_sweep(bool sweep);
+    bool sweep() const { return m_sweep; }
     
 private:
     const TriangleMesh      *mesh;
+    // Alternatively to the mesh above, an indexed mesh is being sliced.
+    const IndexedMesh       *m_indexed_mesh = nullptr;
     // Map from a facet to an edge index.
     std::vector<int>         facets_edges;
     // Scaled copy of this->mesh->stl.v_shared
@@ -183,14 +195,42 @@ private:
     Eigen::Quaternion<float, Eigen::DontAlign> m_quaternion;
     // Whether or not the above quaterion should be used
     bool                     m_use_quaternion = false;
-
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
+    // Whether the sweep plane slicing is enabled.
+    bool                     m_sweep = false;
+    // Z extent of a facet (rotated by m_quaternion if m_use_quaternion), unscaled.
+    struct FacetZSpan {
+        float min_z;
+        float max_z;
+        int   facet_idx;
+    };
+    // Facets sorted by their minimum Z, only maintained if m_sweep is enabled.
+    std::vector<FacetZSpan>  m_facets_z_sorted;
+    // Maximum of max_z over blocks of facets_z_block_size consecutive facets of m_facets_z_sorted, to find the facets
+    // spanning the first plane of a band without visiting all the facets below it.
+    static constexpr size_t  facets_z_block_size = 256;
+    std::vector<float>       m_facets_z_block_max;
+
+    // Slice a single facet, store the intersection lines into the per layer buckets (thread local, no locking).
+    void _init(throw_on_cancel_callback_type throw_on_cancel);
+    bool _initialized() const { return this->mesh != nullptr || m_indexed_mesh != nullptr; }
+    size_t _facets_count() const;
+    // Vertices and normal of a facet, unscaled, rotated by m_quaternion if m_use_quaternion.
+    stl_facet _facet(int facet_idx) const;
+    // Indices of the shared vertices of a facet.
+    Vec3i _facet_vertices(int facet_idx) const;
+    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z) const;
+    void _build_z_index();
+    // Sweep plane slicing over m_facets_z_sorted, bands of layers in parallel.
+    void _slice_sweep(const std::vector<float> &z, std::vector<IntersectionLines>* lines, throw_on_cancel_callback_type throw_on_cancel) const;
     void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
     void make_expolygons(const Polygons &loops, const float closing_radius, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     void make_expolygons(std::vector<IntersectionLine> &lines, const float closing_radius, ExPolygons* slices) const;
 };
 
+// Convex hull of a point cloud, the points are passed as consecutive XYZ triplets.
+TriangleMesh convex_hull_3d_from_points(const std::vector<float> &points);
+
 TriangleMesh make_cube(double x, double y, double z);
 
 // Generate a TriangleMesh of a cylinder
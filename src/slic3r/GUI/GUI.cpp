@@ -237,6 +237,8 @@ void change_opt_value(DynamicPrintConfig& config, const t_config_option_key& opt
 				config.set_key_value(opt_key, new ConfigOptionEnum<SLADisplayOrientation>(boost::any_cast<SLADisplayOrientation>(value)));
             else if(opt_key.compare("support_pillar_connection_mode") == 0)
                 config.set_key_value(opt_key, new ConfigOptionEnum<SLAPillarConnectionMode>(boost::any_cast<SLAPillarConnectionMode>(value)));
+            else if(opt_key.compare("png_filter") == 0)
+                config.set_key_value(opt_key, new ConfigOptionEnum<SLAPNGFilter>(boost::any_cast<SLAPNGFilter>(value)));
 			}
 			break;
 		case coPoints:{
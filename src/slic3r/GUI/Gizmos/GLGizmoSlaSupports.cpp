@@ -165,7 +165,7 @@ void GLGizmoSlaSupports::render_clipping_plane(const Selection& selection) const
         // Now initialize the TMS for the object, perform the cut and save the result.
         if (! m_tms) {
             m_tms.reset(new TriangleMeshSlicer);
-            m_tms->init(m_mesh, [](){});
+            m_tms->init(m_mesh.get(), [](){});
         }
         std::vector<ExPolygons> list_of_expolys;
         m_tms->set_up_direction(up);
@@ -378,8 +378,10 @@ bool GLGizmoSlaSupports::is_point_clipped(const Vec3d& point) const
 
 bool GLGizmoSlaSupports::is_mesh_update_necessary() const
 {
+    // The mesh snapshot is stale, if the volume mesh was modified or replaced, as the modification copies a shared mesh.
     return ((m_state == On) && (m_model_object != nullptr) && !m_model_object->instances.empty())
-        && ((m_model_object->id() != m_current_mesh_model_id) || m_V.size()==0);
+        && ((m_model_object->id() != m_current_mesh_model_id) || m_V.size()==0 || 
+            m_mesh != m_model_object->volumes.front()->get_mesh_shared_ptr());
 }
 
 void GLGizmoSlaSupports::update_mesh()
@@ -390,8 +392,11 @@ void GLGizmoSlaSupports::update_mesh()
     // We rely on SLA model object having a single volume,
     // this way we can use that mesh directly.
     // This mesh does not account for the possible Z up SLA offset.
-    m_mesh = &m_model_object->volumes.front()->mesh;
-    const_cast<TriangleMesh*>(m_mesh)->require_shared_vertices(); // TriangleMeshSlicer needs this
+    ModelVolume *volume = m_model_object->volumes.front();
+    if (! volume->mesh().has_shared_vertices())
+        // The mesh is copied first if it is being referenced by the background processing.
+        volume->mesh_mutable().require_shared_vertices(); // TriangleMeshSlicer needs this
+    m_mesh = volume->get_mesh_shared_ptr();
     const stl_file& stl = m_mesh->stl;
     V.resize(3 * stl.stats.number_of_facets, 3);
     F.resize(stl.stats.number_of_facets, 3);
@@ -409,6 +414,10 @@ void GLGizmoSlaSupports::update_mesh()
 
     m_AABB = igl::AABB<Eigen::MatrixXf,3>();
     m_AABB.init(m_V, m_F);
+
+    // The slicer of the clipping plane references the former mesh, recreate it and the cached cut.
+    m_tms.reset();
+    m_old_clipping_plane_distance = -1.f;
 }
 
 // Unprojects the mouse position on the mesh and return the hit point and normal of the facet.
@@ -807,7 +816,7 @@ void GLGizmoSlaSupports::find_intersecting_facets(const igl::AABB<Eigen::MatrixX
 
 void GLGizmoSlaSupports::make_line_segments() const
 {
-    TriangleMeshSlicer tms(&m_model_object->volumes.front()->mesh);
+    TriangleMeshSlicer tms(&m_model_object->volumes.front()->mesh());
     Vec3f normal(0.f, 1.f, 1.f);
     double d = 0.;
 
@@ -38,7 +38,8 @@ private:
     Eigen::MatrixXf m_V; // vertices
     Eigen::MatrixXi m_F; // facets indices
     igl::AABB<Eigen::MatrixXf,3> m_AABB;
-    const TriangleMesh* m_mesh;
+    // Mesh of the model object, shared with the ModelVolume.
+    std::shared_ptr<const TriangleMesh> m_mesh;
     mutable const TriangleMesh* m_supports_mesh;
     mutable std::vector<Vec2f> m_triangles;
     mutable std::vector<Vec2f> m_supports_triangles;
@@ -652,6 +652,9 @@ boost::any ConfigOptionsGroup::get_config_value(const DynamicPrintConfig& config
         else if (opt_key.compare("support_pillar_connection_mode") == 0) {
             ret  = static_cast<int>(config.option<ConfigOptionEnum<SLAPillarConnectionMode>>(opt_key)->value);
         }
+        else if (opt_key.compare("png_filter") == 0) {
+            ret  = static_cast<int>(config.option<ConfigOptionEnum<SLAPNGFilter>>(opt_key)->value);
+        }
 	}
 		break;
 	case coPoints:
@@ -514,6 +514,7 @@ const std::vector<std::string>& Preset::sla_printer_options()
             "relative_correction",
             "absolute_correction",
             "gamma_correction",
+            "png_filter",
             "print_host", "printhost_apikey", "printhost_cafile",
             "printer_notes",
             "inherits"
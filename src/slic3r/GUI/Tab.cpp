@@ -2102,6 +2102,9 @@ void TabPrinter::build_sla()
     optgroup->append_single_option_line("absolute_correction");
     optgroup->append_single_option_line("gamma_correction");
 
+    optgroup = page->new_optgroup(_(L("Layer images")));
+    optgroup->append_single_option_line("png_filter");
+
     optgroup = page->new_optgroup(_(L("Print Host upload")));
     build_printhost(optgroup.get());
 
@@ -0,0 +1,95 @@
+// Verifies the bounding box aware boolean operations (diff_bbox(), intersection_ex_bbox() etc.) against the plain Clipper operations:
+// The resulting areas have to be the same.
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Polyline.hpp>
+
+#include "random_islands.hpp"
+
+using namespace Slic3r;
+
+static double area(const Polygons &polygons)
+{
+    double a = 0.;
+    for (const Polygon &polygon : polygons)
+        a += polygon.area();
+    return a;
+}
+
+static double area(const ExPolygons &expolygons)
+{
+    double a = 0.;
+    for (const ExPolygon &expolygon : expolygons)
+        a += expolygon.area();
+    return a;
+}
+
+// Both sets have to cover the same area.
+static bool same_area(const Polygons &a, const Polygons &b)
+{
+    double tolerance = scale_(0.001) * scale_(0.001);
+    return std::abs(area(a) - area(b)) < tolerance &&
+        area(diff(a, b)) < tolerance && area(diff(b, a)) < tolerance;
+}
+
+static bool test_polygons()
+{
+    std::mt19937 rng(0);
+    bool ok = true;
+    for (size_t n : { 0, 1, 10, 1000 })
+        for (bool safety_offset : { false, true })
+            for (bool parallel : { false, true }) {
+                Polygons subject = test::random_square_islands(rng, n);
+                Polygons clip    = test::random_square_islands(rng, n / 2 + 1);
+                ok &= same_area(diff_bbox(subject, clip, safety_offset, parallel), diff(subject, clip, safety_offset));
+                ok &= same_area(intersection_bbox(subject, clip, safety_offset, parallel), intersection(subject, clip, safety_offset));
+                ok &= same_area(union_bbox(subject, safety_offset, parallel), union_(subject, safety_offset));
+                ExPolygons ex = diff_ex_bbox(subject, clip, safety_offset, parallel);
+                ok &= same_area(to_polygons(ex), to_polygons(diff_ex(subject, clip, safety_offset))) && std::abs(area(ex) - area(diff_ex(subject, clip, safety_offset))) < 1.;
+                ex = intersection_ex_bbox(subject, clip, safety_offset, parallel);
+                ok &= same_area(to_polygons(ex), to_polygons(intersection_ex(subject, clip, safety_offset)));
+                ex = union_ex_bbox(subject, safety_offset, parallel);
+                ok &= same_area(to_polygons(ex), to_polygons(union_ex(subject, safety_offset)));
+                // The islands of the union do not overlap.
+                ok &= std::abs(area(ex) - area(union_(to_polygons(ex)))) < 1.;
+            }
+    std::cout << "polygons: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_polylines()
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<coord_t> position(0, coord_t(scale_(100.)));
+    bool ok = true;
+    for (size_t n : { 0, 1, 10, 1000 })
+        for (bool parallel : { false, true }) {
+            Polylines subject;
+            for (size_t i = 0; i < n; ++ i)
+                subject.emplace_back(Polyline(Point(position(rng), position(rng)), Point(position(rng), position(rng))));
+            // Short polylines mostly outside of the clip polygons.
+            for (size_t i = 0; i < n; ++ i) {
+                Point pt(position(rng), position(rng));
+                subject.emplace_back(Polyline(pt, pt + Point(coord_t(scale_(1.)), 0)));
+            }
+            Polygons clip = test::random_square_islands(rng, n / 10 + 1);
+            ok &= std::abs(total_length(diff_pl_bbox(subject, clip, false, parallel)) - total_length(diff_pl(subject, clip))) < 1.;
+            ok &= std::abs(total_length(intersection_pl_bbox(subject, clip, false, parallel)) - total_length(intersection_pl(subject, clip))) < 1.;
+            ok &= std::abs(total_length(intersection_pl_bbox(subject, clip, true, parallel)) - total_length(intersection_pl(subject, clip, true))) < 1.;
+        }
+    std::cout << "polylines: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_polygons();
+    ok &= test_polylines();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+#ifndef slic3r_tests_random_islands_hpp_
+#define slic3r_tests_random_islands_hpp_
+
+// Random layer like geometry shared by the tests.
+
+#include <random>
+#include <cmath>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Polygon.hpp>
+
+namespace Slic3r {
+namespace test {
+
+// Star shaped polygon of num_vertices vertices around (x, y) in mm, the vertices at random distances given by radius
+// multiplied by scale.
+inline Polygon random_star(std::mt19937 &rng, std::uniform_real_distribution<double> &radius, size_t num_vertices, double x, double y, double scale)
+{
+    Polygon out;
+    for (size_t i = 0; i < num_vertices; ++ i) {
+        double a = 2. * PI * double(i) / double(num_vertices);
+        double r = scale * radius(rng);
+        out.points.emplace_back(Point::new_scale(x + r * cos(a), y + r * sin(a)));
+    }
+    return out;
+}
+
+// n star shaped islands centered at random points of the rectangle [x_min, x_max] x [y_min, y_max] in mm, with their
+// vertices radius_min to radius_max mm from the center. Every second island has a star shaped hole.
+inline ExPolygons random_star_islands(std::mt19937 &rng, size_t n, double x_min, double y_min, double x_max, double y_max,
+                                      double radius_min, double radius_max, size_t num_vertices)
+{
+    std::uniform_real_distribution<double> position_x(x_min, x_max);
+    std::uniform_real_distribution<double> position_y(y_min, y_max);
+    std::uniform_real_distribution<double> radius(radius_min, radius_max);
+    ExPolygons out;
+    for (size_t i = 0; i < n; ++ i) {
+        double x = position_x(rng);
+        double y = position_y(rng);
+        ExPolygon expoly;
+        expoly.contour = random_star(rng, radius, num_vertices, x, y, 1.);
+        if (i % 2 == 0) {
+            Polygon hole = random_star(rng, radius, num_vertices, x, y, 0.15);
+            hole.reverse();
+            expoly.holes.emplace_back(std::move(hole));
+        }
+        out.emplace_back(std::move(expoly));
+    }
+    return out;
+}
+
+inline Polygon square(coord_t x, coord_t y, coord_t size)
+{
+    return Polygon({ Point(x, y), Point(x + size, y), Point(x + size, y + size), Point(x, y + size) });
+}
+
+// n square islands of 0.5 to 4 mm scattered over a 100 x 100 mm area, some of them overlapping or touching each other.
+// Every third island has a square hole, every seventh one a smaller square touching it.
+inline Polygons random_square_islands(std::mt19937 &rng, size_t n)
+{
+    std::uniform_int_distribution<coord_t> position(0, coord_t(scale_(100.)));
+    std::uniform_int_distribution<coord_t> size(coord_t(scale_(0.5)), coord_t(scale_(4.)));
+    Polygons out;
+    for (size_t i = 0; i < n; ++ i) {
+        coord_t x = position(rng);
+        coord_t y = position(rng);
+        coord_t s = size(rng);
+        out.emplace_back(square(x, y, s));
+        if (i % 3 == 0) {
+            Polygon hole = square(x + s / 4, y + s / 4, s / 2);
+            hole.reverse();
+            out.emplace_back(std::move(hole));
+        }
+        if (i % 7 == 0)
+            // Touching the island.
+            out.emplace_back(square(x + s, y, s / 2));
+    }
+    return out;
+}
+
+} // namespace test
+} // namespace Slic3r
+
+#endif // slic3r_tests_random_islands_hpp_
@@ -0,0 +1,99 @@
+// Verifies the batch signed distance queries of EdgeGrid::Grid against the queries of a single point,
+// which they have to replicate exactly, and the grids rasterized in parallel against a brute force search over all the edges.
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/EdgeGrid.hpp>
+#include <libslic3r/Geometry.hpp>
+
+#include "random_islands.hpp"
+
+using namespace Slic3r;
+
+static Points random_points(std::mt19937 &rng, size_t n, double min, double max)
+{
+    std::uniform_real_distribution<double> position(min, max);
+    Points out;
+    for (size_t i = 0; i < n; ++ i)
+        out.emplace_back(Point::new_scale(position(rng), position(rng)));
+    return out;
+}
+
+static bool test_batch_queries()
+{
+    std::mt19937 rng(0);
+    bool ok = true;
+    for (size_t num_islands : { 1, 10, 200 }) {
+        ExPolygons islands = test::random_star_islands(rng, num_islands, 0., 0., 50., 50., 1., 5., 7);
+        EdgeGrid::Grid grid;
+        grid.create(islands, coord_t(scale_(1.)));
+        grid.calculate_sdf();
+        // Query the vertices of the islands as the seam placement does, and random points including points outside of the grid.
+        Points pts = random_points(rng, 5000, -10., 60.);
+        for (const ExPolygon &expoly : islands)
+            append(pts, expoly.contour.points);
+        for (coord_t search_radius : { coord_t(scale_(0.05)), coord_t(scale_(0.32)), coord_t(scale_(3.)) }) {
+            std::vector<EdgeGrid::Grid::EdgeDistance> edge_distances;
+            grid.signed_distances_edges(pts, search_radius, edge_distances);
+            std::vector<coordf_t> distances;
+            ok &= grid.signed_distances(pts, search_radius, distances);
+            ok &= edge_distances.size() == pts.size() && distances.size() == pts.size();
+            for (size_t i = 0; ok && i < pts.size(); ++ i) {
+                coordf_t dist       = 0.;
+                bool     on_segment = false;
+                bool     found      = grid.signed_distance_edges(pts[i], search_radius, dist, &on_segment);
+                const EdgeGrid::Grid::EdgeDistance &ed = edge_distances[i];
+                ok &= found == (ed.edge.first != nullptr);
+                if (found) {
+                    ok &= dist == ed.distance && on_segment == ed.on_segment;
+                    // The distance to the returned edge is the distance found.
+                    const Points &contour = *ed.edge.first;
+                    Line edge(contour[ed.edge.second], contour[(ed.edge.second + 1) % contour.size()]);
+                    ok &= std::abs(edge.distance_to(pts[i]) - std::abs(dist)) < 1.;
+                }
+                ok &= grid.signed_distance(pts[i], search_radius, dist) && dist == distances[i];
+            }
+        }
+    }
+    std::cout << "batch queries: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_parallel_create()
+{
+    std::mt19937 rng(1);
+    // Enough edges for the grid to be rasterized in parallel.
+    ExPolygons islands = test::random_star_islands(rng, 2000, 0., 0., 200., 200., 1., 5., 12);
+    EdgeGrid::Grid grid;
+    grid.create(islands, coord_t(scale_(1.)));
+    Lines lines;
+    for (const ExPolygon &expoly : islands)
+        append(lines, expoly.lines());
+    const coord_t search_radius = coord_t(scale_(1.5));
+    bool ok = true;
+    for (const Point &pt : random_points(rng, 2000, 0., 200.)) {
+        // An edge in the search radius has to be found in the grid, at the same distance.
+        double dist_min = std::numeric_limits<double>::max();
+        for (const Line &line : lines)
+            dist_min = std::min(dist_min, line.distance_to(pt));
+        coordf_t dist = 0.;
+        bool found = grid.signed_distance_edges(pt, search_radius, dist);
+        if (dist_min < 0.99 * search_radius)
+            ok &= found && std::abs(std::abs(dist) - dist_min) < 1.;
+        else if (found)
+            ok &= std::abs(dist) >= dist_min - 1.;
+    }
+    std::cout << "parallel create: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_batch_queries();
+    ok &= test_parallel_create();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
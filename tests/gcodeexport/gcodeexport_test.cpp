@@ -0,0 +1,113 @@
+// Regression test of the pipelined G-code export (GCode::set_pipelined_export()).
+// A couple of synthetic objects are sliced with several configurations and exported
+// both serially and through the pipeline. The two G-code files have to be identical.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <functional>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+using namespace Slic3r;
+
+static void add_object(Model &model, const char *name, TriangleMesh &&mesh, size_t num_instances = 1)
+{
+    ModelObject *object = model.add_object();
+    object->name = name;
+    object->add_volume(std::move(mesh));
+    for (size_t i = 0; i < num_instances; ++ i)
+        object->add_instance();
+}
+
+// Slice the model and export it into path, either serially or through the pipeline.
+static std::string export_gcode(const Model &model, const DynamicPrintConfig &config, bool pipelined, const std::string &path)
+{
+    Print print;
+    print.apply(model, config);
+    std::string err = print.validate();
+    if (! err.empty())
+        throw std::runtime_error(err);
+    print.process();
+    GCode gcode;
+    gcode.set_pipelined_export(pipelined);
+    gcode.do_export(&print, path.c_str());
+
+    // Drop the header, which contains a timestamp.
+    std::ifstream     file(path);
+    std::stringstream out;
+    for (std::string line; std::getline(file, line);)
+        if (! boost::starts_with(line, "; generated by "))
+            out << line << '\n';
+    return out.str();
+}
+
+static bool test_export(const char *name, const std::function<void(Model&, DynamicPrintConfig&)> &setup)
+{
+    Model model;
+    std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+    setup(model, *config);
+    model.arrange_objects(PrintConfig::min_object_distance(config.get()));
+    model.center_instances_around_point(Vec2d(100., 100.));
+
+    boost::filesystem::path tmp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    std::string path_serial    = tmp.string() + "-serial.gcode";
+    std::string path_pipelined = tmp.string() + "-pipelined.gcode";
+    bool        ok             = false;
+    try {
+        std::string serial    = export_gcode(model, *config, false, path_serial);
+        std::string pipelined = export_gcode(model, *config, true,  path_pipelined);
+        ok = ! serial.empty() && serial == pipelined;
+        std::cout << name << ": " << (ok ? "OK" : "FAILED, the pipelined G-code differs from the serial one") << std::endl;
+    } catch (const std::exception &ex) {
+        std::cout << name << ": FAILED, " << ex.what() << std::endl;
+    }
+    boost::filesystem::remove(path_serial);
+    boost::filesystem::remove(path_pipelined);
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+
+    ok &= test_export("multiple objects", [](Model &model, DynamicPrintConfig &config) {
+        add_object(model, "cube",     make_cube(20., 20., 10.));
+        add_object(model, "cylinder", make_cylinder(8., 15.), 2);
+        add_object(model, "sphere",   make_sphere(10., 2. * PI / 60.));
+        config.set_deserialize("cooling", "1");
+        config.set_deserialize("fan_below_layer_time", "100");
+        config.set_deserialize("slowdown_below_layer_time", "30");
+        config.set_deserialize("gcode_comments", "1");
+        config.set_deserialize("support_material", "1");
+    });
+
+    ok &= test_export("complete objects", [](Model &model, DynamicPrintConfig &config) {
+        add_object(model, "cube",     make_cube(20., 20., 10.), 2);
+        add_object(model, "cylinder", make_cylinder(8., 15.));
+        config.set_deserialize("complete_objects", "1");
+        config.set_deserialize("cooling", "1");
+        config.set_deserialize("slowdown_below_layer_time", "30");
+    });
+
+    ok &= test_export("spiral vase", [](Model &model, DynamicPrintConfig &config) {
+        add_object(model, "cylinder", make_cylinder(15., 20.));
+        config.set_deserialize("spiral_vase", "1");
+        config.set_deserialize("perimeters", "1");
+        config.set_deserialize("top_solid_layers", "0");
+        config.set_deserialize("fill_density", "0");
+        config.set_deserialize("bottom_solid_layers", "3");
+    });
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+// Verifies the streaming mode of GCodeTimeEstimator (GCodeTimeEstimator::set_streaming()) against the estimate
+// calculated over the complete G-code, and the M73 lines filled in by GCodeTimeEstimator::patch_remaining_times().
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCodeTimeEstimator.hpp>
+
+using namespace Slic3r;
+
+// Synthetic G-code with long and short moves, travels with retractions, feed rate changes and a few st_synchronize() points.
+static std::vector<std::string> generate_gcode(size_t num_layers)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coordinates(20., 180.);
+    std::uniform_real_distribution<double> segments(0.05, 2.);
+    std::vector<std::string> lines;
+    char   line[128];
+    double x = 100.;
+    double y = 100.;
+    lines.emplace_back("M83");
+    for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        sprintf(line, "G1 Z%.3f F10800", 0.2 * (layer_id + 1));
+        lines.emplace_back(line);
+        if (layer_id % 10 == 5)
+            lines.emplace_back("M109 S215");
+        if (layer_id % 7 == 3)
+            lines.emplace_back("G4 P500");
+        for (size_t island = 0; island < 20; ++ island) {
+            lines.emplace_back("G1 E-0.8 F2100");
+            x = coordinates(rng);
+            y = coordinates(rng);
+            sprintf(line, "G1 X%.3f Y%.3f F7800", x, y);
+            lines.emplace_back(line);
+            lines.emplace_back("G1 E0.8 F2100");
+            lines.emplace_back((island % 2) ? "G1 F1800" : "G1 F3000");
+            // A curve made of short segments followed by a couple of long lines.
+            double angle = 0.;
+            for (size_t i = 0; i < 150; ++ i) {
+                double len = segments(rng);
+                angle += 0.1;
+                x = std::min(190., std::max(10., x + len * std::cos(angle)));
+                y = std::min(190., std::max(10., y + len * std::sin(angle)));
+                sprintf(line, "G1 X%.3f Y%.3f E%.5f", x, y, 0.04 * len);
+                lines.emplace_back(line);
+            }
+            for (size_t i = 0; i < 4; ++ i) {
+                double x2 = coordinates(rng);
+                double y2 = coordinates(rng);
+                sprintf(line, "G1 X%.3f Y%.3f E%.5f", x2, y2, 0.04 * std::sqrt((x2 - x) * (x2 - x) + (y2 - y) * (y2 - y)));
+                lines.emplace_back(line);
+                x = x2;
+                y = y2;
+            }
+        }
+    }
+    return lines;
+}
+
+static float estimate(const std::vector<std::string> &lines, size_t window_size)
+{
+    GCodeTimeEstimator estimator(GCodeTimeEstimator::Normal);
+    estimator.set_streaming(window_size, 0.f);
+    for (const std::string &line : lines)
+        estimator.add_gcode_line(line);
+    estimator.calculate_time(false);
+    return estimator.get_time();
+}
+
+static bool test_total_time(const std::vector<std::string> &lines)
+{
+    float reference = estimate(lines, 0);
+    bool  ok        = reference > 0.f;
+    for (size_t window_size : { size_t(16), size_t(128), GCodeTimeEstimator::Default_Streaming_Window_Size }) {
+        float time  = estimate(lines, window_size);
+        float error = std::abs(time - reference) / reference;
+        // The junction speeds are limited by a short look-ahead only, the planner window covers many of them.
+        if (error > ((window_size < 128) ? 0.01f : 0.001f)) {
+            std::cout << "Window " << window_size << ": " << time << " s, expected " << reference << " s" << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "streaming total time: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+// Parse the M73 lines into pairs of (percentage, remaining minutes), return the other lines.
+static std::vector<std::string> read_remaining_times(const std::string &path, std::vector<std::pair<int, int>> &markers, bool &ok)
+{
+    std::vector<std::string> gcode;
+    std::ifstream file(path);
+    for (std::string line; std::getline(file, line);)
+        if (boost::starts_with(line, "M73 ")) {
+            int percent, minutes;
+            if (sscanf(line.c_str(), "M73 P%d R%d", &percent, &minutes) == 2)
+                markers.emplace_back(percent, minutes);
+            else
+                ok = false;
+        } else
+            gcode.emplace_back(line);
+    return gcode;
+}
+
+static bool test_remaining_times(const std::vector<std::string> &lines)
+{
+    // Emulate GCode::_do_export(): Write the G-code with the M73 placeholders, then patch the placeholders.
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    GCodeTimeEstimator estimator(GCodeTimeEstimator::Normal);
+    estimator.set_streaming(GCodeTimeEstimator::Default_Streaming_Window_Size, 60.f);
+    {
+        std::string out = estimator.get_first_remaining_time_placeholder(0);
+        for (const std::string &line : lines) {
+            estimator.add_gcode_line(line);
+            out += line;
+            out += '\n';
+            if (estimator.remaining_time_placeholder_requested())
+                out += estimator.get_remaining_time_placeholder(out.size());
+        }
+        estimator.calculate_time(false);
+        if (estimator.remaining_time_placeholder_requested())
+            out += estimator.get_remaining_time_placeholder(out.size());
+        out += estimator.get_last_remaining_time_line();
+        std::ofstream file(path, std::ios::binary);
+        file << out;
+    }
+    estimator.patch_remaining_times(path);
+    float total = estimator.get_time();
+
+    bool ok = true;
+    std::vector<std::pair<int, int>> markers;
+    // The G-code itself has to stay untouched.
+    ok &= read_remaining_times(path, markers, ok) == lines;
+    boost::filesystem::remove(path);
+
+    // About one M73 line per minute of print plus the first and the last one.
+    int expected = int(total / 60.f) + 2;
+    ok &= std::abs(int(markers.size()) - expected) <= 2 + expected / 50;
+    ok &= ! markers.empty() && markers.front() == std::make_pair(0, int(std::round(total / 60.f))) && markers.back() == std::make_pair(100, 0);
+    if (! ok)
+        std::cout << "M73 lines: " << markers.size() << ", expected " << expected << std::endl;
+    for (size_t i = 1; ok && i < markers.size(); ++ i) {
+        const std::pair<int, int> &prev = markers[i - 1];
+        const std::pair<int, int> &curr = markers[i];
+        // Percentage and remaining time have to be monotonous and consistent with each other.
+        if (curr.first < prev.first || curr.second > prev.second ||
+            std::abs(float(curr.second) - total * (100.f - float(curr.first)) / 6000.f) > 1.f + total / 6000.f) {
+            std::cout << "Unexpected M73 P" << curr.first << " R" << curr.second << " after M73 P" << prev.first << " R" << prev.second << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "streaming remaining times: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    std::vector<std::string> lines = generate_gcode(100);
+    bool ok = test_total_time(lines);
+    ok &= test_remaining_times(lines);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+// Verifies the fast number formatting of GCodeWriter (gcode_format_fixed(), GCodeG1Formatter)
+// against the former std::ostringstream << std::fixed << std::setprecision() output.
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCodeWriter.hpp>
+#include <libslic3r/GCodeReader.hpp>
+
+using namespace Slic3r;
+
+static std::string format_fixed(double value, int digits)
+{
+    char buf[GCODE_FORMAT_FIXED_MAX_LEN + 1];
+    *gcode_format_fixed(buf, value, digits) = 0;
+    return buf;
+}
+
+// The former formatting with the trailing zeros removed.
+static std::string format_fixed_reference(double value, int digits)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(digits) << value;
+    std::string out = ss.str();
+    if (out.find('.') != std::string::npos) {
+        while (out.back() == '0')
+            out.pop_back();
+        if (out.back() == '.')
+            out.pop_back();
+    }
+    if (out == "-0")
+        out = "0";
+    return out;
+}
+
+static bool test_format_fixed()
+{
+    size_t num_failed = 0;
+    auto check = [&num_failed](double value, int digits) {
+        std::string out = format_fixed(value, digits);
+        std::string ref = format_fixed_reference(value, digits);
+        if (out != ref) {
+            // Values at the rounding boundary may be rounded either way.
+            double diff = std::abs(atof(out.c_str()) - atof(ref.c_str()));
+            if (diff > 1.0001 * std::pow(10., - digits) && ++ num_failed < 10)
+                std::cout << "gcode_format_fixed(" << std::setprecision(17) << value << ", " << digits << ") = " << out << ", expected " << ref << std::endl;
+        }
+    };
+
+    for (double value : { 0., -0., 1., -1., 10., 100., 0.1, 0.375, -0.0004, 0.0006, 1.5, 199.9999, 200.00049, 1234.5678, -1234.5678, 9999999. })
+        for (int digits : { 0, 1, 3, 5 })
+            if (format_fixed(value, digits) != format_fixed_reference(value, digits)) {
+                std::cout << "gcode_format_fixed(" << value << ", " << digits << ") = " << format_fixed(value, digits) <<
+                    ", expected " << format_fixed_reference(value, digits) << std::endl;
+                ++ num_failed;
+            }
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coordinates(-1000., 1000.);
+    std::uniform_real_distribution<double> extrusions(-10000., 100000.);
+    for (size_t i = 0; i < 1000000; ++ i) {
+        check(coordinates(rng), XYZF_EXPORT_DIGITS);
+        check(extrusions(rng), E_EXPORT_DIGITS);
+        // Values already rounded to the export precision, as produced by repeated moves along the same lines.
+        check(std::round(coordinates(rng) * 1000.) / 1000., XYZF_EXPORT_DIGITS);
+    }
+
+    std::cout << "gcode_format_fixed: " << (num_failed == 0 ? "OK" : "FAILED") << std::endl;
+    return num_failed == 0;
+}
+
+static bool test_writer()
+{
+    GCodeWriter writer;
+    writer.set_extruders({ 0 });
+    writer.set_extruder(0);
+
+    GCodeReader reader;
+    bool ok = true;
+    auto check = [&reader, &ok](const std::string &gcode, double x, double y, double e) {
+        reader.parse_line(gcode, [&ok, &gcode, x, y, e](GCodeReader &, const GCodeReader::GCodeLine &line) {
+            if (! line.cmd_is("G1") ||
+                std::abs(line.x() - x) > 0.0006 || std::abs(line.y() - y) > 0.0006 ||
+                std::abs(line.e() - e) > 0.00002) {
+                std::cout << "Unexpected G-code: " << gcode;
+                ok = false;
+            }
+        });
+    };
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coordinates(0., 250.);
+    for (size_t i = 0; i < 10000; ++ i) {
+        Vec2d  pt(coordinates(rng), coordinates(rng));
+        double e0 = writer.extruder()->E();
+        check(writer.extrude_to_xy(pt, 0.01), pt(0), pt(1), e0 + 0.01);
+    }
+
+    if (writer.travel_to_xy(Vec2d(10., 20.5)) != "G1 X10 Y20.5 F" + format_fixed(writer.config.travel_speed.value * 60., 3) + "\n" ||
+        writer.set_speed(1800.) != "G1 F1800\n" ||
+        writer.set_speed(1234.5678, "", ";_EXTRUDE_SET_SPEED") != "G1 F1234.568;_EXTRUDE_SET_SPEED\n" ||
+        writer.travel_to_z(0.25) != "G1 Z0.25 F" + format_fixed(writer.config.travel_speed.value * 60., 3) + "\n" ||
+        writer.travel_to_xyz(Vec3d(1.5, 2., 10.0004)) != "G1 X1.5 Y2 Z10 F" + format_fixed(writer.config.travel_speed.value * 60., 3) + "\n")
+        ok = false;
+
+    std::cout << "GCodeWriter: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_format_fixed();
+    ok &= test_writer();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+// Verifies that slicing an IndexedMesh produces exactly the same layers as slicing the TriangleMesh it was created from,
+// both with the sweep plane slicing enabled and disabled.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/IndexedMesh.hpp>
+
+using namespace Slic3r;
+
+// Overlapping solids with slanted, vertical and horizontal facets.
+static TriangleMesh test_mesh()
+{
+    TriangleMesh mesh = make_sphere(10., 2. * PI / 60.);
+    TriangleMesh cube = make_cube(12., 8., 25.);
+    cube.translate(-2., -4., -5.);
+    mesh.merge(cube);
+    TriangleMesh cylinder = make_cylinder(3., 30., 2. * PI / 40.);
+    cylinder.rotate_x(0.4f);
+    cylinder.translate(8., 8., -10.);
+    mesh.merge(cylinder);
+    mesh.repair();
+    mesh.require_shared_vertices();
+    return mesh;
+}
+
+static std::vector<ExPolygons> slice(const TriangleMesh &mesh, const IndexedMesh *indexed, const std::vector<float> &z, bool sweep)
+{
+    TriangleMeshSlicer slicer;
+    slicer.set_sweep(sweep);
+    if (indexed == nullptr)
+        slicer.init(&mesh, [](){});
+    else
+        slicer.init(indexed, [](){});
+    std::vector<ExPolygons> layers;
+    slicer.slice(z, 0.049f, &layers, [](){});
+    return layers;
+}
+
+static bool same_layers(const std::vector<ExPolygons> &l1, const std::vector<ExPolygons> &l2)
+{
+    if (l1.size() != l2.size())
+        return false;
+    for (size_t i = 0; i < l1.size(); ++ i) {
+        if (l1[i].size() != l2[i].size())
+            return false;
+        for (size_t j = 0; j < l1[i].size(); ++ j) {
+            const ExPolygon &e1 = l1[i][j];
+            const ExPolygon &e2 = l2[i][j];
+            if (e1.contour.points != e2.contour.points || e1.holes.size() != e2.holes.size())
+                return false;
+            for (size_t k = 0; k < e1.holes.size(); ++ k)
+                if (e1.holes[k].points != e2.holes[k].points)
+                    return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    TriangleMesh mesh = test_mesh();
+    IndexedMesh  indexed(mesh);
+
+    std::vector<float> z;
+    BoundingBoxf3 bb = mesh.bounding_box();
+    for (float zz = float(bb.min(2)) + 0.05f; zz < float(bb.max(2)); zz += 0.1f)
+        z.emplace_back(zz);
+    // A plane through the horizontal top of the cube.
+    z.emplace_back(20.f);
+    std::sort(z.begin(), z.end());
+
+    bool ok = true;
+    size_t num_expolygons = 0;
+    for (bool sweep : { false, true }) {
+        std::vector<ExPolygons> layers_mesh    = slice(mesh, nullptr,  z, sweep);
+        std::vector<ExPolygons> layers_indexed = slice(mesh, &indexed, z, sweep);
+        bool same = same_layers(layers_mesh, layers_indexed);
+        for (const ExPolygons &layer : layers_mesh)
+            num_expolygons += layer.size();
+        std::cout << "slicing " << (sweep ? "with" : "without") << " the sweep plane: " << (same ? "same layers" : "DIFFERENT LAYERS") << std::endl;
+        ok &= same;
+    }
+    // The mesh is not sliced into nothing.
+    ok &= num_expolygons >= 2 * z.size();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
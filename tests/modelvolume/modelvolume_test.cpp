@@ -0,0 +1,162 @@
+// Verifies that the meshes of ModelVolumes are shared by the copies of a Model and copied on write,
+// and the geometry derived from the volumes, which is cached by ModelObject.
+
+#include <iostream>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Geometry.hpp>
+
+#include <tbb/atomic.h>
+#include <tbb/parallel_for.h>
+
+using namespace Slic3r;
+
+static bool test_shared_copy()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->add_volume(make_cube(20., 20., 20.));
+    object->add_instance();
+
+    // The background processing keeps a copy of the Model, see Print::apply().
+    Model copy(model);
+    const ModelVolume &volume      = *model.objects.front()->volumes.front();
+    const ModelVolume &volume_copy = *copy.objects.front()->volumes.front();
+    bool ok = &volume.mesh() == &volume_copy.mesh() && &volume.get_convex_hull() == &volume_copy.get_convex_hull();
+
+    // Duplicating the object shares the mesh as well.
+    ModelObject *duplicate = model.add_object(*model.objects.front());
+    ok &= &duplicate->volumes.front()->mesh() == &volume.mesh();
+
+    std::cout << "shared copy: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_copy_on_write()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    ModelVolume *volume = object->add_volume(make_cube(20., 20., 20.));
+    object->add_instance();
+    Model copy(model);
+    const ModelVolume &volume_copy = *copy.objects.front()->volumes.front();
+
+    // Modifying the geometry of a shared mesh makes a private copy of the mesh and of the convex hull.
+    const TriangleMesh *mesh_before = &volume->mesh();
+    volume->scale_geometry(Vec3d(2., 2., 2.));
+    bool ok = &volume->mesh() != &volume_copy.mesh() && &volume->get_convex_hull() != &volume_copy.get_convex_hull() &&
+              &volume_copy.mesh() == mesh_before;
+    ok &= volume->mesh().bounding_box().size().isApprox(Vec3d(40., 40., 40.)) &&
+          volume->get_convex_hull().bounding_box().size().isApprox(Vec3d(40., 40., 40.)) &&
+          volume_copy.mesh().bounding_box().size().isApprox(Vec3d(20., 20., 20.)) &&
+          volume_copy.get_convex_hull().bounding_box().size().isApprox(Vec3d(20., 20., 20.));
+
+    // Once the mesh is not shared anymore, it is modified in place.
+    const TriangleMesh *mesh_unique = &volume->mesh();
+    volume->scale_geometry(Vec3d(0.5, 0.5, 0.5));
+    ok &= &volume->mesh() == mesh_unique && volume->mesh().bounding_box().size().isApprox(Vec3d(20., 20., 20.));
+
+    std::cout << "copy on write: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+// The 2D convex hull of the transformed raw mesh, calculated the hard way.
+static Polygon convex_hull_2d_reference(const ModelObject &object, const Transform3d &trafo)
+{
+    TriangleMesh mesh = *object.raw_mesh();
+    mesh.transform(trafo);
+    return mesh.convex_hull();
+}
+
+static bool test_geometry_cache()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->add_volume(make_cube(20., 20., 20.));
+    ModelVolume *cylinder = object->add_volume(make_cylinder(5., 30.));
+    cylinder->set_offset(Vec3d(20., 0., 0.));
+    ModelVolume *modifier = object->add_volume(make_cube(50., 50., 50.));
+    modifier->set_type(ModelVolumeType::PARAMETER_MODIFIER);
+    object->add_instance();
+
+    // Repeated queries return the cached geometry, the copies of the Model share it.
+    std::shared_ptr<const TriangleMesh> raw_mesh = object->raw_mesh();
+    std::shared_ptr<const TriangleMesh> raw_hull = object->raw_convex_hull();
+    bool ok = object->raw_mesh() == raw_mesh && object->raw_convex_hull() == raw_hull &&
+              raw_mesh->bounding_box().min.isApprox(object->raw_mesh_bounding_box().min) &&
+              raw_mesh->bounding_box().max.isApprox(object->raw_mesh_bounding_box().max) &&
+              raw_hull->bounding_box().size().isApprox(raw_mesh->bounding_box().size(), 1e-5);
+    Model copy(model);
+    ok &= copy.objects.front()->raw_mesh() == raw_mesh;
+
+    auto check_convex_hull_2d = [&ok, object](const Transform3d &trafo) {
+        Polygon hull      = object->convex_hull_2d(trafo);
+        Polygon reference = convex_hull_2d_reference(*object, trafo);
+        ok &= std::abs(hull.area() - reference.area()) < 1e-4 * reference.area() && hull.bounding_box().size().cast<double>().isApprox(reference.bounding_box().size().cast<double>(), 1e-4);
+    };
+    check_convex_hull_2d(Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0.5, 0.3, 0.), Vec3d(1.5, 1.5, 1.5)));
+    check_convex_hull_2d(Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0., 0., 0.), Vec3d(1., 1., 1.), Vec3d(-1., 1., 1.)));
+
+    // Moving an instance keeps the cache, moving a volume or modifying a mesh drops it.
+    object->instances.front()->set_offset(Vec3d(100., 100., 0.));
+    object->invalidate_bounding_box();
+    ok &= object->raw_mesh() == raw_mesh;
+    cylinder->set_offset(Vec3d(40., 0., 0.));
+    ok &= std::abs(object->raw_mesh()->bounding_box().size().x() - 45.) < 1e-5;
+    // The mesh returned before the change stays valid.
+    ok &= std::abs(raw_mesh->bounding_box().size().x() - 25.) < 1e-5;
+    check_convex_hull_2d(Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0.5, 0.3, 0.), Vec3d(1.5, 1.5, 1.5)));
+    cylinder->scale_geometry(Vec3d(2., 2., 2.));
+    ok &= std::abs(object->raw_mesh()->bounding_box().size().z() - 60.) < 1e-5 &&
+          std::abs(object->raw_convex_hull()->bounding_box().size().z() - 60.) < 1e-5;
+    check_convex_hull_2d(Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0.5, 0.3, 0.), Vec3d(1.5, 1.5, 1.5)));
+    // The copy of the Model still sees the former geometry.
+    ok &= copy.objects.front()->raw_mesh() == raw_mesh;
+
+    std::cout << "geometry cache: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+// The UI thread validates the Print while the background thread reads the raw mesh of the same object.
+static bool test_geometry_cache_concurrent()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->add_volume(make_cube(20., 20., 20.));
+    ModelVolume *cylinder = object->add_volume(make_cylinder(5., 30.));
+    cylinder->set_offset(Vec3d(20., 0., 0.));
+    object->add_instance();
+
+    const Transform3d trafo     = Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0.5, 0.3, 0.), Vec3d(1.5, 1.5, 1.5));
+    const double      area      = convex_hull_2d_reference(*object, trafo).area();
+    const Vec3d       mesh_size = object->raw_mesh()->bounding_box().size();
+    bool              ok        = true;
+    for (int round = 0; round < 10; ++ round) {
+        object->invalidate_geometry_cache();
+        tbb::atomic<int> failed;
+        failed = 0;
+        tbb::parallel_for(0, 64, [&](int i) {
+            bool same = (i & 1) ?
+                std::abs(object->convex_hull_2d(trafo).area() - area) < 1e-4 * area :
+                object->raw_mesh()->bounding_box().size().isApprox(mesh_size);
+            if (! same)
+                ++ failed;
+        });
+        ok &= failed == 0;
+    }
+
+    std::cout << "concurrent geometry cache: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_shared_copy();
+    ok &= test_copy_on_write();
+    ok &= test_geometry_cache();
+    ok &= test_geometry_cache_concurrent();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,222 @@
+// Verifies the run-length encoded rasterizer backend against the AGG backend, which it has to replicate pixel by pixel,
+// and the PNG files produced by both backends, filtered and compressed in bands of rows.
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Rasterizer/Rasterizer.hpp>
+#include <libnest2d/backends/clipper/clipper_polygon.hpp>
+
+#include <miniz/miniz.h>
+
+#include "random_islands.hpp"
+
+using namespace Slic3r;
+
+// Star shaped islands with star shaped holes scattered over an area of w x h mm, reaching over its borders.
+static ExPolygons random_islands(std::mt19937 &rng, size_t n, double w, double h, size_t num_vertices)
+{
+    ExPolygons out = test::random_star_islands(rng, n, -5., -5., w + 5., h + 5., 0.02, 6., num_vertices);
+    std::uniform_real_distribution<double> position_x(-5., w + 5.);
+    std::uniform_real_distribution<double> position_y(-5., h + 5.);
+    std::uniform_real_distribution<double> radius(0.02, 6.);
+    // Axis aligned rectangles exercise the vertical and horizontal edges.
+    for (size_t i = 0; i < n / 4; ++ i) {
+        double x = position_x(rng);
+        double y = position_y(rng);
+        double r = radius(rng);
+        ExPolygon expoly;
+        expoly.contour.points = { Point::new_scale(x, y), Point::new_scale(x + r, y), Point::new_scale(x + r, y + 0.5 * r), Point::new_scale(x, y + 0.5 * r) };
+        out.emplace_back(std::move(expoly));
+    }
+    return out;
+}
+
+static ClipperLib::Polygon to_clipper(const ExPolygon &expoly)
+{
+    ClipperLib::Polygon out;
+    for (const Point &pt : expoly.contour.points)
+        out.Contour.emplace_back(pt(0), pt(1));
+    for (const Polygon &hole : expoly.holes) {
+        out.Holes.emplace_back();
+        for (const Point &pt : hole.points)
+            out.Holes.back().emplace_back(pt(0), pt(1));
+    }
+    return out;
+}
+
+static std::vector<std::uint8_t> pixels(Raster &raster)
+{
+    RawBytes raw = raster.save(Raster::Compression::RAW);
+    // Skip the "P5 w h 255 " header.
+    size_t header = raw.size() - raster.resolution().pixels();
+    return std::vector<std::uint8_t>(raw.data() + header, raw.data() + raw.size());
+}
+
+static std::uint32_t read_u32_be(const std::uint8_t *p)
+{
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | std::uint32_t(p[3]);
+}
+
+// Decode an 8 bit grayscale PNG with the NONE, SUB or UP filtered rows, checking the CRCs of the chunks and the Adler-32
+// of the image data.
+static bool decode_png(const RawBytes &png, unsigned width, unsigned height, std::vector<std::uint8_t> &out)
+{
+    static const std::uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (png.size() < 8 || memcmp(png.data(), signature, 8) != 0)
+        return false;
+    std::vector<std::uint8_t> idat;
+    bool ok = false;
+    for (size_t pos = 8; pos + 12 <= png.size();) {
+        std::uint32_t      len  = read_u32_be(png.data() + pos);
+        const std::uint8_t *type = png.data() + pos + 4;
+        if (pos + 12 + len > png.size() || read_u32_be(type + 4 + len) != mz_crc32(MZ_CRC32_INIT, type, len + 4))
+            return false;
+        if (memcmp(type, "IHDR", 4) == 0)
+            ok = len == 13 && read_u32_be(type + 4) == width && read_u32_be(type + 8) == height &&
+                 type[12] == 8 && type[13] == 0 && type[14] == 0 && type[15] == 0 && type[16] == 0;
+        else if (memcmp(type, "IDAT", 4) == 0)
+            idat.insert(idat.end(), type + 4, type + 4 + len);
+        else if (memcmp(type, "IEND", 4) == 0)
+            break;
+        pos += 12 + len;
+    }
+    size_t len = 0;
+    void  *data = tinfl_decompress_mem_to_heap(idat.data(), idat.size(), &len, TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32);
+    if (! ok || data == nullptr)
+        return false;
+    out.clear();
+    if (len == size_t(width + 1) * height) {
+        const std::uint8_t *row = static_cast<const std::uint8_t*>(data);
+        for (unsigned y = 0; y < height; ++ y, row += width + 1) {
+            ok &= row[0] <= 2;
+            for (unsigned x = 0; x < width; ++ x) {
+                std::uint8_t v = row[x + 1];
+                if (row[0] == 1 && x > 0)
+                    v += out[out.size() - 1];
+                else if (row[0] == 2 && y > 0)
+                    v += out[out.size() - width];
+                out.push_back(v);
+            }
+        }
+    } else
+        ok = false;
+    mz_free(data);
+    return ok;
+}
+
+static bool test_same_pixels()
+{
+    std::mt19937 rng(0);
+    bool ok = true;
+    const Raster::Resolution res(240, 427);
+    const Raster::PixelDim   pxdim(0.047, 0.047);
+    const double             w = res.width_px * pxdim.w_mm;
+    const double             h = res.height_px * pxdim.h_mm;
+    for (double gamma : { 1., 2.2, 0. })
+        for (Raster::Origin origin : { Raster::Origin::TOP_LEFT, Raster::Origin::BOTTOM_LEFT })
+            for (size_t num_islands : { 1, 10, 100 }) {
+                // Many overlapping islands to test the blending of the anti-aliased edges.
+                ExPolygons islands = random_islands(rng, num_islands, w, h, 5 + num_islands % 7);
+                Raster agg(res, pxdim, origin, gamma, Raster::Backend::AGG);
+                Raster rle(res, pxdim, origin, gamma, Raster::Backend::RLE);
+                ok &= rle.backend() == Raster::Backend::RLE;
+                for (size_t i = 0; i < islands.size(); ++ i)
+                    if (i % 2 == 0) {
+                        agg.draw(islands[i]);
+                        rle.draw(islands[i]);
+                    } else {
+                        ClipperLib::Polygon poly = to_clipper(islands[i]);
+                        agg.draw(poly);
+                        rle.draw(poly);
+                    }
+                std::vector<std::uint8_t> agg_pixels = pixels(agg);
+                std::vector<std::uint8_t> rle_pixels = pixels(rle);
+                ok &= agg_pixels == rle_pixels;
+                std::vector<std::uint8_t> png_pixels;
+                ok &= decode_png(rle.save(Raster::Compression::PNG), res.width_px, res.height_px, png_pixels) && png_pixels == agg_pixels;
+                // Reset keeps the backend and clears the raster.
+                rle.reset(res, pxdim, gamma);
+                ok &= rle.backend() == Raster::Backend::RLE && pixels(rle) == std::vector<std::uint8_t>(res.pixels(), 0);
+            }
+    std::cout << "same pixels as AGG: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_png()
+{
+    bool ok = true;
+    const Raster::PixelDim pxdim(0.047, 0.047);
+    // An empty raster, a fully covered raster (long runs crossing the rows) and a raster with a single pixel.
+    for (unsigned size : { 1, 64, 1000 }) {
+        const Raster::Resolution res(size, size + 7);
+        const double w = res.width_px * pxdim.w_mm;
+        const double h = res.height_px * pxdim.h_mm;
+        ExPolygon    full;
+        full.contour.points = { Point::new_scale(-1., -1.), Point::new_scale(w + 1., -1.), Point::new_scale(w + 1., h + 1.), Point::new_scale(-1., h + 1.) };
+        ExPolygon    dot;
+        dot.contour.points = { Point::new_scale(0., 0.), Point::new_scale(pxdim.w_mm, 0.), Point::new_scale(0., pxdim.h_mm) };
+        for (int fill = 0; fill < 3; ++ fill) {
+            Raster agg(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::AGG);
+            Raster rle(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::RLE);
+            if (fill > 0) {
+                agg.draw(fill == 1 ? full : dot);
+                rle.draw(fill == 1 ? full : dot);
+            }
+            std::vector<std::uint8_t> png_pixels;
+            ok &= decode_png(rle.save(Raster::Compression::PNG), res.width_px, res.height_px, png_pixels) && png_pixels == pixels(agg);
+        }
+    }
+    std::cout << "png: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_png_bands()
+{
+    std::mt19937 rng(1);
+    bool ok = true;
+    // Large enough to be compressed in several bands by both backends.
+    const Raster::Resolution res(2000, 1301);
+    const Raster::PixelDim   pxdim(0.047, 0.047);
+    ExPolygons islands = random_islands(rng, 200, res.width_px * pxdim.w_mm, res.height_px * pxdim.h_mm, 9);
+    Raster agg(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::AGG);
+    Raster rle(res, pxdim, Raster::Origin::TOP_LEFT, 1., Raster::Backend::RLE);
+    for (const ExPolygon &expoly : islands) {
+        agg.draw(expoly);
+        rle.draw(expoly);
+    }
+    std::vector<std::uint8_t> agg_pixels = pixels(agg);
+    for (PNGFilter filter : { PNGFilter::NONE, PNGFilter::SUB, PNGFilter::UP })
+        for (int level : { 0, 1, 6 })
+            for (Raster *raster : { &agg, &rle }) {
+                std::vector<std::uint8_t> png_pixels;
+                ok &= decode_png(raster->save(Raster::Compression::PNG, Raster::PNGOptions(level, filter)), res.width_px, res.height_px, png_pixels) &&
+                      png_pixels == agg_pixels;
+            }
+
+    // The Adler-32 of the whole data has to be combined from the Adler-32 of its parts.
+    std::vector<std::uint8_t> data(200000);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (std::uint8_t &b : data)
+        b = std::uint8_t(byte(rng) < 128 ? 255 : byte(rng));
+    for (size_t split : { size_t(0), size_t(1), size_t(65521), size_t(100000), data.size() }) {
+        std::uint32_t adler1 = std::uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data(), split));
+        std::uint32_t adler2 = std::uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data() + split, data.size() - split));
+        ok &= adler32_combine(adler1, adler2, data.size() - split) == std::uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data(), data.size()));
+    }
+    std::cout << "png bands and filters: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_same_pixels();
+    ok &= test_png();
+    ok &= test_png_bands();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
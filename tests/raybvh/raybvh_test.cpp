@@ -0,0 +1,148 @@
+// Verifies the ray casting of sla::RayBVH against a brute force igl::ray_mesh_intersect() over all the triangles, and the
+// packets of rays against the rays cast one by one, which they have to replicate exactly.
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/SLARayBVH.hpp>
+
+#include <igl/ray_mesh_intersect.h>
+
+using namespace Slic3r;
+using sla::RayBVH;
+
+// Overlapping solids, so that some of the rays start inside the mesh, and a plate meshed twice, so that its triangles coincide.
+static void test_mesh(Eigen::MatrixXd &V, Eigen::MatrixXi &F)
+{
+    TriangleMesh mesh = make_sphere(10., 2. * PI / 60.);
+    TriangleMesh cube = make_cube(12., 8., 25.);
+    cube.translate(-2., -4., -5.);
+    mesh.merge(cube);
+    TriangleMesh cylinder = make_cylinder(3., 30., 2. * PI / 40.);
+    cylinder.translate(8., 8., -10.);
+    mesh.merge(cylinder);
+    TriangleMesh plate = make_cube(20., 20., 1.);
+    plate.translate(-30., -30., -20.);
+    mesh.merge(plate);
+    mesh.merge(plate);
+
+    const stl_file &stl = mesh.stl;
+    V.resize(3 * stl.stats.number_of_facets, 3);
+    F.resize(stl.stats.number_of_facets, 3);
+    for (int i = 0; i < int(stl.stats.number_of_facets); ++ i)
+        for (int j = 0; j < 3; ++ j) {
+            V.row(3 * i + j) = stl.facet_start[i].vertex[j].cast<double>();
+            F(i, j) = 3 * i + j;
+        }
+}
+
+// Bundles of 8 rays aimed at the mesh: parallel rays around a common axis, rays fanning out of a common source, axis
+// aligned rays (some of them starting on the faces of the cube) and random rays.
+static void test_rays(std::mt19937 &rng, std::vector<Vec3d> &sources, std::vector<Vec3d> &dirs)
+{
+    std::uniform_real_distribution<double> pos(-35., 35.);
+    std::uniform_real_distribution<double> target(-10., 10.);
+    auto random_source = [&]() { return Vec3d(pos(rng), pos(rng), pos(rng)); };
+    auto random_dir    = [&](const Vec3d &source) { return (Vec3d(target(rng), target(rng), target(rng)) - source).normalized(); };
+    for (int bundle = 0; bundle < 500; ++ bundle) {
+        Vec3d s = random_source();
+        Vec3d d = random_dir(s);
+        Vec3d a = d.cross(std::abs(d(0)) < 0.9 ? Vec3d(1., 0., 0.) : Vec3d(0., 1., 0.)).normalized();
+        Vec3d b = d.cross(a);
+        for (int i = 0; i < 8; ++ i) {
+            double phi = 2. * PI * i / 8.;
+            switch (bundle % 4) {
+            case 0:
+                sources.emplace_back(s + cos(phi) * a + sin(phi) * b);
+                dirs.emplace_back(d);
+                break;
+            case 1:
+                sources.emplace_back(s);
+                dirs.emplace_back((d + 0.3 * (cos(phi) * a + sin(phi) * b)).normalized());
+                break;
+            case 2: {
+                Vec3d axis = Vec3d::Zero();
+                axis(i % 3) = (i % 2) ? 1. : -1.;
+                Vec3d p = s;
+                if (i % 4 == 0)
+                    // On the face x = -2 of the cube.
+                    p(0) = -2.;
+                sources.emplace_back(p);
+                dirs.emplace_back(axis);
+                break;
+            }
+            default:
+                sources.emplace_back(random_source());
+                dirs.emplace_back(random_dir(sources.back()));
+            }
+        }
+    }
+}
+
+static bool test_against_igl()
+{
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    test_mesh(V, F);
+    RayBVH bvh(V, F);
+
+    std::mt19937       rng(0);
+    std::vector<Vec3d> sources, dirs;
+    test_rays(rng, sources, dirs);
+
+    std::vector<RayBVH::Hit> packets(sources.size());
+    bvh.intersect(sources.data(), dirs.data(), sources.size(), packets.data());
+
+    bool   ok      = true;
+    size_t num_hit = 0;
+    for (size_t i = 0; i < sources.size(); ++ i) {
+        RayBVH::Hit hit = bvh.intersect(sources[i], dirs[i]);
+        ok &= hit.t == packets[i].t && hit.face == packets[i].face;
+
+        // The closest of all the hits, in double precision.
+        std::vector<igl::Hit> hits;
+        Eigen::RowVector3d s = sources[i], d = dirs[i];
+        igl::ray_mesh_intersect(s, d, V, F, hits);
+        if (hits.empty()) {
+            ok &= hit.face == -1 && std::isinf(hit.t);
+            continue;
+        }
+        ++ num_hit;
+        // The hits are sorted by their t in single precision, the faces sharing an edge hit by the ray tie.
+        double tmin = std::numeric_limits<double>::infinity();
+        for (const igl::Hit &h : hits)
+            if (std::abs(double(h.t) - double(hits.front().t)) < 1e-5) {
+                Eigen::RowVector3d v0 = V.row(F(h.id, 0)), v1 = V.row(F(h.id, 1)), v2 = V.row(F(h.id, 2));
+                double t, u, v;
+                intersect_triangle1(s.data(), d.data(), v0.data(), v1.data(), v2.data(), &t, &u, &v);
+                tmin = std::min(tmin, t);
+            }
+        ok &= hit.face >= 0 && hit.t == tmin;
+    }
+    // Most of the rays have to hit something for the test to be meaningful.
+    ok &= num_hit > sources.size() / 2;
+
+    std::cout << "against igl: " << num_hit << " of " << sources.size() << " rays hit, " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_empty()
+{
+    RayBVH      bvh(Eigen::MatrixXd(0, 3), Eigen::MatrixXi(0, 3));
+    RayBVH::Hit hit = bvh.intersect(Vec3d(0., 0., 0.), Vec3d(0., 0., 1.));
+    bool        ok  = bvh.empty() && hit.face == -1 && std::isinf(hit.t);
+    std::cout << "empty mesh: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_against_igl();
+    ok &= test_empty();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,206 @@
+// Verifies the greedy chaining accelerated by a grid (ShortestPath.hpp) against the former linear scans,
+// which it has to replicate including the resolution of ties, and the 2-opt improvement of the chains.
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Geometry.hpp>
+#include <libslic3r/ExtrusionEntityCollection.hpp>
+#include <libslic3r/PolylineCollection.hpp>
+#include <libslic3r/ShortestPath.hpp>
+
+using namespace Slic3r;
+
+// The former Geometry::chained_path().
+static std::vector<size_t> reference_chain_points(const Points &points, Point start_near)
+{
+    Points              remaining = points;
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < points.size(); ++ i)
+        indices.emplace_back(i);
+    std::vector<size_t> out;
+    while (! remaining.empty()) {
+        int idx = start_near.nearest_point_index(remaining);
+        start_near = remaining[idx];
+        out.emplace_back(indices[idx]);
+        remaining.erase(remaining.begin() + idx);
+        indices.erase(indices.begin() + idx);
+    }
+    return out;
+}
+
+// The former PolylineCollection::_chained_path_from(), picking the first of the end points at the same distance.
+static Polylines reference_chain_polylines(Polylines src, Point start_near, bool no_reverse)
+{
+    Polylines out;
+    while (! src.empty()) {
+        size_t best    = 0;
+        double best_d2 = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < src.size() * 2; ++ i) {
+            if (no_reverse && (i & 1))
+                continue;
+            const Point &pt = (i & 1) ? src[i / 2].last_point() : src[i / 2].first_point();
+            double d2 = sqr(double(start_near.x() - pt.x())) + sqr(double(start_near.y() - pt.y()));
+            if (d2 < best_d2) {
+                best    = i;
+                best_d2 = d2;
+            }
+        }
+        out.emplace_back(std::move(src[best / 2]));
+        src.erase(src.begin() + best / 2);
+        if (best & 1)
+            out.back().reverse();
+        start_near = out.back().last_point();
+    }
+    return out;
+}
+
+// Random points on a coarse lattice, so that there are many duplicate points and many points at the same distance.
+static Points random_points(std::mt19937 &rng, size_t n, coord_t range, coord_t step)
+{
+    std::uniform_int_distribution<coord_t> dist(0, range);
+    Points out;
+    for (size_t i = 0; i < n; ++ i)
+        out.emplace_back(dist(rng) * step, dist(rng) * step);
+    return out;
+}
+
+static Polylines random_polylines(std::mt19937 &rng, size_t n, coord_t range, coord_t step)
+{
+    Points    points = random_points(rng, n * 2, range, step);
+    Polylines out;
+    for (size_t i = 0; i < n; ++ i)
+        out.emplace_back(Polyline(points[2 * i], points[2 * i + 1]));
+    return out;
+}
+
+static bool test_chain_points()
+{
+    std::mt19937 rng(0);
+    bool ok = true;
+    for (size_t n : { 0, 1, 2, 17, 300, 3000 })
+        for (coord_t range : { 3, 40, 100000 }) {
+            Points points = random_points(rng, n, range, 1000);
+            std::vector<size_t> reference = reference_chain_points(points, Point(-5000, 70000));
+            ok &= chain_points(points, Point(-5000, 70000)) == reference;
+            std::vector<size_t> indices;
+            Geometry::chained_path(points, indices);
+            ok &= indices == reference_chain_points(points, points.empty() ? Point() : points.front());
+        }
+    std::cout << "chain points: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_chain_polylines()
+{
+    std::mt19937 rng(1);
+    bool ok = true;
+    for (size_t n : { 1, 2, 17, 300, 3000 })
+        for (coord_t range : { 3, 40, 100000 })
+            for (bool no_reverse : { false, true }) {
+                Polylines polylines = random_polylines(rng, n, range, 1000);
+                Polylines reference = reference_chain_polylines(polylines, Point(3000, -2000), no_reverse);
+                Polylines chained   = PolylineCollection::chained_path_from(polylines, Point(3000, -2000), no_reverse);
+                ok &= chained.size() == reference.size();
+                for (size_t i = 0; ok && i < chained.size(); ++ i)
+                    ok &= chained[i].points == reference[i].points;
+                // The rvalue overload moves the polylines.
+                Polylines moved = PolylineCollection::chained_path_from(std::move(polylines), Point(3000, -2000), no_reverse);
+                for (size_t i = 0; ok && i < moved.size(); ++ i)
+                    ok &= moved[i].points == reference[i].points;
+            }
+    std::cout << "chain polylines: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_chain_extrusions()
+{
+    std::mt19937 rng(2);
+    bool ok = true;
+    for (size_t n : { 1, 17, 300, 3000 }) {
+        Polylines polylines = random_polylines(rng, n, 40, 1000);
+        ExtrusionEntityCollection collection;
+        std::vector<bool> can_reverse;
+        for (size_t i = 0; i < polylines.size(); ++ i) {
+            if (i % 5 == 3) {
+                // A loop is never reversed.
+                ExtrusionPath path(erPerimeter, 0.1, 0.4f, 0.2f);
+                path.polyline = Polygon({ polylines[i].first_point(), polylines[i].last_point(), polylines[i].last_point() + Point(500, 700) }).split_at_first_point();
+                collection.append(ExtrusionLoop(path));
+                can_reverse.push_back(false);
+            } else {
+                ExtrusionPath path(erInternalInfill, 0.1, 0.4f, 0.2f);
+                path.polyline = polylines[i];
+                collection.append(path);
+                can_reverse.push_back(true);
+            }
+        }
+        // The former ExtrusionEntityCollection::chained_path_from(): Point::nearest_point_index() over both end points,
+        // the first point being stored twice for the entities not to be reversed.
+        Points endpoints;
+        for (const ExtrusionEntity *entity : collection.entities) {
+            endpoints.push_back(entity->first_point());
+            endpoints.push_back(entity->can_reverse() ? entity->last_point() : entity->first_point());
+        }
+        std::vector<size_t> remaining;
+        for (size_t i = 0; i < collection.entities.size(); ++ i)
+            remaining.push_back(i);
+        std::vector<size_t> reference;
+        Point start_near(0, 0);
+        while (! remaining.empty()) {
+            int start_index = start_near.nearest_point_index(endpoints);
+            size_t idx = remaining[start_index / 2];
+            reference.push_back(idx);
+            bool reverse = (start_index % 2) && can_reverse[idx];
+            start_near = reverse ? collection.entities[idx]->first_point() : collection.entities[idx]->last_point();
+            remaining.erase(remaining.begin() + start_index / 2);
+            endpoints.erase(endpoints.begin() + start_index / 2 * 2, endpoints.begin() + start_index / 2 * 2 + 2);
+        }
+        ExtrusionEntityCollection chained;
+        std::vector<size_t>       orig_indices;
+        collection.chained_path_from(Point(0, 0), &chained, false, erMixed, &orig_indices);
+        ok &= orig_indices == reference && chained.entities.size() == reference.size();
+        for (size_t i = 0; ok && i < chained.entities.size(); ++ i)
+            if (chained.entities[i]->is_loop())
+                ok &= chained.entities[i]->first_point() == collection.entities[orig_indices[i]]->first_point();
+    }
+    std::cout << "chain extrusions: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_two_opt()
+{
+    std::mt19937 rng(3);
+    Polylines polylines = random_polylines(rng, 5000, 100000, 1000);
+    Points endpoints;
+    for (const Polyline &polyline : polylines) {
+        endpoints.emplace_back(polyline.first_point());
+        endpoints.emplace_back(polyline.last_point());
+    }
+    std::vector<std::pair<size_t, bool>> chain    = chain_segments(endpoints, Point(0, 0), false);
+    double                               greedy   = chain_travel_length(endpoints, Point(0, 0), chain);
+    improve_chain_by_two_opt(endpoints, Point(0, 0), chain, 10.);
+    double                               improved = chain_travel_length(endpoints, Point(0, 0), chain);
+    // Each segment is still visited exactly once.
+    std::vector<bool> visited(polylines.size(), false);
+    bool ok = chain.size() == polylines.size();
+    for (const std::pair<size_t, bool> &segment : chain) {
+        ok &= ! visited[segment.first];
+        visited[segment.first] = true;
+    }
+    ok &= improved < greedy;
+    std::cout << "2-opt: travel " << greedy * SCALING_FACTOR << " mm -> " << improved * SCALING_FACTOR << " mm: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_chain_points();
+    ok &= test_chain_polylines();
+    ok &= test_chain_extrusions();
+    ok &= test_two_opt();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
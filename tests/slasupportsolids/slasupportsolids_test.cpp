@@ -0,0 +1,189 @@
+// Verifies the sections of the SLA support solids computed in closed form against the slices of their meshes: the convex
+// hulls of the points sampled densely on the spheres and disks the solids are made of.
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/SLASupportSolids.hpp>
+
+using namespace Slic3r;
+using sla::SupportSolid;
+
+static TriangleMesh solid_mesh(const SupportSolid &solid)
+{
+    const int          steps = 240;
+    std::vector<float> points;
+    auto add = [&points](const Vec3d &p) { points.insert(points.end(), { float(p(0)), float(p(1)), float(p(2)) }); };
+    if (solid.shape == SupportSolid::SPHERES) {
+        // The points beyond the cutting planes are moved onto the circles cut from the spheres.
+        auto add_cut = [&solid, &add](const Vec3d &center, double r, double lon, double z) {
+            double zcut = std::min(std::max(z, solid.zcut_bottom - center(2)), solid.zcut_top - center(2));
+            double rho  = std::sqrt(std::max(0., r * r - zcut * zcut));
+            add(center + Vec3d(rho * cos(lon), rho * sin(lon), zcut));
+        };
+        for (int i = 0; i <= steps / 4; ++ i) {
+            double lat = PI * i / (steps / 4);
+            for (int j = 0; j < steps / 2; ++ j) {
+                double lon = 4 * PI * j / steps;
+                add_cut(solid.p1, solid.r1, lon, solid.r1 * cos(lat));
+                add_cut(solid.p2, solid.r2, lon, solid.r2 * cos(lat));
+            }
+        }
+    } else {
+        Vec3d d = (solid.p2 - solid.p1).normalized();
+        Vec3d u = d.cross(std::abs(d(0)) < 0.9 ? Vec3d(1., 0., 0.) : Vec3d(0., 1., 0.)).normalized();
+        Vec3d v = d.cross(u);
+        for (int j = 0; j < steps; ++ j) {
+            double a = 2 * PI * j / steps;
+            add(solid.p1 + solid.r1 * (cos(a) * u + sin(a) * v));
+            add(solid.p2 + solid.r2 * (cos(a) * u + sin(a) * v));
+        }
+    }
+    TriangleMesh mesh = convex_hull_3d_from_points(points);
+    mesh.require_shared_vertices();
+    return mesh;
+}
+
+static double area_mm2(const ExPolygons &expolys)
+{
+    double area = 0.;
+    for (const ExPolygon &expoly : expolys)
+        area += expoly.area();
+    return area * SCALING_FACTOR * SCALING_FACTOR;
+}
+
+// Area of the symmetric difference of two slices in mm^2.
+static double xor_area(const ExPolygons &a, const ExPolygons &b)
+{
+    return area_mm2(diff_ex(to_polygons(a), to_polygons(b))) + area_mm2(diff_ex(to_polygons(b), to_polygons(a)));
+}
+
+static std::vector<SupportSolid> test_solids()
+{
+    std::vector<SupportSolid> solids;
+    // Junction
+    solids.emplace_back(SupportSolid::sphere(Vec3d(1., 2., 3.), 0.8, 360));
+    // Heads pointing in various directions
+    solids.emplace_back(SupportSolid::SPHERES, Vec3d(0., 0., 5.), Vec3d(0.3, -0.2, 3.2), 0.2, 0.5, 360);
+    solids.emplace_back(SupportSolid::SPHERES, Vec3d(0., 0., 5.), Vec3d(1.5, 0.4, 5.1), 0.4, 0.6, 360);
+    // Capsule
+    solids.emplace_back(SupportSolid::SPHERES, Vec3d(-1., 0., 2.), Vec3d(2., 1., 6.), 0.3, 0.3, 360);
+    // Ends of a compact bridge, half spheres cut horizontally
+    solids.emplace_back(SupportSolid::cut_sphere(Vec3d(-1., 0., 2.), 0.3, 1.95, std::numeric_limits<double>::infinity(), 360));
+    solids.emplace_back(SupportSolid::cut_sphere(Vec3d(2., 1., 6.), 0.3, - std::numeric_limits<double>::infinity(), 6.1, 360));
+    // Pillar, pillar base
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(2., 2., 0.), Vec3d(2., 2., 8.), 1., 1., 360);
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(2., 2., 0.), Vec3d(2., 2., 1.), 2., 1., 360);
+    // Bridges, steep, flat and horizontal
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(0., 0., 1.), Vec3d(1., -2., 7.), 0.6, 0.6, 360);
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(0., 0., 4.), Vec3d(6., 3., 4.5), 0.6, 0.6, 360);
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(0., 0., 4.), Vec3d(-3., 5., 4.), 0.5, 0.5, 360);
+    // Tilted cone
+    solids.emplace_back(SupportSolid::DISKS, Vec3d(0., 1., 2.), Vec3d(2., 3., 5.), 1.2, 0.4, 360);
+    return solids;
+}
+
+static bool test_sections()
+{
+    bool ok = true;
+    for (const SupportSolid &solid : test_solids()) {
+        TriangleMesh       mesh = solid_mesh(solid);
+        TriangleMeshSlicer slicer(&mesh);
+        std::vector<float> heights;
+        double zmin = solid.min_z(), zmax = solid.max_z();
+        for (int i = - 2; i <= 42; ++ i)
+            heights.emplace_back(float(zmin + (zmax - zmin) * (i + 0.5) / 41.));
+        std::vector<ExPolygons> reference;
+        slicer.slice(heights, 0.f, &reference, [](){});
+        double scale = std::max(solid.r1, solid.r2);
+        for (size_t i = 0; i < heights.size(); ++ i) {
+            Polygon    section = sla::section(solid, heights[i]);
+            ExPolygons analytic;
+            if (! section.points.empty()) {
+                ok &= section.is_counter_clockwise();
+                analytic.emplace_back();
+                analytic.back().contour = section;
+            }
+            ok &= xor_area(analytic, reference[i]) < 0.005 * area_mm2(reference[i]) + 2e-3 * scale * scale;
+        }
+    }
+    std::cout << "sections: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_slice()
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> pos(0., 20.);
+    std::uniform_real_distribution<double> offset(-3., 3.);
+    std::uniform_real_distribution<double> radius(0.2, 1.);
+    std::vector<SupportSolid> solids;
+    for (int i = 0; i < 60; ++ i) {
+        Vec3d  p1(pos(rng), pos(rng), pos(rng));
+        Vec3d  p2 = p1 + Vec3d(offset(rng), offset(rng), offset(rng));
+        double r  = radius(rng);
+        switch (i % 4) {
+        case 0: solids.emplace_back(SupportSolid::sphere(p1, r, 45)); break;
+        case 1: solids.emplace_back(SupportSolid::SPHERES, p1, p2, r, 0.5 * r, 45); break;
+        case 2: solids.emplace_back(SupportSolid::DISKS, p1, p2, r, r, 45); break;
+        default: solids.emplace_back(SupportSolid::DISKS, p1, Vec3d(p1(0), p1(1), 0.), r, 2 * r, 45);
+        }
+    }
+    TriangleMesh merged;
+    for (const SupportSolid &solid : solids)
+        merged.merge(solid_mesh(solid));
+    merged.require_shared_vertices();
+
+    // TriangleMeshSlicer needs sorted heights, the solids are sliced at shuffled heights to exercise the Z interval index.
+    std::vector<float> sorted_heights;
+    for (float z = -0.075f; z < 25.f; z += 0.05f)
+        sorted_heights.emplace_back(z);
+    std::vector<size_t> order(sorted_heights.size());
+    for (size_t i = 0; i < order.size(); ++ i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<float> heights;
+    for (size_t i : order)
+        heights.emplace_back(sorted_heights[i]);
+
+    bool ok = true;
+    for (float closing_radius : { 0.f, 0.1f }) {
+        TriangleMeshSlicer      slicer(&merged);
+        std::vector<ExPolygons> reference;
+        slicer.slice(sorted_heights, closing_radius, &reference, [](){});
+        std::vector<ExPolygons> layers;
+        sla::slice(solids, heights, closing_radius, layers);
+        ok &= layers.size() == heights.size();
+        for (size_t i = 0; ok && i < heights.size(); ++ i)
+            ok &= xor_area(layers[i], reference[order[i]]) < 0.01 * area_mm2(reference[order[i]]) + 1e-3;
+    }
+
+    // The sections are united with the polygons already in the layers.
+    std::vector<ExPolygons> layers(heights.size());
+    ExPolygon square;
+    square.contour.points = { Point::new_scale(-10., -10.), Point::new_scale(-5., -10.), Point::new_scale(-5., -5.), Point::new_scale(-10., -5.) };
+    for (ExPolygons &layer : layers)
+        layer.emplace_back(square);
+    std::vector<ExPolygons> sliced;
+    sla::slice(solids, heights, 0.f, sliced);
+    sla::slice(solids, heights, 0.f, layers);
+    for (size_t i = 0; i < heights.size(); ++ i)
+        ok &= std::abs(area_mm2(layers[i]) - area_mm2(sliced[i]) - 25.) < 1e-6;
+
+    std::cout << "slice: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_sections();
+    ok &= test_slice();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
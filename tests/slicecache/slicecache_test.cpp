@@ -0,0 +1,149 @@
+// Verifies the persistent slice cache (Print::set_slice_cache_dir()): The G-code of a print sliced from the cache
+// has to be identical to the G-code of a print sliced from the meshes.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/GCode.hpp>
+#include <libslic3r/SliceCache.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+using namespace Slic3r;
+
+static bool test_hasher()
+{
+    // Test vectors of MurmurHash3_x64_128 with zero seed.
+    SliceCacheHasher empty;
+    SliceCacheHasher fox;
+    std::string      text = "The quick brown fox jumps over the lazy dog";
+    fox.update(text.data(), text.size());
+    bool ok = empty.digest() == "00000000000000000000000000000000" && fox.digest() == "e34bbc7bbc071b6c7a433ca9c49a9347";
+    // Hashing in pieces produces the same digest.
+    SliceCacheHasher pieces;
+    for (size_t i = 0; i < text.size(); i += 5)
+        pieces.update(text.data() + i, std::min(size_t(5), text.size() - i));
+    ok &= pieces.digest() == fox.digest();
+    std::cout << "hasher: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static Model make_model()
+{
+    Model model;
+    ModelObject *object = model.add_object();
+    object->name = "cube";
+    object->add_volume(make_cube(20., 20., 10.));
+    // A modifier volume creates a second region.
+    ModelVolume *modifier = object->add_volume(make_cylinder(6., 20.));
+    modifier->set_type(ModelVolumeType::PARAMETER_MODIFIER);
+    modifier->set_offset(Vec3d(10., 10., 0.));
+    modifier->config.set_deserialize("fill_density", "60%");
+    object->add_instance();
+    model.center_instances_around_point(Vec2d(100., 100.));
+    return model;
+}
+
+static std::string export_gcode(const Model &model, const DynamicPrintConfig &config, const boost::filesystem::path &cache_dir = boost::filesystem::path())
+{
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string() + ".gcode";
+    Print print;
+    print.set_slice_cache_dir(cache_dir.string());
+    print.apply(model, config);
+    print.process();
+    GCode gcode;
+    gcode.do_export(&print, path.c_str());
+    // Drop the header, which contains a timestamp.
+    std::ifstream     file(path);
+    std::stringstream out;
+    for (std::string line; std::getline(file, line);)
+        if (! boost::starts_with(line, "; generated by "))
+            out << line << '\n';
+    file.close();
+    boost::filesystem::remove(path);
+    return out.str();
+}
+
+static std::vector<boost::filesystem::path> cache_entries(const boost::filesystem::path &dir)
+{
+    std::vector<boost::filesystem::path> out;
+    for (boost::filesystem::directory_iterator it(dir); it != boost::filesystem::directory_iterator(); ++ it)
+        out.emplace_back(it->path());
+    return out;
+}
+
+static bool test_cache(const char *name, const Model &model, const DynamicPrintConfig &config, const boost::filesystem::path &dir)
+{
+    std::string reference = export_gcode(model, config);
+
+    bool   ok          = ! reference.empty();
+    size_t num_entries = boost::filesystem::exists(dir) ? cache_entries(dir).size() : 0;
+    // Cache miss, the sliced layers are stored.
+    ok &= export_gcode(model, config, dir) == reference;
+    std::vector<boost::filesystem::path> entries = cache_entries(dir);
+    ok &= entries.size() == num_entries + 1;
+    // Cache hit, the cache entry is not written again.
+    std::time_t time_old = std::time(nullptr) - 3600;
+    for (const boost::filesystem::path &path : entries)
+        boost::filesystem::last_write_time(path, time_old);
+    ok &= export_gcode(model, config, dir) == reference;
+    for (const boost::filesystem::path &path : cache_entries(dir))
+        ok &= boost::filesystem::last_write_time(path) == time_old;
+    ok &= cache_entries(dir).size() == num_entries + 1;
+
+    std::cout << name << ": " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+static bool test_corrupted(const Model &model, const DynamicPrintConfig &config, const boost::filesystem::path &dir)
+{
+    std::string reference = export_gcode(model, config);
+    // Truncate the cache entries, they shall be ignored and written again.
+    for (const boost::filesystem::path &path : cache_entries(dir))
+        boost::filesystem::resize_file(path, boost::filesystem::file_size(path) / 2);
+    bool ok = export_gcode(model, config, dir) == reference && export_gcode(model, config, dir) == reference;
+    // A bogus number of layers, which overflows the size check if multiplied by the minimum layer size.
+    for (const boost::filesystem::path &path : cache_entries(dir)) {
+        std::fstream file(path.string(), std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t     num_layers = uint64_t(1) << 62;
+        file.seekp(16);
+        file.write((const char*)&num_layers, sizeof(num_layers));
+    }
+    ok &= export_gcode(model, config, dir) == reference;
+    std::cout << "corrupted cache entry: " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_hasher();
+
+    boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    try {
+        Model model = make_model();
+        std::unique_ptr<DynamicPrintConfig> config(DynamicPrintConfig::new_from_defaults());
+        config->set_deserialize("fill_density", "20%");
+        ok &= test_cache("slice cache", model, *config, dir);
+        // Changing a slicing parameter creates a new cache entry.
+        config->set_deserialize("layer_height", "0.15");
+        config->set_deserialize("elefant_foot_compensation", "0.2");
+        config->set_deserialize("xy_size_compensation", "0.1");
+        ok &= test_cache("slice cache, second configuration", model, *config, dir);
+        ok &= test_corrupted(model, *config, dir);
+    } catch (const std::exception &ex) {
+        std::cout << "slice cache: FAILED, " << ex.what() << std::endl;
+        ok = false;
+    }
+    boost::filesystem::remove_all(dir);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}